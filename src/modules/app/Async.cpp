@@ -0,0 +1,55 @@
+/**
+ * @file
+ */
+
+#include "Async.h"
+#include "core/Common.h"
+#include "core/SharedPtr.h"
+#include "core/concurrent/Atomic.h"
+
+namespace app {
+
+void for_parallel(int start, int end, const std::function<void(int, int)> &func, int blockSize) {
+	if (end <= start) {
+		return;
+	}
+	const int n = end - start;
+	const int threads = core_max(1, (int)app::App::getInstance()->threadPool().size());
+	if (blockSize <= 0) {
+		// a few blocks per thread to balance uneven work
+		blockSize = core_max(1, n / (threads * 4));
+	}
+	const int blocks = (n + blockSize - 1) / blockSize;
+	if (blocks == 1) {
+		func(start, end);
+		return;
+	}
+	struct ParallelState {
+		core::AtomicInt next{0};
+		core::AtomicInt done{0};
+	};
+	// the state is shared with the tasks - they might start after this function returned. Such tasks don't touch the
+	// function anymore.
+	core::SharedPtr<ParallelState> state = core::make_shared<ParallelState>();
+	auto work = [start, end, blocks, blockSize, &func](ParallelState &s) {
+		for (;;) {
+			const int block = s.next.increment(1);
+			if (block >= blocks) {
+				return;
+			}
+			const int blockStart = start + block * blockSize;
+			func(blockStart, core_min(end, blockStart + blockSize));
+			s.done.increment(1);
+		}
+	};
+	const int tasks = core_min(blocks, threads) - 1;
+	for (int i = 0; i < tasks; ++i) {
+		app::async([state, work]() { work(*state.get()); });
+	}
+	work(*state.get());
+	while (state->done < blocks) {
+		app::App::getInstance()->wait(1);
+	}
+}
+
+} // namespace app
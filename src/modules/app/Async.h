@@ -6,6 +6,7 @@
 
 #include "app/App.h"
 #include "core/concurrent/ThreadPool.h"
+#include <functional>
 #include <future>
 
 namespace app {
@@ -16,4 +17,14 @@ auto async(F &&f, Args &&...args) -> std::future<typename std::invoke_result<F,
 	return app::App::getInstance()->threadPool().enqueue(core::forward<F>(f), core::forward<Args>(args)...);
 }
 
+/**
+ * @brief Splits the range @c [start, end) into blocks and executes the given function for each block in the thread
+ * pool. The calling thread takes part in the work and the function returns once all blocks were executed.
+ *
+ * @param blockSize The amount of elements per block - @c 0 picks a size that distributes the range over the threads
+ * of the pool
+ * @note The function gets the range @c [blockStart, blockEnd) of the block
+ */
+void for_parallel(int start, int end, const std::function<void(int, int)> &func, int blockSize = 0);
+
 } // namespace app
@@ -5,6 +5,7 @@
 #include "Color.h"
 #include "core/Algorithm.h"
 #include "core/ArrayLength.h"
+#include "core/ColorHistogram.h"
 #include "core/Common.h"
 #include "core/GLM.h"
 #include "core/Log.h"
@@ -162,24 +163,60 @@ Color::ColorReductionType Color::toColorReductionType(const char *str) {
 	return ColorReductionType::Max;
 }
 
+using HistogramEntry = ColorHistogram::Entry;
+
+static void fillUnusedColors(RGBA *targetBuf, size_t n, size_t maxTargetBufColors) {
+	for (size_t i = n; i < maxTargetBufColors; ++i) {
+		targetBuf[i] = RGBA(0xFFFFFFFFU);
+	}
+}
+
+static RGBA weightedAverage(const core::Buffer<HistogramEntry> &colors) {
+	uint64_t r = 0, g = 0, b = 0, a = 0, weight = 0;
+	for (const HistogramEntry &entry : colors) {
+		r += (uint64_t)entry.color.r * entry.weight;
+		g += (uint64_t)entry.color.g * entry.weight;
+		b += (uint64_t)entry.color.b * entry.weight;
+		a += (uint64_t)entry.color.a * entry.weight;
+		weight += entry.weight;
+	}
+	return RGBA(r / weight, g / weight, b / weight, a / weight);
+}
+
+static inline uint8_t colorComponent(RGBA color, int axis) {
+	if (axis == 0) {
+		return color.r;
+	}
+	if (axis == 1) {
+		return color.g;
+	}
+	return color.b;
+}
+
 struct ColorBox {
 	RGBA min, max;
-	core::Buffer<RGBA> pixels;
+	core::Buffer<HistogramEntry> colors;
+	/** the amount of input colors in this box */
+	uint64_t weight = 0;
 };
 
-static int medianCutFindMedian(const core::Buffer<RGBA> &colors, int axis) {
-	core::Buffer<int> values;
-	for (const core::RGBA &color : colors) {
-		if (axis == 0) {
-			values.push_back(color.r);
-		} else if (axis == 1) {
-			values.push_back(color.g);
-		} else {
-			values.push_back(color.b);
+/**
+ * @brief The weighted median - the same value as picking the middle of all sorted input colors
+ */
+static int medianCutFindMedian(const ColorBox &box, int axis) {
+	uint64_t counts[256]{};
+	for (const HistogramEntry &entry : box.colors) {
+		counts[colorComponent(entry.color, axis)] += entry.weight;
+	}
+	const uint64_t middle = box.weight / 2;
+	uint64_t sum = 0;
+	for (int value = 0; value < 256; ++value) {
+		sum += counts[value];
+		if (sum > middle) {
+			return value;
 		}
 	}
-	core::sort(values.begin(), values.end(), core::Less<int>());
-	return values[values.size() / 2];
+	return 255;
 }
 
 static core::Pair<ColorBox, ColorBox> medianCutSplitBox(const ColorBox &box) {
@@ -191,43 +228,22 @@ static core::Pair<ColorBox, ColorBox> medianCutSplitBox(const ColorBox &box) {
 		longestAxis = 2;
 	}
 
-	int median = medianCutFindMedian(box.pixels, longestAxis);
+	const int median = medianCutFindMedian(box, longestAxis);
 	ColorBox box1, box2;
-	for (const core::RGBA &color : box.pixels) {
-		if (longestAxis == 0) {
-			if (color.r < median) {
-				box1.pixels.push_back(color);
-			} else {
-				box2.pixels.push_back(color);
-			}
-		} else if (longestAxis == 1) {
-			if (color.g < median) {
-				box1.pixels.push_back(color);
-			} else {
-				box2.pixels.push_back(color);
-			}
+	for (const HistogramEntry &entry : box.colors) {
+		if (colorComponent(entry.color, longestAxis) < median) {
+			box1.colors.push_back(entry);
+			box1.weight += entry.weight;
 		} else {
-			if (color.b < median) {
-				box1.pixels.push_back(color);
-			} else {
-				box2.pixels.push_back(color);
-			}
+			box2.colors.push_back(entry);
+			box2.weight += entry.weight;
 		}
 	}
 
-	box1.min.r = box.min.r;
-	box1.max.r = box.max.r;
-	box1.min.g = box.min.g;
-	box1.max.g = box.max.g;
-	box1.min.b = box.min.b;
-	box1.max.b = box.max.b;
-
-	box2.min.r = box.min.r;
-	box2.max.r = box.max.r;
-	box2.min.g = box.min.g;
-	box2.max.g = box.max.g;
-	box2.min.b = box.min.b;
-	box2.max.b = box.max.b;
+	box1.min = box.min;
+	box1.max = box.max;
+	box2.min = box.min;
+	box2.max = box.max;
 
 	if (longestAxis == 0) {
 		box1.max.r = median;
@@ -243,19 +259,25 @@ static core::Pair<ColorBox, ColorBox> medianCutSplitBox(const ColorBox &box) {
 	return core::Pair{box1, box2};
 }
 
-static int quantizeMedianCut(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors) {
-	core::Buffer<RGBA> pixels;
-	pixels.append(inputBuf, inputBufColors);
+static ColorBox initialColorBox(const HistogramEntry *colors, size_t n) {
+	ColorBox box{{0, 0, 0, 255}, {255, 255, 255, 255}, {}, 0u};
+	box.colors.append(colors, n);
+	for (size_t i = 0; i < n; ++i) {
+		box.weight += colors[i].weight;
+	}
+	return box;
+}
 
+static int quantizeMedianCut(RGBA *targetBuf, size_t maxTargetBufColors, const HistogramEntry *colors, size_t n) {
 	core::DynamicArray<ColorBox> boxes;
-	boxes.emplace_back(ColorBox{{0, 0, 0, 255}, {255, 255, 255, 255}, pixels});
+	boxes.emplace_back(initialColorBox(colors, n));
 
 	while (boxes.size() < maxTargetBufColors) {
-		size_t maxSize = 0;
+		uint64_t maxWeight = 0;
 		size_t maxIndex = 0;
 		for (size_t i = 0; i < boxes.size(); ++i) {
-			if (boxes[i].pixels.size() > maxSize) {
-				maxSize = boxes[i].pixels.size();
+			if (boxes[i].weight > maxWeight) {
+				maxWeight = boxes[i].weight;
 				maxIndex = i;
 			}
 		}
@@ -267,34 +289,21 @@ static int quantizeMedianCut(RGBA *targetBuf, size_t maxTargetBufColors, const R
 		boxes.push_back(boxesPair.second);
 	}
 
-	size_t n = 0;
+	size_t colorCount = 0;
 	for (const ColorBox &box : boxes) {
-		if (box.pixels.empty()) {
+		if (box.colors.empty()) {
 			continue;
 		}
-		uint32_t r = 0, g = 0, b = 0, a = 0;
-		for (const core::RGBA &color : box.pixels) {
-			r += color.r;
-			g += color.g;
-			b += color.b;
-			a += color.a;
-		}
-		r /= box.pixels.size();
-		g /= box.pixels.size();
-		b /= box.pixels.size();
-		a /= box.pixels.size();
-		targetBuf[n++] = core::RGBA(r, g, b, a);
-		if (n >= maxTargetBufColors) {
-			return (int)n;
+		targetBuf[colorCount++] = weightedAverage(box.colors);
+		if (colorCount >= maxTargetBufColors) {
+			return (int)colorCount;
 		}
 	}
-	for (size_t i = n; i < maxTargetBufColors; ++i) {
-		targetBuf[i] = RGBA(0xFFFFFFFFU);
-	}
-	return (int)n;
+	fillUnusedColors(targetBuf, colorCount, maxTargetBufColors);
+	return (int)colorCount;
 }
 
-static int quantizeOctree(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors) {
+static int quantizeOctree(RGBA *targetBuf, size_t maxTargetBufColors, const HistogramEntry *colors, size_t n) {
 	core_assert(glm::isPowerOfTwo(maxTargetBufColors));
 	using BBox = math::AABB<uint8_t>;
 	struct ColorNode {
@@ -307,10 +316,10 @@ static int quantizeOctree(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA
 	const BBox aabb(0, 0, 0, 255, 255, 255);
 	using Tree = math::Octree<ColorNode, uint8_t>;
 	Tree octree(aabb, 32);
-	for (size_t i = 0; i < inputBufColors; ++i) {
-		octree.insert(inputBuf[i]);
+	for (size_t i = 0; i < n; ++i) {
+		octree.insert(colors[i].color);
 	}
-	size_t n = 0;
+	size_t colorCount = 0;
 	const glm::ivec3 dim(8);
 	const int rmax = aabb.getWidthX() + 1 - dim.r;
 	const int gmax = aabb.getWidthY() + 1 - dim.g;
@@ -325,74 +334,117 @@ static int quantizeOctree(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA
 				if (k == 0) {
 					continue;
 				}
-				targetBuf[n++] = contents.front().color;
-				if (n >= maxTargetBufColors) {
-					return (int)n;
+				targetBuf[colorCount++] = contents.front().color;
+				if (colorCount >= maxTargetBufColors) {
+					return (int)colorCount;
 				}
 			}
 		}
 	}
-	for (size_t i = n; i < maxTargetBufColors; ++i) {
-		targetBuf[i] = RGBA(0xFFFFFFFFU);
+	fillUnusedColors(targetBuf, colorCount, maxTargetBufColors);
+	return (int)colorCount;
+}
+
+static int quantizeKMeans(RGBA *targetBuf, size_t maxTargetBufColors, const HistogramEntry *colors, size_t n,
+						  uint32_t seed) {
+	static constexpr int MaxIterations = 256;
+	const int k = (int)maxTargetBufColors;
+
+	// pick the initial centers like random input colors - the bins are weighted by their amount of colors. Only the
+	// output of the engine is used - the std distributions are implementation defined.
+	core::Buffer<uint64_t> cumulativeWeights;
+	cumulativeWeights.resize(n);
+	uint64_t totalWeight = 0;
+	for (size_t i = 0; i < n; ++i) {
+		totalWeight += colors[i].weight;
+		cumulativeWeights[i] = totalWeight;
 	}
-	return (int)n;
-}
-
-static inline float getDistance(const glm::vec4 &p1, const glm::vec4 &p2) {
-	return glm::length(p1 - p2);
-}
-
-static int quantizeKMeans(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors) {
-	core::DynamicArray<glm::vec4> centers;
-	centers.resize(maxTargetBufColors);
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_int_distribution<> dis(0, (int)inputBufColors - 1);
-	for (int i = 0; i < (int)maxTargetBufColors; i++) {
-		centers[i] = core::Color::fromRGBA(inputBuf[dis(gen)]);
+	std::mt19937 gen(seed);
+
+	// the centers are stored per component to allow the compiler to vectorize the distance computation
+	core::Buffer<float> centers;
+	centers.resize(k * 4);
+	float *cr = centers.data();
+	float *cg = cr + k;
+	float *cb = cg + k;
+	float *ca = cb + k;
+	for (int i = 0; i < k; ++i) {
+		const uint64_t random = (((uint64_t)gen() << 32) | (uint64_t)gen()) % totalWeight;
+		size_t lo = 0;
+		size_t hi = n - 1;
+		while (lo < hi) {
+			const size_t mid = (lo + hi) / 2;
+			if (cumulativeWeights[mid] > random) {
+				hi = mid;
+			} else {
+				lo = mid + 1;
+			}
+		}
+		const glm::vec4 &center = core::Color::fromRGBA(colors[lo].color);
+		cr[i] = center.r;
+		cg[i] = center.g;
+		cb[i] = center.b;
+		ca[i] = center.a;
 	}
 
-	bool changed = true;
-	while (changed) {
-		changed = false;
-		core::DynamicArray<core::DynamicArray<glm::vec4>> clusters(maxTargetBufColors);
-		for (size_t i = 0; i < inputBufColors; ++i) {
-			const glm::vec4 point = core::Color::fromRGBA(inputBuf[i]);
+	core::Buffer<glm::vec4> points;
+	points.reserve(n);
+	for (size_t i = 0; i < n; ++i) {
+		points.push_back(core::Color::fromRGBA(colors[i].color));
+	}
+	core::Buffer<float> distances;
+	distances.resize(k);
+	float *dist = distances.data();
+	core::Buffer<glm::dvec4> sums;
+	sums.resize(k);
+	core::Buffer<double> weights;
+	weights.resize(k);
+
+	for (int iteration = 0; iteration < MaxIterations; ++iteration) {
+		sums.fill(glm::dvec4(0.0));
+		weights.fill(0.0);
+		for (size_t i = 0; i < n; ++i) {
+			const glm::vec4 &p = points[i];
+			for (int c = 0; c < k; ++c) {
+				const float dr = cr[c] - p.r;
+				const float dg = cg[c] - p.g;
+				const float db = cb[c] - p.b;
+				const float da = ca[c] - p.a;
+				dist[c] = dr * dr + dg * dg + db * db + da * da;
+			}
 			int closest = 0;
-			float closestDistance = getDistance(point, centers[0]);
-			for (int n = 1; n < (int)maxTargetBufColors; n++) {
-				float d = getDistance(point, centers[n]);
-				if (d < closestDistance) {
-					closest = n;
-					closestDistance = d;
+			for (int c = 1; c < k; ++c) {
+				if (dist[c] < dist[closest]) {
+					closest = c;
 				}
 			}
-			clusters[closest].push_back(point);
+			sums[closest] += glm::dvec4(p) * (double)colors[i].weight;
+			weights[closest] += (double)colors[i].weight;
 		}
-		for (int i = 0; i < (int)maxTargetBufColors; i++) {
-			if (clusters[i].empty()) {
+		bool changed = false;
+		for (int c = 0; c < k; ++c) {
+			if (weights[c] <= 0.0) {
 				continue;
 			}
-			glm::vec4 newCenter(0.0f);
-			for (const glm::vec4 &point : clusters[i]) {
-				newCenter += point;
-			}
-			newCenter /= clusters[i].size();
-			if (getDistance(newCenter, centers[i]) > 0.0001f) {
-				centers[i] = newCenter;
+			const glm::vec4 newCenter(sums[c] / weights[c]);
+			const glm::vec4 center(cr[c], cg[c], cb[c], ca[c]);
+			if (glm::distance(newCenter, center) > 0.0001f) {
+				cr[c] = newCenter.r;
+				cg[c] = newCenter.g;
+				cb[c] = newCenter.b;
+				ca[c] = newCenter.a;
 				changed = true;
 			}
 		}
+		if (!changed) {
+			break;
+		}
 	}
 
-	size_t n = 0;
-	for (const glm::vec4 &c : centers) {
-		targetBuf[n++] = core::Color::getRGBA(c);
+	for (int i = 0; i < k; ++i) {
+		targetBuf[i] = core::Color::getRGBA(glm::vec4(cr[i], cg[i], cb[i], ca[i]));
 	}
-	for (size_t i = n; i < maxTargetBufColors; ++i) {
-		targetBuf[i] = RGBA(0xFFFFFFFFU);
-	}
-	return (int)n;
+	return k;
 }
 
 // Based on NeuQuant algorithm from jo_gif_quantize
@@ -541,17 +593,14 @@ static int quantizeNeuQuant(RGBA *targetBuf, size_t maxTargetBufColors, const RG
 	return numColors;
 }
 
-static int quantizeWu(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors) {
-	core::Buffer<RGBA> pixels;
-	pixels.append(inputBuf, inputBufColors);
-
+static int quantizeWu(RGBA *targetBuf, size_t maxTargetBufColors, const HistogramEntry *colors, size_t n) {
 	// Initialize the set of boxes with the full color range
 	core::DynamicArray<ColorBox> boxes;
-	boxes.emplace_back(ColorBox{{0, 0, 0, 255}, {255, 255, 255, 255}, pixels});
+	boxes.emplace_back(initialColorBox(colors, n));
 
 	// Iterate until we reach the desired number of boxes
 	while (boxes.size() < maxTargetBufColors) {
-		// Find the box with the largest volume (i.e., the most pixels)
+		// Find the box with the largest volume
 		int maxVolume = std::numeric_limits<int>::min();
 		size_t maxVolumeIndex = 0;
 		for (size_t i = 0; i < boxes.size(); ++i) {
@@ -565,8 +614,7 @@ static int quantizeWu(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *in
 
 		// Split the box with the largest volume into two boxes along its longest dimension
 		const ColorBox &box = boxes[maxVolumeIndex];
-		const size_t pixelCount = box.pixels.size();
-		if (pixelCount <= 0) {
+		if (box.colors.empty()) {
 			boxes.erase(maxVolumeIndex);
 			continue;
 		}
@@ -585,49 +633,37 @@ static int quantizeWu(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *in
 		}
 
 		ColorBox box1, box2;
-		box1.pixels.reserve(pixelCount / 2);
-		box2.pixels.reserve(pixelCount / 2);
+		box1.colors.reserve(box.colors.size() / 2);
+		box2.colors.reserve(box.colors.size() / 2);
 		switch (component) {
 		case 0:
 			box1.min = box.min;
 			box1.max = RGBA(midpoint, box.max.g, box.max.b, 255);
 			box2.min = RGBA(midpoint + 1, box.min.g, box.min.b, 255);
 			box2.max = box.max;
-			for (const RGBA &pixel : box.pixels) {
-				if (pixel.r <= midpoint) {
-					box1.pixels.push_back(pixel);
-				} else {
-					box2.pixels.push_back(pixel);
-				}
-			}
 			break;
 		case 1:
 			box1.min = box.min;
 			box1.max = RGBA(box.max.r, midpoint, box.max.b, 255);
 			box2.min = RGBA(box.min.r, midpoint + 1, box.min.b, 255);
 			box2.max = box.max;
-			for (const RGBA &pixel : box.pixels) {
-				if (pixel.g <= midpoint) {
-					box1.pixels.push_back(pixel);
-				} else {
-					box2.pixels.push_back(pixel);
-				}
-			}
 			break;
 		case 2:
 			box1.min = box.min;
 			box1.max = RGBA(box.max.r, box.max.g, midpoint);
 			box2.min = RGBA(box.min.r, box.min.g, midpoint + 1);
 			box2.max = box.max;
-			for (const RGBA &pixel : box.pixels) {
-				if (pixel.b <= midpoint) {
-					box1.pixels.push_back(pixel);
-				} else {
-					box2.pixels.push_back(pixel);
-				}
-			}
 			break;
 		}
+		for (const HistogramEntry &entry : box.colors) {
+			if (colorComponent(entry.color, component) <= midpoint) {
+				box1.colors.push_back(entry);
+				box1.weight += entry.weight;
+			} else {
+				box2.colors.push_back(entry);
+				box2.weight += entry.weight;
+			}
+		}
 
 		// Replace the original box with the two split boxes
 		boxes.erase(maxVolumeIndex);
@@ -635,31 +671,21 @@ static int quantizeWu(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *in
 		boxes.emplace_back(core::move(box2));
 	}
 
-	size_t n = 0;
+	size_t colorCount = 0;
 	for (const ColorBox &box : boxes) {
-		if (box.pixels.empty()) {
+		if (box.colors.empty()) {
 			continue;
 		}
-		RGBA average(0, 0, 0, 255);
-		for (const RGBA &pixel : box.pixels) {
-			average.r += pixel.r;
-			average.g += pixel.g;
-			average.b += pixel.b;
-		}
-		average.r /= box.pixels.size();
-		average.g /= box.pixels.size();
-		average.b /= box.pixels.size();
-		targetBuf[n++] = average;
-	}
-
-	for (size_t i = n; i < maxTargetBufColors; ++i) {
-		targetBuf[i] = RGBA(0xFFFFFFFFU);
+		RGBA average = weightedAverage(box.colors);
+		average.a = 255;
+		targetBuf[colorCount++] = average;
 	}
-	return (int)n;
+	fillUnusedColors(targetBuf, colorCount, maxTargetBufColors);
+	return (int)colorCount;
 }
 
 int Color::quantize(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors,
-					ColorReductionType type) {
+					ColorReductionType type, uint32_t seed) {
 	if (inputBufColors <= maxTargetBufColors) {
 		size_t n;
 		for (n = 0; n < inputBufColors; ++n) {
@@ -670,17 +696,46 @@ int Color::quantize(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inpu
 		}
 		return (int)n;
 	}
+	if (type == ColorReductionType::NeuQuant) {
+		// the network is trained with samples of the input colors
+		return quantizeNeuQuant(targetBuf, maxTargetBufColors, inputBuf, inputBufColors);
+	}
+	ColorHistogram histogram;
+	histogram.add(inputBuf, inputBufColors);
+	return quantize(targetBuf, maxTargetBufColors, histogram, type, seed);
+}
+
+int Color::quantize(RGBA *targetBuf, size_t maxTargetBufColors, const ColorHistogram &histogram,
+					ColorReductionType type, uint32_t seed) {
+	core::Buffer<HistogramEntry> colors;
+	histogram.entries(colors);
+	if (colors.size() <= maxTargetBufColors) {
+		size_t n;
+		for (n = 0; n < colors.size(); ++n) {
+			targetBuf[n] = colors[n].color;
+		}
+		for (size_t i = n; i < maxTargetBufColors; ++i) {
+			targetBuf[i] = RGBA(255, 255, 255, 255);
+		}
+		return (int)n;
+	}
 	switch (type) {
 	case ColorReductionType::Wu:
-		return quantizeWu(targetBuf, maxTargetBufColors, inputBuf, inputBufColors);
+		return quantizeWu(targetBuf, maxTargetBufColors, colors.data(), colors.size());
 	case ColorReductionType::KMeans:
-		return quantizeKMeans(targetBuf, maxTargetBufColors, inputBuf, inputBufColors);
-	case ColorReductionType::NeuQuant:
-		return quantizeNeuQuant(targetBuf, maxTargetBufColors, inputBuf, inputBufColors);
+		return quantizeKMeans(targetBuf, maxTargetBufColors, colors.data(), colors.size(), seed);
+	case ColorReductionType::NeuQuant: {
+		core::Buffer<RGBA> pixels;
+		pixels.reserve(colors.size());
+		for (const HistogramEntry &entry : colors) {
+			pixels.push_back(entry.color);
+		}
+		return quantizeNeuQuant(targetBuf, maxTargetBufColors, pixels.data(), pixels.size());
+	}
 	case ColorReductionType::Octree:
-		return quantizeOctree(targetBuf, maxTargetBufColors, inputBuf, inputBufColors);
+		return quantizeOctree(targetBuf, maxTargetBufColors, colors.data(), colors.size());
 	case ColorReductionType::MedianCut:
-		return quantizeMedianCut(targetBuf, maxTargetBufColors, inputBuf, inputBufColors);
+		return quantizeMedianCut(targetBuf, maxTargetBufColors, colors.data(), colors.size());
 	default:
 		break;
 	}
@@ -13,6 +13,8 @@
 
 namespace core {
 
+class ColorHistogram;
+
 class Color {
 public:
 	static const uint32_t magnitude = 255;
@@ -74,9 +76,18 @@ public:
 	static const char* toColorReductionTypeString(Color::ColorReductionType type);
 
 	/**
+	 * @brief The input colors are counted in a @c ColorHistogram first - only the NeuQuant network is trained with the
+	 * input colors directly.
+	 * @param seed The seed for the initial cluster centers of KMeans - the same seed always gives the same result
 	 * @return @c -1 on error or the amount of @code colors <= maxTargetBufColors @endcode
 	 */
-	static int quantize(RGBA* targetBuf, size_t maxTargetBufColors, const RGBA* inputBuf, size_t inputBufColors, ColorReductionType type = ColorReductionType::MedianCut);
+	static int quantize(RGBA* targetBuf, size_t maxTargetBufColors, const RGBA* inputBuf, size_t inputBufColors, ColorReductionType type = ColorReductionType::MedianCut, uint32_t seed = 0u);
+	/**
+	 * @brief Reduces the weighted colors of the histogram. The time doesn't depend on the amount of colors that were
+	 * added to the histogram.
+	 * @sa ColorHistogram
+	 */
+	static int quantize(RGBA* targetBuf, size_t maxTargetBufColors, const ColorHistogram &histogram, ColorReductionType type = ColorReductionType::MedianCut, uint32_t seed = 0u);
 
 	static inline glm::vec4 fromRGBA(const RGBA rgba) {
 		return fromRGBA(rgba.r, rgba.g, rgba.b, rgba.a);
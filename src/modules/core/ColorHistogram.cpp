@@ -0,0 +1,110 @@
+/**
+ * @file
+ */
+
+#include "ColorHistogram.h"
+#include "core/Algorithm.h"
+#include "core/StandardLib.h"
+#include <limits.h>
+
+namespace core {
+
+ColorHistogram::ColorHistogram() {
+	_bins.resize(Bins);
+	clear();
+}
+
+void ColorHistogram::clear() {
+	core_memset(_bins.data(), 0, _bins.size() * sizeof(Bin));
+	_exact.clear();
+	_exactOverflow = false;
+	_total = 0u;
+}
+
+void ColorHistogram::addExact(RGBA color, uint64_t count) {
+	auto iter = _exact.find(color);
+	if (iter != _exact.end()) {
+		iter->value += count;
+		return;
+	}
+	if (_exact.size() >= MaxExactColors) {
+		_exact.clear();
+		_exactOverflow = true;
+		return;
+	}
+	_exact.put(color, count);
+}
+
+void ColorHistogram::add(const RGBA *colors, size_t n) {
+	for (size_t i = 0; i < n; ++i) {
+		add(colors[i]);
+	}
+}
+
+void ColorHistogram::merge(const ColorHistogram &other) {
+	for (int i = 0; i < Bins; ++i) {
+		const Bin &src = other._bins[i];
+		if (src.count == 0u) {
+			continue;
+		}
+		Bin &dest = _bins[i];
+		dest.r += src.r;
+		dest.g += src.g;
+		dest.b += src.b;
+		dest.a += src.a;
+		dest.count += src.count;
+	}
+	_total += other._total;
+	if (other._exactOverflow) {
+		_exact.clear();
+		_exactOverflow = true;
+		return;
+	}
+	for (auto iter = other._exact.begin(); iter != other._exact.end() && !_exactOverflow; ++iter) {
+		addExact(iter->key, iter->value);
+	}
+}
+
+static inline uint32_t toWeight(uint64_t count) {
+	return count > UINT_MAX ? UINT_MAX : (uint32_t)count;
+}
+
+void ColorHistogram::entries(core::Buffer<Entry> &out) const {
+	out.clear();
+	if (!_exactOverflow) {
+		out.reserve(_exact.size());
+		for (auto iter = _exact.begin(); iter != _exact.end(); ++iter) {
+			out.push_back(Entry{iter->key, toWeight(iter->value)});
+		}
+		// the map order depends on the insertion order - sort to get the same result for merged histograms
+		core::sort(out.begin(), out.end(), [](const Entry &lhs, const Entry &rhs) {
+			const int lhsBin = bin(lhs.color);
+			const int rhsBin = bin(rhs.color);
+			if (lhsBin != rhsBin) {
+				return lhsBin < rhsBin;
+			}
+			return lhs.color.rgba < rhs.color.rgba;
+		});
+		return;
+	}
+	size_t used = 0u;
+	for (int i = 0; i < Bins; ++i) {
+		if (_bins[i].count != 0u) {
+			++used;
+		}
+	}
+	out.reserve(used);
+	for (int i = 0; i < Bins; ++i) {
+		const Bin &b = _bins[i];
+		if (b.count == 0u) {
+			continue;
+		}
+		// round to the nearest value
+		const uint64_t half = b.count / 2u;
+		const RGBA color((uint8_t)((b.r + half) / b.count), (uint8_t)((b.g + half) / b.count),
+						 (uint8_t)((b.b + half) / b.count), (uint8_t)((b.a + half) / b.count));
+		out.push_back(Entry{color, toWeight(b.count)});
+	}
+}
+
+} // namespace core
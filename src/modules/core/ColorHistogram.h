@@ -0,0 +1,99 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/RGBA.h"
+#include "core/collection/Buffer.h"
+#include "core/collection/DynamicMap.h"
+#include <stdint.h>
+
+namespace core {
+
+/**
+ * @brief Counts the colors of an image or any other color source in bins of 5 bits per rgb channel
+ *
+ * As long as there are not more than @c MaxExactColors different colors, the exact colors are counted, too, and
+ * entries() returns them. Only if there are more colors, the bins are used: every bin keeps the sum of the colors that
+ * were added to it. The color of a bin is the average of these colors - a bin that only got one color returns this
+ * color unchanged. The color quantizers are operating on the weighted entries instead of every input color.
+ *
+ * Histograms can be filled independently for parts of the input and merged afterwards.
+ *
+ * @sa Color::quantize()
+ */
+class ColorHistogram {
+public:
+	static constexpr int Bits = 5;
+	static constexpr int Bins = 1 << (Bits * 3);
+	static constexpr size_t MaxExactColors = 4096u;
+
+	struct Entry {
+		RGBA color;
+		uint32_t weight;
+	};
+
+private:
+	struct Bin {
+		uint64_t r;
+		uint64_t g;
+		uint64_t b;
+		uint64_t a;
+		uint64_t count;
+	};
+	core::Buffer<Bin> _bins;
+	core::DynamicMap<RGBA, uint64_t, 1031, RGBAHasher> _exact;
+	// there were more than MaxExactColors different colors - only the bins are used
+	bool _exactOverflow = false;
+	uint64_t _total = 0u;
+
+	void addExact(RGBA color, uint64_t count);
+
+	static inline int bin(RGBA color) {
+		return ((color.r >> (8 - Bits)) << (Bits * 2)) | ((color.g >> (8 - Bits)) << Bits) | (color.b >> (8 - Bits));
+	}
+
+public:
+	ColorHistogram();
+
+	void clear();
+
+	inline void add(RGBA color) {
+		Bin &b = _bins[bin(color)];
+		b.r += color.r;
+		b.g += color.g;
+		b.b += color.b;
+		b.a += color.a;
+		++b.count;
+		++_total;
+		if (!_exactOverflow) {
+			addExact(color, 1u);
+		}
+	}
+
+	void add(const RGBA *colors, size_t n);
+	void merge(const ColorHistogram &other);
+
+	/**
+	 * @return The amount of colors that were added
+	 */
+	inline uint64_t total() const {
+		return _total;
+	}
+
+	/**
+	 * @return @c true if entries() returns the exact input colors
+	 */
+	inline bool exact() const {
+		return !_exactOverflow;
+	}
+
+	/**
+	 * @brief The exact colors and their weights - or the average color and weight of every used bin if there are too
+	 * many different colors. Sorted by the bin index.
+	 */
+	void entries(core::Buffer<Entry> &out) const;
+};
+
+} // namespace core
@@ -33,6 +33,7 @@ constexpr const char *AssetPanelLocalDirectory = "ui_assetlocaldirectory";
 
 constexpr const char *HttpConnectTimeout = "http_connecttimeout";
 constexpr const char *HttpTimeout = "http_timeout";
+constexpr const char *HttpMaxConnections = "http_maxconnections";
 
 constexpr const char *ClientGamma = "cl_gamma";
 constexpr const char *ClientShadowMap = "cl_shadowmap";
@@ -68,6 +69,7 @@ constexpr const char *MetricHost = "metric_host";
 constexpr const char *MetricJsonUrl = "metric_json_url";
 constexpr const char *MetricFlavor = "metric_flavor";
 constexpr const char *MetricUUID = "metric_uuid";
+constexpr const char *MetricInterval = "metric_interval";
 
 constexpr const char *VoxelPalette = "palette";
 constexpr const char *NormalPalette = "normalpalette";
@@ -105,6 +107,8 @@ constexpr const char *VoxformatQBSaveLeftHanded = "voxformat_qbsavelefthanded";
 constexpr const char *VoxformatQBSaveCompressed = "voxformat_qbsavecompressed";
 constexpr const char *VoxFormatGLTF_KHR_materials_pbrSpecularGlossiness = "voxformat_gltf_khr_materials_pbrspecularglossiness";
 constexpr const char *VoxFormatGLTF_KHR_materials_specular = "voxformat_gltf_khr_materials_specular";
+constexpr const char *VoxFormatGLTF_KHR_mesh_quantization = "voxformat_gltf_khr_mesh_quantization";
+constexpr const char *VoxFormatGLTF_EXT_meshopt_compression = "voxformat_gltf_ext_meshopt_compression";
 constexpr const char *VoxformatImageVolumeMaxDepth = "voxformat_imagevolumemaxdepth";
 constexpr const char *VoxformatImageHeightmapMinHeight = "voxformat_imageheightmapminheight";
 constexpr const char *VoxformatImageVolumeBothSides = "voxformat_imagevolumebothsides";
@@ -1,8 +1,13 @@
 #include "app/benchmark/AbstractBenchmark.h"
 #include "core/collection/Map.h"
+#include "core/collection/ConcurrentPriorityQueue.h"
+#include "core/collection/ConcurrentQueue.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Lock.h"
 #include "core/Assert.h"
 #include <unordered_map>
 #include <map>
+#include <thread>
 
 class MapBenchmark: public app::AbstractBenchmark {
 };
@@ -57,4 +62,90 @@ BENCHMARK_REGISTER_F(MapBenchmark, compareToMapCore)->RangeMultiplier(2)->Range(
 BENCHMARK_REGISTER_F(MapBenchmark, compareToMapStd)->RangeMultiplier(2)->Range(8, 512);
 BENCHMARK_REGISTER_F(MapBenchmark, compareToUnorderedMapStd)->RangeMultiplier(2)->Range(8, 512);
 
+/**
+ * @brief The mutex based queue that was used by ConcurrentQueue before it was switched to the lock-free ring
+ */
+template<class Data>
+class LockedQueue {
+private:
+	core::DynamicArray<Data> _data;
+	core::Lock _mutex;
+
+public:
+	void push(const Data &data) {
+		core::ScopedLock lock(_mutex);
+		_data.push_back(data);
+	}
+
+	bool pop(Data &data) {
+		core::ScopedLock lock(_mutex);
+		if (_data.empty()) {
+			return false;
+		}
+		data = _data.front();
+		_data.erase(_data.begin());
+		return true;
+	}
+};
+
+class QueueBenchmark : public app::AbstractBenchmark {
+protected:
+	static constexpr int Elements = 20000;
+
+	/**
+	 * @brief The given amount of producer threads push their elements while the calling thread pops them
+	 */
+	template<class QUEUE>
+	void run(benchmark::State &state, QUEUE &queue) {
+		const int producers = (int)state.range(0);
+		const int n = Elements / producers;
+		core::DynamicArray<std::thread> threads;
+		threads.reserve(producers);
+		for (int p = 0; p < producers; ++p) {
+			threads.emplace_back([&queue, n]() {
+				for (int i = 0; i < n; ++i) {
+					queue.push(i);
+				}
+			});
+		}
+		int popped = 0;
+		int value;
+		while (popped < n * producers) {
+			if (queue.pop(value)) {
+				++popped;
+			} else {
+				std::this_thread::yield();
+			}
+		}
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(QueueBenchmark, ConcurrentQueue) (benchmark::State& state) {
+	for (auto _ : state) {
+		core::ConcurrentQueue<int> queue(1024);
+		run(state, queue);
+	}
+}
+
+BENCHMARK_DEFINE_F(QueueBenchmark, ConcurrentPriorityQueue) (benchmark::State& state) {
+	for (auto _ : state) {
+		core::ConcurrentPriorityQueue<int> queue(1024);
+		run(state, queue);
+	}
+}
+
+BENCHMARK_DEFINE_F(QueueBenchmark, LockedQueue) (benchmark::State& state) {
+	for (auto _ : state) {
+		LockedQueue<int> queue;
+		run(state, queue);
+	}
+}
+
+BENCHMARK_REGISTER_F(QueueBenchmark, ConcurrentQueue)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+BENCHMARK_REGISTER_F(QueueBenchmark, ConcurrentPriorityQueue)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+BENCHMARK_REGISTER_F(QueueBenchmark, LockedQueue)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+
 BENCHMARK_MAIN();
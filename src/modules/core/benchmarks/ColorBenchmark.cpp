@@ -0,0 +1,54 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/ArrayLength.h"
+#include "core/Color.h"
+#include "core/collection/Buffer.h"
+
+class ColorBenchmark : public app::AbstractBenchmark {
+protected:
+	core::Buffer<core::RGBA> _colors;
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		// a texture like input with a lot of similar colors
+		const int64_t n = state.range(0);
+		_colors.clear();
+		_colors.reserve(n);
+		uint32_t s = 4711u;
+		for (int64_t i = 0; i < n; ++i) {
+			s = s * 1664525u + 1013904223u;
+			const uint8_t base = (uint8_t)(i / 4096);
+			_colors.push_back(core::RGBA(base + (s >> 28), (uint8_t)(base * 3) + ((s >> 20) & 15),
+										 (uint8_t)(base * 7) + ((s >> 12) & 15), 255));
+		}
+	}
+
+	void quantize(::benchmark::State &state, core::Color::ColorReductionType type) {
+		core::RGBA targetBuf[256];
+		for (auto _ : state) {
+			int n = core::Color::quantize(targetBuf, lengthof(targetBuf), _colors.data(), _colors.size(), type);
+			benchmark::DoNotOptimize(n);
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)_colors.size());
+	}
+};
+
+BENCHMARK_DEFINE_F(ColorBenchmark, QuantizeMedianCut)(benchmark::State &state) {
+	quantize(state, core::Color::ColorReductionType::MedianCut);
+}
+
+BENCHMARK_DEFINE_F(ColorBenchmark, QuantizeWu)(benchmark::State &state) {
+	quantize(state, core::Color::ColorReductionType::Wu);
+}
+
+BENCHMARK_DEFINE_F(ColorBenchmark, QuantizeKMeans)(benchmark::State &state) {
+	quantize(state, core::Color::ColorReductionType::KMeans);
+}
+
+BENCHMARK_REGISTER_F(ColorBenchmark, QuantizeMedianCut)->RangeMultiplier(16)->Range(1 << 16, 1 << 20);
+BENCHMARK_REGISTER_F(ColorBenchmark, QuantizeWu)->RangeMultiplier(16)->Range(1 << 16, 1 << 20);
+BENCHMARK_REGISTER_F(ColorBenchmark, QuantizeKMeans)->Arg(1 << 16)->Arg(1 << 20);
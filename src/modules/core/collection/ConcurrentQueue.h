@@ -7,6 +7,7 @@
 #include "core/concurrent/Atomic.h"
 #include "core/concurrent/Lock.h"
 #include "core/concurrent/ConditionVariable.h"
+#include "core/collection/ConcurrentRingBuffer.h"
 #include "core/collection/DynamicArray.h"
 #include "core/Trace.h"
 #include "core/Common.h"
@@ -15,22 +16,71 @@
 
 namespace core {
 
+/**
+ * @brief Unbounded multi producer multi consumer queue
+ *
+ * The elements are passed through a lock-free ring buffer. Only if the ring is full, the elements are put into an
+ * overflow list behind a lock - until the overflow list is drained again, new elements are put there, too. This keeps
+ * the order of the elements of one producer. The lock is also taken if a consumer is waiting in waitAndPop() -
+ * producers don't touch the condition variable if no one is waiting.
+ *
+ * @ingroup Collections
+ */
 template<class Data>
 class ConcurrentQueue {
 private:
-	using Collection = core::DynamicArray<Data>;
-	Collection _data core_thread_guarded_by(_mutex);
+	static constexpr size_t MinCapacity = 64u;
+	core::ConcurrentRingBuffer<Data> _ring;
+	core::DynamicArray<Data> _overflow core_thread_guarded_by(_mutex);
+	// the elements in front of this index were already popped - the list is cleared once it was drained completely
+	size_t _overflowFront core_thread_guarded_by(_mutex) = 0u;
 	mutable core_trace_mutex(core::Lock,  _mutex, "ConcurrentQueue");
 	core::ConditionVariable _conditionVariable;
+	core::AtomicInt _overflowSize { 0 };
+	core::AtomicInt _waiting { 0 };
 	core::AtomicBool _abort { false };
+
+	template<typename T>
+	void pushInternal(T&& data) {
+		if (_overflowSize == 0 && _ring.tryPush(core::forward<T>(data))) {
+			return;
+		}
+		core::ScopedLock lock(_mutex);
+		_overflow.push_back(core::forward<T>(data));
+		++_overflowSize;
+	}
+
+	void notify() {
+		if (_waiting > 0) {
+			// taking the lock makes sure that the waiting consumer is already inside of the wait call
+			core::ScopedLock lock(_mutex);
+			_conditionVariable.notify_one();
+		}
+	}
+
+	bool popOverflow(Data& poppedValue) {
+		core::ScopedLock lock(_mutex);
+		// the ring might have been filled again while we were waiting for the lock - those elements are older
+		if (_ring.tryPop(poppedValue)) {
+			return true;
+		}
+		if (_overflowFront >= _overflow.size()) {
+			return false;
+		}
+		poppedValue = core::move(_overflow[_overflowFront++]);
+		if (_overflowFront == _overflow.size()) {
+			_overflow.clear();
+			_overflowFront = 0u;
+		}
+		--_overflowSize;
+		return true;
+	}
+
 public:
 	using value_type = Data;
 	using Key = Data;
 
-	ConcurrentQueue(size_t reserve = 0u) {
-		if (reserve) {
-			_data.reserve(reserve);
-		}
+	ConcurrentQueue(size_t reserve = 0u) : _ring(core_max(reserve, MinCapacity)) {
 	}
 
 	~ConcurrentQueue() {
@@ -39,6 +89,7 @@ public:
 
 	void abortWait() {
 		_abort = true;
+		core::ScopedLock lock(_mutex);
 		_conditionVariable.notify_all();
 	}
 
@@ -47,126 +98,115 @@ public:
 	}
 
 	void clear() {
+		Data data;
+		while (_ring.tryPop(data)) {
+		}
 		core::ScopedLock lock(_mutex);
-		_data.clear();
+		_overflow.clear();
+		_overflowFront = 0u;
+		_overflowSize = 0;
 	}
 
 	void release() {
+		clear();
 		core::ScopedLock lock(_mutex);
-		_data.release();
+		_overflow.release();
 	}
 
 	template<typename ITER>
 	void push(ITER first, ITER last) {
-		{
-			core::ScopedLock lock(_mutex);
-			for (ITER i = first; i != last; ++i) {
-				_data.push_back(*i);
-			}
+		for (ITER i = first; i != last; ++i) {
+			pushInternal(*i);
 		}
-		_conditionVariable.notify_one();
+		notify();
 	}
 
 	template<typename ITER, typename FUNC>
 	void push(ITER first, ITER last, FUNC&& func) {
-		{
-			core::ScopedLock lock(_mutex);
-			for (ITER i = first; i != last; ++i) {
-				_data.push_back(func(*i));
-			}
+		for (ITER i = first; i != last; ++i) {
+			pushInternal(func(*i));
 		}
-		_conditionVariable.notify_one();
+		notify();
 	}
 
 	void push(Data const& data) {
-		{
-			core::ScopedLock lock(_mutex);
-			_data.push_back(data);
-		}
-		_conditionVariable.notify_one();
+		pushInternal(data);
+		notify();
 	}
 
 	void push(Data&& data) {
-		{
-			core::ScopedLock lock(_mutex);
-			_data.push_back(core::move(data));
-		}
-		_conditionVariable.notify_one();
+		pushInternal(core::move(data));
+		notify();
 	}
 
 	template<typename ... _Args>
 	void emplace(_Args&&... __args) {
-		{
-			core::ScopedLock lock(_mutex);
-			_data.emplace_back(core::forward<_Args>(__args)...);
-		}
-		_conditionVariable.notify_one();
+		pushInternal(Data(core::forward<_Args>(__args)...));
+		notify();
 	}
 
 	inline bool empty() const {
-		core::ScopedLock lock(_mutex);
-		return _data.empty();
+		return size() == 0u;
 	}
 
 	inline uint32_t size() const {
-		core::ScopedLock lock(_mutex);
-		return (uint32_t)_data.size();
+		return _ring.size() + (uint32_t)(int)_overflowSize;
 	}
 
 	bool pop(Data& poppedValue) {
-		core::ScopedLock lock(_mutex);
-		if (_data.empty()) {
+		if (_ring.tryPop(poppedValue)) {
+			return true;
+		}
+		if (_overflowSize == 0) {
 			return false;
 		}
-
-		poppedValue = core::move(_data.front());
-		_data.erase(_data.begin());
-		return true;
+		return popOverflow(poppedValue);
 	}
 
 	template<class COLLECTION>
 	bool popAll(COLLECTION& out) {
-		core::ScopedLock lock(_mutex);
-		if (_data.empty()) {
-			return false;
+		Data data;
+		bool popped = false;
+		while (pop(data)) {
+			out.push_back(core::move(data));
+			popped = true;
 		}
-
-		out.append(_data);
-		_data.clear();
-		return true;
+		return popped;
 	}
 
 	template<class COLLECTION>
 	bool pop(COLLECTION& out, size_t n) {
-		core::ScopedLock lock(_mutex);
-		if (_data.empty()) {
-			return false;
-		}
-
-		out.reserve(out.size() + n);
+		Data data;
+		bool popped = false;
 		for (size_t i = 0; i < n; ++i) {
-			if (_data.size() <= i) {
+			if (!pop(data)) {
 				break;
 			}
-			out.push_back(core::move(_data[i]));
+			out.push_back(core::move(data));
+			popped = true;
 		}
-		_data.erase(_data.begin(), n);
-		return true;
+		return popped;
 	}
 
 	bool waitAndPop(Data& poppedValue) {
-		core::ScopedLock lock(_mutex);
-		while (_data.empty() && !_abort) {
-			if (!_conditionVariable.wait(_mutex)) {
+		for (;;) {
+			if (_abort) {
 				return false;
 			}
+			if (pop(poppedValue)) {
+				return true;
+			}
+			core::ScopedLock lock(_mutex);
+			++_waiting;
+			// check again after announcing the wait - a producer either sees the waiting consumer or we see the element
+			while (!_abort && _ring.empty() && _overflowSize == 0) {
+				if (!_conditionVariable.wait(_mutex)) {
+					--_waiting;
+					return false;
+				}
+			}
+			--_waiting;
 		}
-		if (_abort) {
-			return false;
-		}
-		poppedValue = core::move(_data.front());
-		_data.erase(_data.begin());
-		return true;
 	}
 };
 
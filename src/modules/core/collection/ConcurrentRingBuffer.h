@@ -0,0 +1,152 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/NonCopyable.h"
+#include "core/concurrent/Atomic.h"
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core {
+
+/**
+ * @brief Bounded lock-free multi producer multi consumer queue
+ *
+ * Every slot carries a sequence number that tells producers and consumers whether the slot is free for the current
+ * round of the ring or already filled. Producers and consumers only contend on the head and tail counters with a
+ * compare-and-swap - there is no lock involved. A single producer or a single consumer is just a special case of this.
+ *
+ * The capacity is rounded up to the next power of two. The elements are constructed in the slots on push and
+ * destroyed on pop - @c Data doesn't need a default constructor.
+ *
+ * @note tryPush() fails if the ring is full - see ConcurrentQueue for an unbounded queue on top of this.
+ * @ingroup Collections
+ */
+template<class Data>
+class ConcurrentRingBuffer : public core::NonCopyable {
+private:
+	struct Slot {
+		core::AtomicInt sequence;
+		alignas(Data) uint8_t storage[sizeof(Data)];
+
+		inline Data *data() {
+			return (Data *)storage;
+		}
+	};
+	Slot *_slots;
+	uint32_t _mask;
+	// keep the counters of the producers and the consumers on different cache lines
+	alignas(64) core::AtomicInt _tail{0};
+	alignas(64) core::AtomicInt _head{0};
+
+	static uint32_t roundCapacity(size_t capacity) {
+		uint32_t n = 2u;
+		while (n < capacity && n < (1u << 30)) {
+			n <<= 1;
+		}
+		return n;
+	}
+
+public:
+	using value_type = Data;
+
+	ConcurrentRingBuffer(size_t capacity = 256u) {
+		const uint32_t n = roundCapacity(capacity);
+		_mask = n - 1u;
+		_slots = new Slot[n];
+		for (uint32_t i = 0u; i < n; ++i) {
+			_slots[i].sequence = (int)i;
+		}
+	}
+
+	~ConcurrentRingBuffer() {
+		const uint32_t tail = (uint32_t)(int)_tail;
+		for (uint32_t pos = (uint32_t)(int)_head; pos != tail; ++pos) {
+			Slot &slot = _slots[pos & _mask];
+			if ((uint32_t)(int)slot.sequence == pos + 1u) {
+				slot.data()->~Data();
+			}
+		}
+		delete[] _slots;
+	}
+
+	inline size_t capacity() const {
+		return (size_t)_mask + 1u;
+	}
+
+	/**
+	 * @return @c false if the ring is full
+	 */
+	template<typename T>
+	bool tryPush(T &&data) {
+		uint32_t pos = (uint32_t)(int)_tail;
+		for (;;) {
+			Slot &slot = _slots[pos & _mask];
+			const int diff = (int)((uint32_t)(int)slot.sequence - pos);
+			if (diff == 0) {
+				// the slot is free in this round - claim it
+				if (_tail.compare_exchange((int)pos, (int)(pos + 1u))) {
+					new (slot.storage) Data(core::forward<T>(data));
+					slot.sequence = (int)(pos + 1u);
+					return true;
+				}
+				pos = (uint32_t)(int)_tail;
+			} else if (diff < 0) {
+				// the slot still holds the element of the previous round
+				return false;
+			} else {
+				// another producer was faster
+				pos = (uint32_t)(int)_tail;
+			}
+		}
+	}
+
+	/**
+	 * @return @c false if the ring is empty
+	 */
+	bool tryPop(Data &out) {
+		uint32_t pos = (uint32_t)(int)_head;
+		for (;;) {
+			Slot &slot = _slots[pos & _mask];
+			const int diff = (int)((uint32_t)(int)slot.sequence - (pos + 1u));
+			if (diff == 0) {
+				if (_head.compare_exchange((int)pos, (int)(pos + 1u))) {
+					Data *data = slot.data();
+					out = core::move(*data);
+					data->~Data();
+					// free the slot for the next round
+					slot.sequence = (int)(pos + _mask + 1u);
+					return true;
+				}
+				pos = (uint32_t)(int)_head;
+			} else if (diff < 0) {
+				// nothing was pushed into this slot yet
+				return false;
+			} else {
+				// another consumer was faster
+				pos = (uint32_t)(int)_head;
+			}
+		}
+	}
+
+	/**
+	 * @note This is only a snapshot if other threads are pushing or popping
+	 */
+	inline uint32_t size() const {
+		const uint32_t head = (uint32_t)(int)_head;
+		const uint32_t tail = (uint32_t)(int)_tail;
+		const int diff = (int)(tail - head);
+		return diff > 0 ? (uint32_t)diff : 0u;
+	}
+
+	inline bool empty() const {
+		return size() == 0u;
+	}
+};
+
+} // namespace core
@@ -4,6 +4,7 @@
 
 #include <gtest/gtest.h>
 #include "core/Color.h"
+#include "core/ColorHistogram.h"
 #include "core/RGBA.h"
 #include "core/ArrayLength.h"
 #include "core/StringUtil.h"
@@ -117,6 +118,111 @@ TEST(ColorTest, testQuantize) {
 
 	n = core::Color::quantize(targetBuf, lengthof(targetBuf), buf, lengthof(buf), core::Color::ColorReductionType::KMeans);
 	EXPECT_EQ(256, n) << "Failed with k-means.\n" << core::BufferView<RGBA>(targetBuf, n) << "\n" << core::BufferView<RGBA>(buf, lengthof(buf));
+
+	// reduce the colors
+	core::RGBA smallTargetBuf[128] {};
+	n = core::Color::quantize(smallTargetBuf, lengthof(smallTargetBuf), buf, lengthof(buf), core::Color::ColorReductionType::Octree);
+	EXPECT_GT(n, 0) << "Failed with octree.\n" << core::BufferView<RGBA>(smallTargetBuf, n);
+	EXPECT_LE(n, 128);
+
+	n = core::Color::quantize(smallTargetBuf, lengthof(smallTargetBuf), buf, lengthof(buf), core::Color::ColorReductionType::Wu);
+	EXPECT_GT(n, 0) << "Failed with Wu.\n" << core::BufferView<RGBA>(smallTargetBuf, n);
+	EXPECT_LE(n, 128);
+
+	n = core::Color::quantize(smallTargetBuf, lengthof(smallTargetBuf), buf, lengthof(buf), core::Color::ColorReductionType::MedianCut);
+	EXPECT_GT(n, 0) << "Failed with median cut.\n" << core::BufferView<RGBA>(smallTargetBuf, n);
+	EXPECT_LE(n, 128);
+
+	n = core::Color::quantize(smallTargetBuf, lengthof(smallTargetBuf), buf, lengthof(buf), core::Color::ColorReductionType::KMeans);
+	EXPECT_EQ(128, n) << "Failed with k-means.\n" << core::BufferView<RGBA>(smallTargetBuf, n);
+}
+
+static void fillQuantizeInput(core::Buffer<RGBA> &colors, int repeat) {
+	for (int r = 0; r < repeat; ++r) {
+		for (int i = 0; i < 1000; ++i) {
+			colors.push_back(RGBA((i * 37) & 255, (i * 91) & 255, (i * 13) & 255, 255));
+		}
+	}
+}
+
+TEST(ColorTest, testColorHistogram) {
+	core::ColorHistogram histogram;
+	const RGBA colors[] = {RGBA(255, 0, 0), RGBA(255, 0, 0), RGBA(10, 20, 30), RGBA(0, 0, 255)};
+	histogram.add(colors, lengthof(colors));
+	core::ColorHistogram other;
+	other.add(RGBA(0, 0, 255));
+	histogram.merge(other);
+	EXPECT_EQ(5u, histogram.total());
+
+	core::Buffer<core::ColorHistogram::Entry> entries;
+	histogram.entries(entries);
+	ASSERT_EQ(3u, entries.size());
+	// sorted by the bin index - a bin with only one color keeps this color
+	EXPECT_EQ(RGBA(0, 0, 255), entries[0].color);
+	EXPECT_EQ(2u, entries[0].weight);
+	EXPECT_EQ(RGBA(10, 20, 30), entries[1].color);
+	EXPECT_EQ(1u, entries[1].weight);
+	EXPECT_EQ(RGBA(255, 0, 0), entries[2].color);
+	EXPECT_EQ(2u, entries[2].weight);
+}
+
+TEST(ColorTest, testColorHistogramExactColors) {
+	core::ColorHistogram histogram;
+	// both colors fall into the same bin
+	histogram.add(RGBA(0, 0, 0));
+	histogram.add(RGBA(1, 1, 1));
+	EXPECT_TRUE(histogram.exact());
+	core::Buffer<core::ColorHistogram::Entry> entries;
+	histogram.entries(entries);
+	ASSERT_EQ(2u, entries.size());
+	EXPECT_EQ(RGBA(0, 0, 0), entries[0].color);
+	EXPECT_EQ(RGBA(1, 1, 1), entries[1].color);
+
+	// too many different colors - fall back to the bins
+	for (int i = 0; i < (int)core::ColorHistogram::MaxExactColors; ++i) {
+		histogram.add(RGBA(i & 255, (i >> 8) & 255, 128));
+	}
+	EXPECT_FALSE(histogram.exact());
+	histogram.entries(entries);
+	EXPECT_LE(entries.size(), (size_t)core::ColorHistogram::Bins);
+	EXPECT_EQ((uint64_t)core::ColorHistogram::MaxExactColors + 2u, histogram.total());
+}
+
+TEST(ColorTest, testQuantizeIndependentOfInputSize) {
+	core::Buffer<RGBA> colors;
+	fillQuantizeInput(colors, 1);
+	core::Buffer<RGBA> repeatedColors;
+	fillQuantizeInput(repeatedColors, 50);
+	const core::Color::ColorReductionType types[] = {core::Color::ColorReductionType::MedianCut,
+													 core::Color::ColorReductionType::Wu};
+	for (core::Color::ColorReductionType type : types) {
+		core::RGBA targetBuf[64];
+		core::RGBA repeatedTargetBuf[64];
+		const int n = core::Color::quantize(targetBuf, lengthof(targetBuf), colors.data(), colors.size(), type);
+		const int repeatedN = core::Color::quantize(repeatedTargetBuf, lengthof(repeatedTargetBuf),
+													repeatedColors.data(), repeatedColors.size(), type);
+		ASSERT_GT(n, 0) << core::Color::toColorReductionTypeString(type);
+		ASSERT_EQ(n, repeatedN) << core::Color::toColorReductionTypeString(type);
+		for (int i = 0; i < n; ++i) {
+			EXPECT_EQ(targetBuf[i], repeatedTargetBuf[i]) << core::Color::toColorReductionTypeString(type);
+		}
+	}
+}
+
+TEST(ColorTest, testQuantizeKMeansSeed) {
+	core::Buffer<RGBA> colors;
+	fillQuantizeInput(colors, 4);
+	core::RGBA targetBuf1[32];
+	core::RGBA targetBuf2[32];
+	const int n1 = core::Color::quantize(targetBuf1, lengthof(targetBuf1), colors.data(), colors.size(),
+										 core::Color::ColorReductionType::KMeans, 42u);
+	const int n2 = core::Color::quantize(targetBuf2, lengthof(targetBuf2), colors.data(), colors.size(),
+										 core::Color::ColorReductionType::KMeans, 42u);
+	ASSERT_EQ(32, n1);
+	ASSERT_EQ(n1, n2);
+	for (int i = 0; i < n1; ++i) {
+		EXPECT_EQ(targetBuf1[i], targetBuf2[i]) << "Same seed must give the same result at " << i;
+	}
 }
 
 TEST(ColorTest, testDistanceMin) {
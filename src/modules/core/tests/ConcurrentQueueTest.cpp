@@ -95,6 +95,24 @@ TEST_F(ConcurrentQueueTest, testPushWaitAndPopMultipleThreads) {
 #endif
 }
 
+TEST_F(ConcurrentQueueTest, testOverflowKeepsOrder) {
+	// more elements than the ring can hold - the overflow list must keep the order of the producer
+	const uint32_t n = 20000u;
+	core::ConcurrentQueue<uint32_t> queue;
+	std::thread threadPush([&] () {
+		for (uint32_t i = 0u; i < n; ++i) {
+			queue.push(i);
+		}
+	});
+	for (uint32_t i = 0u; i < n; ++i) {
+		uint32_t v;
+		ASSERT_TRUE(queue.waitAndPop(v));
+		ASSERT_EQ(i, v);
+	}
+	threadPush.join();
+	EXPECT_TRUE(queue.empty());
+}
+
 TEST_F(ConcurrentQueueTest, testAbortWait) {
 	core::ConcurrentQueue<int> queue;
 	std::thread threadWait([&] () {
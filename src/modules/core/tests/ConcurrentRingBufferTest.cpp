@@ -0,0 +1,96 @@
+/**
+ * @file
+ */
+
+#include "core/collection/ConcurrentRingBuffer.h"
+#include "core/SharedPtr.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Atomic.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace collection {
+
+class ConcurrentRingBufferTest : public testing::Test {};
+
+TEST_F(ConcurrentRingBufferTest, testPushPop) {
+	core::ConcurrentRingBuffer<int> ring(4);
+	ASSERT_EQ(4u, ring.capacity());
+	for (int round = 0; round < 3; ++round) {
+		for (int i = 0; i < 4; ++i) {
+			ASSERT_TRUE(ring.tryPush(i));
+		}
+		EXPECT_FALSE(ring.tryPush(4)) << "The ring should be full";
+		EXPECT_EQ(4u, ring.size());
+		for (int i = 0; i < 4; ++i) {
+			int v;
+			ASSERT_TRUE(ring.tryPop(v));
+			ASSERT_EQ(i, v);
+		}
+		int v;
+		EXPECT_FALSE(ring.tryPop(v));
+		EXPECT_TRUE(ring.empty());
+	}
+}
+
+TEST_F(ConcurrentRingBufferTest, testDestroyElements) {
+	core::SharedPtr<int> ptr = core::make_shared<int>(1);
+	{
+		core::ConcurrentRingBuffer<core::SharedPtr<int>> ring(8);
+		ASSERT_TRUE(ring.tryPush(ptr));
+		ASSERT_TRUE(ring.tryPush(ptr));
+		core::SharedPtr<int> popped;
+		ASSERT_TRUE(ring.tryPop(popped));
+		popped = core::SharedPtr<int>();
+		EXPECT_EQ(2, (int)*ptr.refCnt());
+	}
+	EXPECT_EQ(1, (int)*ptr.refCnt()) << "The elements that are left in the ring should be destroyed";
+}
+
+TEST_F(ConcurrentRingBufferTest, testMultipleProducersMultipleConsumers) {
+	const int producers = 4;
+	const int consumers = 4;
+	const int n = 20000;
+	core::ConcurrentRingBuffer<int> ring(64);
+	core::DynamicArray<int> counts[consumers];
+	core::DynamicArray<std::thread> threads;
+	threads.reserve(producers + consumers);
+	for (int p = 0; p < producers; ++p) {
+		threads.emplace_back([&ring, p, n]() {
+			for (int i = 0; i < n; ++i) {
+				while (!ring.tryPush(p * n + i)) {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	core::AtomicInt popped{0};
+	for (int c = 0; c < consumers; ++c) {
+		counts[c].resize(producers * n);
+		counts[c].fill(0);
+		threads.emplace_back([&ring, &popped, &counts, c, n]() {
+			int v;
+			while (popped < producers * n) {
+				if (ring.tryPop(v)) {
+					++counts[c][v];
+					popped.increment(1);
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+	for (int i = 0; i < producers * n; ++i) {
+		int count = 0;
+		for (int c = 0; c < consumers; ++c) {
+			count += counts[c][i];
+		}
+		ASSERT_EQ(1, count) << "Value " << i << " was popped " << count << " times";
+	}
+	EXPECT_TRUE(ring.empty());
+}
+
+} // namespace collection
@@ -0,0 +1,62 @@
+/**
+ * @file
+ */
+
+#include "DownloadManager.h"
+#include "core/ConfigVar.h"
+#include "core/Common.h"
+#include "core/Log.h"
+#include "core/Var.h"
+#include "core/concurrent/ThreadPool.h"
+#include "io/Archive.h"
+
+namespace http {
+
+DownloadManager::DownloadManager(int connections) : _connections(connections) {
+}
+
+DownloadManager::~DownloadManager() {
+	shutdown();
+}
+
+bool DownloadManager::init() {
+	if (_threadPool != nullptr) {
+		return true;
+	}
+	int connections = _connections;
+	if (connections <= 0) {
+		connections = core::Var::get(cfg::HttpMaxConnections, "4")->intVal();
+	}
+	connections = core_max(1, connections);
+	Log::debug("Use %i connections for downloads", connections);
+	_threadPool = new core::ThreadPool(connections, "Download");
+	_threadPool->init();
+	return true;
+}
+
+void DownloadManager::shutdown() {
+	if (_threadPool == nullptr) {
+		return;
+	}
+	_threadPool->shutdown(false);
+	delete _threadPool;
+	_threadPool = nullptr;
+}
+
+void DownloadManager::abort() {
+	if (_threadPool == nullptr) {
+		return;
+	}
+	_threadPool->abort();
+}
+
+std::future<CacheResult> DownloadManager::download(const io::ArchivePtr &archive, const core::String &file,
+												   const core::String &url, bool revalidate) {
+	if (_threadPool == nullptr) {
+		Log::error("DownloadManager is not initialized");
+		return std::future<CacheResult>();
+	}
+	return _threadPool->enqueue([archive, file, url, revalidate]() { return cacheFile(archive, file, url, revalidate); });
+}
+
+} // namespace http
@@ -0,0 +1,56 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "HttpCache.h"
+#include "core/IComponent.h"
+#include <future>
+
+namespace core {
+class ThreadPool;
+}
+
+namespace http {
+
+/**
+ * @brief Downloads files into an archive with a bounded number of concurrent connections
+ *
+ * Each worker thread keeps its own connection (see the backend implementations) - so requests to the same host are
+ * reusing the connection instead of doing a new handshake for every file.
+ *
+ * @sa cacheFile()
+ * @ingroup IO
+ */
+class DownloadManager : public core::IComponent {
+private:
+	const int _connections;
+	core::ThreadPool *_threadPool = nullptr;
+
+public:
+	/**
+	 * @param connections The amount of parallel downloads - if @c 0 the value of the @c http_maxconnections cvar is
+	 * used
+	 */
+	DownloadManager(int connections = 0);
+	virtual ~DownloadManager();
+
+	bool init() override;
+	/**
+	 * @brief Waits for the running downloads - but drops the queued ones
+	 */
+	void shutdown() override;
+	/**
+	 * @brief Removes the queued downloads. The futures of these downloads are not satisfied - so don't wait for them.
+	 */
+	void abort();
+
+	/**
+	 * @return An invalid future if the manager isn't initialized
+	 */
+	std::future<CacheResult> download(const io::ArchivePtr &archive, const core::String &file,
+									  const core::String &url, bool revalidate = false);
+};
+
+} // namespace http
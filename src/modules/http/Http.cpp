@@ -4,6 +4,7 @@
 
 #include "Http.h"
 #include "Request.h"
+#include "core/StringUtil.h"
 
 namespace http {
 
@@ -11,6 +12,16 @@ bool isValidStatusCode(int statusCode) {
 	return statusCode >= 200 && statusCode < 300;
 }
 
+bool header(const core::StringMap<core::String> &headers, const char *key, core::String &value) {
+	for (const auto &e : headers) {
+		if (core::string::iequals(e->first, key)) {
+			value = e->second;
+			return true;
+		}
+	}
+	return false;
+}
+
 bool download(const core::String &url, io::WriteStream &stream, int *statusCode,
 			  core::StringMap<core::String> *outheaders) {
 	if (url.empty()) {
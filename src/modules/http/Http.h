@@ -10,7 +10,17 @@
 
 namespace http {
 
+/**
+ * @brief The response headers contain the status code of the response under this key - like the http/2 pseudo header
+ * @note Not every backend is able to fill this before the body is written
+ */
+static constexpr const char *StatusHeader = ":status";
+
 bool isValidStatusCode(int statusCode);
+/**
+ * @brief Case insensitive lookup of a response header - http/2 servers send lower case header names
+ */
+bool header(const core::StringMap<core::String> &headers, const char *key, core::String &value);
 bool download(const core::String &url, io::WriteStream &stream, int *statusCode = nullptr,
 			  core::StringMap<core::String> *outheaders = nullptr);
 
@@ -0,0 +1,288 @@
+/**
+ * @file
+ */
+
+#include "HttpCache.h"
+#include "app/App.h"
+#include "core/Log.h"
+#include "core/ScopedPtr.h"
+#include "core/StringUtil.h"
+#include "http/Http.h"
+#include "http/Request.h"
+#include "io/Archive.h"
+#include "io/Stream.h"
+#include <inttypes.h>
+
+namespace http {
+
+namespace {
+
+/**
+ * @brief The http validators of a cached file
+ */
+struct Validators {
+	core::String etag;
+	core::String lastModified;
+
+	bool empty() const {
+		return etag.empty() && lastModified.empty();
+	}
+};
+
+static const char *EtagPrefix = "etag: ";
+static const char *LastModifiedPrefix = "last-modified: ";
+
+/**
+ * @brief Writes the body of a response into the part file
+ *
+ * The part file is only opened once the first bytes of the body arrive - at this point the headers of the response
+ * are known and we can decide whether the body is appended to the data of a previous transfer or replaces it. Bodies
+ * of error responses are not written at all.
+ */
+class CacheWriteStream : public io::WriteStream {
+private:
+	const io::ArchivePtr &_archive;
+	const core::String &_part;
+	const core::StringMap<core::String> &_headers;
+	const int64_t _offset;
+	io::SeekableWriteStream *_stream = nullptr;
+	int64_t _written = 0;
+	bool _discard = false;
+	bool _rangeMismatch = false;
+
+	bool open() {
+		core::String status;
+		if (header(_headers, StatusHeader, status) && !isValidStatusCode(core::string::toInt(status))) {
+			_discard = true;
+			return true;
+		}
+		core::String contentRange;
+		if (_offset > 0 && header(_headers, "content-range", contentRange)) {
+			// bytes <first>-<last>/<size>
+			const size_t start = contentRange.find_first_of(' ');
+			const int64_t first = start == core::String::npos ? -1 : core::string::toLong(contentRange.substr(start + 1));
+			if (first != _offset) {
+				Log::warn("Unexpected content range %s for offset %" PRId64, contentRange.c_str(), _offset);
+				_rangeMismatch = true;
+				return false;
+			}
+			_stream = _archive->appendStream(_part);
+			if (_stream == nullptr) {
+				Log::debug("The archive doesn't support appending to %s", _part.c_str());
+				_rangeMismatch = true;
+				return false;
+			}
+		} else {
+			_stream = _archive->writeStream(_part);
+		}
+		return _stream != nullptr;
+	}
+
+public:
+	CacheWriteStream(const io::ArchivePtr &archive, const core::String &part,
+					 const core::StringMap<core::String> &headers, int64_t offset)
+		: _archive(archive), _part(part), _headers(headers), _offset(offset) {
+	}
+
+	~CacheWriteStream() {
+		delete _stream;
+	}
+
+	int write(const void *buf, size_t size) override {
+		if (_stream == nullptr && !_discard && !open()) {
+			return -1;
+		}
+		if (_discard) {
+			return (int)size;
+		}
+		const int n = _stream->write(buf, size);
+		if (n > 0) {
+			_written += n;
+		}
+		return n;
+	}
+
+	/**
+	 * @brief The partial data of a previous transfer can't be continued with this response
+	 */
+	inline bool rangeMismatch() const {
+		return _rangeMismatch;
+	}
+
+	/**
+	 * @brief Makes sure that the part file exists - even for responses without a body
+	 */
+	bool finish() {
+		if (_stream == nullptr && !_discard && !open()) {
+			return false;
+		}
+		delete _stream;
+		_stream = nullptr;
+		return true;
+	}
+
+	inline int64_t written() const {
+		return _written;
+	}
+};
+
+static core::String metaFile(const core::String &file) {
+	return file + ".httpcache";
+}
+
+static Validators responseValidators(const core::StringMap<core::String> &headers) {
+	Validators validators;
+	header(headers, "etag", validators.etag);
+	header(headers, "last-modified", validators.lastModified);
+	return validators;
+}
+
+static Validators loadValidators(const io::ArchivePtr &archive, const core::String &file) {
+	Validators validators;
+	const core::String &meta = metaFile(file);
+	if (!archive->exists(meta)) {
+		return validators;
+	}
+	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(meta));
+	if (!stream) {
+		return validators;
+	}
+	core::String line;
+	while (stream->readLine(line)) {
+		if (core::string::startsWith(line, EtagPrefix)) {
+			validators.etag = line.substr(SDL_strlen(EtagPrefix));
+		} else if (core::string::startsWith(line, LastModifiedPrefix)) {
+			validators.lastModified = line.substr(SDL_strlen(LastModifiedPrefix));
+		}
+	}
+	return validators;
+}
+
+static void saveValidators(const io::ArchivePtr &archive, const core::String &file, const Validators &validators) {
+	core::ScopedPtr<io::SeekableWriteStream> stream(archive->writeStream(metaFile(file)));
+	if (!stream) {
+		Log::debug("Failed to write the http cache validators for %s", file.c_str());
+		return;
+	}
+	if (!validators.etag.empty()) {
+		stream->writeStringFormat(false, "%s%s\n", EtagPrefix, validators.etag.c_str());
+	}
+	if (!validators.lastModified.empty()) {
+		stream->writeStringFormat(false, "%s%s\n", LastModifiedPrefix, validators.lastModified.c_str());
+	}
+}
+
+static int64_t fileSize(const io::ArchivePtr &archive, const core::String &file) {
+	if (!archive->exists(file)) {
+		return 0;
+	}
+	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(file));
+	if (!stream) {
+		return 0;
+	}
+	return stream->size();
+}
+
+} // namespace
+
+CacheResult cacheFile(const io::ArchivePtr &archive, const core::String &file, const core::String &url,
+					  bool revalidate) {
+	const bool cached = archive->exists(file);
+	if (cached && !revalidate) {
+		Log::debug("Use cached file at %s for %s", file.c_str(), url.c_str());
+		return CacheResult::Cached;
+	}
+	const CacheResult failed = cached ? CacheResult::Cached : CacheResult::Failed;
+	const core::String part = file + ".part";
+	// the validators of the cached file are used for the revalidation - the validators of the part file for the
+	// resume - without validators we can't tell whether the partial data belongs to the current version
+	Validators validators = loadValidators(archive, cached ? file : part);
+	bool resumable = !cached;
+	int64_t offset = 0;
+	if (resumable && !validators.empty()) {
+		offset = fileSize(archive, part);
+	}
+
+	constexpr int MaxAttempts = 8;
+	for (int attempt = 0; attempt < MaxAttempts; ++attempt) {
+		Request request(url, RequestType::GET);
+		request.noCache();
+		if (cached) {
+			if (!validators.etag.empty()) {
+				request.addHeader("If-None-Match", validators.etag);
+			}
+			if (!validators.lastModified.empty()) {
+				request.addHeader("If-Modified-Since", validators.lastModified);
+			}
+		} else if (offset > 0) {
+			Log::debug("Resume download of %s at %" PRId64, url.c_str(), offset);
+			request.addHeader("Range", core::string::format("bytes=%" PRId64 "-", offset));
+			request.addHeader("If-Range", validators.etag.empty() ? validators.lastModified : validators.etag);
+		}
+		core::StringMap<core::String> headers;
+		int statusCode = 0;
+		bool success;
+		int64_t written;
+		bool rangeMismatch;
+		{
+			CacheWriteStream stream(archive, part, headers, offset);
+			success = request.execute(stream, &statusCode, &headers);
+			if (success && isValidStatusCode(statusCode)) {
+				success = stream.finish();
+			}
+			written = stream.written();
+			rangeMismatch = stream.rangeMismatch();
+		}
+		// TODO: HTTP: handle these headers https://www.ietf.org/archive/id/draft-polli-ratelimit-headers-02.html
+		// x-ratelimit-remaining "<number>"
+		// x-ratelimit-limit "<number>"
+		// x-ratelimit-used "<number>"
+		// x-ratelimit-reset "<timestamp utc>"
+		if (success && cached && statusCode == 304) {
+			Log::debug("Cached file %s for %s is up to date", file.c_str(), url.c_str());
+			return CacheResult::NotModified;
+		}
+		if (isValidStatusCode(statusCode) && written > 0) {
+			// remember the version of the partial data for resuming the transfer
+			if (statusCode != 206) {
+				// the whole resource was sent - not the continuation of the partial data
+				validators = responseValidators(headers);
+			}
+			saveValidators(archive, part, validators);
+		}
+		if (success && isValidStatusCode(statusCode)) {
+			if (!archive->rename(part, file)) {
+				Log::error("Failed to write %s into http cache", file.c_str());
+				return failed;
+			}
+			archive->rename(metaFile(part), metaFile(file));
+			Log::debug("Wrote %s to http cache", file.c_str());
+			return CacheResult::Downloaded;
+		}
+		if (statusCode == 429) {
+			Log::warn("Too many requests, retrying in 5 seconds... %s (%s)", url.c_str(), file.c_str());
+			app::App::getInstance()->wait(5000);
+			continue;
+		}
+		if (statusCode == 416 || rangeMismatch) {
+			// the partial data doesn't fit to the resource - start from scratch
+			resumable = resumable && statusCode == 416;
+			offset = 0;
+			continue;
+		}
+		if (!success && isValidStatusCode(statusCode) && written > 0) {
+			// the transfer was interrupted - continue where it stopped if possible
+			if (resumable && !validators.empty()) {
+				offset = fileSize(archive, part);
+			} else {
+				offset = 0;
+			}
+			continue;
+		}
+		break;
+	}
+	Log::warn("Failed to download %s (%s)", url.c_str(), file.c_str());
+	return failed;
+}
+
+} // namespace http
@@ -0,0 +1,43 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/SharedPtr.h"
+#include "core/String.h"
+
+namespace io {
+class Archive;
+typedef core::SharedPtr<Archive> ArchivePtr;
+} // namespace io
+
+namespace http {
+
+enum class CacheResult {
+	Failed,		 /**< the file is not available */
+	Cached,		 /**< the file was already cached and was not checked against the server */
+	NotModified, /**< the server confirmed that the cached file is still up to date */
+	Downloaded	 /**< the file was downloaded or updated */
+};
+
+inline bool isAvailable(CacheResult result) {
+	return result != CacheResult::Failed;
+}
+
+/**
+ * @brief Makes the response of the given url available as file in the archive
+ *
+ * The body is streamed into @c <file>.part and moved to the target file once the transfer is complete - a partial
+ * download is never visible under the target name. An interrupted transfer is resumed with a range request if the
+ * archive supports appending. The ETag and Last-Modified validators of the response are stored next to the file in
+ * @c <file>.httpcache and are used for the resume (If-Range) and for the revalidation of the cached file.
+ *
+ * @param revalidate Send a conditional request for an already cached file. If the server can't be reached, the
+ * cached file is used.
+ * @ingroup IO
+ */
+CacheResult cacheFile(const io::ArchivePtr &archive, const core::String &file, const core::String &url,
+					  bool revalidate = false);
+
+} // namespace http
@@ -3,52 +3,28 @@
  */
 
 #include "HttpCacheStream.h"
-#include "app/App.h"
 #include "core/Log.h"
 #include "core/StringUtil.h"
-#include "http/Http.h"
+#include "http/HttpCache.h"
 #include "io/Archive.h"
-#include "io/BufferedReadWriteStream.h"
 #include "io/Stream.h"
 
 namespace http {
 
-HttpCacheStream::HttpCacheStream(const io::ArchivePtr &archive, const core::String &file, const core::String &url) {
+HttpCacheStream::HttpCacheStream(const io::ArchivePtr &archive, const core::String &file, const core::String &url,
+								 bool revalidate) {
 	if (core::string::startsWith(url, "file://")) {
 		_readStream = archive->readStream(url.substr(7));
 		return;
 	}
-	if (archive->exists(file)) {
-		Log::debug("Use cached file at %s for %s", file.c_str(), url.c_str());
-		_readStream = archive->readStream(file);
-		core_assert(_readStream != nullptr);
+	const CacheResult result = cacheFile(archive, file, url, revalidate);
+	if (!isAvailable(result)) {
 		return;
 	}
-	Log::debug("try to download %s from %s", file.c_str(), url.c_str());
-	io::BufferedReadWriteStream bufStream(1024 * 1024);
-	int statusCode = 0;
-	core::StringMap<core::String> outheaders;
-	if (http::download(url, bufStream, &statusCode, &outheaders)) {
-		// TODO: HTTP: handle these headers https://www.ietf.org/archive/id/draft-polli-ratelimit-headers-02.html
-		// x-ratelimit-remaining "<number>"
-		// x-ratelimit-limit "<number>"
-		// x-ratelimit-used "<number>"
-		// x-ratelimit-reset "<timestamp utc>"
-		if (http::isValidStatusCode(statusCode)) {
-			write(archive, file, bufStream);
-		} else if (statusCode == 429) {
-			Log::warn("Too many requests, retrying in 5 seconds... %s (%s)", url.c_str(), file.c_str());
-			app::App::getInstance()->wait(5000);
-			if (http::download(url, bufStream, &statusCode)) {
-				if (http::isValidStatusCode(statusCode)) {
-					write(archive, file, bufStream);
-				}
-			}
-		} else {
-			Log::warn("Failed to download %s (%s)", url.c_str(), file.c_str());
-		}
-	} else {
-		Log::warn("Failed to download %s (%s)", url.c_str(), file.c_str());
+	_newInCache = result == CacheResult::Downloaded;
+	_readStream = archive->readStream(file);
+	if (_readStream == nullptr) {
+		Log::error("Failed to read %s from http cache", file.c_str());
 	}
 }
 
@@ -56,8 +32,9 @@ HttpCacheStream::~HttpCacheStream() {
 	delete _readStream;
 }
 
-core::String HttpCacheStream::string(const io::ArchivePtr &archive, const core::String &file, const core::String &url) {
-	HttpCacheStream stream(archive, file, url);
+core::String HttpCacheStream::string(const io::ArchivePtr &archive, const core::String &file, const core::String &url,
+									 bool revalidate) {
+	HttpCacheStream stream(archive, file, url, revalidate);
 	if (!stream.valid()) {
 		return "";
 	}
@@ -71,20 +48,6 @@ void HttpCacheStream::close() {
 	_readStream = nullptr;
 }
 
-void HttpCacheStream::write(const io::ArchivePtr &archive, const core::String &file,
-							io::BufferedReadWriteStream &bufStream) {
-	bufStream.seek(0);
-	if (io::SeekableWriteStream *ws = archive->writeStream(file)) {
-		ws->write(bufStream.getBuffer(), bufStream.size());
-		delete ws;
-		_readStream = archive->readStream(file);
-		_newInCache = true;
-		Log::debug("Wrote %s to http cache", file.c_str());
-	} else {
-		Log::error("Failed to write %s into http cache", file.c_str());
-	}
-}
-
 bool HttpCacheStream::valid() const {
 	if (_readStream == nullptr) {
 		return false;
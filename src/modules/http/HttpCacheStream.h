@@ -8,8 +8,6 @@
 #include "io/Stream.h"
 
 namespace io {
-class FileStream;
-class BufferedReadWriteStream;
 class Archive;
 typedef core::SharedPtr<Archive> ArchivePtr;
 } // namespace io
@@ -18,22 +16,24 @@ namespace http {
 
 /**
  * @brief Download from the given url and store it in the given file. If the file already exists, it will not get
- * downloaded again.
+ * downloaded again - unless a revalidation is requested.
  *
+ * @sa cacheFile()
  * @ingroup IO
  */
 class HttpCacheStream : public io::SeekableReadStream {
 private:
 	io::SeekableReadStream *_readStream = nullptr;
 	bool _newInCache = false;
-	void write(const io::ArchivePtr &archive, const core::String &file, io::BufferedReadWriteStream &bufStream);
 
 public:
 	/**
 	 * @param[in] file The path to the file stored in the archive
+	 * @param[in] revalidate Ask the server whether an already cached file is still up to date
 	 * @sa io::Filesystem::homePath()
 	 */
-	HttpCacheStream(const io::ArchivePtr &archive, const core::String &file, const core::String &url);
+	HttpCacheStream(const io::ArchivePtr &archive, const core::String &file, const core::String &url,
+					bool revalidate = false);
 	virtual ~HttpCacheStream();
 
 	void close() override;
@@ -44,7 +44,8 @@ public:
 	int64_t pos() const override;
 	bool isNewInCache() const;
 
-	static core::String string(const io::ArchivePtr &archive, const core::String &file, const core::String &url);
+	static core::String string(const io::ArchivePtr &archive, const core::String &file, const core::String &url,
+							   bool revalidate = false);
 };
 
 inline bool HttpCacheStream::isNewInCache() const {
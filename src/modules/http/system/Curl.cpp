@@ -5,6 +5,7 @@
 #include "Curl.h"
 #include "core/Log.h"
 #include "core/StringUtil.h"
+#include "http/Http.h"
 
 #include <curl/curl.h>
 
@@ -23,6 +24,16 @@ static size_t WriteHeaderData(char *b, size_t size, size_t nitems, void *userdat
 	if (str.last() == '\r')
 		str.erase(str.size() - 1);
 
+	// a new response starts (redirects or interim responses) - only keep the headers of the last one
+	if (core::string::startsWith(str, "HTTP/")) {
+		headers->clear();
+		const size_t statusPos = str.find_first_of(' ');
+		if (statusPos != core::String::npos) {
+			headers->put(StatusHeader, str.substr(statusPos + 1, 3));
+		}
+		return total;
+	}
+
 	size_t pos = str.find_first_of(':');
 	if (pos != core::String::npos) {
 		const core::String &key = str.substr(0, pos);
@@ -37,9 +48,33 @@ static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *use
 	return ((io::WriteStream *)userp)->write(contents, size * nmemb);
 }
 
+/**
+ * @brief Every thread keeps its curl handle - resetting the handle keeps the open connections, the dns and the tls
+ * session caches of the handle alive for the next request to the same host
+ */
+struct CurlHandle {
+	CURL *curl = nullptr;
+
+	~CurlHandle() {
+		if (curl != nullptr) {
+			curl_easy_cleanup(curl);
+		}
+	}
+
+	CURL *acquire() {
+		if (curl == nullptr) {
+			curl = curl_easy_init();
+		} else {
+			curl_easy_reset(curl);
+		}
+		return curl;
+	}
+};
+
 bool http_request(io::WriteStream &stream, int *statusCode, core::StringMap<core::String> *outheaders,
 				  RequestContext &ctx) {
-	CURL *curl = curl_easy_init();
+	static thread_local CurlHandle handle;
+	CURL *curl = handle.acquire();
 	if (curl == nullptr) {
 		return false;
 	}
@@ -87,7 +122,6 @@ bool http_request(io::WriteStream &stream, int *statusCode, core::StringMap<core
 		*statusCode = (int)statusCodeCurl;
 	}
 	curl_slist_free_all(headers);
-	curl_easy_cleanup(curl);
 	return res == CURLE_OK;
 }
 
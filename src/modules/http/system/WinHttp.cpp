@@ -5,6 +5,8 @@
 #include "WinHttp.h"
 #include "core/Log.h"
 #include "core/ArrayLength.h"
+#include "core/StringUtil.h"
+#include "http/Http.h"
 
 #define WIN32_LEAN_AND_MEAN (1)
 #include <sstream>
@@ -177,6 +179,7 @@ bool http_request(io::WriteStream &stream, int *statusCode, core::StringMap<core
 	}
 
 	if (outheaders) {
+		outheaders->put(StatusHeader, core::string::toString((int)dwStatusCode));
 		DWORD headerLength = sizeof(DWORD);
 		if (!WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_RAW_HEADERS_CRLF, WINHTTP_HEADER_NAME_BY_INDEX, nullptr,
 								 &headerLength, WINHTTP_NO_HEADER_INDEX) &&
@@ -0,0 +1,301 @@
+/**
+ * @file
+ */
+
+#include "http/HttpCache.h"
+#include "app/tests/AbstractTest.h"
+#include "core/ScopedPtr.h"
+#include "core/StringUtil.h"
+#include "core/concurrent/Atomic.h"
+#include "http/DownloadManager.h"
+#include "http/HttpCacheStream.h"
+#include "http/Request.h"
+#include "io/Filesystem.h"
+#include "io/FilesystemArchive.h"
+#include <gtest/gtest.h>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <thread>
+#endif
+
+namespace http {
+
+#ifndef _WIN32
+
+/**
+ * @brief Minimal http server on localhost that serves one resource with an ETag and supports conditional and range
+ * requests
+ */
+class TestServer {
+private:
+	int _socket = -1;
+	int _port = 0;
+	std::thread _thread;
+	core::String _body;
+	core::String _etag = "\"v1\"";
+
+	void handle(int client) {
+		core::String request;
+		char buf[1024];
+		while (request.find("\r\n\r\n") == core::String::npos) {
+			const ssize_t n = ::recv(client, buf, sizeof(buf), 0);
+			if (n <= 0) {
+				return;
+			}
+			request.append(buf, (size_t)n);
+		}
+		requests.increment(1);
+		core::String ifNoneMatch;
+		core::String ifRange;
+		core::String range;
+		core::DynamicArray<core::String> lines;
+		core::string::splitString(request, lines, "\r\n");
+		for (const core::String &line : lines) {
+			const size_t pos = line.find_first_of(':');
+			if (pos == core::String::npos) {
+				continue;
+			}
+			const core::String &key = line.substr(0, pos).toLower();
+			const core::String &value = core::string::trim(line.substr(pos + 1));
+			if (key == "if-none-match") {
+				ifNoneMatch = value;
+			} else if (key == "if-range") {
+				ifRange = value;
+			} else if (key == "range") {
+				range = value;
+			}
+		}
+		if (!ifNoneMatch.empty() && ifNoneMatch == _etag) {
+			notModified.increment(1);
+			send(client, core::string::format("HTTP/1.1 304 Not Modified\r\nETag: %s\r\nConnection: close\r\n\r\n",
+											  _etag.c_str()));
+			return;
+		}
+		size_t offset = 0;
+		if (core::string::startsWith(range, "bytes=") && (ifRange.empty() || ifRange == _etag)) {
+			rangeRequests.increment(1);
+			offset = (size_t)core::string::toLong(range.substr(6));
+		}
+		const size_t length = _body.size() - offset;
+		core::String header;
+		if (offset > 0) {
+			header = core::string::format("HTTP/1.1 206 Partial Content\r\nContent-Range: bytes %i-%i/%i\r\n",
+										  (int)offset, (int)_body.size() - 1, (int)_body.size());
+		} else {
+			header = "HTTP/1.1 200 OK\r\n";
+		}
+		header += core::string::format("ETag: %s\r\nContent-Length: %i\r\nConnection: close\r\n\r\n", _etag.c_str(),
+									   (int)length);
+		send(client, header);
+		size_t sendBytes = length;
+		const int drop = dropAfter.exchange(0);
+		if (drop > 0 && (size_t)drop < length) {
+			// simulate an interrupted connection
+			sendBytes = drop;
+		}
+		send(client, _body.substr(offset, sendBytes));
+	}
+
+	static void send(int client, const core::String &data) {
+		size_t sent = 0;
+		while (sent < data.size()) {
+			const ssize_t n = ::send(client, data.c_str() + sent, data.size() - sent, MSG_NOSIGNAL);
+			if (n <= 0) {
+				return;
+			}
+			sent += (size_t)n;
+		}
+	}
+
+	void run() {
+		for (;;) {
+			const int client = ::accept(_socket, nullptr, nullptr);
+			if (client < 0) {
+				return;
+			}
+			handle(client);
+			::close(client);
+		}
+	}
+
+public:
+	core::AtomicInt requests{0};
+	core::AtomicInt rangeRequests{0};
+	core::AtomicInt notModified{0};
+	/** the next full response is cut after this amount of body bytes */
+	core::AtomicInt dropAfter{0};
+
+	TestServer() {
+		for (int i = 0; i < 100000; ++i) {
+			_body += (char)('a' + (i * 7) % 26);
+		}
+	}
+
+	~TestServer() {
+		stop();
+	}
+
+	bool start() {
+		_socket = ::socket(AF_INET, SOCK_STREAM, 0);
+		if (_socket < 0) {
+			return false;
+		}
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = 0;
+		socklen_t len = sizeof(addr);
+		if (::bind(_socket, (sockaddr *)&addr, sizeof(addr)) != 0 || ::listen(_socket, 8) != 0 ||
+			::getsockname(_socket, (sockaddr *)&addr, &len) != 0) {
+			return false;
+		}
+		_port = ntohs(addr.sin_port);
+		_thread = std::thread([this]() { run(); });
+		return true;
+	}
+
+	void stop() {
+		if (_socket >= 0) {
+			::shutdown(_socket, SHUT_RDWR);
+			::close(_socket);
+			_socket = -1;
+		}
+		if (_thread.joinable()) {
+			_thread.join();
+		}
+	}
+
+	core::String url(const char *path) const {
+		return core::string::format("http://127.0.0.1:%i/%s", _port, path);
+	}
+
+	const core::String &body() const {
+		return _body;
+	}
+};
+
+class HttpCacheTest : public app::AbstractTest {
+protected:
+	TestServer _server;
+	io::ArchivePtr _archive;
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		if (!Request::supported()) {
+			GTEST_SKIP() << "No http support available";
+		}
+		ASSERT_TRUE(_server.start());
+		_archive = io::openFilesystemArchive(_testApp->filesystem(), "", false);
+	}
+
+	void TearDown() override {
+		_server.stop();
+		_archive = io::ArchivePtr();
+		app::AbstractTest::TearDown();
+	}
+
+	void remove(const core::String &file) {
+		for (const char *suffix : {"", ".httpcache", ".part", ".part.httpcache"}) {
+			const core::String &path = _testApp->filesystem()->homeWritePath(file + suffix);
+			if (io::Filesystem::sysExists(path)) {
+				io::Filesystem::sysRemoveFile(path);
+			}
+		}
+	}
+
+	core::String content(const core::String &file) {
+		core::ScopedPtr<io::SeekableReadStream> stream(_archive->readStream(file));
+		if (!stream) {
+			return "";
+		}
+		core::String str;
+		stream->readString((int)stream->size(), str);
+		return str;
+	}
+};
+
+TEST_F(HttpCacheTest, testDownloadAndRevalidate) {
+	const core::String file = "httpcachetest-download.txt";
+	remove(file);
+	ASSERT_EQ(CacheResult::Downloaded, cacheFile(_archive, file, _server.url("file")));
+	EXPECT_EQ(_server.body(), content(file));
+	EXPECT_FALSE(_archive->exists(file + ".part"));
+	EXPECT_EQ(1, (int)_server.requests);
+
+	EXPECT_EQ(CacheResult::Cached, cacheFile(_archive, file, _server.url("file")));
+	EXPECT_EQ(1, (int)_server.requests) << "The cached file should not be requested again";
+
+	EXPECT_EQ(CacheResult::NotModified, cacheFile(_archive, file, _server.url("file"), true));
+	EXPECT_EQ(2, (int)_server.requests);
+	EXPECT_EQ(1, (int)_server.notModified);
+	EXPECT_EQ(_server.body(), content(file));
+	remove(file);
+}
+
+TEST_F(HttpCacheTest, testResume) {
+	const core::String file = "httpcachetest-resume.txt";
+	remove(file);
+	_server.dropAfter = 30000;
+	ASSERT_EQ(CacheResult::Downloaded, cacheFile(_archive, file, _server.url("file")));
+	EXPECT_GE((int)_server.requests, 2);
+	EXPECT_GE((int)_server.rangeRequests, 1) << "The interrupted transfer should be continued with a range request";
+	EXPECT_EQ(_server.body(), content(file));
+	EXPECT_FALSE(_archive->exists(file + ".part"));
+	remove(file);
+}
+
+TEST_F(HttpCacheTest, testFailed) {
+	const core::String file = "httpcachetest-failed.txt";
+	remove(file);
+	_server.stop();
+	EXPECT_EQ(CacheResult::Failed, cacheFile(_archive, file, _server.url("file")));
+	EXPECT_FALSE(_archive->exists(file));
+}
+
+TEST_F(HttpCacheTest, testHttpCacheStream) {
+	const core::String file = "httpcachetest-stream.txt";
+	remove(file);
+	{
+		HttpCacheStream stream(_archive, file, _server.url("file"));
+		ASSERT_TRUE(stream.valid());
+		EXPECT_TRUE(stream.isNewInCache());
+		EXPECT_EQ((int64_t)_server.body().size(), stream.size());
+	}
+	{
+		HttpCacheStream stream(_archive, file, _server.url("file"), true);
+		ASSERT_TRUE(stream.valid());
+		EXPECT_FALSE(stream.isNewInCache());
+		EXPECT_EQ(1, (int)_server.notModified);
+	}
+	remove(file);
+}
+
+TEST_F(HttpCacheTest, testDownloadManager) {
+	DownloadManager downloadManager(2);
+	ASSERT_TRUE(downloadManager.init());
+	core::DynamicArray<std::future<CacheResult>> futures;
+	futures.reserve(6);
+	for (int i = 0; i < 6; ++i) {
+		const core::String &file = core::string::format("httpcachetest-manager-%i.txt", i);
+		remove(file);
+		futures.emplace_back(downloadManager.download(_archive, file, _server.url("file")));
+	}
+	for (std::future<CacheResult> &future : futures) {
+		ASSERT_TRUE(future.valid());
+		EXPECT_EQ(CacheResult::Downloaded, future.get());
+	}
+	downloadManager.shutdown();
+	for (int i = 0; i < 6; ++i) {
+		const core::String &file = core::string::format("httpcachetest-manager-%i.txt", i);
+		EXPECT_EQ(_server.body(), content(file));
+		remove(file);
+	}
+}
+
+#endif
+
+} // namespace http
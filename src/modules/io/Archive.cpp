@@ -55,6 +55,14 @@ bool Archive::write(const core::String &filePath, io::ReadStream &stream) {
 	return wstream->writeStream(stream);
 }
 
+SeekableWriteStream *Archive::appendStream(const core::String &filePath) {
+	return nullptr;
+}
+
+bool Archive::rename(const core::String &from, const core::String &to) {
+	return false;
+}
+
 bool isZipArchive(const core::String &filename) {
 	const core::String &ext = core::string::extractExtension(filename);
 	return ext == "zip" || ext == "pk3";
@@ -67,6 +67,17 @@ public:
 	virtual SeekableWriteStream *writeStream(const core::String &filePath);
 
 	virtual bool write(const core::String &filePath, io::ReadStream &stream);
+
+	/**
+	 * @brief Opens the file to append data to it - the file is created if it doesn't exist yet
+	 * @return @c nullptr if the archive doesn't support appending
+	 * @sa writeStream()
+	 */
+	virtual SeekableWriteStream *appendStream(const core::String &filePath);
+	/**
+	 * @brief Moves a file inside the archive - an existing target file is replaced
+	 */
+	virtual bool rename(const core::String &from, const core::String &to);
 };
 
 inline const ArchiveFiles &Archive::files() const {
@@ -200,6 +200,10 @@ public:
 	 * @param file The full path to the file or relative to the current working dir of your app.
 	 */
 	static bool sysRemoveFile(const core::String& file);
+	/**
+	 * @brief Moves the file - an existing target file is replaced
+	 */
+	static bool sysRename(const core::String &from, const core::String &to);
 };
 
 inline const Paths& Filesystem::registeredPaths() const {
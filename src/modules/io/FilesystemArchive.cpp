@@ -5,6 +5,7 @@
 #include "FilesystemArchive.h"
 #include "core/Log.h"
 #include "core/SharedPtr.h"
+#include "core/StringUtil.h"
 #include "io/File.h"
 #include "io/FileStream.h"
 #include "io/Filesystem.h"
@@ -77,6 +78,31 @@ SeekableWriteStream *FilesystemArchive::writeStream(const core::String &filePath
 	return stream;
 }
 
+core::String FilesystemArchive::writePath(const core::String &filePath) const {
+	if (_sysmode) {
+		return filePath;
+	}
+	return _filesytem->homeWritePath(filePath);
+}
+
+SeekableWriteStream *FilesystemArchive::appendStream(const core::String &filePath) {
+	const core::String &path = writePath(filePath);
+	const core::String &dir = core::string::extractDir(path);
+	if (!dir.empty()) {
+		Filesystem::sysCreateDir(dir, true);
+	}
+	const io::FilePtr &file = core::make_shared<io::File>(path, FileMode::Append);
+	if (!file->validHandle()) {
+		Log::error("Could not open file %s for appending: %s", file->name().c_str(), file->lastError().c_str());
+		return nullptr;
+	}
+	return new io::FileStream(file);
+}
+
+bool FilesystemArchive::rename(const core::String &from, const core::String &to) {
+	return Filesystem::sysRename(writePath(from), writePath(to));
+}
+
 ArchivePtr openFilesystemArchive(const io::FilesystemPtr &fs, const core::String &path, bool sysmode) {
 	core::SharedPtr<FilesystemArchive> fa = core::make_shared<FilesystemArchive>(fs, sysmode);
 	if (!path.empty() && fs->sysIsReadableDir(path)) {
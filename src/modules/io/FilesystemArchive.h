@@ -32,6 +32,11 @@ public:
 
 	SeekableReadStream *readStream(const core::String &filePath) override;
 	SeekableWriteStream *writeStream(const core::String &filePath) override;
+	SeekableWriteStream *appendStream(const core::String &filePath) override;
+	bool rename(const core::String &from, const core::String &to) override;
+
+private:
+	core::String writePath(const core::String &filePath) const;
 };
 
 /**
@@ -53,6 +53,22 @@ SeekableWriteStream *MemoryArchive::writeStream(const core::String &filePath) {
 	return new SeekableReadWriteStreamWrapper((io::SeekableWriteStream*)iter->second);
 }
 
+bool MemoryArchive::rename(const core::String &from, const core::String &to) {
+	auto iter = _entries.find(from);
+	if (iter == _entries.end()) {
+		return false;
+	}
+	BufferedReadWriteStream *stream = iter->second;
+	_entries.erase(iter);
+	auto target = _entries.find(to);
+	if (target != _entries.end()) {
+		delete target->second;
+		_entries.erase(target);
+	}
+	_entries.put(to, stream);
+	return true;
+}
+
 SeekableReadStream *MemoryArchive::readStream(const core::String &filePath) {
 	auto iter = _entries.find(filePath);
 	if (iter == _entries.end()) {
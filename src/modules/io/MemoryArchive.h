@@ -31,6 +31,7 @@ public:
 	bool remove(const core::String &name);
 	SeekableReadStream *readStream(const core::String &filePath) override;
 	SeekableWriteStream *writeStream(const core::String &filePath) override;
+	bool rename(const core::String &from, const core::String &to) override;
 };
 
 using MemoryArchivePtr = core::SharedPtr<MemoryArchive>;
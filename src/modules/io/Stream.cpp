@@ -44,16 +44,8 @@ bool WriteStream::writeStringFormat(bool terminate, const char *fmt, ...) {
 	SDL_vsnprintf(text, bufSize, fmt, ap);
 	text[sizeof(text) - 1] = '\0';
 	va_end(ap);
-	const size_t length = SDL_strlen(text);
-	for (size_t i = 0u; i < length; i++) {
-		if (!writeUInt8(uint8_t(text[i]))) {
-			return false;
-		}
-	}
-	if (!terminate) {
-		return true;
-	}
-	return writeUInt8(uint8_t('\0'));
+	const size_t length = SDL_strlen(text) + (terminate ? 1u : 0u);
+	return write(text, length) != -1;
 }
 
 bool WriteStream::writeFormat(const char *fmt, ...) {
@@ -106,16 +98,12 @@ bool WriteStream::writeUInt8(uint8_t val) {
 }
 
 bool WriteStream::writeString(const core::String &string, bool terminate) {
-	const size_t length = string.size();
-	for (size_t i = 0u; i < length; i++) {
-		if (!writeUInt8(uint8_t(string[i]))) {
-			return false;
-		}
-	}
-	if (!terminate) {
+	// c_str() is always null terminated
+	const size_t length = string.size() + (terminate ? 1u : 0u);
+	if (length == 0u) {
 		return true;
 	}
-	return writeUInt8(uint8_t('\0'));
+	return write(string.c_str(), length) != -1;
 }
 
 bool WriteStream::writeLine(const core::String &string, const char *lineEnding) {
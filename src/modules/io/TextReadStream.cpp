@@ -0,0 +1,316 @@
+/**
+ * @file
+ */
+
+#include "TextReadStream.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+#include <SDL_stdinc.h>
+#include <string.h>
+
+namespace io {
+
+// all integers up to 2^53 and these powers of ten are exactly representable as double - a single multiplication or
+// division is correctly rounded then
+static const double Pow10[] = {1e0,	 1e1,  1e2,	 1e3,  1e4,	 1e5,  1e6,	 1e7,  1e8,	 1e9,  1e10, 1e11,
+							   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+static constexpr uint64_t MaxExactMantissa = 1ull << 53;
+
+static inline bool isSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\v' || c == '\f';
+}
+
+static inline bool isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+TextReadStream::TextReadStream(SeekableReadStream &stream, int bufferedBytes) : _stream(stream) {
+	_capacity = core_max(bufferedBytes, 64);
+	_buffer = (char *)core_malloc(_capacity);
+	_bufferPos = _stream.pos();
+}
+
+TextReadStream::~TextReadStream() {
+	_stream.seek(pos());
+	core_free(_buffer);
+}
+
+bool TextReadStream::fill() {
+	if (_eos) {
+		return false;
+	}
+	if (_begin > 0u) {
+		const size_t unread = _end - _begin;
+		if (unread > 0u) {
+			SDL_memmove(_buffer, _buffer + _begin, unread);
+		}
+		_bufferPos += (int64_t)_begin;
+		_searched = _searched > _begin ? _searched - _begin : 0u;
+		_end = unread;
+		_begin = 0u;
+	}
+	if (_end == _capacity) {
+		// a line that is longer than the buffer
+		_capacity *= 2u;
+		_buffer = (char *)core_realloc(_buffer, _capacity);
+	}
+	const int64_t remaining = _stream.remaining();
+	const size_t wanted = (size_t)core_min((int64_t)(_capacity - _end), remaining);
+	if (wanted == 0u) {
+		_eos = true;
+		return false;
+	}
+	const int bytes = _stream.read(_buffer + _end, wanted);
+	if (bytes <= 0) {
+		_eos = true;
+		return false;
+	}
+	_end += (size_t)bytes;
+	return true;
+}
+
+bool TextReadStream::readLine(Line &line) {
+	for (;;) {
+		const char *begin = _buffer + _begin;
+		const char *end = _buffer + _end;
+		const size_t searchStart = core_max(_begin, _searched);
+		// memchr is vectorized by the c library - the line break search is not done byte by byte
+		const char *lf = (const char *)memchr(_buffer + searchStart, '\n', _end - searchStart);
+		const char *lineEnd = lf != nullptr ? lf : end;
+		const char *cr = (const char *)memchr(begin, '\r', lineEnd - begin);
+		if (cr != nullptr && (cr + 1 < end || _eos)) {
+			// old mac style line breaks or windows line breaks
+			line.cur = begin;
+			line.end = cr;
+			const char *next = cr + 1;
+			if (next < end && *next == '\n') {
+				++next;
+			}
+			_begin = next - _buffer;
+			return true;
+		}
+		if (lf != nullptr) {
+			line.cur = begin;
+			line.end = lf;
+			_begin = lf + 1 - _buffer;
+			return true;
+		}
+		_searched = _end;
+		if (!fill()) {
+			if (_begin == _end) {
+				return false;
+			}
+			// the last line without a line break
+			line.cur = _buffer + _begin;
+			line.end = _buffer + _end;
+			if (line.end[-1] == '\r') {
+				--line.end;
+			}
+			_begin = _end;
+			return true;
+		}
+	}
+}
+
+bool TextReadStream::readLine(core::String &str) {
+	Line line;
+	if (!readLine(line)) {
+		return false;
+	}
+	str = line.str();
+	return true;
+}
+
+bool TextReadStream::skipLine() {
+	Line line;
+	return readLine(line);
+}
+
+const char *TextReadStream::parseInt(const char *begin, const char *end, int &value) {
+	const char *cur = begin;
+	bool negative = false;
+	if (cur < end && (*cur == '-' || *cur == '+')) {
+		negative = *cur == '-';
+		++cur;
+	}
+	if (cur == end || !isDigit(*cur)) {
+		return nullptr;
+	}
+	int64_t n = 0;
+	for (; cur < end && isDigit(*cur); ++cur) {
+		if (n < INT32_MAX) {
+			n = n * 10 + (*cur - '0');
+		}
+	}
+	value = (int)(negative ? -n : n);
+	return cur;
+}
+
+static const char *parseFloatFallback(const char *begin, const char *end, float &value) {
+	char buf[128];
+	size_t len = core_min((size_t)(end - begin), sizeof(buf) - 1);
+	core_memcpy(buf, begin, len);
+	buf[len] = '\0';
+	char *parsedEnd = nullptr;
+	const double v = SDL_strtod(buf, &parsedEnd);
+	if (parsedEnd == buf) {
+		return nullptr;
+	}
+	value = (float)v;
+	return begin + (parsedEnd - buf);
+}
+
+const char *TextReadStream::parseFloat(const char *begin, const char *end, float &value) {
+	const char *cur = begin;
+	bool negative = false;
+	if (cur < end && (*cur == '-' || *cur == '+')) {
+		negative = *cur == '-';
+		++cur;
+	}
+	uint64_t mantissa = 0u;
+	int significantDigits = 0;
+	int exponent = 0;
+	bool digits = false;
+	bool exact = true;
+	for (; cur < end && isDigit(*cur); ++cur) {
+		digits = true;
+		if (significantDigits < 19) {
+			mantissa = mantissa * 10u + (uint64_t)(*cur - '0');
+			if (mantissa != 0u) {
+				++significantDigits;
+			}
+		} else {
+			++exponent;
+			exact &= *cur == '0';
+		}
+	}
+	if (cur < end && *cur == '.') {
+		++cur;
+		for (; cur < end && isDigit(*cur); ++cur) {
+			digits = true;
+			if (significantDigits < 19) {
+				mantissa = mantissa * 10u + (uint64_t)(*cur - '0');
+				if (mantissa != 0u) {
+					++significantDigits;
+				}
+				--exponent;
+			} else {
+				exact &= *cur == '0';
+			}
+		}
+	}
+	if (!digits) {
+		// inf, nan or hex values
+		return parseFloatFallback(begin, end, value);
+	}
+	if (cur < end && (*cur == 'e' || *cur == 'E')) {
+		const char *exp = cur + 1;
+		bool negativeExp = false;
+		if (exp < end && (*exp == '-' || *exp == '+')) {
+			negativeExp = *exp == '-';
+			++exp;
+		}
+		// without digits the 'e' is not part of the number
+		if (exp < end && isDigit(*exp)) {
+			int e = 0;
+			for (; exp < end && isDigit(*exp); ++exp) {
+				if (e < 10000) {
+					e = e * 10 + (*exp - '0');
+				}
+			}
+			exponent += negativeExp ? -e : e;
+			cur = exp;
+		}
+	}
+	if (!exact || mantissa > MaxExactMantissa || exponent < -22 || exponent > 22) {
+		return parseFloatFallback(begin, end, value);
+	}
+	double v = (double)mantissa;
+	if (exponent < 0) {
+		v /= Pow10[-exponent];
+	} else {
+		v *= Pow10[exponent];
+	}
+	value = (float)(negative ? -v : v);
+	return cur;
+}
+
+bool TextReadStream::Line::empty() {
+	skipWhitespace();
+	return cur >= end;
+}
+
+void TextReadStream::Line::skipWhitespace() {
+	while (cur < end && isSpace(*cur)) {
+		++cur;
+	}
+}
+
+bool TextReadStream::Line::consume(const char *prefix) {
+	skipWhitespace();
+	const size_t len = SDL_strlen(prefix);
+	if ((size_t)(end - cur) < len || SDL_memcmp(cur, prefix, len) != 0) {
+		return false;
+	}
+	cur += len;
+	return true;
+}
+
+bool TextReadStream::Line::token(const char *&tokenBegin, const char *&tokenEnd) {
+	skipWhitespace();
+	if (cur >= end) {
+		return false;
+	}
+	tokenBegin = cur;
+	while (cur < end && !isSpace(*cur)) {
+		++cur;
+	}
+	tokenEnd = cur;
+	return true;
+}
+
+bool TextReadStream::Line::skipToken() {
+	const char *tokenBegin;
+	const char *tokenEnd;
+	return token(tokenBegin, tokenEnd);
+}
+
+bool TextReadStream::Line::readToken(core::String &str) {
+	const char *tokenBegin;
+	const char *tokenEnd;
+	if (!token(tokenBegin, tokenEnd)) {
+		return false;
+	}
+	str = core::String(tokenBegin, tokenEnd - tokenBegin);
+	return true;
+}
+
+bool TextReadStream::Line::readInt(int &value) {
+	const char *tokenBegin;
+	const char *tokenEnd;
+	if (!token(tokenBegin, tokenEnd)) {
+		return false;
+	}
+	if (parseInt(tokenBegin, tokenEnd, value) == nullptr) {
+		value = 0;
+	}
+	return true;
+}
+
+bool TextReadStream::Line::readFloat(float &value) {
+	const char *tokenBegin;
+	const char *tokenEnd;
+	if (!token(tokenBegin, tokenEnd)) {
+		return false;
+	}
+	if (parseFloat(tokenBegin, tokenEnd, value) == nullptr) {
+		value = 0.0f;
+	}
+	return true;
+}
+
+core::String TextReadStream::Line::str() const {
+	return core::String(cur, end - cur);
+}
+
+} // namespace io
@@ -0,0 +1,127 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Stream.h"
+#include "core/String.h"
+
+namespace io {
+
+/**
+ * @brief Buffered line reader for text based file formats
+ *
+ * The wrapped stream is read in large blocks. Lines are handed out as pointer ranges into the internal buffer and the
+ * numbers are parsed in place - nothing is allocated per line. Line breaks can be @c \\n, @c \\r\\n or @c \\r.
+ *
+ * @note The reader reads ahead. On destruction the wrapped stream is positioned right after the last line that was
+ * read - this allows to parse only a part of a stream as text.
+ * @sa TextWriteStream
+ * @ingroup IO
+ */
+class TextReadStream {
+public:
+	/**
+	 * @brief A single line of text without the line break
+	 *
+	 * The tokens of the line are separated by whitespace. The read functions advance the line to the next token.
+	 * @note The pointers are only valid until the next line is read from the stream.
+	 */
+	struct Line {
+		const char *cur = nullptr;
+		const char *end = nullptr;
+
+		/**
+		 * @return @c true if there are no more tokens in this line
+		 */
+		bool empty();
+		void skipWhitespace();
+		/**
+		 * @brief Skip the given prefix (after any leading whitespace) if the line starts with it
+		 * @return @c false if the line doesn't start with the given prefix. Nothing is skipped in this case.
+		 */
+		bool consume(const char *prefix);
+		/**
+		 * @return @c false if there are no more tokens in this line
+		 */
+		bool token(const char *&tokenBegin, const char *&tokenEnd);
+		bool skipToken();
+		bool readToken(core::String &str);
+		/**
+		 * @brief Reads the next token as number - like @c atoi() this is @c 0 for tokens that are no numbers
+		 * @return @c false if there are no more tokens in this line
+		 */
+		bool readInt(int &value);
+		/**
+		 * @brief Reads the next token as number - like @c atof() this is @c 0 for tokens that are no numbers
+		 * @return @c false if there are no more tokens in this line
+		 */
+		bool readFloat(float &value);
+		/**
+		 * @return The remaining part of the line
+		 */
+		core::String str() const;
+	};
+
+private:
+	SeekableReadStream &_stream;
+	char *_buffer;
+	size_t _capacity;
+	/** start of the unread data in the buffer */
+	size_t _begin = 0u;
+	/** end of the valid data in the buffer */
+	size_t _end = 0u;
+	/** everything before this buffer offset was already searched for a @c \\n */
+	size_t _searched = 0u;
+	/** the stream position of the first byte in the buffer */
+	int64_t _bufferPos;
+	bool _eos = false;
+
+	/**
+	 * @brief Read the next block from the wrapped stream. The buffer is grown if it is full.
+	 */
+	bool fill();
+
+public:
+	/**
+	 * @param[in] bufferedBytes The amount of bytes that are read at once from the wrapped stream. The buffer is
+	 * grown for lines that are longer than this.
+	 */
+	TextReadStream(SeekableReadStream &stream, int bufferedBytes = 256 * 1024);
+	~TextReadStream();
+
+	/**
+	 * @return @c false if the end of the stream was reached
+	 */
+	bool readLine(Line &line);
+	bool readLine(core::String &str);
+	bool skipLine();
+
+	bool eos() const;
+	/**
+	 * @return The position in the wrapped stream right after the last line that was read
+	 */
+	int64_t pos() const;
+
+	/**
+	 * @brief Parses a decimal number with optional fraction and exponent. The result is the same as with @c strtod()
+	 * - most numbers are parsed without any library call.
+	 * @return The end of the number or @c nullptr if the given range doesn't start with a number
+	 */
+	static const char *parseFloat(const char *begin, const char *end, float &value);
+	/**
+	 * @return The end of the number or @c nullptr if the given range doesn't start with a number
+	 */
+	static const char *parseInt(const char *begin, const char *end, int &value);
+};
+
+inline bool TextReadStream::eos() const {
+	return _begin == _end && (_eos || _stream.eos());
+}
+
+inline int64_t TextReadStream::pos() const {
+	return _bufferPos + (int64_t)_begin;
+}
+
+} // namespace io
@@ -0,0 +1,177 @@
+/**
+ * @file
+ */
+
+#include "TextWriteStream.h"
+#include "core/ArrayLength.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+#include <SDL_stdinc.h>
+#include <math.h>
+
+namespace io {
+
+// a float scaled by these values is still exactly representable as double
+static const uint64_t Pow10[] = {1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull};
+
+TextWriteStream::TextWriteStream(WriteStream &stream, int bufferedBytes) : _stream(stream) {
+	_capacity = core_max((size_t)bufferedBytes, MaxNumberLength * 4);
+	_buffer = (char *)core_malloc(_capacity);
+}
+
+TextWriteStream::~TextWriteStream() {
+	flushBuffer();
+	core_free(_buffer);
+}
+
+bool TextWriteStream::flushBuffer() {
+	if (_size == 0u) {
+		return !_failed;
+	}
+	if (_stream.write(_buffer, _size) == -1) {
+		_failed = true;
+	}
+	_size = 0u;
+	return !_failed;
+}
+
+bool TextWriteStream::flush() {
+	if (!flushBuffer()) {
+		return false;
+	}
+	return _stream.flush();
+}
+
+int TextWriteStream::write(const void *buf, size_t size) {
+	if (size > _capacity / 2) {
+		// don't copy big blocks into the buffer
+		if (!flushBuffer()) {
+			return -1;
+		}
+		const int written = _stream.write(buf, size);
+		if (written == -1) {
+			_failed = true;
+		}
+		return written;
+	}
+	char *target = reserve(size);
+	core_memcpy(target, buf, size);
+	_size += size;
+	return _failed ? -1 : (int)size;
+}
+
+bool TextWriteStream::writeText(const char *str) {
+	return write(str, SDL_strlen(str)) != -1;
+}
+
+bool TextWriteStream::writeText(const core::String &str) {
+	return write(str.c_str(), str.size()) != -1;
+}
+
+bool TextWriteStream::writeChar(char c) {
+	char *target = reserve(1);
+	*target = c;
+	++_size;
+	return !_failed;
+}
+
+bool TextWriteStream::writeIntText(int64_t value) {
+	char *target = reserve(MaxNumberLength);
+	_size += formatInt(target, value);
+	return !_failed;
+}
+
+bool TextWriteStream::writeFloatText(float value, int precision) {
+	char *target = reserve(MaxNumberLength);
+	_size += formatFloat(target, value, precision);
+	return !_failed;
+}
+
+bool TextWriteStream::writeFloats(const char *prefix, const float *values, int n, int precision,
+								  const char *lineEnding) {
+	if (prefix != nullptr) {
+		writeText(prefix);
+	}
+	for (int i = 0; i < n; ++i) {
+		char *target = reserve(MaxNumberLength + 1);
+		*target++ = ' ';
+		_size += 1 + formatFloat(target, values[i], precision);
+	}
+	if (lineEnding != nullptr) {
+		writeText(lineEnding);
+	}
+	return !_failed;
+}
+
+bool TextWriteStream::writeInts(const char *prefix, const int *values, int n, const char *lineEnding) {
+	if (prefix != nullptr) {
+		writeText(prefix);
+	}
+	for (int i = 0; i < n; ++i) {
+		char *target = reserve(MaxNumberLength + 1);
+		*target++ = ' ';
+		_size += 1 + formatInt(target, values[i]);
+	}
+	if (lineEnding != nullptr) {
+		writeText(lineEnding);
+	}
+	return !_failed;
+}
+
+static inline int formatUInt(char *buf, uint64_t value) {
+	char tmp[24];
+	int n = 0;
+	do {
+		tmp[n++] = (char)('0' + (value % 10u));
+		value /= 10u;
+	} while (value != 0u);
+	for (int i = 0; i < n; ++i) {
+		buf[i] = tmp[n - 1 - i];
+	}
+	return n;
+}
+
+int TextWriteStream::formatInt(char *buf, int64_t value) {
+	if (value < 0) {
+		buf[0] = '-';
+		// avoid the overflow for INT64_MIN
+		return 1 + formatUInt(buf + 1, (uint64_t)(-(value + 1)) + 1u);
+	}
+	return formatUInt(buf, (uint64_t)value);
+}
+
+int TextWriteStream::formatFloat(char *buf, float value, int precision) {
+	core_assert(precision >= 0);
+	const double v = (double)value;
+	// the scaled value must be exact and fit into the 53 bits of the double mantissa to get the same rounding as printf
+	if (precision >= lengthof(Pow10) || !isfinite(v) || fabs(v) * (double)Pow10[precision] >= 4.0e15) {
+		const int len = SDL_snprintf(buf, MaxNumberLength, "%.*f", precision, v);
+		return core_min(len, (int)MaxNumberLength - 1);
+	}
+	char *p = buf;
+	if (signbit(v)) {
+		*p++ = '-';
+	}
+	const uint64_t scale = Pow10[precision];
+	const double exact = fabs(v) * (double)scale;
+	uint64_t scaled = (uint64_t)exact;
+	const double remainder = exact - (double)scaled;
+	// round half to even - just like printf does for exactly representable values
+	if (remainder > 0.5 || (remainder == 0.5 && (scaled & 1u) != 0u)) {
+		++scaled;
+	}
+	p += formatUInt(p, scaled / scale);
+	if (precision > 0) {
+		*p++ = '.';
+		uint64_t fraction = scaled % scale;
+		for (int i = precision - 1; i >= 0; --i) {
+			p[i] = (char)('0' + (fraction % 10u));
+			fraction /= 10u;
+		}
+		p += precision;
+	}
+	return (int)(p - buf);
+}
+
+} // namespace io
@@ -0,0 +1,99 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Stream.h"
+#include "core/String.h"
+
+namespace io {
+
+/**
+ * @brief Buffered output stream for text based file formats
+ *
+ * All writes (also the binary ones from @c WriteStream) are collected in a buffer and forwarded in large blocks to the
+ * wrapped stream. Numbers are formatted directly into the buffer without going through @c printf.
+ *
+ * @note The stream is flushed on destruction - call @c flush() to get the error state of the final write.
+ * @ingroup IO
+ */
+class TextWriteStream : public WriteStream {
+private:
+	WriteStream &_stream;
+	char *_buffer;
+	size_t _capacity;
+	size_t _size = 0u;
+	bool _failed = false;
+
+	/**
+	 * @brief Make sure the given amount of bytes fit into the buffer
+	 */
+	inline char *reserve(size_t bytes) {
+		if (_size + bytes > _capacity) {
+			flushBuffer();
+		}
+		return _buffer + _size;
+	}
+	bool flushBuffer();
+
+public:
+	/**
+	 * The longest number that is written by @c formatFloat() or @c formatInt() - including the sign
+	 */
+	static constexpr size_t MaxNumberLength = 64;
+
+	/**
+	 * @param[in] bufferedBytes The amount of bytes to buffer before the write is executed on the wrapped stream.
+	 */
+	TextWriteStream(WriteStream &stream, int bufferedBytes = 256 * 1024);
+	virtual ~TextWriteStream();
+
+	int write(const void *buf, size_t size) override;
+	bool flush() override;
+
+	/**
+	 * @return @c false if any of the writes to the wrapped stream failed
+	 */
+	inline bool good() const {
+		return !_failed;
+	}
+
+	bool writeText(const char *str);
+	bool writeText(const core::String &str);
+	bool writeChar(char c);
+	bool writeIntText(int64_t value);
+	/**
+	 * @brief Write the value with a fixed amount of digits after the decimal point - like @c "%.*f"
+	 * @note Not to be confused with the binary @c WriteStream::writeFloat()
+	 */
+	bool writeFloatText(float value, int precision = 6);
+
+	/**
+	 * @brief Writes a line like @c "v 1.0000 2.0000 3.0000" with a space in front of every value
+	 * @param[in] prefix Optional prefix - might be @c nullptr
+	 * @param[in] lineEnding Optional line ending - might be @c nullptr to continue the line
+	 */
+	bool writeFloats(const char *prefix, const float *values, int n, int precision, const char *lineEnding = "\n");
+	/**
+	 * @brief Writes a line like @c "f 1 2 3" with a space in front of every value
+	 * @param[in] prefix Optional prefix - might be @c nullptr
+	 * @param[in] lineEnding Optional line ending - might be @c nullptr to continue the line
+	 */
+	bool writeInts(const char *prefix, const int *values, int n, const char *lineEnding = "\n");
+
+	/**
+	 * @brief Fixed precision float formatting that produces the same output as @c "%.*f" for the values that are
+	 * usually found in mesh files. Values that are too big or not finite are handed over to @c snprintf.
+	 * @param[out] buf The target buffer - must be at least @c MaxNumberLength bytes big
+	 * @return The amount of characters that were written (without a null byte)
+	 */
+	static int formatFloat(char *buf, float value, int precision);
+	/**
+	 * @param[out] buf The target buffer - must be at least @c MaxNumberLength bytes big
+	 * @return The amount of characters that were written (without a null byte)
+	 */
+	static int formatInt(char *buf, int64_t value);
+};
+
+} // namespace io
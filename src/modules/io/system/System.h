@@ -12,6 +12,10 @@ namespace io {
 bool fs_mkdir(const char *path);
 bool fs_rmdir(const char *path);
 bool fs_unlink(const char *path);
+/**
+ * @brief Moves the file - an existing target file is replaced
+ */
+bool fs_rename(const char *from, const char *to);
 bool fs_exists(const char *path);
 bool fs_writeable(const char *path);
 bool fs_hidden(const char *path);
@@ -16,6 +16,7 @@
 #include <dirent.h>
 #include <errno.h>
 #include <pwd.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -215,6 +216,14 @@ bool fs_unlink(const char *path) {
 	return ret == 0;
 }
 
+bool fs_rename(const char *from, const char *to) {
+	const int ret = rename(from, to);
+	if (ret != 0) {
+		Log::error("Failed to rename %s to %s: %s", from, to, strerror(errno));
+	}
+	return ret == 0;
+}
+
 bool fs_exists(const char *path) {
 	const int ret = access(path, F_OK);
 	if (ret != 0) {
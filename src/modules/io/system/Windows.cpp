@@ -120,6 +120,20 @@ bool fs_unlink(const char *path) {
 	return ret == 0;
 }
 
+bool fs_rename(const char *from, const char *to) {
+	WCHAR *wfrom = io_UTF8ToStringW(from);
+	WCHAR *wto = io_UTF8ToStringW(to);
+	priv::denormalizePath(wfrom);
+	priv::denormalizePath(wto);
+	const BOOL ret = MoveFileExW(wfrom, wto, MOVEFILE_REPLACE_EXISTING);
+	SDL_free(wfrom);
+	SDL_free(wto);
+	if (!ret) {
+		Log::error("Failed to rename %s to %s: %i", from, to, (int)GetLastError());
+	}
+	return ret;
+}
+
 bool fs_rmdir(const char *path) {
 	WCHAR *wpath = io_UTF8ToStringW(path);
 	priv::denormalizePath(wpath);
@@ -0,0 +1,126 @@
+/**
+ * @file
+ */
+
+#include "io/TextReadStream.h"
+#include "io/BufferedReadWriteStream.h"
+#include <SDL_stdinc.h>
+#include <gtest/gtest.h>
+#include <math.h>
+
+namespace io {
+
+static void fillStream(BufferedReadWriteStream &stream, const char *text) {
+	stream.write(text, SDL_strlen(text));
+	stream.seek(0);
+}
+
+TEST(TextReadStreamTest, testLineEndings) {
+	BufferedReadWriteStream stream;
+	fillStream(stream, "unix\nwindows\r\nmac\r\rlast");
+	TextReadStream text(stream);
+	core::String line;
+	ASSERT_TRUE(text.readLine(line));
+	EXPECT_EQ("unix", line);
+	ASSERT_TRUE(text.readLine(line));
+	EXPECT_EQ("windows", line);
+	ASSERT_TRUE(text.readLine(line));
+	EXPECT_EQ("mac", line);
+	ASSERT_TRUE(text.readLine(line));
+	EXPECT_EQ("", line);
+	ASSERT_TRUE(text.readLine(line));
+	EXPECT_EQ("last", line);
+	EXPECT_TRUE(text.eos());
+	EXPECT_FALSE(text.readLine(line));
+}
+
+TEST(TextReadStreamTest, testLongLines) {
+	BufferedReadWriteStream stream;
+	core::String expected;
+	for (int i = 0; i < 1000; ++i) {
+		expected.append("0123456789");
+	}
+	core::String content = expected + "\r\n" + expected + "\r\n";
+	fillStream(stream, content.c_str());
+	// the buffer is a lot smaller than a line
+	TextReadStream text(stream, 100);
+	core::String line;
+	ASSERT_TRUE(text.readLine(line));
+	EXPECT_EQ(expected, line);
+	ASSERT_TRUE(text.readLine(line));
+	EXPECT_EQ(expected, line);
+	EXPECT_FALSE(text.readLine(line));
+}
+
+TEST(TextReadStreamTest, testTokens) {
+	BufferedReadWriteStream stream;
+	fillStream(stream, "  vertex 1.5\t-2 3e2 0.5\nfacet 42 -17 x\n");
+	TextReadStream text(stream);
+	TextReadStream::Line line;
+	ASSERT_TRUE(text.readLine(line));
+	EXPECT_FALSE(line.consume("facet"));
+	ASSERT_TRUE(line.consume("vertex"));
+	float x, y, z;
+	ASSERT_TRUE(line.readFloat(x));
+	ASSERT_TRUE(line.readFloat(y));
+	ASSERT_TRUE(line.readFloat(z));
+	EXPECT_FLOAT_EQ(1.5f, x);
+	EXPECT_FLOAT_EQ(-2.0f, y);
+	EXPECT_FLOAT_EQ(300.0f, z);
+	int i;
+	ASSERT_TRUE(line.readInt(i));
+	EXPECT_EQ(0, i) << "Like atoi() the fraction is ignored";
+	EXPECT_TRUE(line.empty());
+	EXPECT_FALSE(line.readInt(i));
+
+	ASSERT_TRUE(text.readLine(line));
+	core::String token;
+	ASSERT_TRUE(line.readToken(token));
+	EXPECT_EQ("facet", token);
+	ASSERT_TRUE(line.readInt(i));
+	EXPECT_EQ(42, i);
+	ASSERT_TRUE(line.readInt(i));
+	EXPECT_EQ(-17, i);
+	ASSERT_TRUE(line.readInt(i));
+	EXPECT_EQ(0, i);
+	EXPECT_FALSE(text.readLine(line));
+}
+
+TEST(TextReadStreamTest, testParseFloat) {
+	const char *values[] = {"0",	   "-0",		"1",		  "-1.25",	  "0.1",	  "0.2",
+							"0.3",	   "3.14159265", "123456.789", "1e-7",	  "2.5E+10",  "1.",
+							".5",	   "0.000001",	"1e30",		  "-1e-30",	  "16777217", "1e400",
+							"inf",	   "nan",		"0.1234567890123456789012"};
+	for (const char *v : values) {
+		float value = -42.0f;
+		const char *end = v + SDL_strlen(v);
+		EXPECT_EQ(end, TextReadStream::parseFloat(v, end, value)) << v;
+		const float expected = (float)SDL_strtod(v, nullptr);
+		if (isnan(expected)) {
+			EXPECT_TRUE(isnan(value)) << v;
+		} else {
+			EXPECT_EQ(expected, value) << v;
+		}
+	}
+	float value;
+	const char *invalid = "x1";
+	EXPECT_EQ(nullptr, TextReadStream::parseFloat(invalid, invalid + 2, value));
+	const char *exponent = "2e";
+	EXPECT_EQ(exponent + 1, TextReadStream::parseFloat(exponent, exponent + 2, value));
+	EXPECT_EQ(2.0f, value);
+}
+
+TEST(TextReadStreamTest, testRestorePosition) {
+	BufferedReadWriteStream stream;
+	fillStream(stream, "ascii header\nend\nbinary");
+	{
+		TextReadStream text(stream);
+		core::String line;
+		ASSERT_TRUE(text.readLine(line));
+		ASSERT_TRUE(text.readLine(line));
+		EXPECT_EQ("end", line);
+	}
+	EXPECT_EQ(17, stream.pos()) << "The stream must continue after the last read line";
+}
+
+} // namespace io
@@ -0,0 +1,67 @@
+/**
+ * @file
+ */
+
+#include "io/TextWriteStream.h"
+#include "io/BufferedReadWriteStream.h"
+#include <SDL_stdinc.h>
+#include <gtest/gtest.h>
+
+namespace io {
+
+static core::String toString(const BufferedReadWriteStream &stream) {
+	return core::String((const char *)stream.getBuffer(), (size_t)stream.size());
+}
+
+TEST(TextWriteStreamTest, testFormatFloat) {
+	const float values[] = {0.0f,	  -0.0f,	  1.0f,		 -1.0f,		 0.5f,	   1.5f,	   2.5f,
+							0.03125f, -0.03125f, 0.00001f,	 -0.00001f, 123.456f, -98765.43f, 1.0e7f,
+							3.0e12f,  1.0e30f,	 0.1f,		 0.2f,		 0.3f,	   1.0f / 3.0f, 65536.125f};
+	char buf[TextWriteStream::MaxNumberLength];
+	char expected[TextWriteStream::MaxNumberLength];
+	for (int precision = 0; precision <= 8; ++precision) {
+		for (float v : values) {
+			const int len = TextWriteStream::formatFloat(buf, v, precision);
+			SDL_snprintf(expected, sizeof(expected), "%.*f", precision, (double)v);
+			EXPECT_EQ(core::String(expected), core::String(buf, len)) << "precision " << precision;
+		}
+	}
+}
+
+TEST(TextWriteStreamTest, testFormatInt) {
+	char buf[TextWriteStream::MaxNumberLength];
+	int len = TextWriteStream::formatInt(buf, 0);
+	EXPECT_EQ("0", core::String(buf, len));
+	len = TextWriteStream::formatInt(buf, -42);
+	EXPECT_EQ("-42", core::String(buf, len));
+	len = TextWriteStream::formatInt(buf, INT64_MIN);
+	EXPECT_EQ("-9223372036854775808", core::String(buf, len));
+}
+
+TEST(TextWriteStreamTest, testWriteLines) {
+	BufferedReadWriteStream target;
+	{
+		TextWriteStream stream(target, 16);
+		const float v[] = {1.0f, -2.5f, 0.125f};
+		const int f[] = {1, 2, 3, 4};
+		EXPECT_TRUE(stream.writeFloats("v", v, 3, 4));
+		EXPECT_TRUE(stream.writeInts("f", f, 4));
+		EXPECT_TRUE(stream.writeText("end"));
+		EXPECT_TRUE(stream.writeChar('\n'));
+		EXPECT_TRUE(stream.writeStringFormat(false, "%i %s\n", 42, "formatted"));
+		EXPECT_TRUE(stream.flush());
+	}
+	EXPECT_EQ("v 1.0000 -2.5000 0.1250\nf 1 2 3 4\nend\n42 formatted\n", toString(target));
+}
+
+TEST(TextWriteStreamTest, testFlushOnDestruction) {
+	BufferedReadWriteStream target;
+	{
+		TextWriteStream stream(target);
+		stream.writeText("buffered");
+		EXPECT_EQ(0, target.size());
+	}
+	EXPECT_EQ("buffered", toString(target));
+}
+
+} // namespace io
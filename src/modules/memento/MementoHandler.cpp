@@ -4,6 +4,7 @@
 
 #include "MementoHandler.h"
 
+#include "app/Async.h"
 #include "command/Command.h"
 #include "core/ArrayLength.h"
 #include "core/Assert.h"
@@ -11,10 +12,9 @@
 #include "core/ScopedPtr.h"
 #include "core/StandardLib.h"
 #include "core/StringUtil.h"
-#include "io/BufferedReadWriteStream.h"
-#include "io/MemoryReadStream.h"
-#include "io/ZipReadStream.h"
-#include "io/ZipWriteStream.h"
+#include "core/TimeProvider.h"
+#include "io/File.h"
+#include "io/Filesystem.h"
 #include "palette/NormalPalette.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxel/RawVolume.h"
@@ -22,6 +22,7 @@
 #include "voxel/Voxel.h"
 #include "voxelutil/VoxelUtil.h"
 #include <inttypes.h>
+#include <lzfse.h>
 
 namespace memento {
 
@@ -125,111 +126,162 @@ MementoState::MementoState(MementoType _type, const core::DynamicArray<core::Str
 	: type(_type), stringList(_stringList) {
 }
 
-MementoData::MementoData(uint8_t *buf, size_t bufSize, const voxel::Region &region)
-	: _compressedSize(bufSize), _region(region) {
-	if (buf != nullptr) {
-		core_assert(_compressedSize > 0);
-		_buffer = buf;
-	} else {
-		core_assert(_compressedSize == 0);
+MementoPayload::MementoPayload(const voxel::RawVolume &volume)
+	: _volume(new voxel::RawVolume(volume)), _uncompressedSize(volume.region().voxels() * sizeof(voxel::Voxel)) {
+}
+
+MementoPayload::~MementoPayload() {
+	delete _volume;
+	core_free(_buffer);
+	if (!_file.empty()) {
+		io::Filesystem::sysRemoveFile(_file);
 	}
 }
 
-MementoData::MementoData(const uint8_t *buf, size_t bufSize, const voxel::Region &region)
-	: _compressedSize(bufSize), _region(region) {
-	if (buf != nullptr) {
-		core_assert(_compressedSize > 0);
-		_buffer = (uint8_t *)core_malloc(_compressedSize);
-		core_memcpy(_buffer, buf, _compressedSize);
+void MementoPayload::compress() {
+	core_trace_scoped(MementoPayloadCompress);
+	const voxel::RawVolume *volume;
+	{
+		core::ScopedLock lock(_lock);
+		if (_storage != Storage::Volume || _compressing) {
+			return;
+		}
+		_compressing = true;
+		volume = _volume;
+	}
+	// the volume copy is only released below - by this thread as it's the only one that is compressing
+	uint8_t *buf = (uint8_t *)core_malloc(_uncompressedSize);
+	void *scratch = core_malloc(lzfse_encode_scratch_size());
+	size_t compressedSize = lzfse_encode_buffer(buf, _uncompressedSize, volume->data(), _uncompressedSize, scratch);
+	core_free(scratch);
+	const bool uncompressed = compressedSize == 0u;
+	if (uncompressed) {
+		// the data doesn't get smaller - keep it as it is
+		core_memcpy(buf, volume->data(), _uncompressedSize);
+		compressedSize = _uncompressedSize;
 	} else {
-		core_assert(_compressedSize == 0);
+		buf = (uint8_t *)core_realloc(buf, compressedSize);
 	}
+
+	core::ScopedLock lock(_lock);
+	_buffer = buf;
+	_compressedSize = compressedSize;
+	_uncompressed = uncompressed;
+	_storage = Storage::Memory;
+	delete _volume;
+	_volume = nullptr;
+	_compressing = false;
+	_compressed.notify_all();
 }
 
-MementoData::MementoData(MementoData &&o) noexcept
-	: _compressedSize(o._compressedSize), _buffer(o._buffer), _region(o._region) {
-	o._compressedSize = 0;
-	o._buffer = nullptr;
+void MementoPayload::waitCompressed() {
+	compress();
+	core::ScopedLock lock(_lock);
+	while (_compressing) {
+		_compressed.wait(_lock);
+	}
 }
 
-MementoData::~MementoData() {
-	if (_buffer != nullptr) {
-		core_free(_buffer);
-		_buffer = nullptr;
+bool MementoPayload::spill(const core::String &file) {
+	core::ScopedLock lock(_lock);
+	if (_storage != Storage::Memory) {
+		return false;
+	}
+	if (!io::Filesystem::sysWrite(file, _buffer, _compressedSize)) {
+		Log::warn("Failed to write the undo state to %s", file.c_str());
+		return false;
 	}
+	core_free(_buffer);
+	_buffer = nullptr;
+	_file = file;
+	_storage = Storage::Disk;
+	return true;
 }
 
-MementoData::MementoData(const MementoData &o) : _compressedSize(o._compressedSize), _region(o._region) {
-	if (o._buffer != nullptr) {
-		core_assert(_compressedSize > 0);
-		_buffer = (uint8_t *)core_malloc(_compressedSize);
-		core_memcpy(_buffer, o._buffer, _compressedSize);
-	} else {
-		core_assert(_compressedSize == 0);
+bool MementoPayload::readCompressed(uint8_t *buf) const {
+	if (_storage == Storage::Memory) {
+		core_memcpy(buf, _buffer, _compressedSize);
+		return true;
+	}
+	io::File file(_file, io::FileMode::SysRead);
+	if (file.read(buf, (int)_compressedSize) != (int)_compressedSize) {
+		Log::error("Failed to read the undo state from %s", _file.c_str());
+		return false;
 	}
+	return true;
 }
 
-MementoData &MementoData::operator=(MementoData &&o) noexcept {
-	if (this != &o) {
-		_compressedSize = o._compressedSize;
-		o._compressedSize = 0;
-		if (_buffer) {
-			core_free(_buffer);
-		}
-		_buffer = o._buffer;
-		o._buffer = nullptr;
-		_region = o._region;
+bool MementoPayload::uncompress(uint8_t *buf, size_t size) const {
+	core_trace_scoped(MementoPayloadUncompress);
+	core::ScopedLock lock(_lock);
+	if (size != _uncompressedSize) {
+		return false;
 	}
-	return *this;
+	if (_storage == Storage::Volume) {
+		core_memcpy(buf, _volume->data(), _uncompressedSize);
+		return true;
+	}
+	if (_uncompressed) {
+		return readCompressed(buf);
+	}
+	uint8_t *compressed = (uint8_t *)core_malloc(_compressedSize);
+	if (!readCompressed(compressed)) {
+		core_free(compressed);
+		return false;
+	}
+	void *scratch = core_malloc(lzfse_decode_scratch_size());
+	const size_t decoded = lzfse_decode_buffer(buf, size, compressed, _compressedSize, scratch);
+	core_free(scratch);
+	core_free(compressed);
+	return decoded == _uncompressedSize;
 }
 
-MementoData &MementoData::operator=(const MementoData &o) noexcept {
-	if (this != &o) {
-		_compressedSize = o._compressedSize;
-		if (_buffer) {
-			core_free(_buffer);
-			_buffer = nullptr;
-		}
-		if (o._buffer != nullptr) {
-			core_assert(_compressedSize > 0);
-			_buffer = (uint8_t *)core_malloc(_compressedSize);
-			core_memcpy(_buffer, o._buffer, _compressedSize);
-		} else {
-			core_assert(_compressedSize == 0);
-		}
-		_region = o._region;
+MementoPayload::Storage MementoPayload::storage() const {
+	core::ScopedLock lock(_lock);
+	return _storage;
+}
+
+size_t MementoPayload::size() const {
+	core::ScopedLock lock(_lock);
+	if (_storage == Storage::Volume) {
+		return _uncompressedSize;
 	}
-	return *this;
+	return _compressedSize;
+}
+
+size_t MementoPayload::memorySize() const {
+	core::ScopedLock lock(_lock);
+	if (_storage == Storage::Volume) {
+		// the copy of the volume holds its own voxel buffer once the edited volume was modified
+		return _uncompressedSize;
+	}
+	if (_storage == Storage::Memory) {
+		return _compressedSize;
+	}
+	return 0u;
+}
+
+MementoData::MementoData(const core::SharedPtr<MementoPayload> &payload, const voxel::Region &region)
+	: _payload(payload), _region(region) {
 }
 
 MementoData MementoData::fromVolume(const voxel::RawVolume *volume, const voxel::Region &region) {
 	if (volume == nullptr) {
 		return MementoData();
 	}
-	voxel::Region mementoRegion = region;
 	// TODO: MEMENTO: see issue https://github.com/vengi-voxel/vengi/issues/200
-	// const bool partialMemento = mementoRegion.isValid();
-	const bool partialMemento = false;
-	if (!partialMemento) {
-		mementoRegion = volume->region();
-	}
-
-	const int allVoxels = volume->region().voxels();
-	io::BufferedReadWriteStream outStream(allVoxels * sizeof(voxel::Voxel));
-	io::ZipWriteStream stream(outStream);
-	if (partialMemento) {
-		voxel::RawVolume v(volume, region);
-		stream.write(v.data(), allVoxels * sizeof(voxel::Voxel));
-	} else {
-		stream.write(volume->data(), allVoxels * sizeof(voxel::Voxel));
-	}
-	stream.flush();
-	const size_t size = (size_t)outStream.size();
-	return {outStream.release(), size, mementoRegion};
+	// only the whole volume is stored - the given region is ignored
+	const voxel::Region &mementoRegion = volume->region();
+
+	// the copy shares the voxels with the volume - the compression is done in the background and the caller
+	// doesn't have to wait for it
+	core::SharedPtr<MementoPayload> payload = core::make_shared<MementoPayload>(*volume);
+	app::async([payload]() { payload->compress(); });
+	return {payload, mementoRegion};
 }
 
 bool MementoData::toVolume(voxel::RawVolume *volume, const MementoData &mementoData) {
-	if (mementoData._buffer == nullptr) {
+	if (!mementoData._payload) {
 		return false;
 	}
 	core_assert_always(volume != nullptr);
@@ -237,10 +289,8 @@ bool MementoData::toVolume(voxel::RawVolume *volume, const MementoData &mementoD
 		return false;
 	}
 	const size_t uncompressedBufferSize = mementoData.region().voxels() * sizeof(voxel::Voxel);
-	io::MemoryReadStream dataStream(mementoData._buffer, mementoData._compressedSize);
-	io::ZipReadStream stream(dataStream, (int)dataStream.size());
 	uint8_t *uncompressedBuf = (uint8_t *)core_malloc(uncompressedBufferSize);
-	if (stream.read(uncompressedBuf, uncompressedBufferSize) == -1) {
+	if (!mementoData._payload->uncompress(uncompressedBuf, uncompressedBufferSize)) {
 		core_free(uncompressedBuf);
 		return false;
 	}
@@ -282,6 +332,9 @@ void MementoHandler::beginGroup(const core::String &name) {
 	Log::debug("Begin memento group: %i (%s)", _groupState, name.c_str());
 	if (_groupState <= 0) {
 		cutFromGroupStatePosition();
+		if (_groups.size() == _groups.capacity()) {
+			eraseFront(1);
+		}
 		_groups.emplace_back(MementoStateGroup{name, {}});
 		_groupStatePosition = stateSize() - 1;
 	}
@@ -326,7 +379,7 @@ void MementoHandler::printState(const MementoState &state) const {
 	Log::info("%s: node id: %s", typeToString(state.type), state.nodeUUID.c_str());
 	Log::info(" - parent: %s", state.parentUUID.c_str());
 	Log::info(" - name: %s", state.name.c_str());
-	Log::info(" - volume: %s", state.data._buffer == nullptr ? "empty" : "volume");
+	Log::info(" - volume: %s", state.data.hasVolume() ? "volume" : "empty");
 	const glm::ivec3 &mins = state.dataRegion().getLowerCorner();
 	const glm::ivec3 &maxs = state.dataRegion().getUpperCorner();
 	Log::info(" - region: mins(%i:%i:%i)/maxs(%i:%i:%i)", mins.x, mins.y, mins.z, maxs.x, maxs.y, maxs.z);
@@ -379,8 +432,8 @@ void MementoHandler::construct() {
 
 void MementoHandler::clearStates() {
 	core_assert_msg(_groupState <= 0, "You should not clear the states while you are recording a group state");
-	_groups.clear();
-	_groupStatePosition = 0u;
+	eraseBack(_groups.size());
+	_groupStatePosition = 0;
 }
 
 void MementoHandler::undoModification(MementoState &s) {
@@ -686,7 +739,7 @@ bool MementoHandler::markUndoPreamble() {
 		// every other state that follows the new one (everything after
 		// the current state position)
 		const size_t n = _groups.size() - (_groupStatePosition + 1);
-		_groups.erase_back(n);
+		eraseBack(n);
 	}
 	return true;
 }
@@ -695,10 +748,10 @@ bool MementoHandler::removeLast() {
 	if (_groups.empty()) {
 		return false;
 	}
-	if (_groupStatePosition == stateSize() - 1) {
+	if (_groupStatePosition == (int)stateSize() - 1) {
 		--_groupStatePosition;
 	}
-	_groups.erase_back(1);
+	eraseBack(1);
 	return true;
 }
 
@@ -738,7 +791,21 @@ bool MementoHandler::markUndo(const core::String &parentId, const core::String &
 void MementoHandler::cutFromGroupStatePosition() {
 	const int cutOff = core_max(0, (int)(stateSize() - _groupStatePosition - 1));
 	Log::debug("Cut off %i states", cutOff);
-	_groups.erase_back(cutOff);
+	eraseBack(cutOff);
+}
+
+void MementoHandler::eraseBack(size_t n) {
+	for (size_t i = 0; i < n; ++i) {
+		_groups[_groups.size() - 1 - i] = MementoStateGroup{};
+	}
+	_groups.erase_back(n);
+}
+
+void MementoHandler::eraseFront(size_t n) {
+	for (size_t i = 0; i < n; ++i) {
+		_groups[i] = MementoStateGroup{};
+	}
+	_groups.erase_front(n);
 }
 
 void MementoHandler::addState(MementoState &&state) {
@@ -751,8 +818,100 @@ void MementoHandler::addState(MementoState &&state) {
 	group.name = "single";
 	group.states.emplace_back(state);
 	cutFromGroupStatePosition();
+	if (_groups.size() == _groups.capacity()) {
+		eraseFront(1);
+	}
 	_groups.emplace_back(core::move(group));
 	_groupStatePosition = stateSize() - 1;
+	applyMemoryBudget();
+}
+
+size_t MementoHandler::memorySize() const {
+	size_t size = 0u;
+	for (const MementoStateGroup &group : _groups) {
+		for (const MementoState &state : group.states) {
+			if (state.data.hasVolume()) {
+				size += state.data.payload()->memorySize();
+			}
+		}
+	}
+	return size;
+}
+
+void MementoHandler::applyMemoryBudget() {
+	size_t size = memorySize();
+	if (size <= _memoryBudget) {
+		return;
+	}
+	core_trace_scoped(MementoApplyMemoryBudget);
+	// the data of these states is still compressed in the background and is moved to disk once that is done
+	size_t pendingSize = 0u;
+	if (!_spillDirectory.empty()) {
+		// the current group stays in memory - it's the most likely one to get undone
+		for (int i = 0; i < _groupStatePosition && size - pendingSize > _memoryBudget; ++i) {
+			for (const MementoState &state : _groups[i].states) {
+				if (!state.data.hasVolume()) {
+					continue;
+				}
+				const core::SharedPtr<MementoPayload> &payload = state.data.payload();
+				const MementoPayload::Storage storage = payload->storage();
+				if (storage == MementoPayload::Storage::Disk) {
+					continue;
+				}
+				const size_t memorySize = payload->memorySize();
+				if (storage == MementoPayload::Storage::Volume) {
+					// don't compress on the calling thread - the next budget check will move it to disk
+					pendingSize += memorySize;
+					continue;
+				}
+				const core::String &file = core::string::format("%s/%" PRIu64 "-%u.undo", _spillDirectory.c_str(),
+																 _spillSession, _spillFiles++);
+				if (payload->spill(file)) {
+					size -= memorySize;
+				}
+			}
+		}
+	}
+	while (size - pendingSize > _memoryBudget && _groupStatePosition > 0) {
+		eraseFront(1);
+		--_groupStatePosition;
+		size = memorySize();
+		// the removed states might have been pending, too
+		pendingSize = core_min(pendingSize, size);
+	}
+	Log::debug("Memento states use %i bytes after applying the budget of %i bytes", (int)size, (int)_memoryBudget);
+}
+
+void MementoHandler::compressStates() {
+	for (const MementoStateGroup &group : _groups) {
+		for (const MementoState &state : group.states) {
+			if (state.data.hasVolume()) {
+				state.data.payload()->waitCompressed();
+			}
+		}
+	}
+	applyMemoryBudget();
+}
+
+void MementoHandler::setMemoryBudget(size_t bytes) {
+	_memoryBudget = bytes;
+	applyMemoryBudget();
+}
+
+size_t MementoHandler::memoryBudget() const {
+	return _memoryBudget;
+}
+
+void MementoHandler::setSpillDirectory(const core::String &directory) {
+	if (!directory.empty() && !io::Filesystem::sysCreateDir(directory)) {
+		Log::warn("Failed to create the undo directory %s", directory.c_str());
+		_spillDirectory = "";
+		return;
+	}
+	_spillDirectory = directory;
+	if (_spillSession == 0u) {
+		_spillSession = core::TimeProvider::systemMillis();
+	}
 }
 
 void MementoHandler::setMaxUndoRegion(const voxel::Region &region) {
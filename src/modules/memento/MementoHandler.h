@@ -6,8 +6,12 @@
 
 #include "core/IComponent.h"
 #include "core/Optional.h"
+#include "core/SharedPtr.h"
 #include "core/String.h"
+#include "core/Trace.h"
 #include "core/collection/RingBuffer.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
 #include "palette/NormalPalette.h"
 #include "palette/Palette.h"
 #include "scenegraph/SceneGraph.h"
@@ -43,51 +47,122 @@ enum class MementoType {
 };
 
 /**
- * @brief Holds the data of a memento state
+ * @brief The voxel data of a memento state
+ *
+ * Right after a state was recorded the payload only holds a copy of the volume. The copy shares the voxel data with
+ * the volume until the volume is modified - so recording a state doesn't block. The voxel data is compressed in the
+ * background and the compressed data can be moved to disk to keep the memory usage of the undo history low.
  *
- * The given buffer is owned by this class and represents a compressed volume
+ * @note All methods can be called from any thread
  */
-class MementoData {
-	friend struct MementoState;
-	friend class MementoHandler;
+class MementoPayload {
+public:
+	enum class Storage { Volume, Memory, Disk };
 
 private:
+	mutable core_trace_mutex(core::Lock, _lock, "MementoPayload");
+	Storage _storage = Storage::Volume;
 	/**
-	 * @brief How big is the buffer with the compressed volume data
+	 * @brief One thread is encoding the copy of the volume - the copy is released by that thread only
+	 */
+	bool _compressing = false;
+	core::ConditionVariable _compressed;
+	/**
+	 * @brief The copy of the volume until the data is compressed
 	 */
-	size_t _compressedSize = 0;
+	voxel::RawVolume *_volume = nullptr;
 	/**
-	 * @brief The compressed volume data
+	 * @brief The compressed volume data if the storage is @c Storage::Memory
 	 */
 	uint8_t *_buffer = nullptr;
+	/**
+	 * @brief How big is the buffer with the compressed volume data
+	 */
+	size_t _compressedSize = 0u;
+	/**
+	 * @brief The data is stored without compression if the compression didn't reduce the size
+	 */
+	bool _uncompressed = false;
+	/**
+	 * @brief The file with the compressed volume data if the storage is @c Storage::Disk
+	 */
+	core::String _file;
+	const size_t _uncompressedSize;
+
+	bool readCompressed(uint8_t *buf) const;
+
+public:
+	MementoPayload(const voxel::RawVolume &volume);
+	~MementoPayload();
+
+	/**
+	 * @brief Compresses the voxel data and releases the copy of the volume. Does nothing if the data was already
+	 * compressed or another thread is currently compressing it.
+	 */
+	void compress();
+	/**
+	 * @brief Like @c compress() - but waits for another thread that is currently compressing the data
+	 */
+	void waitCompressed();
+	/**
+	 * @brief Moves the compressed data into the given file
+	 * @return @c false if the data isn't compressed yet or the file could not get written
+	 */
+	bool spill(const core::String &file);
+	/**
+	 * @brief Writes the voxel data into a buffer that has the size of the volume data
+	 */
+	bool uncompress(uint8_t *buf, size_t size) const;
+
+	Storage storage() const;
+	/**
+	 * @return The amount of bytes that are stored - the compressed size or the size of the voxel data if it isn't
+	 * compressed yet
+	 */
+	size_t size() const;
+	/**
+	 * @return The amount of bytes that are kept in memory - the size of the voxel data as long as it isn't compressed,
+	 * the compressed size afterwards and nothing if the data was moved to disk
+	 */
+	size_t memorySize() const;
+};
+
+/**
+ * @brief Holds the data of a memento state
+ *
+ * The volume data is shared between copies of this class
+ */
+class MementoData {
+	friend struct MementoState;
+	friend class MementoHandler;
+
+private:
+	core::SharedPtr<MementoPayload> _payload;
 	/**
 	 * The region the given volume data is for
 	 */
 	voxel::Region _region{};
 
-	MementoData(const uint8_t *buf, size_t bufSize, const voxel::Region &region);
-	MementoData(uint8_t *buf, size_t bufSize, const voxel::Region &region);
+	MementoData(const core::SharedPtr<MementoPayload> &payload, const voxel::Region &region);
 
 public:
 	MementoData() {
 	}
-	MementoData(MementoData &&o) noexcept;
-	MementoData(const MementoData &o);
-	~MementoData();
 
 	inline size_t size() const {
-		return _compressedSize;
+		return _payload ? _payload->size() : 0u;
 	}
 
-	MementoData &operator=(MementoData &&o) noexcept;
-	MementoData &operator=(const MementoData &o) noexcept;
-
 	inline const voxel::Region &region() const {
 		return _region;
 	}
 
 	inline bool hasVolume() const {
-		return _buffer != nullptr;
+		return (bool)_payload;
+	}
+
+	inline const core::SharedPtr<MementoPayload> &payload() const {
+		return _payload;
 	}
 
 	/**
@@ -96,7 +171,7 @@ public:
 	 */
 	static bool toVolume(voxel::RawVolume *volume, const MementoData &mementoData);
 	/**
-	 * @brief Converts the given volume into a @c MementoData structure (and perform the compression)
+	 * @brief Converts the given volume into a @c MementoData structure. The compression is done in the background.
 	 * @param[in] volume The volume to create the memento state for. This might be @c null.
 	 * @param[in] region The region of the volume to create the memento data for - if this is not a valid region,
 	 * the whole volume is going to added to the memento data.
@@ -148,7 +223,7 @@ struct MementoState {
 	 * Some types (@c MementoType) don't have a volume attached.
 	 */
 	inline bool hasVolumeData() const {
-		return data._buffer != nullptr;
+		return data.hasVolume();
 	}
 
 	inline const voxel::Region &dataRegion() const {
@@ -161,22 +236,42 @@ struct MementoStateGroup {
 	core::DynamicArray<MementoState> states;
 };
 
-using MementoStates = core::RingBuffer<MementoStateGroup, 64u>;
+using MementoStates = core::RingBuffer<MementoStateGroup, 1024u>;
 /**
  * @brief Class that manages the undo and redo steps for the scene
  *
  * @note For the volumes only the dirty regions are stored in a compressed form.
+ *
+ * The amount of states is limited by a memory budget for the compressed volume data. If the budget is exceeded, the
+ * volume data of the oldest states is moved to disk - or the oldest states are removed if this is disabled.
  */
 class MementoHandler : public core::IComponent {
 private:
 	MementoStates _groups;
 	int _groupState = 0;
-	uint8_t _groupStatePosition = 0u;
+	int _groupStatePosition = 0;
 	int _locked = 0;
 	voxel::Region _maxUndoRegion = voxel::Region::InvalidRegion;
+	size_t _memoryBudget = 512u * 1024u * 1024u;
+	/**
+	 * @brief The directory for the volume data of old states - empty if the data should not be moved to disk
+	 */
+	core::String _spillDirectory;
+	uint64_t _spillSession = 0u;
+	uint32_t _spillFiles = 0u;
 
 	void cutFromGroupStatePosition();
 	void addState(MementoState &&state);
+	/**
+	 * @brief Releases the states of the groups before they are removed - the ring buffer doesn't destroy them
+	 */
+	void eraseBack(size_t n);
+	void eraseFront(size_t n);
+	/**
+	 * @brief Moves the data of the oldest states to disk or removes the oldest states until the compressed data fits
+	 * into the memory budget
+	 */
+	void applyMemoryBudget();
 	/**
 	 * @return @c true if it's allowed to create an undo state
 	 */
@@ -232,6 +327,26 @@ public:
 	 */
 	bool recordVolumeStates(const voxel::RawVolume *volume) const;
 
+	/**
+	 * @brief The amount of bytes the compressed volume data of all states may use in memory
+	 */
+	void setMemoryBudget(size_t bytes);
+	size_t memoryBudget() const;
+	/**
+	 * @brief Allow to move the compressed volume data of old states into the given directory instead of removing the
+	 * states if the memory budget is exceeded. An empty directory disables this.
+	 */
+	void setSpillDirectory(const core::String &directory);
+	/**
+	 * @return The amount of bytes the volume data of all states use in memory - including the uncompressed data of the
+	 * states that are still compressed in the background
+	 */
+	size_t memorySize() const;
+	/**
+	 * @brief Compress the volume data of all states that are still compressed in the background - and wait for it
+	 */
+	void compressStates();
+
 	/**
 	 * @brief Locks the handler for accepting new states or perform undo() or redo() steps
 	 * @sa @c unlock()
@@ -280,7 +395,7 @@ public:
 	const MementoStates &states() const;
 
 	size_t stateSize() const;
-	uint8_t statePosition() const;
+	int statePosition() const;
 };
 
 class ScopedMementoGroup {
@@ -335,7 +450,7 @@ inline const MementoStates &MementoHandler::states() const {
 	return _groups;
 }
 
-inline uint8_t MementoHandler::statePosition() const {
+inline int MementoHandler::statePosition() const {
 	return _groupStatePosition;
 }
 
@@ -360,7 +475,7 @@ inline bool MementoHandler::canRedo() const {
 	if (stateSize() <= 1) {
 		return false;
 	}
-	return _groupStatePosition <= stateSize() - 2;
+	return _groupStatePosition <= (int)stateSize() - 2;
 }
 
 } // namespace memento
@@ -3,13 +3,17 @@
  */
 
 #include "../MementoHandler.h"
+#include "app/Async.h"
 #include "app/tests/AbstractTest.h"
+#include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
+#include "io/Filesystem.h"
 #include "math/tests/TestMathHelper.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "scenegraph/SceneGraphTransform.h"
 #include "voxel/RawVolume.h"
+#include "voxel/Voxel.h"
 
 namespace memento {
 
@@ -777,4 +781,98 @@ TEST_F(MementoHandlerTest, testAllAnimations) {
 	_sceneGraph.setAnimations(*stateRedo.stringList.value());
 }
 
+TEST_F(MementoHandlerTest, testCompressedVolumeData) {
+	core::SharedPtr<voxel::RawVolume> volume = create(16);
+	volume->setVoxel(1, 2, 3, voxel::createVoxel(voxel::VoxelType::Generic, 42));
+	ASSERT_TRUE(_mementoHandler.markUndo(0, 1, InvalidNodeId, "Node", scenegraph::SceneGraphNodeType::Model,
+										 volume.get(), MementoType::Modification));
+	// changing the volume after the state was recorded must not change the state
+	volume->setVoxel(1, 2, 3, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	_mementoHandler.compressStates();
+	const MementoState &state = firstState(_mementoHandler.stateGroup());
+	ASSERT_TRUE(state.hasVolumeData());
+	EXPECT_EQ(MementoPayload::Storage::Memory, state.data.payload()->storage());
+	EXPECT_LT(state.data.size(), (size_t)volume->region().voxels() * sizeof(voxel::Voxel));
+	EXPECT_EQ(state.data.size(), _mementoHandler.memorySize());
+
+	voxel::RawVolume restored(volume->region());
+	ASSERT_TRUE(MementoData::toVolume(&restored, state.data));
+	EXPECT_EQ(42, restored.voxel(1, 2, 3).getColor());
+}
+
+TEST_F(MementoHandlerTest, testPayloadMemorySize) {
+	core::SharedPtr<voxel::RawVolume> volume = create(16);
+	volume->setVoxel(1, 2, 3, voxel::createVoxel(voxel::VoxelType::Generic, 42));
+	MementoPayload payload(*volume.get());
+	// the data that is still waiting for the compression counts with its full size
+	const size_t uncompressedSize = (size_t)volume->region().voxels() * sizeof(voxel::Voxel);
+	EXPECT_EQ(uncompressedSize, payload.memorySize());
+	payload.compress();
+	EXPECT_LT(payload.memorySize(), uncompressedSize);
+	EXPECT_EQ(payload.size(), payload.memorySize());
+}
+
+TEST_F(MementoHandlerTest, testPayloadConcurrentCompress) {
+	core::SharedPtr<voxel::RawVolume> volume = create(16);
+	volume->setVoxel(1, 2, 3, voxel::createVoxel(voxel::VoxelType::Generic, 42));
+	core::SharedPtr<MementoPayload> payload = core::make_shared<MementoPayload>(*volume.get());
+	// only one of the threads is encoding the copy of the volume - the others skip or wait for it
+	auto future1 = app::async([payload]() { payload->compress(); });
+	auto future2 = app::async([payload]() { payload->compress(); });
+	payload->waitCompressed();
+	EXPECT_EQ(MementoPayload::Storage::Memory, payload->storage());
+	future1.get();
+	future2.get();
+
+	const size_t uncompressedSize = (size_t)volume->region().voxels() * sizeof(voxel::Voxel);
+	voxel::Voxel *voxels = (voxel::Voxel *)core_malloc(uncompressedSize);
+	ASSERT_TRUE(payload->uncompress((uint8_t *)voxels, uncompressedSize));
+	core::ScopedPtr<voxel::RawVolume> restored(voxel::RawVolume::createRaw(voxels, volume->region()));
+	EXPECT_EQ(42, restored->voxel(1, 2, 3).getColor());
+}
+
+TEST_F(MementoHandlerTest, testMemoryBudgetSpillToDisk) {
+	const core::String directory = io::filesystem()->homeWritePath("undotest");
+	_mementoHandler.setSpillDirectory(directory);
+	core::SharedPtr<voxel::RawVolume> volume = create(8);
+	for (int i = 0; i < 4; ++i) {
+		volume->setVoxel(i, i, i, voxel::createVoxel(voxel::VoxelType::Generic, i + 1));
+		ASSERT_TRUE(_mementoHandler.markUndo(0, 1, InvalidNodeId, "Node", scenegraph::SceneGraphNodeType::Model,
+											 volume.get(), MementoType::Modification));
+	}
+	_mementoHandler.compressStates();
+	const size_t budget = _mementoHandler.memorySize() / 2u;
+	_mementoHandler.setMemoryBudget(budget);
+	ASSERT_EQ(4u, _mementoHandler.stateSize()) << "The states are moved to disk instead of removing them";
+	EXPECT_LE(_mementoHandler.memorySize(), budget);
+
+	_mementoHandler.undo();
+	_mementoHandler.undo();
+	const MementoStateGroup &group = _mementoHandler.undo();
+	const MementoState &state = firstState(group);
+	ASSERT_TRUE(state.hasVolumeData());
+	EXPECT_EQ(MementoPayload::Storage::Disk, state.data.payload()->storage());
+	voxel::RawVolume restored(volume->region());
+	ASSERT_TRUE(MementoData::toVolume(&restored, state.data));
+	EXPECT_EQ(1, restored.voxel(0, 0, 0).getColor());
+	EXPECT_TRUE(voxel::isAir(restored.voxel(1, 1, 1).getMaterial()));
+	_mementoHandler.clearStates();
+	io::Filesystem::sysRemoveDir(directory, true);
+}
+
+TEST_F(MementoHandlerTest, testMemoryBudgetRemoveStates) {
+	_mementoHandler.setSpillDirectory("");
+	core::SharedPtr<voxel::RawVolume> volume = create(8);
+	for (int i = 0; i < 4; ++i) {
+		volume->setVoxel(i, i, i, voxel::createVoxel(voxel::VoxelType::Generic, i + 1));
+		ASSERT_TRUE(_mementoHandler.markUndo(0, 1, InvalidNodeId, "Node", scenegraph::SceneGraphNodeType::Model,
+											 volume.get(), MementoType::Modification));
+	}
+	_mementoHandler.compressStates();
+	_mementoHandler.setMemoryBudget(_mementoHandler.memorySize() - 1u);
+	EXPECT_EQ(3u, _mementoHandler.stateSize()) << "The oldest state should have been removed";
+	EXPECT_EQ(2, _mementoHandler.statePosition());
+	EXPECT_TRUE(_mementoHandler.canUndo());
+}
+
 } // namespace memento
@@ -21,6 +21,14 @@ public:
 
 	virtual bool send(const char *buffer) const = 0;
 
+	/**
+	 * @brief The max size of one message - several metrics can be sent in one message
+	 * @return @c 0 if there is no limit
+	 */
+	virtual size_t maxMessageSize() const {
+		return 0u;
+	}
+
 	virtual bool init() override {
 		return true;
 	}
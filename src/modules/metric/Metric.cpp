@@ -99,7 +99,66 @@ bool Metric::createTags(char *buffer, size_t len, const TagMap &tags, const char
 	return true;
 }
 
-bool Metric::assemble(const char *key, int value, const char *type, const TagMap &tags) const {
+void Metric::beginBatch() const {
+	_batching = true;
+}
+
+bool Metric::endBatch() const {
+	_batching = false;
+	return flushBatch();
+}
+
+bool Metric::send(const char *buffer, size_t len) const {
+	if (!_messageSender) {
+		return false;
+	}
+	if (_batching) {
+		const size_t maxSize = _messageSender->maxMessageSize();
+		if (maxSize > 0u && !_batch.empty() && _batch.size() + 1u + len > maxSize) {
+			if (!flushBatch()) {
+				return false;
+			}
+		}
+		if (_batchLines > 0) {
+			_batch.append(_flavor == Flavor::JSON ? "," : "\n");
+		}
+		_batch.append(buffer, len);
+		++_batchLines;
+		return true;
+	}
+	if (!_messageSender->send(buffer)) {
+		if (_flavor == Flavor::JSON) {
+			_messageSender = IMetricSenderPtr();
+			Log::warn("Failed to send metric - disable metrics for this session");
+		}
+		return false;
+	}
+	return true;
+}
+
+bool Metric::flushBatch() const {
+	if (_batchLines == 0) {
+		return true;
+	}
+	bool success = false;
+	if (_messageSender) {
+		if (_flavor == Flavor::JSON && _batchLines > 1) {
+			const core::String json = "[" + _batch + "]";
+			success = _messageSender->send(json.c_str());
+		} else {
+			success = _messageSender->send(_batch.c_str());
+		}
+		if (!success && _flavor == Flavor::JSON) {
+			_messageSender = IMetricSenderPtr();
+			Log::warn("Failed to send metric - disable metrics for this session");
+		}
+	}
+	_batch.clear();
+	_batchLines = 0;
+	return success;
+}
+
+bool Metric::assemble(const char *key, int value, const char *type, const TagMap &tags, float sampleRate) const {
 	if (!_messageSender) {
 		return false;
 	}
@@ -107,6 +166,15 @@ bool Metric::assemble(const char *key, int value, const char *type, const TagMap
 	char buffer[metricSize];
 	constexpr int tagsSize = 256;
 	char tagsBuffer[tagsSize] = "";
+	// the sample rate is only added if not every event was recorded
+	char rate[32] = "";
+	if (sampleRate > 0.0f && sampleRate < 1.0f) {
+		SDL_snprintf(rate, sizeof(rate), "%f", sampleRate);
+		size_t rateLen = SDL_strlen(rate);
+		while (rateLen > 1 && rate[rateLen - 1] == '0' && rate[rateLen - 2] != '.') {
+			rate[--rateLen] = '\0';
+		}
+	}
 	int written;
 	switch (_flavor) {
 	case Flavor::JSON: {
@@ -116,6 +184,9 @@ bool Metric::assemble(const char *key, int value, const char *type, const TagMap
 		json.append("\"name\": \"").append(key).append("\",");
 		json.append("\"value\": ").append(value).append(",");
 		json.append("\"type\": \"").append(type).append("\",");
+		if (rate[0] != '\0') {
+			json.append("\"sample_rate\": ").append(rate).append(",");
+		}
 		json.append("\"uuid\": \"").append(_uuid).append("\",");
 		json.append("\"tags\": {");
 		bool firstTag = true;
@@ -128,42 +199,39 @@ bool Metric::assemble(const char *key, int value, const char *type, const TagMap
 		}
 		json.append("}");
 		json.append("}");
-		written = json.size();
-		if (!_messageSender->send(json.c_str())) {
-			_messageSender = IMetricSenderPtr();
-			Log::warn("Failed to send metric - disable metrics for this session");
-			return false;
-		}
-		return true;
+		return send(json.c_str(), json.size());
 	}
 	case Flavor::Etsy:
-		written = SDL_snprintf(buffer, sizeof(buffer), "%s.%s:%i|%s", _prefix.c_str(), key, value, type);
+		written = SDL_snprintf(buffer, sizeof(buffer), "%s.%s:%i|%s%s%s", _prefix.c_str(), key, value, type,
+							   rate[0] ? "|@" : "", rate);
 		break;
 	case Flavor::Datadog:
 		if (!createTags(tagsBuffer, sizeof(tagsBuffer), tags, ":", "|#", ",")) {
 			return false;
 		}
-		written = SDL_snprintf(buffer, sizeof(buffer), "%s.%s:%i|%s%s", _prefix.c_str(), key, value, type, tagsBuffer);
+		written = SDL_snprintf(buffer, sizeof(buffer), "%s.%s:%i|%s%s%s%s", _prefix.c_str(), key, value, type,
+							   rate[0] ? "|@" : "", rate, tagsBuffer);
 		break;
 	case Flavor::Influx:
 		if (!createTags(tagsBuffer, sizeof(tagsBuffer), tags, "=", ",", ",")) {
 			return false;
 		}
-		written = SDL_snprintf(buffer, sizeof(buffer), "%s_%s,type=%s%s value=%i", _prefix.c_str(), key, type,
-							   tagsBuffer, value);
+		written = SDL_snprintf(buffer, sizeof(buffer), "%s_%s,type=%s%s value=%i%s%s", _prefix.c_str(), key, type,
+							   tagsBuffer, value, rate[0] ? ",sample_rate=" : "", rate);
 		break;
 	case Flavor::Telegraf:
 	default:
 		if (!createTags(tagsBuffer, sizeof(tagsBuffer), tags, "=", ",", ",")) {
 			return false;
 		}
-		written = SDL_snprintf(buffer, sizeof(buffer), "%s.%s%s:%i|%s", _prefix.c_str(), key, tagsBuffer, value, type);
+		written = SDL_snprintf(buffer, sizeof(buffer), "%s.%s%s:%i|%s%s%s", _prefix.c_str(), key, tagsBuffer, value,
+							   type, rate[0] ? "|@" : "", rate);
 		break;
 	}
 	if (written >= metricSize) {
 		return false;
 	}
-	return _messageSender->send(buffer);
+	return send(buffer, (size_t)written);
 }
 
 } // namespace metric
@@ -43,6 +43,13 @@ private:
 	core::String _uuid;
 	Flavor _flavor = Flavor::Telegraf;
 	mutable IMetricSenderPtr _messageSender;
+	/** the metric lines that are collected between beginBatch() and endBatch() */
+	mutable core::String _batch;
+	mutable int _batchLines = 0;
+	mutable bool _batching = false;
+
+	bool send(const char *buffer, size_t len) const;
+	bool flushBatch() const;
 
 	/**
 	 * @brief Create the needed tag list if it is supported by the specified flavor
@@ -54,7 +61,7 @@ private:
 	 * @return @c false if not all tags could get written into the specified target buffer, @c true otherwise
 	 */
 	bool createTags(char *buffer, size_t len, const TagMap& tags, const char* sep, const char* preamble, const char *split = ",") const;
-	bool assemble(const char* key, int value, const char* type, const TagMap& tags = {}) const;
+	bool assemble(const char* key, int value, const char* type, const TagMap& tags = {}, float sampleRate = 1.0f) const;
 public:
 	~Metric();
 
@@ -65,6 +72,19 @@ public:
 	bool init(const char *prefix, const IMetricSenderPtr& messageSender);
 	void shutdown();
 
+	/**
+	 * @brief Collects all following metrics until endBatch() is called and sends them with as few messages as
+	 * possible
+	 *
+	 * The statsd and influx lines are joined by newlines - one udp packet doesn't exceed
+	 * @c IMetricSender::maxMessageSize() - the json metrics are sent as one array.
+	 */
+	void beginBatch() const;
+	/**
+	 * @brief Sends the metrics that were collected since beginBatch()
+	 */
+	bool endBatch() const;
+
 	/**
 	 * @brief Increments the key
 	 */
@@ -103,10 +123,11 @@ public:
 	 * A timer is a measure of the number of milliseconds elapsed between a start
 	 * and end time, for example the time to complete rendering of a web page for
 	 * a user. Valid timer values are in the range [0, 2^64^).
-	 * @code <metric name>:<value>|ms @endcode
+	 * @code <metric name>:<value>|ms[|@<sample rate>] @endcode
+	 * A sample rate of @c 1/n tells the server that this value stands for @c n timings.
 	 * @note Record execution times
 	 */
-	bool timing(const char* key, uint32_t millis, const TagMap& tags = {}) const;
+	bool timing(const char* key, uint32_t millis, const TagMap& tags = {}, float sampleRate = 1.0f) const;
 
 	/**
 	 * @brief Records a histogram
@@ -144,15 +165,15 @@ inline bool Metric::decrement(const char* key, const TagMap& tags) const {
 }
 
 inline bool Metric::count(const char* key, int delta, const TagMap& tags, float sampleRate) const {
-	return assemble(key, delta, "c", tags); // TODO:"|@%f", sampleRate
+	return assemble(key, delta, "c", tags, sampleRate);
 }
 
 inline bool Metric::gauge(const char* key, uint32_t value, const TagMap& tags) const {
 	return assemble(key, value, "g", tags);
 }
 
-inline bool Metric::timing(const char* key, uint32_t millis, const TagMap& tags) const {
-	return assemble(key, millis, "ms", tags);
+inline bool Metric::timing(const char* key, uint32_t millis, const TagMap& tags, float sampleRate) const {
+	return assemble(key, millis, "ms", tags, sampleRate);
 }
 
 inline bool Metric::histogram(const char* key, uint32_t millis, const TagMap& tags) const {
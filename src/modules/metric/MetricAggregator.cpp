@@ -0,0 +1,137 @@
+/**
+ * @file
+ */
+
+#include "MetricAggregator.h"
+#include "core/Log.h"
+#include <SDL_thread.h>
+
+namespace metric {
+
+static core::AtomicInt s_serial{0};
+
+MetricAggregator::MetricAggregator() : _serial(s_serial.increment(1)) {
+}
+
+MetricAggregator::~MetricAggregator() {
+	for (Shard *s : _shards) {
+		delete s;
+	}
+}
+
+MetricAggregator::Shard *MetricAggregator::createShard() {
+	const unsigned long threadId = (unsigned long)SDL_ThreadID();
+	core::ScopedLock lock(_lock);
+	// the thread might have recorded values for this aggregator before another aggregator was used
+	for (Shard *s : _shards) {
+		if (s->threadId == threadId) {
+			return s;
+		}
+	}
+	Shard *s = new Shard();
+	s->threadId = threadId;
+	_shards.push_back(s);
+	return s;
+}
+
+int MetricAggregator::timingBucket(uint32_t millis) {
+	int bucket = 0;
+	while (millis > 0u && bucket < TimingBuckets - 1) {
+		millis >>= 1;
+		++bucket;
+	}
+	return bucket;
+}
+
+MetricId MetricAggregator::registerMetric(const core::String &key, MetricType type, const TagMap &tags) {
+	core::ScopedLock lock(_lock);
+	const int n = (int)_definitions.size();
+	for (int i = 0; i < n; ++i) {
+		const Definition &def = _definitions[i];
+		if (def.type != type || def.key != key || def.tags.size() != tags.size()) {
+			continue;
+		}
+		bool sameTags = true;
+		for (const auto &e : tags) {
+			core::String value;
+			if (!def.tags.get(e->first, value) || value != e->second) {
+				sameTags = false;
+				break;
+			}
+		}
+		if (sameTags) {
+			return i;
+		}
+	}
+	if (n >= MaxMetrics) {
+		Log::warn("Too many metrics registered - can't add %s", key.c_str());
+		return InvalidMetricId;
+	}
+	_definitions.push_back(Definition{key, type, tags});
+	return n;
+}
+
+bool MetricAggregator::flush(const Metric &metric) {
+	core::ScopedLock flushLock(_flushLock);
+	core::DynamicArray<Value> values;
+	{
+		core::ScopedLock lock(_lock);
+		const int n = (int)_definitions.size();
+		for (int id = 0; id < n; ++id) {
+			const Definition &def = _definitions[id];
+			switch (def.type) {
+			case MetricType::Counter: {
+				int delta = 0;
+				for (Shard *s : _shards) {
+					delta += s->counters[id].exchange(0);
+				}
+				if (delta != 0) {
+					values.push_back(Value{def, delta, 1.0f});
+				}
+				break;
+			}
+			case MetricType::Gauge:
+				if (_gaugesSet[id].exchange(0) != 0) {
+					values.push_back(Value{def, (int)_gauges[id], 1.0f});
+				}
+				break;
+			case MetricType::Timing:
+				for (int b = 0; b < TimingBuckets; ++b) {
+					uint32_t count = 0u;
+					uint64_t sum = 0u;
+					for (Shard *s : _shards) {
+						TimingBucket &bucket = s->timings[id][b];
+						count += (uint32_t)bucket.count.exchange(0);
+						sum += bucket.sum.exchange(0u, std::memory_order_relaxed);
+					}
+					if (count == 0u) {
+						continue;
+					}
+					const uint32_t mean = (uint32_t)((sum + count / 2u) / count);
+					values.push_back(Value{def, (int)mean, 1.0f / (float)count});
+				}
+				break;
+			}
+		}
+	}
+
+	// sending might block - e.g. for the http sender
+	metric.beginBatch();
+	for (const Value &v : values) {
+		const Definition &def = v.definition;
+		switch (def.type) {
+		case MetricType::Counter:
+			metric.count(def.key.c_str(), v.value, def.tags);
+			break;
+		case MetricType::Gauge:
+			metric.gauge(def.key.c_str(), (uint32_t)v.value, def.tags);
+			break;
+		case MetricType::Timing:
+			metric.timing(def.key.c_str(), (uint32_t)v.value, def.tags, v.sampleRate);
+			break;
+		}
+	}
+	return metric.endBatch();
+}
+
+} // namespace metric
@@ -0,0 +1,141 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Metric.h"
+#include "core/NonCopyable.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Atomic.h"
+#include "core/Trace.h"
+#include "core/concurrent/Lock.h"
+#include <atomic>
+#include <stdint.h>
+
+namespace metric {
+
+enum class MetricType : uint8_t { Counter, Gauge, Timing };
+
+/**
+ * @brief The handle of a metric that was registered at the MetricAggregator
+ */
+using MetricId = int;
+static constexpr MetricId InvalidMetricId = -1;
+
+/**
+ * @brief Aggregates counters, gauges and timings on the client side and hands them over to the Metric instance in
+ * batches
+ *
+ * Every thread records into its own shard - recording a value is an uncontended atomic add without any lock or
+ * allocation. The shards are only locked once per thread when the thread records its first value. flush() collects
+ * and resets the values of all shards - the values are sent after the shards were unlocked again.
+ *
+ * Timings are collected in power of two buckets and sent as one timing per bucket with the mean of the bucket and a
+ * sample rate that tells the server how many timings this value stands for.
+ *
+ * @ingroup Metric
+ */
+class MetricAggregator : public core::NonCopyable {
+public:
+	static constexpr int MaxMetrics = 256;
+	static constexpr int TimingBuckets = 16;
+
+private:
+	struct Definition {
+		core::String key;
+		MetricType type;
+		TagMap tags;
+	};
+	struct TimingBucket {
+		core::AtomicInt count;
+		// a lot of long timings would overflow a 32 bit sum between two flushes
+		std::atomic<uint64_t> sum{0u};
+	};
+	struct Shard {
+		unsigned long threadId;
+		core::AtomicInt counters[MaxMetrics];
+		TimingBucket timings[MaxMetrics][TimingBuckets];
+	};
+
+	/** the values of the last flush that are handed over to the metric instance */
+	struct Value {
+		Definition definition;
+		int value;
+		float sampleRate;
+	};
+
+	core_trace_mutex(core::Lock, _lock, "MetricAggregator");
+	/** serializes the flushes - recording and registering metrics is not blocked while a batch is sent */
+	core_trace_mutex(core::Lock, _flushLock, "MetricAggregatorFlush");
+	/** used to detect that the thread local shard of another aggregator instance is cached */
+	const int _serial;
+	core::DynamicArray<Definition> _definitions core_thread_guarded_by(_lock);
+	core::AtomicInt _gauges[MaxMetrics];
+	core::AtomicInt _gaugesSet[MaxMetrics];
+	core::DynamicArray<Shard *> _shards core_thread_guarded_by(_lock);
+
+	Shard *shard();
+	Shard *createShard();
+
+	static int timingBucket(uint32_t millis);
+
+public:
+	MetricAggregator();
+	~MetricAggregator();
+
+	/**
+	 * @brief Registers a metric or returns the id of an already registered metric with the same key, type and tags
+	 * @return @c InvalidMetricId if too many metrics are registered
+	 */
+	MetricId registerMetric(const core::String &key, MetricType type, const TagMap &tags = {});
+
+	void count(MetricId id, int delta = 1);
+	void gauge(MetricId id, uint32_t value);
+	void timing(MetricId id, uint32_t millis);
+
+	/**
+	 * @brief Hands all values that were recorded since the last flush over to the given metric instance in one batch
+	 * @return @c false if sending the batch failed
+	 */
+	bool flush(const Metric &metric);
+};
+
+inline MetricAggregator::Shard *MetricAggregator::shard() {
+	static thread_local struct {
+		int serial = -1;
+		Shard *shard = nullptr;
+	} cache;
+	if (cache.serial != _serial) {
+		cache.shard = createShard();
+		cache.serial = _serial;
+	}
+	return cache.shard;
+}
+
+inline void MetricAggregator::count(MetricId id, int delta) {
+	if (id < 0 || id >= MaxMetrics) {
+		return;
+	}
+	shard()->counters[id].increment(delta);
+}
+
+inline void MetricAggregator::gauge(MetricId id, uint32_t value) {
+	if (id < 0 || id >= MaxMetrics) {
+		return;
+	}
+	// gauges are the last value - there is nothing to aggregate per thread
+	_gauges[id] = (int)value;
+	_gaugesSet[id] = 1;
+}
+
+inline void MetricAggregator::timing(MetricId id, uint32_t millis) {
+	if (id < 0 || id >= MaxMetrics) {
+		return;
+	}
+	TimingBucket &bucket = shard()->timings[id][timingBucket(millis)];
+	bucket.count.increment(1);
+	bucket.sum.fetch_add(millis, std::memory_order_relaxed);
+}
+
+} // namespace metric
@@ -7,6 +7,8 @@
 #include "core/ConfigVar.h"
 #include "core/Log.h"
 #include "core/Var.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
 #include "core/concurrent/ThreadPool.h"
 #include "metric/HTTPMetricSender.h"
 #include "engine-config.h"
@@ -16,7 +18,12 @@ namespace metric {
 struct MetricState {
 	metric::IMetricSenderPtr _sender;
 	metric::Metric _metric;
+	metric::MetricAggregator _aggregator;
 	core::ThreadPool _threadPool{1, "metric"};
+	core::AtomicBool _active{false};
+	bool _stop core_thread_guarded_by(_flushLock) = false;
+	core_trace_mutex(core::Lock, _flushLock, "MetricFlush");
+	core::ConditionVariable _flushCondition;
 
 	bool init(const core::String &appname);
 	void shutdown();
@@ -51,13 +58,35 @@ bool MetricState::init(const core::String &appname) {
 		Log::warn("Failed to init metrics");
 		return false;
 	}
+	const uint32_t interval = (uint32_t)core::Var::get(cfg::MetricInterval, "10000")->intVal();
+	_stop = false;
 	_threadPool.init();
+	// the values are aggregated on the recording threads - only the flush is done by the metric thread
+	_threadPool.enqueue([this, interval]() {
+		core::ScopedLock lock(_flushLock);
+		while (!_stop) {
+			_flushCondition.waitTimeout(_flushLock, interval);
+			if (!_stop) {
+				_aggregator.flush(_metric);
+			}
+		}
+	});
+	_active = true;
 	Log::info("Initialized metrics");
 	return true;
 }
 
 void MetricState::shutdown() {
+	{
+		core::ScopedLock lock(_flushLock);
+		_stop = true;
+	}
+	_flushCondition.notify_all();
 	_threadPool.shutdown(true);
+	if (_active.exchange(false)) {
+		// send what was recorded since the last flush
+		_aggregator.flush(_metric);
+	}
 	if (_sender) {
 		_sender->shutdown();
 		_sender = metric::IMetricSenderPtr();
@@ -65,12 +94,67 @@ void MetricState::shutdown() {
 	_metric.shutdown();
 }
 
+MetricId registerMetric(const core::String &key, MetricType type, const TagMap &tags) {
+	return MetricState::getInstance()._aggregator.registerMetric(key, type, tags);
+}
+
+void count(MetricId id, int delta) {
+	MetricState &s = MetricState::getInstance();
+	if (s._active) {
+		s._aggregator.count(id, delta);
+	}
+}
+
+void gauge(MetricId id, uint32_t value) {
+	MetricState &s = MetricState::getInstance();
+	if (s._active) {
+		s._aggregator.gauge(id, value);
+	}
+}
+
+void timing(MetricId id, uint32_t millis) {
+	MetricState &s = MetricState::getInstance();
+	if (s._active) {
+		s._aggregator.timing(id, millis);
+	}
+}
+
 bool count(const core::String &key, int delta, const TagMap &tags) {
 	MetricState &s = MetricState::getInstance();
-	s._threadPool.enqueue([=, &s]() {
-		s._metric.count(key.c_str(), delta, tags);
-	});
-	return true;
+	if (!s._active) {
+		return false;
+	}
+	const MetricId id = s._aggregator.registerMetric(key, MetricType::Counter, tags);
+	s._aggregator.count(id, delta);
+	return id != InvalidMetricId;
+}
+
+bool gauge(const core::String &key, uint32_t value, const TagMap &tags) {
+	MetricState &s = MetricState::getInstance();
+	if (!s._active) {
+		return false;
+	}
+	const MetricId id = s._aggregator.registerMetric(key, MetricType::Gauge, tags);
+	s._aggregator.gauge(id, value);
+	return id != InvalidMetricId;
+}
+
+bool timing(const core::String &key, uint32_t millis, const TagMap &tags) {
+	MetricState &s = MetricState::getInstance();
+	if (!s._active) {
+		return false;
+	}
+	const MetricId id = s._aggregator.registerMetric(key, MetricType::Timing, tags);
+	s._aggregator.timing(id, millis);
+	return id != InvalidMetricId;
+}
+
+bool flush() {
+	MetricState &s = MetricState::getInstance();
+	if (!s._active) {
+		return false;
+	}
+	return s._aggregator.flush(s._metric);
 }
 
 bool init(const core::String &appname) {
@@ -5,10 +5,34 @@
 #pragma once
 
 #include "Metric.h"
+#include "MetricAggregator.h"
 
 namespace metric {
 
+/**
+ * @brief Registers a metric for the hot path functions that only take the metric id
+ * @note The registration is not bound to init() - it's fine to register the metrics in static initializers
+ */
+MetricId registerMetric(const core::String &key, MetricType type, const TagMap &tags = {});
+
+/**
+ * @brief Records the values on the calling thread - they are sent in batches every @c metric_interval millis
+ */
+void count(MetricId id, int delta = 1);
+void gauge(MetricId id, uint32_t value);
+void timing(MetricId id, uint32_t millis);
+
+/**
+ * @brief Registers the metric on every call - cache the id of @c registerMetric() for values that are recorded often
+ */
 bool count(const core::String &key, int delta = 1, const TagMap &tags = {});
+bool gauge(const core::String &key, uint32_t value, const TagMap &tags = {});
+bool timing(const core::String &key, uint32_t millis, const TagMap &tags = {});
+
+/**
+ * @brief Sends all recorded values now
+ */
+bool flush();
 bool init(const core::String &appname);
 void shutdown();
 
@@ -39,6 +39,12 @@ private:
 public:
 	UDPMetricSender(const core::String& host, int port);
 	bool send(const char* buffer) const override;
+	/**
+	 * @brief Keep the packets below the mtu of the network to avoid fragmentation
+	 */
+	size_t maxMessageSize() const override {
+		return 1432u;
+	}
 
 	/**
 	 * Connects to the port and host given by the cvars @c metric_port and @c metric_host.
@@ -0,0 +1,176 @@
+/**
+ * @file
+ */
+
+#include "metric/MetricAggregator.h"
+#include "core/ConfigVar.h"
+#include "core/StringUtil.h"
+#include "core/Var.h"
+#include "core/collection/DynamicArray.h"
+#include "metric/IMetricSender.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace metric {
+
+class CollectingSender : public IMetricSender {
+private:
+	size_t _maxMessageSize;
+
+public:
+	mutable core::DynamicArray<core::String> messages;
+
+	CollectingSender(size_t maxMessageSize = 0u) : _maxMessageSize(maxMessageSize) {
+	}
+
+	bool send(const char *buffer) const override {
+		messages.push_back(buffer);
+		return true;
+	}
+
+	size_t maxMessageSize() const override {
+		return _maxMessageSize;
+	}
+
+	core::DynamicArray<core::String> lines() const {
+		core::DynamicArray<core::String> all;
+		for (const core::String &message : messages) {
+			core::DynamicArray<core::String> tokens;
+			core::string::splitString(message, tokens, "\n");
+			for (const core::String &t : tokens) {
+				all.push_back(t);
+			}
+		}
+		return all;
+	}
+};
+
+class MetricAggregatorTest : public testing::Test {
+protected:
+	void SetUp() override {
+		core::Var::get(cfg::MetricUUID, "fake");
+		core::Var::get(cfg::MetricFlavor, "")->setVal("etsy");
+	}
+};
+
+TEST_F(MetricAggregatorTest, testRegister) {
+	MetricAggregator aggregator;
+	const MetricId id1 = aggregator.registerMetric("test", MetricType::Counter, {{"type", "vox"}});
+	const MetricId id2 = aggregator.registerMetric("test", MetricType::Counter, {{"type", "qb"}});
+	const MetricId id3 = aggregator.registerMetric("test", MetricType::Timing, {{"type", "vox"}});
+	EXPECT_NE(InvalidMetricId, id1);
+	EXPECT_NE(id1, id2);
+	EXPECT_NE(id1, id3);
+	EXPECT_EQ(id1, aggregator.registerMetric("test", MetricType::Counter, {{"type", "vox"}}));
+}
+
+TEST_F(MetricAggregatorTest, testCounterBatch) {
+	core::SharedPtr<CollectingSender> sender = core::make_shared<CollectingSender>();
+	Metric m;
+	ASSERT_TRUE(m.init("test", sender));
+	MetricAggregator aggregator;
+	const MetricId counter = aggregator.registerMetric("counter", MetricType::Counter);
+	const MetricId gauge = aggregator.registerMetric("gauge", MetricType::Gauge);
+	for (int i = 0; i < 1000; ++i) {
+		aggregator.count(counter);
+		aggregator.gauge(gauge, i);
+	}
+	ASSERT_TRUE(aggregator.flush(m));
+	ASSERT_EQ(1u, sender->messages.size());
+	EXPECT_EQ("test.counter:1000|c\ntest.gauge:999|g", sender->messages[0]);
+
+	// nothing was recorded since the last flush
+	ASSERT_TRUE(aggregator.flush(m));
+	EXPECT_EQ(1u, sender->messages.size());
+}
+
+TEST_F(MetricAggregatorTest, testTimingBuckets) {
+	core::SharedPtr<CollectingSender> sender = core::make_shared<CollectingSender>();
+	Metric m;
+	ASSERT_TRUE(m.init("test", sender));
+	MetricAggregator aggregator;
+	const MetricId timing = aggregator.registerMetric("timing", MetricType::Timing);
+	aggregator.timing(timing, 2);
+	aggregator.timing(timing, 3);
+	aggregator.timing(timing, 100);
+	ASSERT_TRUE(aggregator.flush(m));
+	ASSERT_EQ(1u, sender->messages.size());
+	EXPECT_EQ("test.timing:3|ms|@0.5\ntest.timing:100|ms", sender->messages[0]);
+}
+
+TEST_F(MetricAggregatorTest, testTimingLargeSum) {
+	core::SharedPtr<CollectingSender> sender = core::make_shared<CollectingSender>();
+	Metric m;
+	ASSERT_TRUE(m.init("test", sender));
+	MetricAggregator aggregator;
+	const MetricId timing = aggregator.registerMetric("timing", MetricType::Timing);
+	// the sum of the timings doesn't fit into 32 bit
+	for (int i = 0; i < 40000; ++i) {
+		aggregator.timing(timing, 60000);
+	}
+	ASSERT_TRUE(aggregator.flush(m));
+	ASSERT_EQ(1u, sender->messages.size());
+	EXPECT_EQ("test.timing:60000|ms|@0.000025", sender->messages[0]);
+}
+
+TEST_F(MetricAggregatorTest, testThreads) {
+	core::SharedPtr<CollectingSender> sender = core::make_shared<CollectingSender>();
+	Metric m;
+	ASSERT_TRUE(m.init("test", sender));
+	MetricAggregator aggregator;
+	const MetricId counter = aggregator.registerMetric("counter", MetricType::Counter);
+	core::DynamicArray<std::thread> threads;
+	for (int t = 0; t < 4; ++t) {
+		threads.emplace_back([&]() {
+			for (int i = 0; i < 10000; ++i) {
+				aggregator.count(counter, 2);
+			}
+		});
+	}
+	// flushing while the threads are still recording must not lose any value
+	aggregator.flush(m);
+	for (std::thread &t : threads) {
+		t.join();
+	}
+	aggregator.flush(m);
+	int total = 0;
+	for (const core::String &line : sender->lines()) {
+		ASSERT_TRUE(core::string::startsWith(line, "test.counter:")) << line.c_str();
+		total += core::string::toInt(line.substr(13));
+	}
+	EXPECT_EQ(4 * 10000 * 2, total);
+}
+
+TEST_F(MetricAggregatorTest, testMaxMessageSize) {
+	core::SharedPtr<CollectingSender> sender = core::make_shared<CollectingSender>(64u);
+	Metric m;
+	ASSERT_TRUE(m.init("test", sender));
+	MetricAggregator aggregator;
+	for (int i = 0; i < 10; ++i) {
+		const MetricId id = aggregator.registerMetric(core::string::format("counter%i", i), MetricType::Counter);
+		aggregator.count(id, i + 1);
+	}
+	ASSERT_TRUE(aggregator.flush(m));
+	EXPECT_GT(sender->messages.size(), 1u);
+	for (const core::String &message : sender->messages) {
+		EXPECT_LE(message.size(), 64u);
+	}
+	EXPECT_EQ(10u, sender->lines().size());
+}
+
+TEST_F(MetricAggregatorTest, testJSONBatch) {
+	core::Var::get(cfg::MetricFlavor, "")->setVal("json");
+	core::SharedPtr<CollectingSender> sender = core::make_shared<CollectingSender>();
+	Metric m;
+	ASSERT_TRUE(m.init("test", sender));
+	MetricAggregator aggregator;
+	aggregator.count(aggregator.registerMetric("a", MetricType::Counter));
+	aggregator.count(aggregator.registerMetric("b", MetricType::Counter), 2);
+	ASSERT_TRUE(aggregator.flush(m));
+	ASSERT_EQ(1u, sender->messages.size());
+	EXPECT_EQ(R"([{"name": "a","value": 1,"type": "c","uuid": "fake","tags": {}},)"
+			  R"({"name": "b","value": 2,"type": "c","uuid": "fake","tags": {}}])",
+			  sender->messages[0]);
+}
+
+} // namespace metric
@@ -55,11 +55,12 @@ protected:
 		return sender->metricLine();
 	}
 
-	inline core::String timing(const char *id, int value, Flavor flavor, const TagMap &tags = {}) const {
+	inline core::String timing(const char *id, int value, Flavor flavor, const TagMap &tags = {},
+							   float sampleRate = 1.0f) const {
 		setFlavor(flavor);
 		Metric m;
 		m.init(PREFIX, sender);
-		m.timing(id, value, tags);
+		m.timing(id, value, tags, sampleRate);
 		return sender->metricLine();
 	}
 
@@ -122,6 +123,15 @@ TEST_F(MetricTest, testTimingSingleTag) {
 		<< "Unexpected influx format";
 }
 
+TEST_F(MetricTest, testTimingSampleRate) {
+	const TagMap map{{"key1", "value1"}};
+	EXPECT_EQ(timing("test", 1, Flavor::Etsy, map, 0.25f), PREFIX ".test:1|ms|@0.25");
+	EXPECT_EQ(timing("test", 1, Flavor::Telegraf, map, 0.25f), PREFIX ".test,uuid=fake,key1=value1:1|ms|@0.25");
+	EXPECT_EQ(timing("test", 1, Flavor::Datadog, map, 0.25f), PREFIX ".test:1|ms|@0.25|#uuid:fake,key1:value1");
+	EXPECT_EQ(timing("testkey", 1, Flavor::Influx, map, 0.25f),
+			  PREFIX "_testkey,type=ms,uuid=fake,key1=value1 value=1,sample_rate=0.25");
+}
+
 // The order is not stable - thus the result string order of the tag can differ
 TEST_F(MetricTest, DISABLED_testTimingMultipleTags) {
 	const TagMap map{{"key1", "value1"}, {"key2", "value2"}};
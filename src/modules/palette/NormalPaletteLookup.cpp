@@ -0,0 +1,147 @@
+/**
+ * @file
+ */
+
+#include "NormalPaletteLookup.h"
+#include "core/Common.h"
+#include <float.h>
+#include <glm/common.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/ext/scalar_constants.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+
+namespace palette {
+
+// the radius of a cell is extended a little bit to cover the float precision of the cell computation and the dot
+// products
+static constexpr double CellRadiusMargin = 1e-3;
+static constexpr double DotMargin = 1e-4;
+
+static glm::dvec3 faceDirection(int face, double u, double v) {
+	const int axis = face / 2;
+	const double major = (face & 1) ? -1.0 : 1.0;
+	if (axis == 0) {
+		return glm::dvec3(major, u, v);
+	}
+	if (axis == 1) {
+		return glm::dvec3(u, major, v);
+	}
+	return glm::dvec3(u, v, major);
+}
+
+static double angle(const glm::dvec3 &a, const glm::dvec3 &b) {
+	return glm::acos(glm::clamp(glm::dot(a, b), -1.0, 1.0));
+}
+
+int NormalPaletteLookup::cell(const glm::vec3 &dir) {
+	const glm::vec3 a = glm::abs(dir);
+	int axis;
+	float major, u, v;
+	if (a.x >= a.y && a.x >= a.z) {
+		axis = 0;
+		major = dir.x;
+		u = dir.y;
+		v = dir.z;
+	} else if (a.y >= a.z) {
+		axis = 1;
+		major = dir.y;
+		u = dir.x;
+		v = dir.z;
+	} else {
+		axis = 2;
+		major = dir.z;
+		u = dir.x;
+		v = dir.y;
+	}
+	const int face = axis * 2 + (major < 0.0f ? 1 : 0);
+	const float scale = 0.5f * (float)GridSize / glm::abs(major);
+	const int cu = glm::clamp((int)((u + glm::abs(major)) * scale), 0, GridSize - 1);
+	const int cv = glm::clamp((int)((v + glm::abs(major)) * scale), 0, GridSize - 1);
+	return (face * GridSize + cv) * GridSize + cu;
+}
+
+NormalPaletteLookup::NormalPaletteLookup(const NormalPalette &normalPalette) {
+	_size = (int)normalPalette.size();
+	glm::dvec3 directions[NormalPaletteMaxNormals];
+	double lengths[NormalPaletteMaxNormals];
+	for (int i = 0; i < _size; ++i) {
+		_normals[i] = normalPalette.normal3f(i);
+		lengths[i] = glm::length(glm::dvec3(_normals[i]));
+		directions[i] = lengths[i] > 0.0 ? glm::dvec3(_normals[i]) / lengths[i] : glm::dvec3(0.0);
+	}
+
+	_candidates.reserve(Cells * 8);
+	const double cellSize = 2.0 / GridSize;
+	for (int face = 0; face < 6; ++face) {
+		for (int cv = 0; cv < GridSize; ++cv) {
+			for (int cu = 0; cu < GridSize; ++cu) {
+				const int idx = (face * GridSize + cv) * GridSize + cu;
+				_offsets[idx] = (uint32_t)_candidates.size();
+				const double u0 = -1.0 + cu * cellSize;
+				const double v0 = -1.0 + cv * cellSize;
+				const glm::dvec3 center = glm::normalize(faceDirection(face, u0 + cellSize * 0.5, v0 + cellSize * 0.5));
+				// the cells are bounded by great circles - the corners are the most distant points from the center
+				double radius = 0.0;
+				for (int corner = 0; corner < 4; ++corner) {
+					const double u = u0 + (corner & 1) * cellSize;
+					const double v = v0 + (corner >> 1) * cellSize;
+					radius = core_max(radius, angle(center, glm::normalize(faceDirection(face, u, v))));
+				}
+				radius += CellRadiusMargin;
+
+				// the palette normals don't have unit length - the dot product of a direction inside the cell with a
+				// palette normal is in the range of [lower, upper] of that normal
+				double uppers[NormalPaletteMaxNormals];
+				double bestLower = -DBL_MAX;
+				for (int i = 0; i < _size; ++i) {
+					const double theta = angle(center, directions[i]);
+					uppers[i] = lengths[i] * glm::cos(core_max(0.0, theta - radius));
+					const double lower = lengths[i] * glm::cos(core_min(glm::pi<double>(), theta + radius));
+					bestLower = core_max(bestLower, lower);
+				}
+				for (int i = 0; i < _size; ++i) {
+					if (uppers[i] >= bestLower - DotMargin) {
+						_candidates.push_back((uint8_t)i);
+					}
+				}
+			}
+		}
+	}
+	_offsets[Cells] = (uint32_t)_candidates.size();
+}
+
+uint8_t NormalPaletteLookup::getClosestMatch(const glm::vec3 &normal) const {
+	const glm::vec3 a = glm::abs(normal);
+	if (!(a.x + a.y + a.z > 0.0f)) {
+		// null vector or nan - every dot product is the same
+		return 0u;
+	}
+	uint32_t begin = 0u;
+	uint32_t end = (uint32_t)_size;
+	const uint8_t *candidates = nullptr;
+	if (a.x + a.y + a.z < FLT_MAX) {
+		const int idx = cell(normal);
+		begin = _offsets[idx];
+		end = _offsets[idx + 1];
+		candidates = _candidates.data();
+	}
+	// same comparison as NormalPalette::getClosestMatch() - the candidates are sorted by their palette index
+	uint8_t closestIndex = 0;
+	float maxDot = -1.0f;
+	for (uint32_t i = begin; i < end; ++i) {
+		const uint8_t candidate = candidates != nullptr ? candidates[i] : (uint8_t)i;
+		const float dot = glm::dot(normal, _normals[candidate]);
+		if (dot > maxDot) {
+			maxDot = dot;
+			closestIndex = candidate;
+		}
+	}
+	return closestIndex;
+}
+
+float NormalPaletteLookup::averageCandidates() const {
+	return (float)_candidates.size() / (float)Cells;
+}
+
+} // namespace palette
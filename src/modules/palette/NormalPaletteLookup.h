@@ -0,0 +1,48 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "palette/NormalPalette.h"
+#include <glm/vec3.hpp>
+
+namespace palette {
+
+/**
+ * @brief Finds the closest normal palette index for a direction without searching the whole palette
+ *
+ * The directions are mapped onto the faces of a cube that are divided into a grid of cells. Every cell stores the
+ * palette normals that can be the closest match for any direction inside of the cell - these candidates are computed
+ * once for the given palette. A lookup only compares the direction to the few candidates of its cell.
+ *
+ * The result is the same as with @c NormalPalette::getClosestMatch()
+ * @note The lookup is immutable after construction and can be used from multiple threads
+ */
+class NormalPaletteLookup {
+public:
+	/** cells per axis of a cube face */
+	static constexpr int GridSize = 16;
+	static constexpr int Cells = 6 * GridSize * GridSize;
+
+private:
+	int _size = 0;
+	glm::vec3 _normals[NormalPaletteMaxNormals];
+	/** the candidates of a cell are in @c [_offsets[cell], _offsets[cell + 1]) */
+	uint32_t _offsets[Cells + 1];
+	core::DynamicArray<uint8_t> _candidates;
+
+	static int cell(const glm::vec3 &dir);
+
+public:
+	NormalPaletteLookup(const NormalPalette &normalPalette);
+
+	uint8_t getClosestMatch(const glm::vec3 &normal) const;
+
+	/**
+	 * @return The average amount of palette normals that are compared per lookup
+	 */
+	float averageCandidates() const;
+};
+
+} // namespace palette
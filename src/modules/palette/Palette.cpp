@@ -6,6 +6,7 @@
 #include "app/App.h"
 #include "core/ArrayLength.h"
 #include "core/Color.h"
+#include "core/ColorHistogram.h"
 #include "core/Common.h"
 #include "core/Log.h"
 #include "core/RGBA.h"
@@ -98,6 +99,14 @@ void Palette::quantize(const core::RGBA *inputColors, const size_t inputColorCou
 	markDirty();
 }
 
+void Palette::quantize(const core::ColorHistogram &histogram) {
+	Log::debug("quantize %i colors", (int)histogram.total());
+	core::Color::ColorReductionType reductionType =
+		core::Color::toColorReductionType(core::Var::getSafe(cfg::CoreColorReduction)->strVal().c_str());
+	_colorCount = core::Color::quantize(_colors, lengthof(_colors), histogram, reductionType);
+	markDirty();
+}
+
 bool Palette::hasColor(core::RGBA rgba) {
 	for (int i = 0; i < _colorCount; ++i) {
 		if (_colors[i] == rgba) {
@@ -14,6 +14,10 @@
 #include <stdint.h>
 #include <glm/vec4.hpp>
 
+namespace core {
+class ColorHistogram;
+}
+
 namespace palette {
 
 static const int PaletteMaxColors = 256;
@@ -171,6 +175,10 @@ public:
 				int skipPaletteColorIdx = -1);
 	bool hasColor(core::RGBA rgba);
 	void quantize(const core::RGBA *inputColors, const size_t inputColorCount);
+	/**
+	 * @brief Quantize the colors of an already filled histogram - e.g. if it was filled in parallel
+	 */
+	void quantize(const core::ColorHistogram &histogram);
 
 	static const char* getDefaultPaletteName();
 	static core::String extractPaletteName(const core::String& file);
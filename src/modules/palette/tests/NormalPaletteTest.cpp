@@ -3,6 +3,7 @@
  */
 
 #include "palette/NormalPalette.h"
+#include "palette/NormalPaletteLookup.h"
 #include "app/tests/AbstractTest.h"
 
 namespace palette {
@@ -15,4 +16,44 @@ TEST_F(NormalPaletteTest, testSave) {
 	EXPECT_TRUE(palette.save("redalert2.png"));
 }
 
+static void checkLookup(const NormalPalette &palette) {
+	const NormalPaletteLookup lookup(palette);
+	// axis aligned directions, directions on the cell borders and the palette normals itself
+	for (int x = -2; x <= 2; ++x) {
+		for (int y = -2; y <= 2; ++y) {
+			for (int z = -2; z <= 2; ++z) {
+				const glm::vec3 dir((float)x, (float)y, (float)z);
+				ASSERT_EQ(palette.getClosestMatch(dir), lookup.getClosestMatch(dir)) << dir.x << ":" << dir.y << ":" << dir.z;
+			}
+		}
+	}
+	for (int i = 0; i < (int)palette.size(); ++i) {
+		const glm::vec3 dir = palette.normal3f(i);
+		ASSERT_EQ(palette.getClosestMatch(dir), lookup.getClosestMatch(dir)) << "palette normal " << i;
+	}
+	// pseudo random directions with a fixed seed
+	uint32_t seed = 1337u;
+	auto rnd = [&seed]() {
+		seed = seed * 1664525u + 1013904223u;
+		return (float)(seed >> 8) / (float)(1u << 24) * 2.0f - 1.0f;
+	};
+	for (int i = 0; i < 20000; ++i) {
+		const glm::vec3 dir(rnd(), rnd(), rnd());
+		ASSERT_EQ(palette.getClosestMatch(dir), lookup.getClosestMatch(dir)) << dir.x << ":" << dir.y << ":" << dir.z;
+	}
+	EXPECT_LT(lookup.averageCandidates(), (float)palette.size() / 4.0f);
+}
+
+TEST_F(NormalPaletteTest, testLookupRedAlert2) {
+	NormalPalette palette;
+	palette.redAlert2();
+	checkLookup(palette);
+}
+
+TEST_F(NormalPaletteTest, testLookupTiberianSun) {
+	NormalPalette palette;
+	palette.tiberianSun();
+	checkLookup(palette);
+}
+
 } // namespace palette
@@ -4,6 +4,7 @@
 
 #include "SceneGraph.h"
 #include "SceneUtil.h"
+#include "app/Async.h"
 #include "core/Algorithm.h"
 #include "core/Common.h"
 #include "core/Log.h"
@@ -106,6 +107,12 @@ void SceneGraph::unregisterListener(SceneGraphListener *listener) {
 	Log::error("Listener not found - could not unregister");
 }
 
+void SceneGraph::notifyNodeModified(int nodeId) {
+	for (SceneGraphListener *listener : _listeners) {
+		listener->onNodeModified(nodeId);
+	}
+}
+
 bool SceneGraph::setAnimation(const core::String &animation) {
 	if (animation.empty()) {
 		Log::debug("Can't set empty animation");
@@ -951,7 +958,15 @@ SceneGraph::MergeResult SceneGraph::merge(bool skipHidden) const {
 	const palette::Palette &mergedPalette = mergePalettes(true);
 	const palette::NormalPalette &normalPalette = firstModelNode()->normalPalette();
 
-	voxel::RawVolume *merged = new voxel::RawVolume(mergedRegion);
+	struct MergeNode {
+		const SceneGraphNode *node;
+		const voxel::RawVolume *volume;
+		voxel::Region sourceRegion;
+		glm::ivec3 destMins;
+		uint8_t remap[palette::PaletteMaxColors];
+	};
+	core::DynamicArray<MergeNode> mergeNodes;
+	mergeNodes.reserve(n);
 	for (const auto &e : nodes()) {
 		const SceneGraphNode &node = e->second;
 		if (!node.isAnyModelNode()) {
@@ -960,22 +975,56 @@ SceneGraph::MergeResult SceneGraph::merge(bool skipHidden) const {
 		if (skipHidden && !node.visible()) {
 			continue;
 		}
-		const voxel::Region &sourceRegion = resolveRegion(node);
-		const voxel::Region &destRegion = sceneRegion(node, keyFrameIdx);
+		MergeNode mergeNode;
+		mergeNode.node = &node;
+		mergeNode.volume = resolveVolume(node);
+		mergeNode.sourceRegion = resolveRegion(node);
+		// TODO: SCENEGRAPH: rotation
+		mergeNode.destMins = sceneRegion(node, keyFrameIdx).getLowerCorner();
+		mergeNodes.emplace_back(core::move(mergeNode));
+	}
+	// overlapping voxels are taken from the node that was added last - independent of the hash map order
+	core::sort(mergeNodes.begin(), mergeNodes.end(),
+			   [](const MergeNode &a, const MergeNode &b) { return a.node->id() < b.node->id(); });
+
+	// the palette lookup is done once per color and not once per voxel
+	app::for_parallel(0, (int)mergeNodes.size(), [&mergeNodes, &mergedPalette](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			MergeNode &mergeNode = mergeNodes[i];
+			const palette::Palette &nodePalette = mergeNode.node->palette();
+			for (int c = 0; c < palette::PaletteMaxColors; ++c) {
+				mergeNode.remap[c] = mergedPalette.getClosestMatch(nodePalette.color(c));
+			}
+		}
+	});
 
-		auto func = [&node, &mergedPalette](voxel::Voxel &voxel) {
-			if (isAir(voxel.getMaterial())) {
-				return false;
+	voxel::RawVolume *merged = new voxel::RawVolume(mergedRegion);
+	// every slice of the merged volume is written by only one thread - all nodes are merged into the slices in the
+	// same order as above
+	app::for_parallel(mergedRegion.getLowerZ(), mergedRegion.getUpperZ() + 1, [&](int start, int end) {
+		for (const MergeNode &mergeNode : mergeNodes) {
+			const voxel::Region &sourceRegion = mergeNode.sourceRegion;
+			const int offsetZ = mergeNode.destMins.z - sourceRegion.getLowerZ();
+			const int lowerZ = core_max(sourceRegion.getLowerZ(), start - offsetZ);
+			const int upperZ = core_min(sourceRegion.getUpperZ(), end - 1 - offsetZ);
+			if (lowerZ > upperZ) {
+				continue;
 			}
-			const core::RGBA color = node.palette().color(voxel.getColor());
-			const uint8_t index = mergedPalette.getClosestMatch(color);
-			voxel.setColor(index);
-			return true;
-		};
-		const voxel::RawVolume *v = resolveVolume(node);
-		// TODO: SCENEGRAPH: rotation
-		voxelutil::mergeVolumes(merged, v, destRegion, sourceRegion, func);
-	}
+			const voxel::Region sourceSlab(sourceRegion.getLowerX(), sourceRegion.getLowerY(), lowerZ,
+										   sourceRegion.getUpperX(), sourceRegion.getUpperY(), upperZ);
+			const voxel::Region destSlab(glm::ivec3(mergeNode.destMins.x, mergeNode.destMins.y, lowerZ + offsetZ),
+										 glm::ivec3(mergeNode.destMins.x, mergeNode.destMins.y, lowerZ + offsetZ) +
+											 sourceSlab.getDimensionsInVoxels() - 1);
+			auto func = [&mergeNode](voxel::Voxel &voxel) {
+				if (isAir(voxel.getMaterial())) {
+					return false;
+				}
+				voxel.setColor(mergeNode.remap[voxel.getColor()]);
+				return true;
+			};
+			voxelutil::mergeVolumes(merged, mergeNode.volume, destSlab, sourceSlab, func);
+		}
+	});
 	return MergeResult{merged, mergedPalette, normalPalette};
 }
 
@@ -112,6 +112,12 @@ public:
 	bool isRegistered(SceneGraphListener *listener) const;
 	void unregisterListener(SceneGraphListener *listener);
 	void registerListener(SceneGraphListener *listener);
+	/**
+	 * @brief Informs the listeners that the voxels of the given node were modified
+	 * @note The scene graph doesn't know about modifications of the volumes - this is called by the code that is
+	 * modifying them
+	 */
+	void notifyNodeModified(int nodeId);
 
 	/**
 	 * @brief The list of known animation ids
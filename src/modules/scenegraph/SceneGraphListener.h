@@ -24,6 +24,11 @@ public:
 	}
 	virtual void onNodesAligned() {
 	}
+	/**
+	 * @sa SceneGraph::notifyNodeModified()
+	 */
+	virtual void onNodeModified(int nodeId) {
+	}
 };
 
 } // namespace scenegraph
@@ -9,6 +9,7 @@
 #include "core/Hash.h"
 #include "core/Log.h"
 #include "core/StringUtil.h"
+#include "core/concurrent/Atomic.h"
 #include "palette/NormalPalette.h"
 #include "palette/Palette.h"
 #include "scenegraph/SceneGraph.h"
@@ -21,9 +22,16 @@
 
 namespace scenegraph {
 
+static uint32_t nextVolumeGeneration() {
+	// nodes are also created by the format loaders in other threads
+	static core::AtomicInt generation{0};
+	return (uint32_t)generation.increment(1) + 1u;
+}
+
 SceneGraphNode::SceneGraphNode(SceneGraphNode &&move) noexcept {
 	_volume = move._volume;
 	move._volume = nullptr;
+	_volumeGeneration = move._volumeGeneration;
 	_name = core::move(move._name);
 	_id = move._id;
 	move._id = InvalidNodeId;
@@ -57,6 +65,7 @@ SceneGraphNode &SceneGraphNode::operator=(SceneGraphNode &&move) noexcept {
 	}
 	setVolume(move._volume, move._flags & VolumeOwned);
 	move._volume = nullptr;
+	_volumeGeneration = move._volumeGeneration;
 	_name = core::move(move._name);
 	_id = move._id;
 	move._id = InvalidNodeId;
@@ -403,6 +412,7 @@ void SceneGraphNode::setVolume(voxel::RawVolume *volume, bool transferOwnership)
 		_flags &= ~VolumeOwned;
 	}
 	_volume = volume;
+	_volumeGeneration = nextVolumeGeneration();
 }
 
 void SceneGraphNode::setVolume(const voxel::RawVolume *volume) {
@@ -410,6 +420,7 @@ void SceneGraphNode::setVolume(const voxel::RawVolume *volume) {
 					(int)_type);
 	release();
 	_volume = const_cast<voxel::RawVolume *>(volume);
+	_volumeGeneration = nextVolumeGeneration();
 }
 
 bool SceneGraphNode::isLocked() const {
@@ -92,6 +92,10 @@ protected:
 	core::String _uuid;
 	core::String _name;
 	voxel::RawVolume *_volume = nullptr;
+	/**
+	 * @brief Changes with every setVolume() call - unique over all nodes
+	 */
+	uint32_t _volumeGeneration = 0u;
 	SceneGraphKeyFramesMap _keyFramesMap;
 	SceneGraphKeyFrames *_keyFrames = nullptr;
 	core::Buffer<int, 32> _children;
@@ -198,6 +202,12 @@ public:
 	 * @return voxel::RawVolume - might be @c nullptr
 	 */
 	voxel::RawVolume *volume();
+	/**
+	 * @brief Identifies the volume instance of this node. The address of a new volume might be the same as the one of
+	 * an already deleted volume - the generation is not.
+	 * @sa setVolume()
+	 */
+	uint32_t volumeGeneration() const;
 	/**
 	 * @brief Remaps the voxel colors to the new given palette
 	 * @note The palette is not set by this method - you have to call @c setPalette() on your own.
@@ -364,6 +374,10 @@ inline const SceneGraphNodeCamera& toCameraNode(const SceneGraphNode& node) {
 	return (const SceneGraphNodeCamera&)node;
 }
 
+inline uint32_t SceneGraphNode::volumeGeneration() const {
+	return _volumeGeneration;
+}
+
 inline bool SceneGraphNode::owns() const {
 	return _volume;
 }
@@ -9,7 +9,6 @@
 #include "math/Easing.h"
 #include "voxel/RawVolume.h"
 #include "scenegraph/SceneGraphNode.h"
-#include "voxelutil/VolumeCropper.h"
 #include "voxelutil/VolumeSplitter.h"
 
 namespace scenegraph {
@@ -231,15 +230,10 @@ bool splitVolumes(const scenegraph::SceneGraph &srcSceneGraph, scenegraph::Scene
 			continue;
 		}
 		Log::debug("Split needed for node '%s'", node.name().c_str());
-		core::DynamicArray<voxel::RawVolume *> rawVolumes = voxelutil::splitVolume(node.volume(), maxSize, createEmpty);
+		core::DynamicArray<voxel::RawVolume *> rawVolumes = voxelutil::splitVolume(node.volume(), maxSize, createEmpty, crop);
 		Log::debug("Created %i volumes", (int)rawVolumes.size());
 		for (voxel::RawVolume *v : rawVolumes) {
 			scenegraph::SceneGraphNode newNode(SceneGraphNodeType::Model);
-			if (crop) {
-				voxel::RawVolume *cv = voxelutil::cropVolume(v);
-				delete v;
-				v = cv;
-			}
 			copyNode(node, newNode, false);
 			newNode.setVolume(v, true);
 			destSceneGraph.emplace(core::move(newNode));
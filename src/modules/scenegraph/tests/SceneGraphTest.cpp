@@ -258,6 +258,57 @@ TEST_F(SceneGraphTest, testMerge) {
 	EXPECT_TRUE(voxel::isBlocked(v->voxel(1, 1, 1).getMaterial()));
 }
 
+TEST_F(SceneGraphTest, testMergeOverlapping) {
+	SceneGraph sceneGraph;
+	palette::Palette palette1;
+	palette1.setSize(2);
+	palette1.setColor(0, core::RGBA(0, 0, 0, 255));
+	palette1.setColor(1, core::RGBA(255, 0, 0, 255));
+	palette1.markDirty();
+	palette::Palette palette2;
+	palette2.setSize(2);
+	palette2.setColor(0, core::RGBA(0, 0, 0, 255));
+	palette2.setColor(1, core::RGBA(0, 255, 0, 255));
+	palette2.markDirty();
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setName("node1");
+		voxel::RawVolume *v = new voxel::RawVolume(voxel::Region(0, 63));
+		for (int z = 0; z < 64; ++z) {
+			v->setVoxel(z, z, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		}
+		node.setVolume(v, true);
+		node.setPalette(palette1);
+		sceneGraph.emplace(core::move(node));
+	}
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setName("node2");
+		voxel::RawVolume *v = new voxel::RawVolume(voxel::Region(0, 31));
+		for (int z = 0; z < 32; ++z) {
+			v->setVoxel(z, z, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		}
+		node.setVolume(v, true);
+		node.setPalette(palette2);
+		SceneGraphTransform transform;
+		transform.setWorldTranslation(glm::vec3(16));
+		node.setTransform(0, transform);
+		sceneGraph.emplace(core::move(node));
+	}
+	SceneGraph::MergeResult merged = sceneGraph.merge();
+	core::ScopedPtr<voxel::RawVolume> v(merged.volume());
+	ASSERT_NE(nullptr, v);
+	EXPECT_EQ(64, v->region().getDepthInVoxels());
+	for (int z = 0; z < 64; ++z) {
+		const voxel::Voxel &voxel = v->voxel(z, z, z);
+		ASSERT_TRUE(voxel::isBlocked(voxel.getMaterial())) << z;
+		const bool secondNode = z >= 16 && z < 48;
+		const core::RGBA expected = secondNode ? palette2.color(1) : palette1.color(1);
+		EXPECT_EQ(expected, merged.palette.color(voxel.getColor()))
+			<< "the node that was added last must win at " << z;
+	}
+}
+
 TEST_F(SceneGraphTest, testMergeWithTranslation) {
 	SceneGraph sceneGraph;
 	{
@@ -8,7 +8,7 @@
 #include "core/SharedPtr.h"
 #include "core/Var.h"
 #include "core/collection/Array.h"
-#include "core/collection/ConcurrentPriorityQueue.h"
+#include "core/collection/ConcurrentQueue.h"
 #include "core/collection/DynamicMap.h"
 #include "core/collection/PriorityQueue.h"
 #include "core/concurrent/ThreadPool.h"
@@ -68,15 +68,11 @@ private:
 		ExtractionCtx() {
 		}
 		ExtractionCtx(const glm::ivec3 &_mins, int _idx, voxel::ChunkMesh &&_mesh)
-			: mins(_mins), idx(_idx), mesh(_mesh) {
+			: mins(_mins), idx(_idx), mesh(core::move(_mesh)) {
 		}
 		glm::ivec3 mins{};
 		int idx = -1;
 		voxel::ChunkMesh mesh;
-
-		inline bool operator<(const ExtractionCtx &rhs) const {
-			return idx < rhs.idx;
-		}
 	};
 
 	MeshesMap _meshes[MeshType_Max];
@@ -104,7 +100,9 @@ private:
 	core::AtomicInt _pendingExtractorTasks{0};
 	voxel::Region calculateExtractRegion(int x, int y, int z, const glm::ivec3 &meshSize) const;
 	core::ThreadPool _threadPool{core::halfcpus(), "VolumeRndr"};
-	core::ConcurrentPriorityQueue<MeshState::ExtractionCtx> _pendingQueue;
+	// the extracted meshes are handed over in the order the extraction finished - a newer extraction of a chunk always
+	// replaces the older one
+	core::ConcurrentQueue<MeshState::ExtractionCtx> _pendingQueue{1024};
 	core::VarPtr _meshMode;
 	bool deleteMeshes(const glm::ivec3 &pos, int idx);
 	void clear();
@@ -0,0 +1,259 @@
+/**
+ * @file
+ */
+
+#include "PaletteVolume.h"
+#include "core/Assert.h"
+#include "core/StandardLib.h"
+
+namespace voxel {
+
+PaletteVolume::PaletteVolume(const Region &region) : _region(region) {
+	core_assert_msg(width() > 0, "Volume width must be greater than zero.");
+	core_assert_msg(height() > 0, "Volume height must be greater than zero.");
+	core_assert_msg(depth() > 0, "Volume depth must be greater than zero.");
+	const size_t voxels = (size_t)width() * (size_t)height() * (size_t)depth();
+	_colors.resize(voxels);
+	_types.resize((voxels + 3) / 4);
+	_noNormal.resize((voxels + 7) / 8);
+	clear();
+}
+
+void PaletteVolume::setVoxelAt(int idx, const Voxel &voxel) {
+	const VoxelType material = voxel.getMaterial();
+	if (voxel::isAir(material)) {
+		if (type(idx) == TypeExtended) {
+			_extended.remove(idx);
+		}
+		_colors[idx] = 0u;
+		setType(idx, TypeAir);
+		return;
+	}
+	_colors[idx] = voxel.getColor();
+	// everything but the color index and the material must match the default values of voxel::createVoxel() or the
+	// voxel::Voxel constructor
+	const uint8_t normal = voxel.getNormal();
+	if ((normal == 0u || normal == NO_NORMAL) && voxel.getFlags() == 0u && voxel._unused2 == 0u) {
+		if (type(idx) == TypeExtended) {
+			_extended.remove(idx);
+		}
+		setNormal(idx, normal);
+		setType(idx, voxel::isTransparent(material) ? TypeTransparent : TypeGeneric);
+		return;
+	}
+	setType(idx, TypeExtended);
+	_extended.put(idx, voxel);
+}
+
+bool PaletteVolume::setVoxel(int32_t x, int32_t y, int32_t z, const Voxel &voxel) {
+	if (!_region.containsPoint(x, y, z)) {
+		return false;
+	}
+	setVoxelAt(index(x, y, z), voxel);
+	return true;
+}
+
+void PaletteVolume::clear() {
+	core_memset(_colors.data(), 0, _colors.size());
+	core_memset(_types.data(), 0, _types.size());
+	core_memset(_noNormal.data(), 0, _noNormal.size());
+	_extended.clear();
+}
+
+size_t PaletteVolume::bytes() const {
+	return _colors.size() + _types.size() + _noNormal.size() + _extended.size() * (sizeof(int) + sizeof(Voxel));
+}
+
+PaletteVolume::Sampler::Sampler(const PaletteVolume *volume) : _volume(const_cast<PaletteVolume *>(volume)) {
+}
+
+PaletteVolume::Sampler::Sampler(const PaletteVolume &volume) : _volume(const_cast<PaletteVolume *>(&volume)) {
+}
+
+bool PaletteVolume::Sampler::setVoxel(const Voxel &voxel) {
+	if (_currentPositionInvalid) {
+		return false;
+	}
+	_volume->setVoxelAt(_index, voxel);
+	_currentVoxel = _volume->voxelAt(_index);
+	return true;
+}
+
+bool PaletteVolume::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_t zPos) {
+	_posInVolume.x = xPos;
+	_posInVolume.y = yPos;
+	_posInVolume.z = zPos;
+
+	const voxel::Region &region = this->region();
+	_currentPositionInvalid = 0u;
+	if (!region.containsPointInX(xPos)) {
+		_currentPositionInvalid |= SAMPLER_INVALIDX;
+	}
+	if (!region.containsPointInY(yPos)) {
+		_currentPositionInvalid |= SAMPLER_INVALIDY;
+	}
+	if (!region.containsPointInZ(zPos)) {
+		_currentPositionInvalid |= SAMPLER_INVALIDZ;
+	}
+
+	if (currentPositionValid()) {
+		_index = _volume->index(xPos, yPos, zPos);
+		updateVoxel();
+		return true;
+	}
+	return false;
+}
+
+void PaletteVolume::Sampler::movePositive(math::Axis axis, uint32_t offset) {
+	switch (axis) {
+	case math::Axis::X:
+		movePositiveX(offset);
+		break;
+	case math::Axis::Y:
+		movePositiveY(offset);
+		break;
+	case math::Axis::Z:
+		movePositiveZ(offset);
+		break;
+	default:
+		break;
+	}
+}
+
+void PaletteVolume::Sampler::movePositiveX(uint32_t offset) {
+	const bool bIsOldPositionValid = currentPositionValid();
+
+	_posInVolume.x += (int)offset;
+
+	if (!region().containsPointInX(_posInVolume.x)) {
+		_currentPositionInvalid |= SAMPLER_INVALIDX;
+	} else {
+		_currentPositionInvalid &= ~SAMPLER_INVALIDX;
+	}
+
+	// Then we update the voxel index
+	if (!bIsOldPositionValid) {
+		setPosition(_posInVolume);
+	} else if (currentPositionValid()) {
+		_index += (int)offset;
+		updateVoxel();
+	}
+}
+
+void PaletteVolume::Sampler::movePositiveY(uint32_t offset) {
+	const bool bIsOldPositionValid = currentPositionValid();
+
+	_posInVolume.y += (int)offset;
+
+	if (!region().containsPointInY(_posInVolume.y)) {
+		_currentPositionInvalid |= SAMPLER_INVALIDY;
+	} else {
+		_currentPositionInvalid &= ~SAMPLER_INVALIDY;
+	}
+
+	// Then we update the voxel index
+	if (!bIsOldPositionValid) {
+		setPosition(_posInVolume);
+	} else if (currentPositionValid()) {
+		_index += (int)offset * _volume->width();
+		updateVoxel();
+	}
+}
+
+void PaletteVolume::Sampler::movePositiveZ(uint32_t offset) {
+	const bool bIsOldPositionValid = currentPositionValid();
+
+	_posInVolume.z += (int)offset;
+
+	if (!region().containsPointInZ(_posInVolume.z)) {
+		_currentPositionInvalid |= SAMPLER_INVALIDZ;
+	} else {
+		_currentPositionInvalid &= ~SAMPLER_INVALIDZ;
+	}
+
+	// Then we update the voxel index
+	if (!bIsOldPositionValid) {
+		setPosition(_posInVolume);
+	} else if (currentPositionValid()) {
+		_index += (int)offset * _volume->width() * _volume->height();
+		updateVoxel();
+	}
+}
+
+void PaletteVolume::Sampler::moveNegative(math::Axis axis, uint32_t offset) {
+	switch (axis) {
+	case math::Axis::X:
+		moveNegativeX(offset);
+		break;
+	case math::Axis::Y:
+		moveNegativeY(offset);
+		break;
+	case math::Axis::Z:
+		moveNegativeZ(offset);
+		break;
+	default:
+		break;
+	}
+}
+
+void PaletteVolume::Sampler::moveNegativeX(uint32_t offset) {
+	const bool bIsOldPositionValid = currentPositionValid();
+
+	_posInVolume.x -= (int)offset;
+
+	if (!region().containsPointInX(_posInVolume.x)) {
+		_currentPositionInvalid |= SAMPLER_INVALIDX;
+	} else {
+		_currentPositionInvalid &= ~SAMPLER_INVALIDX;
+	}
+
+	// Then we update the voxel index
+	if (!bIsOldPositionValid) {
+		setPosition(_posInVolume);
+	} else if (currentPositionValid()) {
+		_index -= (int)offset;
+		updateVoxel();
+	}
+}
+
+void PaletteVolume::Sampler::moveNegativeY(uint32_t offset) {
+	const bool bIsOldPositionValid = currentPositionValid();
+
+	_posInVolume.y -= (int)offset;
+
+	if (!region().containsPointInY(_posInVolume.y)) {
+		_currentPositionInvalid |= SAMPLER_INVALIDY;
+	} else {
+		_currentPositionInvalid &= ~SAMPLER_INVALIDY;
+	}
+
+	// Then we update the voxel index
+	if (!bIsOldPositionValid) {
+		setPosition(_posInVolume);
+	} else if (currentPositionValid()) {
+		_index -= (int)offset * _volume->width();
+		updateVoxel();
+	}
+}
+
+void PaletteVolume::Sampler::moveNegativeZ(uint32_t offset) {
+	const bool bIsOldPositionValid = currentPositionValid();
+
+	_posInVolume.z -= (int)offset;
+
+	if (!region().containsPointInZ(_posInVolume.z)) {
+		_currentPositionInvalid |= SAMPLER_INVALIDZ;
+	} else {
+		_currentPositionInvalid &= ~SAMPLER_INVALIDZ;
+	}
+
+	// Then we update the voxel index
+	if (!bIsOldPositionValid) {
+		setPosition(_posInVolume);
+	} else if (currentPositionValid()) {
+		_index -= (int)offset * _volume->width() * _volume->height();
+		updateVoxel();
+	}
+}
+
+} // namespace voxel
@@ -0,0 +1,443 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/DynamicArray.h"
+#include "core/collection/DynamicMap.h"
+#include "math/Axis.h"
+#include "voxel/Region.h"
+#include "voxel/Voxel.h"
+#include "voxelutil/VolumeVisitor.h"
+
+namespace voxel {
+
+/**
+ * @brief Compact volume that only stores the palette color index of each voxel
+ *
+ * A @c RawVolume needs 4 bytes per voxel - but most assets never use the normal index, the flags or the ambient
+ * occlusion byte. This volume stores one byte for the color index, two bits for the voxel type and one bit for the
+ * two default normals (@c 0 from @c voxel::createVoxel() and @c NO_NORMAL from the @c voxel::Voxel constructor).
+ * Voxels that carry any other normal, flags or ambient occlusion data are stored in a side channel, so every
+ * @c voxel::Voxel survives the round trip.
+ *
+ * This reduces the memory and the bandwidth of scanning the volume to roughly a third of a @c RawVolume.
+ *
+ * @note The volume is not thread safe for concurrent writes - several voxels share one byte of type information.
+ * @note This is a standalone building block - the scene graph nodes still use @c RawVolume.
+ * @sa RawVolume
+ * @sa SparseVolume
+ */
+class PaletteVolume {
+public:
+	/**
+	 * @brief The two bit type of a voxel - @c Extended means the voxel is stored in the side channel
+	 */
+	enum Type : uint8_t { TypeAir = 0, TypeTransparent = 1, TypeGeneric = 2, TypeExtended = 3 };
+
+	class Sampler {
+	private:
+		static const uint8_t SAMPLER_INVALIDX = 1 << 0;
+		static const uint8_t SAMPLER_INVALIDY = 1 << 1;
+		static const uint8_t SAMPLER_INVALIDZ = 1 << 2;
+
+		void updateVoxel();
+
+	public:
+		Sampler(const PaletteVolume &volume);
+		Sampler(const PaletteVolume *volume);
+
+		/**
+		 * @note The voxel is returned by value - there is no @c voxel::Voxel instance in the volume that a reference
+		 * could point to.
+		 */
+		Voxel voxel() const;
+		const Region &region() const;
+
+		bool currentPositionValid() const;
+
+		bool setPosition(const glm::ivec3 &pos);
+		bool setPosition(int32_t x, int32_t y, int32_t z);
+		bool setVoxel(const Voxel &voxel);
+		const glm::ivec3 &position() const;
+
+		void movePositiveX(uint32_t offset = 1);
+		void movePositiveY(uint32_t offset = 1);
+		void movePositiveZ(uint32_t offset = 1);
+		void movePositive(math::Axis axis, uint32_t offset = 1);
+
+		void moveNegativeX(uint32_t offset = 1);
+		void moveNegativeY(uint32_t offset = 1);
+		void moveNegativeZ(uint32_t offset = 1);
+		void moveNegative(math::Axis axis, uint32_t offset = 1);
+
+		Voxel peekVoxel1nx1ny1nz() const;
+		Voxel peekVoxel1nx1ny0pz() const;
+		Voxel peekVoxel1nx1ny1pz() const;
+		Voxel peekVoxel1nx0py1nz() const;
+		Voxel peekVoxel1nx0py0pz() const;
+		Voxel peekVoxel1nx0py1pz() const;
+		Voxel peekVoxel1nx1py1nz() const;
+		Voxel peekVoxel1nx1py0pz() const;
+		Voxel peekVoxel1nx1py1pz() const;
+
+		Voxel peekVoxel0px1ny1nz() const;
+		Voxel peekVoxel0px1ny0pz() const;
+		Voxel peekVoxel0px1ny1pz() const;
+		Voxel peekVoxel0px0py1nz() const;
+		Voxel peekVoxel0px0py0pz() const;
+		Voxel peekVoxel0px0py1pz() const;
+		Voxel peekVoxel0px1py1nz() const;
+		Voxel peekVoxel0px1py0pz() const;
+		Voxel peekVoxel0px1py1pz() const;
+
+		Voxel peekVoxel1px1ny1nz() const;
+		Voxel peekVoxel1px1ny0pz() const;
+		Voxel peekVoxel1px1ny1pz() const;
+		Voxel peekVoxel1px0py1nz() const;
+		Voxel peekVoxel1px0py0pz() const;
+		Voxel peekVoxel1px0py1pz() const;
+		Voxel peekVoxel1px1py1nz() const;
+		Voxel peekVoxel1px1py0pz() const;
+		Voxel peekVoxel1px1py1pz() const;
+
+	protected:
+		PaletteVolume *_volume;
+
+		// The current position in the volume
+		glm::ivec3 _posInVolume{0, 0, 0};
+		// The linear index of the current position - only valid if the current position is valid
+		int _index = 0;
+
+		/** Other current position information */
+		Voxel _currentVoxel;
+
+		/** Whether the current position is inside the volume */
+		uint8_t _currentPositionInvalid = 0u;
+	};
+
+private:
+	voxel::Region _region;
+	/** one color index per voxel */
+	core::DynamicArray<uint8_t> _colors;
+	/** four two bit @c Type values per byte */
+	core::DynamicArray<uint8_t> _types;
+	/** one bit per voxel - set if the normal is @c NO_NORMAL instead of @c 0 */
+	core::DynamicArray<uint8_t> _noNormal;
+	/** voxels that can't be expressed by color index and type - keyed by the linear index */
+	core::DynamicMap<int, Voxel, 1031> _extended;
+	/** Border voxel */
+	Voxel _borderVoxel;
+
+	inline int index(int32_t x, int32_t y, int32_t z) const {
+		const glm::ivec3 &lower = _region.getLowerCorner();
+		return (x - lower.x) + (y - lower.y) * width() + (z - lower.z) * width() * height();
+	}
+
+	inline Type type(int idx) const {
+		return (Type)((_types[idx >> 2] >> ((idx & 3) << 1)) & 3u);
+	}
+
+	inline void setType(int idx, Type type) {
+		uint8_t &bits = _types[idx >> 2];
+		const int shift = (idx & 3) << 1;
+		bits = (uint8_t)((bits & ~(3u << shift)) | ((uint32_t)type << shift));
+	}
+
+	inline uint8_t normal(int idx) const {
+		return (_noNormal[idx >> 3] & (1u << (idx & 7))) ? NO_NORMAL : 0u;
+	}
+
+	inline void setNormal(int idx, uint8_t normal) {
+		uint8_t &bits = _noNormal[idx >> 3];
+		if (normal == NO_NORMAL) {
+			bits = (uint8_t)(bits | (1u << (idx & 7)));
+		} else {
+			bits = (uint8_t)(bits & ~(1u << (idx & 7)));
+		}
+	}
+
+	Voxel voxelAt(int idx) const;
+	void setVoxelAt(int idx, const Voxel &voxel);
+
+public:
+	PaletteVolume(const Region &region);
+	/**
+	 * @brief Creates a compact copy of the given volume - this works for every volume type with a @c Sampler
+	 */
+	template<class Volume>
+	static PaletteVolume *create(const Volume &volume) {
+		PaletteVolume *v = new PaletteVolume(volume.region());
+		v->copyFrom(volume);
+		return v;
+	}
+
+	[[nodiscard]] inline const Region &region() const {
+		return _region;
+	}
+
+	int32_t width() const;
+	int32_t height() const;
+	int32_t depth() const;
+
+	/**
+	 * @brief The voxel at the given position or the border voxel if the position is outside the region
+	 */
+	[[nodiscard]] Voxel voxel(int32_t x, int32_t y, int32_t z) const;
+	[[nodiscard]] inline Voxel voxel(const glm::ivec3 &pos) const {
+		return voxel(pos.x, pos.y, pos.z);
+	}
+
+	/**
+	 * @brief Fast access to the palette color index - without building the @c voxel::Voxel instance
+	 * @note The position must be inside the region
+	 */
+	[[nodiscard]] uint8_t colorIndex(int32_t x, int32_t y, int32_t z) const;
+	/**
+	 * @note The position must be inside the region
+	 */
+	[[nodiscard]] bool isAir(int32_t x, int32_t y, int32_t z) const;
+
+	bool setVoxel(int32_t x, int32_t y, int32_t z, const Voxel &voxel);
+	inline bool setVoxel(const glm::ivec3 &pos, const Voxel &voxel) {
+		return setVoxel(pos.x, pos.y, pos.z, voxel);
+	}
+
+	const Voxel &borderValue() const;
+	void setBorderValue(const Voxel &voxel);
+
+	/**
+	 * @brief Sets all voxels to air
+	 */
+	void clear();
+
+	/**
+	 * @brief The amount of voxels that are stored in the side channel because they carry a normal, flags or ambient
+	 * occlusion data
+	 */
+	[[nodiscard]] inline size_t extendedVoxels() const {
+		return _extended.size();
+	}
+
+	/**
+	 * @brief The memory in bytes that is used for the voxel data
+	 */
+	[[nodiscard]] size_t bytes() const;
+
+	template<class Volume>
+	void copyTo(Volume &target) const {
+		Sampler sampler(this);
+		for (int32_t z = _region.getLowerZ(); z <= _region.getUpperZ(); ++z) {
+			for (int32_t y = _region.getLowerY(); y <= _region.getUpperY(); ++y) {
+				sampler.setPosition(_region.getLowerX(), y, z);
+				for (int32_t x = _region.getLowerX(); x <= _region.getUpperX(); ++x) {
+					const Voxel voxel = sampler.voxel();
+					if (!voxel::isAir(voxel.getMaterial())) {
+						target.setVoxel(x, y, z, voxel);
+					}
+					sampler.movePositiveX();
+				}
+			}
+		}
+	}
+
+	template<class Volume>
+	void copyFrom(const Volume &source) {
+		auto visitor = [this](int x, int y, int z, const voxel::Voxel &voxel) { setVoxel(x, y, z, voxel); };
+		voxelutil::visitVolume(source, _region, 1, 1, 1, visitor);
+	}
+};
+
+inline int32_t PaletteVolume::width() const {
+	return _region.getWidthInVoxels();
+}
+
+inline int32_t PaletteVolume::height() const {
+	return _region.getHeightInVoxels();
+}
+
+inline int32_t PaletteVolume::depth() const {
+	return _region.getDepthInVoxels();
+}
+
+inline const Voxel &PaletteVolume::borderValue() const {
+	return _borderVoxel;
+}
+
+inline void PaletteVolume::setBorderValue(const Voxel &voxel) {
+	_borderVoxel = voxel;
+}
+
+inline Voxel PaletteVolume::voxelAt(int idx) const {
+	switch (type(idx)) {
+	case TypeTransparent:
+		return createVoxel(VoxelType::Transparent, _colors[idx], normal(idx));
+	case TypeGeneric:
+		return createVoxel(VoxelType::Generic, _colors[idx], normal(idx));
+	case TypeExtended: {
+		auto iter = _extended.find(idx);
+		if (iter != _extended.end()) {
+			return iter->second;
+		}
+		break;
+	}
+	case TypeAir:
+		break;
+	}
+	return Voxel();
+}
+
+inline Voxel PaletteVolume::voxel(int32_t x, int32_t y, int32_t z) const {
+	if (!_region.containsPoint(x, y, z)) {
+		return _borderVoxel;
+	}
+	return voxelAt(index(x, y, z));
+}
+
+inline uint8_t PaletteVolume::colorIndex(int32_t x, int32_t y, int32_t z) const {
+	return _colors[index(x, y, z)];
+}
+
+inline bool PaletteVolume::isAir(int32_t x, int32_t y, int32_t z) const {
+	return type(index(x, y, z)) == TypeAir;
+}
+
+inline const Region &PaletteVolume::Sampler::region() const {
+	return _volume->region();
+}
+
+inline const glm::ivec3 &PaletteVolume::Sampler::position() const {
+	return _posInVolume;
+}
+
+inline bool PaletteVolume::Sampler::currentPositionValid() const {
+	return !_currentPositionInvalid;
+}
+
+inline Voxel PaletteVolume::Sampler::voxel() const {
+	if (this->currentPositionValid()) {
+		return _currentVoxel;
+	}
+	return _volume->borderValue();
+}
+
+inline bool PaletteVolume::Sampler::setPosition(const glm::ivec3 &v3dNewPos) {
+	return setPosition(v3dNewPos.x, v3dNewPos.y, v3dNewPos.z);
+}
+
+inline void PaletteVolume::Sampler::updateVoxel() {
+	if (currentPositionValid()) {
+		_currentVoxel = _volume->voxelAt(_index);
+	}
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1nx1ny1nz() const {
+	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y - 1, this->_posInVolume.z - 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1nx1ny0pz() const {
+	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y - 1, this->_posInVolume.z);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1nx1ny1pz() const {
+	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y - 1, this->_posInVolume.z + 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1nx0py1nz() const {
+	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y, this->_posInVolume.z - 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1nx0py0pz() const {
+	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y, this->_posInVolume.z);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1nx0py1pz() const {
+	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y, this->_posInVolume.z + 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1nx1py1nz() const {
+	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y + 1, this->_posInVolume.z - 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1nx1py0pz() const {
+	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y + 1, this->_posInVolume.z);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1nx1py1pz() const {
+	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y + 1, this->_posInVolume.z + 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel0px1ny1nz() const {
+	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y - 1, this->_posInVolume.z - 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel0px1ny0pz() const {
+	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y - 1, this->_posInVolume.z);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel0px1ny1pz() const {
+	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y - 1, this->_posInVolume.z + 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel0px0py1nz() const {
+	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y, this->_posInVolume.z - 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel0px0py0pz() const {
+	return voxel();
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel0px0py1pz() const {
+	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y, this->_posInVolume.z + 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel0px1py1nz() const {
+	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y + 1, this->_posInVolume.z - 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel0px1py0pz() const {
+	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y + 1, this->_posInVolume.z);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel0px1py1pz() const {
+	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y + 1, this->_posInVolume.z + 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1px1ny1nz() const {
+	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y - 1, this->_posInVolume.z - 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1px1ny0pz() const {
+	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y - 1, this->_posInVolume.z);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1px1ny1pz() const {
+	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y - 1, this->_posInVolume.z + 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1px0py1nz() const {
+	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y, this->_posInVolume.z - 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1px0py0pz() const {
+	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y, this->_posInVolume.z);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1px0py1pz() const {
+	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y, this->_posInVolume.z + 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1px1py1nz() const {
+	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y + 1, this->_posInVolume.z - 1);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1px1py0pz() const {
+	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y + 1, this->_posInVolume.z);
+}
+
+inline Voxel PaletteVolume::Sampler::peekVoxel1px1py1pz() const {
+	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y + 1, this->_posInVolume.z + 1);
+}
+
+} // namespace voxel
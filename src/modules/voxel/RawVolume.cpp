@@ -5,6 +5,7 @@
 #include "RawVolume.h"
 #include "core/Assert.h"
 #include "core/StandardLib.h"
+#include "core/concurrent/Atomic.h"
 #include <glm/common.hpp>
 #include <limits>
 
@@ -23,20 +24,46 @@ RawVolume::RawVolume(const Region &regValid) : _region(regValid) {
 	initialise(regValid);
 }
 
-RawVolume::RawVolume(const RawVolume *copy) : _region(copy->region()) {
-	setBorderValue(copy->borderValue());
-	const size_t size = RawVolume::size(_region);
-	_data = (Voxel *)core_malloc(size);
-	_borderVoxel = copy->_borderVoxel;
-	core_memcpy((void*)_data, (void*)copy->_data, size);
+RawVolume::RawVolume(const RawVolume *copy) : RawVolume(*copy) {
 }
 
 RawVolume::RawVolume(const RawVolume &copy) : _region(copy.region()) {
 	setBorderValue(copy.borderValue());
+	// the data is shared until one of the volumes is modified
+	_data = copy._data;
+	_refs = copy._refs;
+	_refs->increment(1);
+}
+
+bool RawVolume::isShared() const {
+	return _refs != nullptr && *_refs > 1;
+}
+
+void RawVolume::detach() {
+	if (!isShared()) {
+		return;
+	}
 	const size_t size = RawVolume::size(_region);
-	_data = (Voxel *)core_malloc(size);
-	_borderVoxel = copy._borderVoxel;
-	core_memcpy((void*)_data, (void*)copy._data, size);
+	Voxel *data = (Voxel *)core_malloc(size);
+	core_assert_msg_always(data != nullptr, "Failed to allocate the memory for a volume with the dimensions %i:%i:%i",
+						   width(), height(), depth());
+	core_memcpy((void *)data, (const void *)_data, size);
+	release();
+	_data = data;
+	_refs = new core::AtomicInt(1);
+}
+
+void RawVolume::release() {
+	if (_refs == nullptr) {
+		return;
+	}
+	// the previous value is returned
+	if (_refs->decrement(1) == 1) {
+		core_free(_data);
+		delete _refs;
+	}
+	_data = nullptr;
+	_refs = nullptr;
 }
 
 static inline voxel::Region accumulate(const core::DynamicArray<Region> &regions) {
@@ -79,18 +106,23 @@ RawVolume::RawVolume(const RawVolume &src, const core::DynamicArray<Region> &cop
 RawVolume::RawVolume(const RawVolume& src, const Region& region, bool *onlyAir) : _region(region) {
 	core_assert(region.isValid());
 	setBorderValue(src.borderValue());
+	if (src.region() == _region) {
+		_data = src._data;
+		_refs = src._refs;
+		_refs->increment(1);
+		if (onlyAir) {
+			*onlyAir = false;
+		}
+		return;
+	}
 	const size_t size = RawVolume::size(_region);
 	_data = (Voxel *)core_malloc(size);
+	_refs = new core::AtomicInt(1);
 	if (!intersects(src.region(), _region)) {
 		if (onlyAir) {
 			*onlyAir = true;
 		}
 		core_memset((void *)_data, 0, size);
-	} else if (src.region() == _region) {
-		core_memcpy((void *)_data, (void *)src._data, size);
-		if (onlyAir) {
-			*onlyAir = false;
-		}
 	} else {
 		if (!src.region().containsRegion(_region)) {
 			_region.cropTo(src._region);
@@ -132,6 +164,8 @@ RawVolume::RawVolume(const RawVolume& src, const Region& region, bool *onlyAir)
 RawVolume::RawVolume(RawVolume &&move) noexcept {
 	_data = move._data;
 	move._data = nullptr;
+	_refs = move._refs;
+	move._refs = nullptr;
 	_region = move._region;
 	_borderVoxel = move._borderVoxel;
 }
@@ -142,15 +176,15 @@ RawVolume::RawVolume(const Voxel *data, const voxel::Region &region) {
 	core_memcpy((void *)_data, (const void *)data, size);
 }
 
-RawVolume::RawVolume(Voxel *data, const voxel::Region &region) : _region(region), _data(data) {
+RawVolume::RawVolume(Voxel *data, const voxel::Region &region)
+	: _region(region), _data(data), _refs(new core::AtomicInt(1)) {
 	core_assert_msg(width() > 0, "Volume width must be greater than zero.");
 	core_assert_msg(height() > 0, "Volume height must be greater than zero.");
 	core_assert_msg(depth() > 0, "Volume depth must be greater than zero.");
 }
 
 RawVolume::~RawVolume() {
-	core_free(_data);
-	_data = nullptr;
+	release();
 }
 
 bool RawVolume::move(const glm::ivec3 &shift) {
@@ -158,6 +192,8 @@ bool RawVolume::move(const glm::ivec3 &shift) {
 	const int h = height();
 	const int d = depth();
 
+	detach();
+
 	glm::ivec3 t = shift;
 	t.x = (t.x % w + w) % w;
 	t.y = (t.y % h + h) % h;
@@ -245,6 +281,7 @@ bool RawVolume::setVoxel(const glm::ivec3 &pos, const Voxel &voxel) {
 	if (_data[index].isSame(voxel)) {
 		return false;
 	}
+	detach();
 	_data[index] = voxel;
 	return true;
 }
@@ -253,6 +290,7 @@ void RawVolume::setVoxelUnsafe(const glm::ivec3 &pos, const Voxel &voxel) {
 	const glm::ivec3 &lowerCorner = _region.getLowerCorner();
 	const glm::ivec3 localPos = pos - lowerCorner;
 	const int index = localPos.x + localPos.y * width() + localPos.z * width() * height();
+	detach();
 	_data[index] = voxel;
 }
 
@@ -271,17 +309,20 @@ void RawVolume::initialise(const Region &regValidRegion) {
 	_data = (Voxel *)core_malloc(size);
 	core_assert_msg_always(_data != nullptr, "Failed to allocate the memory for a volume with the dimensions %i:%i:%i",
 						   width(), height(), depth());
+	_refs = new core::AtomicInt(1);
 
 	// Clear to zeros
 	clear();
 }
 
 void RawVolume::clear() {
+	detach();
 	const size_t size = RawVolume::size(_region);
 	core_memset(_data, 0, size);
 }
 
 void RawVolume::fill(const voxel::Voxel &voxel) {
+	detach();
 	const size_t size = width() * height() * depth();
 	for (size_t i = 0; i < size; ++i) {
 		_data[i] = voxel;
@@ -303,6 +344,8 @@ bool RawVolume::Sampler::setVoxel(const Voxel &voxel) {
 	if (_currentPositionInvalid) {
 		return false;
 	}
+	_volume->detach();
+	rebase();
 	*_currentVoxel = voxel;
 	return true;
 }
@@ -332,7 +375,8 @@ bool RawVolume::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_t zPos) {
 		const int32_t iLocalZPos = zPos - v3dLowerCorner.z;
 		const int32_t uVoxelIndex = iLocalXPos + iLocalYPos * _volume->width() + iLocalZPos * _volume->width() * _volume->height();
 
-		_currentVoxel = _volume->_data + uVoxelIndex;
+		_dataBase = _volume->_data;
+		_currentVoxel = _dataBase + uVoxelIndex;
 		return true;
 	}
 	_currentVoxel = nullptr;
@@ -370,6 +414,7 @@ void RawVolume::Sampler::movePositiveX(uint32_t offset) {
 	if (!bIsOldPositionValid) {
 		setPosition(_posInVolume);
 	} else if (currentPositionValid()) {
+		rebase();
 		_currentVoxel += (intptr_t)offset;
 	} else {
 		_currentVoxel = nullptr;
@@ -391,6 +436,7 @@ void RawVolume::Sampler::movePositiveY(uint32_t offset) {
 	if (!bIsOldPositionValid) {
 		setPosition(_posInVolume);
 	} else if (currentPositionValid()) {
+		rebase();
 		_currentVoxel += (intptr_t)(_volume->width() * offset);
 	} else {
 		_currentVoxel = nullptr;
@@ -412,6 +458,7 @@ void RawVolume::Sampler::movePositiveZ(uint32_t offset) {
 	if (!bIsOldPositionValid) {
 		setPosition(_posInVolume);
 	} else if (currentPositionValid()) {
+		rebase();
 		_currentVoxel += (intptr_t)(_volume->width() * _volume->height() * offset);
 	} else {
 		_currentVoxel = nullptr;
@@ -449,6 +496,7 @@ void RawVolume::Sampler::moveNegativeX(uint32_t offset) {
 	if (!bIsOldPositionValid) {
 		setPosition(_posInVolume);
 	} else if (currentPositionValid()) {
+		rebase();
 		_currentVoxel -= (intptr_t)offset;
 	} else {
 		_currentVoxel = nullptr;
@@ -470,6 +518,7 @@ void RawVolume::Sampler::moveNegativeY(uint32_t offset) {
 	if (!bIsOldPositionValid) {
 		setPosition(_posInVolume);
 	} else if (currentPositionValid()) {
+		rebase();
 		_currentVoxel -= (intptr_t)(_volume->width() * offset);
 	} else {
 		_currentVoxel = nullptr;
@@ -491,6 +540,7 @@ void RawVolume::Sampler::moveNegativeZ(uint32_t offset) {
 	if (!bIsOldPositionValid) {
 		setPosition(_posInVolume);
 	} else if (currentPositionValid()) {
+		rebase();
 		_currentVoxel -= (intptr_t)(_volume->width() * _volume->height() * offset);
 	} else {
 		_currentVoxel = nullptr;
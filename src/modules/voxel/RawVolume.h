@@ -10,10 +10,20 @@
 #include "math/Axis.h"
 #include <glm/vec3.hpp>
 
+namespace core {
+class AtomicInt;
+}
+
 namespace voxel {
 
 /**
  * Simple volume implementation which stores data in a single large 3D array.
+ *
+ * The voxel data is reference counted and copied on write. Copying a volume (e.g. for undo snapshots, the clipboard,
+ * node duplication or background exports) is cheap - the data is only duplicated once one of the volumes is
+ * modified.
+ *
+ * @note Writing to a volume that shares its data duplicates the whole voxel data once.
  */
 class RawVolume {
 public:
@@ -87,10 +97,23 @@ public:
 		glm::ivec3 _posInVolume{0, 0, 0};
 
 		/** Other current position information */
-		Voxel *_currentVoxel = nullptr;
+		mutable Voxel *_currentVoxel = nullptr;
+		/** The voxel data of the volume that @c _currentVoxel points into */
+		mutable Voxel *_dataBase = nullptr;
 
 		/** Whether the current position is inside the volume */
 		uint8_t _currentPositionInvalid = 0u;
+
+		/**
+		 * @brief The volume might have detached its shared data since the voxel pointer was computed
+		 * @note The old data might already be freed by the other owner - call this before every access
+		 */
+		inline void rebase() const {
+			if (_dataBase != _volume->_data) {
+				_currentVoxel = _volume->_data + (_currentVoxel - _dataBase);
+				_dataBase = _volume->_data;
+			}
+		}
 	};
 
 	RawVolume(const Voxel *data, const voxel::Region &region);
@@ -120,6 +143,11 @@ public:
 
 	~RawVolume();
 
+	/**
+	 * @return @c true if the voxel data is shared with other volumes - the next write operation will copy the data
+	 */
+	bool isShared() const;
+
 	/**
 	 * Copy the raw data of the volume
 	 * @note It's the callers responsibility to properly release the memory.
@@ -222,8 +250,16 @@ public:
 	 */
 	bool move(const glm::ivec3 &t);
 
+	/**
+	 * @brief Make sure the voxel data is not shared with any other volume before it gets modified
+	 * @note Call this before different threads are writing into the volume - the write functions are detaching the
+	 * data on their own, but that's not thread safe
+	 */
+	void detach();
+
 private:
 	void initialise(const Region &region);
+	void release();
 
 	/** The size of the volume */
 	Region _region;
@@ -233,6 +269,8 @@ private:
 
 	/** The voxel data */
 	Voxel *_data;
+	/** The amount of volumes that share @c _data */
+	core::AtomicInt *_refs = nullptr;
 };
 
 inline const Region &RawVolume::region() const {
@@ -276,6 +314,7 @@ inline const glm::ivec3 &RawVolume::Sampler::position() const {
 
 inline const Voxel &RawVolume::Sampler::voxel() const {
 	if (this->currentPositionValid()) {
+		rebase();
 		return *_currentVoxel;
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y, this->_posInVolume.z);
@@ -293,6 +332,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1nx1ny1nz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x) && CAN_GO_NEG_Y(this->_posInVolume.y) &&
 		CAN_GO_NEG_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel - 1 - region.getWidthInVoxels() - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y - 1, this->_posInVolume.z - 1);
@@ -301,6 +341,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1nx1ny1nz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel1nx1ny0pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x) && CAN_GO_NEG_Y(this->_posInVolume.y)) {
+		rebase();
 		return *(_currentVoxel - 1 - region.getWidthInVoxels());
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y - 1, this->_posInVolume.z);
@@ -310,6 +351,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1nx1ny1pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x) && CAN_GO_NEG_Y(this->_posInVolume.y) &&
 		CAN_GO_POS_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel - 1 - region.getWidthInVoxels() + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y - 1, this->_posInVolume.z + 1);
@@ -318,6 +360,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1nx1ny1pz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel1nx0py1nz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x) && CAN_GO_NEG_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel - 1 - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y, this->_posInVolume.z - 1);
@@ -326,6 +369,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1nx0py1nz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel1nx0py0pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x)) {
+		rebase();
 		return *(_currentVoxel - 1);
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y, this->_posInVolume.z);
@@ -334,6 +378,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1nx0py0pz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel1nx0py1pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x) && CAN_GO_POS_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel - 1 + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y, this->_posInVolume.z + 1);
@@ -343,6 +388,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1nx1py1nz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x) && CAN_GO_POS_Y(this->_posInVolume.y) &&
 		CAN_GO_NEG_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel - 1 + region.getWidthInVoxels() - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y + 1, this->_posInVolume.z - 1);
@@ -351,6 +397,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1nx1py1nz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel1nx1py0pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x) && CAN_GO_POS_Y(this->_posInVolume.y)) {
+		rebase();
 		return *(_currentVoxel - 1 + region.getWidthInVoxels());
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y + 1, this->_posInVolume.z);
@@ -360,6 +407,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1nx1py1pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x) && CAN_GO_POS_Y(this->_posInVolume.y) &&
 		CAN_GO_POS_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel - 1 + region.getWidthInVoxels() + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y + 1, this->_posInVolume.z + 1);
@@ -368,6 +416,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1nx1py1pz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel0px1ny1nz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_NEG_Y(this->_posInVolume.y) && CAN_GO_NEG_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel - region.getWidthInVoxels() - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y - 1, this->_posInVolume.z - 1);
@@ -376,6 +425,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel0px1ny1nz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel0px1ny0pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_NEG_Y(this->_posInVolume.y)) {
+		rebase();
 		return *(_currentVoxel - region.getWidthInVoxels());
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y - 1, this->_posInVolume.z);
@@ -384,6 +434,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel0px1ny0pz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel0px1ny1pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_NEG_Y(this->_posInVolume.y) && CAN_GO_POS_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel - region.getWidthInVoxels() + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y - 1, this->_posInVolume.z + 1);
@@ -392,6 +443,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel0px1ny1pz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel0px0py1nz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_NEG_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y, this->_posInVolume.z - 1);
@@ -399,6 +451,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel0px0py1nz() const {
 
 inline const Voxel &RawVolume::Sampler::peekVoxel0px0py0pz() const {
 	if (this->currentPositionValid()) {
+		rebase();
 		return *_currentVoxel;
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y, this->_posInVolume.z);
@@ -407,6 +460,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel0px0py0pz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel0px0py1pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_POS_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y, this->_posInVolume.z + 1);
@@ -415,6 +469,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel0px0py1pz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel0px1py1nz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_POS_Y(this->_posInVolume.y) && CAN_GO_NEG_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel + region.getWidthInVoxels() - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y + 1, this->_posInVolume.z - 1);
@@ -423,6 +478,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel0px1py1nz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel0px1py0pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_POS_Y(this->_posInVolume.y)) {
+		rebase();
 		return *(_currentVoxel + region.getWidthInVoxels());
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y + 1, this->_posInVolume.z);
@@ -431,6 +487,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel0px1py0pz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel0px1py1pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_POS_Y(this->_posInVolume.y) && CAN_GO_POS_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel + region.getWidthInVoxels() + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y + 1, this->_posInVolume.z + 1);
@@ -440,6 +497,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1px1ny1nz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x) && CAN_GO_NEG_Y(this->_posInVolume.y) &&
 		CAN_GO_NEG_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel + 1 - region.getWidthInVoxels() - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y - 1, this->_posInVolume.z - 1);
@@ -448,6 +506,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1px1ny1nz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel1px1ny0pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x) && CAN_GO_NEG_Y(this->_posInVolume.y)) {
+		rebase();
 		return *(_currentVoxel + 1 - region.getWidthInVoxels());
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y - 1, this->_posInVolume.z);
@@ -457,6 +516,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1px1ny1pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x) && CAN_GO_NEG_Y(this->_posInVolume.y) &&
 		CAN_GO_POS_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel + 1 - region.getWidthInVoxels() + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y - 1, this->_posInVolume.z + 1);
@@ -465,6 +525,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1px1ny1pz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel1px0py1nz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x) && CAN_GO_NEG_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel + 1 - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y, this->_posInVolume.z - 1);
@@ -473,6 +534,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1px0py1nz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel1px0py0pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x)) {
+		rebase();
 		return *(_currentVoxel + 1);
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y, this->_posInVolume.z);
@@ -481,6 +543,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1px0py0pz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel1px0py1pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x) && CAN_GO_POS_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel + 1 + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y, this->_posInVolume.z + 1);
@@ -490,6 +553,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1px1py1nz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x) && CAN_GO_POS_Y(this->_posInVolume.y) &&
 		CAN_GO_NEG_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel + 1 + region.getWidthInVoxels() - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y + 1, this->_posInVolume.z - 1);
@@ -498,6 +562,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1px1py1nz() const {
 inline const Voxel &RawVolume::Sampler::peekVoxel1px1py0pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x) && CAN_GO_POS_Y(this->_posInVolume.y)) {
+		rebase();
 		return *(_currentVoxel + 1 + region.getWidthInVoxels());
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y + 1, this->_posInVolume.z);
@@ -507,6 +572,7 @@ inline const Voxel &RawVolume::Sampler::peekVoxel1px1py1pz() const {
 	const Region &region = this->region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x) && CAN_GO_POS_Y(this->_posInVolume.y) &&
 		CAN_GO_POS_Z(this->_posInVolume.z)) {
+		rebase();
 		return *(_currentVoxel + 1 + region.getWidthInVoxels() + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y + 1, this->_posInVolume.z + 1);
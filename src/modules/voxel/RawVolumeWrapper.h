@@ -136,6 +136,20 @@ public:
 		return _dirtyRegion;
 	}
 
+	/**
+	 * @brief Adds a region to the dirty region - for bulk writes that went directly into the wrapped volume
+	 */
+	void addDirtyRegion(const Region& region) {
+		if (!region.isValid()) {
+			return;
+		}
+		if (_dirtyRegion.isValid()) {
+			_dirtyRegion.accumulate(region);
+		} else {
+			_dirtyRegion = region;
+		}
+	}
+
 	/**
 	 * @return @c false if the voxel was not placed because the given position is outside of the valid region, @c
 	 * true if the voxel was placed in the region.
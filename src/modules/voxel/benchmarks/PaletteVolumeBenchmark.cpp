@@ -0,0 +1,60 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "voxel/PaletteVolume.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/VolumeVisitor.h"
+
+class PaletteVolumeBenchmark : public app::AbstractBenchmark {
+protected:
+	const voxel::Region _region{0, 0, 0, 255, 127, 255};
+	voxel::RawVolume _rawVolume{_region};
+	voxel::PaletteVolume _paletteVolume{_region};
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		for (int z = _region.getLowerZ(); z <= _region.getUpperZ(); ++z) {
+			for (int x = _region.getLowerX(); x <= _region.getUpperX(); ++x) {
+				const int height = (x ^ z) & 127;
+				for (int y = 0; y <= height; ++y) {
+					const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, (uint8_t)(x + y + z));
+					_rawVolume.setVoxel(x, y, z, voxel);
+					_paletteVolume.setVoxel(x, y, z, voxel);
+				}
+			}
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(PaletteVolumeBenchmark, VisitRawVolume)(benchmark::State &state) {
+	for (auto _ : state) {
+		uint32_t colors = 0u;
+		voxelutil::visitVolume(_rawVolume,
+							   [&](int, int, int, const voxel::Voxel &voxel) { colors += voxel.getColor(); });
+		benchmark::DoNotOptimize(colors);
+	}
+}
+
+BENCHMARK_DEFINE_F(PaletteVolumeBenchmark, VisitPaletteVolume)(benchmark::State &state) {
+	for (auto _ : state) {
+		uint32_t colors = 0u;
+		voxelutil::visitVolume(_paletteVolume,
+							   [&](int, int, int, const voxel::Voxel &voxel) { colors += voxel.getColor(); });
+		benchmark::DoNotOptimize(colors);
+	}
+}
+
+BENCHMARK_DEFINE_F(PaletteVolumeBenchmark, CreatePaletteVolume)(benchmark::State &state) {
+	for (auto _ : state) {
+		voxel::PaletteVolume *v = voxel::PaletteVolume::create(_rawVolume);
+		benchmark::DoNotOptimize(v);
+		delete v;
+	}
+}
+
+BENCHMARK_REGISTER_F(PaletteVolumeBenchmark, VisitRawVolume);
+BENCHMARK_REGISTER_F(PaletteVolumeBenchmark, VisitPaletteVolume);
+BENCHMARK_REGISTER_F(PaletteVolumeBenchmark, CreatePaletteVolume);
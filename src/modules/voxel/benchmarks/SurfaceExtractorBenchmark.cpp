@@ -3,9 +3,11 @@
  */
 
 #include "app/benchmark/AbstractBenchmark.h"
+#include "palette/Palette.h"
 #include "voxel/ChunkMesh.h"
 #include "voxel/RawVolume.h"
 #include "voxel/SurfaceExtractor.h"
+#include <glm/geometric.hpp>
 
 class SurfaceExtractorBenchmark : public app::AbstractBenchmark {
 protected:
@@ -107,4 +109,38 @@ BENCHMARK_DEFINE_F(SurfaceExtractorBenchmark, Visit)(benchmark::State &state) {
 
 BENCHMARK_REGISTER_F(SurfaceExtractorBenchmark, Visit);
 
+class MarchingCubesBenchmark : public app::AbstractBenchmark {
+protected:
+	voxel::RawVolume v{voxel::Region{0, 0, 0, 127, 127, 127}};
+	palette::Palette pal;
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		pal.nippon();
+		// a sphere with some noise on the surface
+		const glm::vec3 center(63.5f);
+		for (int z = 0; z < 128; ++z) {
+			for (int y = 0; y < 128; ++y) {
+				for (int x = 0; x < 128; ++x) {
+					const float radius = 52.0f + (float)((x * 7 + y * 13 + z * 3) % 5);
+					if (glm::distance(glm::vec3(x, y, z), center) < radius) {
+						v.setVoxel(x, y, z, voxel::createVoxel(pal, (x + y + z) % 255));
+					}
+				}
+			}
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(MarchingCubesBenchmark, Extract)(benchmark::State &state) {
+	for (auto _ : state) {
+		voxel::ChunkMesh mesh;
+		voxel::SurfaceExtractionContext ctx = voxel::buildMarchingCubesContext(&v, v.region(), mesh, pal);
+		voxel::extractSurface(ctx);
+	}
+}
+
+BENCHMARK_REGISTER_F(MarchingCubesBenchmark, Extract);
+
 BENCHMARK_MAIN();
@@ -3,9 +3,12 @@
  */
 
 #include "MarchingCubesSurfaceExtractor.h"
+#include "app/Async.h"
+#include "core/ArrayLength.h"
 #include "core/Color.h"
 #include "core/Common.h"
 #include "core/collection/Array2DView.h"
+#include "core/concurrent/Concurrency.h"
 #include "MarchingCubesTables.h"
 #include "math/Axis.h"
 #include "voxel/ChunkMesh.h"
@@ -59,8 +62,71 @@ static glm::vec3 computeCentralDifferenceGradient(const RawVolume::Sampler &volI
 	return glm::vec3(voxel1nx - voxel1px, voxel1ny - voxel1py, voxel1nz - voxel1pz);
 }
 
+/**
+ * @brief The result of the extraction of a range of slices of the region
+ *
+ * The indices are local to the vertices of the slab - indices with the @c SeamIndexFlag reference a vertex of the last
+ * slice of the previous slab and are resolved when the slabs are merged.
+ */
+struct MarchingCubesSlab {
+	int32_t startZ = 0;
+	int32_t endZ = 0; // exclusive
+	VertexArray vertices;
+	NormalArray normals;
+	IndexArray indices;
+	// the vertex indices of the last slice - used to resolve the seam indices of the next slab
+	core::DynamicArray<glm::uvec3> lastSliceIndices;
+};
+
+static constexpr IndexType InvalidIndex = 0xFFFFFFFFu;
+static constexpr IndexType SeamIndexFlag = 1u << 31;
+// a slab should at least have this amount of slices - each slab has to compute the cell indices of one additional slice
+static constexpr int32_t MinSlabDepth = 32;
+// smaller regions (like the chunks of the renderer) are not worth to be split
+static constexpr int64_t MinParallelVoxels = 128 * 128 * 128;
+
+/**
+ * @brief Classifies the voxels of one row of the region - @c 128 for air, @c 0 otherwise.
+ *
+ * The voxels inside the volume are read straight from the volume memory in a loop without branches that the compiler
+ * vectorizes. Positions outside of the volume get the classification of the border voxel.
+ */
+static void classifyRow(const RawVolume *volume, int32_t lowerX, int32_t y, int32_t z, uint8_t *out, int32_t w) {
+	const Region &volumeRegion = volume->region();
+	const uint8_t borderAir = isAir(volume->borderValue().getMaterial()) ? 128 : 0;
+	int32_t inStart = w;
+	int32_t inEnd = w;
+	if (y >= volumeRegion.getLowerY() && y <= volumeRegion.getUpperY() && z >= volumeRegion.getLowerZ() &&
+		z <= volumeRegion.getUpperZ()) {
+		inStart = glm::clamp(volumeRegion.getLowerX() - lowerX, 0, w);
+		inEnd = glm::clamp(volumeRegion.getUpperX() + 1 - lowerX, 0, w);
+	}
+	if (inStart >= inEnd) {
+		inStart = inEnd = w;
+	}
+	for (int32_t x = 0; x < inStart; ++x) {
+		out[x] = borderAir;
+	}
+	if (inStart < inEnd) {
+		const int32_t vw = volumeRegion.getWidthInVoxels();
+		const int32_t vh = volumeRegion.getHeightInVoxels();
+		const size_t offset = (size_t)(lowerX + inStart - volumeRegion.getLowerX()) +
+							  (size_t)(y - volumeRegion.getLowerY()) * vw +
+							  (size_t)(z - volumeRegion.getLowerZ()) * vw * vh;
+		const Voxel *src = (const Voxel *)volume->data() + offset;
+		uint8_t *dst = out + inStart;
+		const int32_t n = inEnd - inStart;
+		for (int32_t i = 0; i < n; ++i) {
+			dst[i] = isAir(src[i].getMaterial()) ? 128 : 0;
+		}
+	}
+	for (int32_t x = inEnd; x < w; ++x) {
+		out[x] = borderAir;
+	}
+}
+
 static void generateVertex(math::Axis axis, const palette::Palette &palette, RawVolume::Sampler &sampler,
-				   ChunkMesh *result, core::Array2DView<glm::ivec3> &indicesView,
+				   MarchingCubesSlab &slab, core::Array2DView<glm::uvec3> &indicesView,
 				   const Voxel &v111, const glm::vec3 &n111, float v111Density, int x, int y) {
 	sampler.moveNegative(axis);
 	const Voxel v110 = sampler.voxel();
@@ -88,23 +154,26 @@ static void generateVertex(math::Axis axis, const palette::Palette &palette, Raw
 	surfaceVertex.info = 0;
 	surfaceVertex.flags = blendedVoxel.getFlags();
 
-	const IndexType lastVertexIndex = result->mesh[0].addVertex(surfaceVertex);
-	result->mesh[0].setNormal(lastVertexIndex, normal);
-	indicesView.get(x, y)[idx] = (int)lastVertexIndex;
+	const IndexType lastVertexIndex = (IndexType)slab.vertices.size();
+	slab.vertices.push_back(surfaceVertex);
+	slab.normals.push_back(normal);
+	indicesView.get(x, y)[idx] = lastVertexIndex;
 
 	sampler.movePositive(axis);
 }
 
-void extractMarchingCubesMesh(const RawVolume *volume, const palette::Palette &palette, const Region &region, ChunkMesh *result, bool optimize) {
-	core_assert_msg(volume != nullptr, "Provided volume cannot be null");
-	core_assert_msg(result != nullptr, "Provided mesh cannot be null");
-
-	result->clear();
-
+/**
+ * @brief Extracts the slices [startZ, endZ) of the region
+ *
+ * The cell indices of a slice depend on the previous slice - a slab that doesn't start at the beginning of the region
+ * computes the cell indices of the slice in front of it, but doesn't generate any vertices for it. The vertices of
+ * that slice belong to the previous slab and are referenced by seam indices.
+ */
+static void extractSlab(const RawVolume *volume, const palette::Palette &palette, const Region &region,
+						MarchingCubesSlab &slab) {
 	// Store some commonly used values for performance and convenience
 	const int32_t w = region.getWidthInVoxels();
 	const int32_t h = region.getHeightInVoxels();
-	const int32_t d = region.getDepthInVoxels();
 
 	// A naive implementation of Marching Cubes might sample the eight corner voxels of every cell to determine the cell
 	// index. However, when processing the cells sequentially we can observe that many of the voxels are shared with
@@ -114,26 +183,35 @@ void extractMarchingCubesMesh(const RawVolume *volume, const palette::Palette &p
 	core::DynamicArray<uint8_t> previousRowCellIndices(w);
 	core::DynamicArray<uint8_t> previousSliceCellIndicesBuf((size_t)(w * h));
 	core::Array2DView<uint8_t> previousSliceCellIndicesView(previousSliceCellIndicesBuf.data(), w, h);
+	// the air classification of the voxels of the current row
+	core::DynamicArray<uint8_t> rowAir(w);
 
 	// A given vertex may be shared by multiple triangles, so we need to keep track of the indices into the vertex
 	// array.
-	core::DynamicArray<glm::ivec3> indicesBuf((size_t)(w * h));
-	core::DynamicArray<glm::ivec3> previousIndicesBuf((size_t)(w * h));
+	core::DynamicArray<glm::uvec3> indicesBuf((size_t)(w * h));
+	core::DynamicArray<glm::uvec3> previousIndicesBuf((size_t)(w * h));
+
+	const int32_t firstZ = slab.startZ > 0 ? slab.startZ - 1 : 0;
 
 	// A sampler pointing at the beginning of the region, which gets incremented to always point at the beginning of a
 	// slice.
 	RawVolume::Sampler startOfSlice(volume);
-	startOfSlice.setPosition(region.getLowerCorner());
+	startOfSlice.setPosition(region.getLowerX(), region.getLowerY(), region.getLowerZ() + firstZ);
+
+	for (int32_t z = firstZ; z < slab.endZ; z++) {
+		// the slice in front of the slab only provides the cell indices
+		const bool seamSlice = z < slab.startZ;
 
-	for (int32_t z = 0; z < d; z++) {
 		// A sampler pointing at the beginning of the slice, which gets incremented to always point at the beginning of
 		// a row.
 		RawVolume::Sampler startOfRow = startOfSlice;
 
-		core::Array2DView<glm::ivec3> indicesView(indicesBuf.data(), w, h);
-		core::Array2DView<glm::ivec3> previousIndicesView(previousIndicesBuf.data(), w, h);
+		core::Array2DView<glm::uvec3> indicesView(indicesBuf.data(), w, h);
+		core::Array2DView<glm::uvec3> previousIndicesView(previousIndicesBuf.data(), w, h);
 
 		for (int32_t y = 0; y < h; y++) {
+			classifyRow(volume, region.getLowerX(), region.getLowerY() + y, region.getLowerZ() + z, rowAir.data(), w);
+
 			// Copying a sampler which is already pointing at the correct location seems (slightly) faster than
 			// calling setPosition(). Therefore we make use of 'startOfRow' and 'startOfSlice' to reset the sampler.
 			RawVolume::Sampler sampler = startOfRow;
@@ -141,13 +219,7 @@ void extractMarchingCubesMesh(const RawVolume *volume, const palette::Palette &p
 			for (int32_t x = 0; x < w; x++) {
 				// Note: In many cases the provided region will be (mostly) empty which means mesh vertices/indices
 				// are not generated and the only thing that is done for each cell is the computation of "cellIndex".
-				// It appears that retrieving the voxel value is not so expensive and that it is the bitwise combining
-				// which actually carries the cost.
-				//
-				// If we really need to speed this up more then it may be possible to pack 4 8-bit cell indices into
-				// a single 32-bit value and then perform the bitwise logic on all four of them at the same time.
-				// However, this complicates the code and there would still be the cost of packing/unpacking so it's
-				// not clear if there is really a benefit. It's something to consider in the future.
+				// The voxels of the row are already classified - what's left is the bitwise combining.
 
 				// Each bit of the cell index specifies whether a given corner of the cell is above or below the
 				// threshold.
@@ -175,10 +247,7 @@ void extractMarchingCubesMesh(const RawVolume *volume, const palette::Palette &p
 
 				// The last bit of our cube index is obtained by looking
 				// at the relevant voxel and comparing it to the threshold
-				const Voxel v111 = sampler.voxel();
-				if (convertToDensity(v111) < DensityThreshold) {
-					cellIndex |= 128;
-				}
+				cellIndex |= rowAir[x];
 
 				// The current value becomes the previous value, ready for the next iteration.
 				previousCellIndex = cellIndex;
@@ -194,7 +263,8 @@ void extractMarchingCubesMesh(const RawVolume *volume, const palette::Palette &p
 				// empty volume) it still incurs significant overhead, probably because the code is large and bloats the
 				// for loop which contains it. On my empty volume test case the code as given runs in 34ms, but if I
 				// replace the condition with 'false' it runs in 24ms and gives the same output (i.e. none).
-				if (core_unlikely(edge != 0u)) {
+				if (core_unlikely(edge != 0u) && !seamSlice) {
+					const Voxel v111 = sampler.voxel();
 					const float v111Density = convertToDensity(v111);
 
 					// Performance note: Computing normals is one of the bottlenecks in the mesh generation process. The
@@ -207,19 +277,22 @@ void extractMarchingCubesMesh(const RawVolume *volume, const palette::Palette &p
 
 					/* Find the vertices where the surface intersects the cube */
 					if ((edge & 64) && x > 0) {
-						generateVertex(math::Axis::X, palette, sampler, result, indicesView, v111, n111, v111Density, x, y);
+						generateVertex(math::Axis::X, palette, sampler, slab, indicesView, v111, n111, v111Density, x, y);
 					}
 					if ((edge & 32) && y > 0) {
-						generateVertex(math::Axis::Y, palette, sampler, result, indicesView, v111, n111, v111Density, x, y);
+						generateVertex(math::Axis::Y, palette, sampler, slab, indicesView, v111, n111, v111Density, x, y);
 					}
 					if ((edge & 1024) && z > 0) {
-						generateVertex(math::Axis::Z, palette, sampler, result, indicesView, v111, n111, v111Density, x, y);
+						generateVertex(math::Axis::Z, palette, sampler, slab, indicesView, v111, n111, v111Density, x, y);
 					}
 
 					// Now output the indices. For the first row, column or slice there aren't
 					// any (the region size in cells is one less than the region size in voxels)
 					if (x != 0 && y != 0 && z != 0) {
-						int32_t indlist[12] { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+						IndexType indlist[12];
+						for (int i = 0; i < lengthof(indlist); ++i) {
+							indlist[i] = InvalidIndex;
+						}
 
 						/* Find the vertices where the surface intersects the cube */
 						if (edge & 1) {
@@ -260,12 +333,14 @@ void extractMarchingCubesMesh(const RawVolume *volume, const palette::Palette &p
 						}
 
 						for (int i = 0; triTable[cellIndex][i] != -1; i += 3) {
-							const int32_t ind0 = indlist[triTable[cellIndex][i + 0]];
-							const int32_t ind1 = indlist[triTable[cellIndex][i + 1]];
-							const int32_t ind2 = indlist[triTable[cellIndex][i + 2]];
-
-							if (ind0 != -1 && ind1 != -1 && ind2 != -1) {
-								result->mesh[0].addTriangle(ind0, ind1, ind2);
+							const IndexType ind0 = indlist[triTable[cellIndex][i + 0]];
+							const IndexType ind1 = indlist[triTable[cellIndex][i + 1]];
+							const IndexType ind2 = indlist[triTable[cellIndex][i + 2]];
+
+							if (ind0 != InvalidIndex && ind1 != InvalidIndex && ind2 != InvalidIndex) {
+								slab.indices.push_back(ind0);
+								slab.indices.push_back(ind1);
+								slab.indices.push_back(ind2);
 							}
 						}
 					}
@@ -276,7 +351,100 @@ void extractMarchingCubesMesh(const RawVolume *volume, const palette::Palette &p
 		}
 		startOfSlice.movePositiveZ();
 
-		core::exchange(indicesBuf, previousIndicesBuf);
+		if (seamSlice) {
+			// the x and y vertices of the seam slice are owned by the previous slab - the cell and the axis are
+			// encoded into the index
+			for (size_t i = 0; i < previousIndicesBuf.size(); ++i) {
+				const IndexType seamIndex = SeamIndexFlag | (IndexType)(i * 2);
+				previousIndicesBuf[i] = glm::uvec3(seamIndex, seamIndex + 1, InvalidIndex);
+			}
+		} else {
+			core::exchange(indicesBuf, previousIndicesBuf);
+		}
+	}
+	core::exchange(slab.lastSliceIndices, previousIndicesBuf);
+}
+
+static int slabCount(const Region &region) {
+	const int32_t d = region.getDepthInVoxels();
+	const int64_t voxels = (int64_t)region.getWidthInVoxels() * region.getHeightInVoxels() * d;
+	if (d < 2 * MinSlabDepth || voxels < MinParallelVoxels) {
+		return 1;
+	}
+	return (int)core_min((uint32_t)(d / MinSlabDepth), core::cpus());
+}
+
+void extractMarchingCubesMesh(const RawVolume *volume, const palette::Palette &palette, const Region &region,
+							  ChunkMesh *result, bool optimize, int slabs) {
+	core_assert_msg(volume != nullptr, "Provided volume cannot be null");
+	core_assert_msg(result != nullptr, "Provided mesh cannot be null");
+
+	result->clear();
+
+	const int32_t d = region.getDepthInVoxels();
+	if (slabs <= 0) {
+		slabs = slabCount(region);
+	}
+	slabs = glm::clamp(slabs, 1, d);
+
+	core::DynamicArray<MarchingCubesSlab> slabResults(slabs);
+	for (int i = 0; i < slabs; ++i) {
+		slabResults[i].startZ = (int32_t)((int64_t)d * i / slabs);
+		slabResults[i].endZ = (int32_t)((int64_t)d * (i + 1) / slabs);
+	}
+
+	if (slabs == 1) {
+		extractSlab(volume, palette, region, slabResults[0]);
+	} else {
+		// one slab per block - the calling thread takes part in the extraction
+		app::for_parallel(
+			0, slabs,
+			[&](int start, int end) {
+				for (int i = start; i < end; ++i) {
+					extractSlab(volume, palette, region, slabResults[i]);
+				}
+			},
+			1);
+	}
+
+	// merge the slabs in order - this gives the same vertex and index order as a serial extraction
+	Mesh &mesh = result->mesh[0];
+	if (slabs == 1) {
+		core::exchange(mesh.getVertexVector(), slabResults[0].vertices);
+		core::exchange(mesh.getNormalVector(), slabResults[0].normals);
+		core::exchange(mesh.getIndexVector(), slabResults[0].indices);
+	} else {
+		size_t vertexCount = 0;
+		size_t indexCount = 0;
+		for (const MarchingCubesSlab &slab : slabResults) {
+			vertexCount += slab.vertices.size();
+			indexCount += slab.indices.size();
+		}
+		VertexArray &vertices = mesh.getVertexVector();
+		NormalArray &normals = mesh.getNormalVector();
+		IndexArray &indices = mesh.getIndexVector();
+		vertices.reserve(vertexCount);
+		normals.reserve(vertexCount);
+		indices.reserve(indexCount);
+		IndexType previousOffset = 0;
+		for (int i = 0; i < slabs; ++i) {
+			const MarchingCubesSlab &slab = slabResults[i];
+			const IndexType offset = (IndexType)vertices.size();
+			vertices.append(slab.vertices.data(), slab.vertices.size());
+			normals.append(slab.normals.data(), slab.normals.size());
+			for (IndexType index : slab.indices) {
+				if (index & SeamIndexFlag) {
+					// weld the seam - use the vertex that was created by the previous slab
+					core_assert(i > 0);
+					const IndexType seam = index & ~SeamIndexFlag;
+					const glm::uvec3 &cell = slabResults[i - 1].lastSliceIndices[seam / 2];
+					indices.push_back(previousOffset + cell[seam % 2]);
+				} else {
+					indices.push_back(offset + index);
+				}
+			}
+			previousOffset = offset;
+		}
 	}
 
 	if (optimize) {
@@ -14,8 +14,16 @@ class RawVolume;
 class Region;
 struct ChunkMesh;
 
-// Also known as: "3D Contouring", "Marching Cubes", "Surface Reconstruction"
+/**
+ * @brief Also known as: "3D Contouring", "Marching Cubes", "Surface Reconstruction"
+ *
+ * Large regions are split into slabs along the z axis that are extracted in parallel. The vertices on the seam
+ * between two slabs are only created once by the lower slab and are referenced by the upper one - the result is the
+ * same as for a serial extraction.
+ *
+ * @param slabs The amount of slabs - @c 0 picks the amount based on the region size and the available cores
+ */
 void extractMarchingCubesMesh(const RawVolume *volume, const palette::Palette &palette, const Region &region,
-							  ChunkMesh *result, bool optimize);
+							  ChunkMesh *result, bool optimize, int slabs = 0);
 
 } // namespace voxel
@@ -0,0 +1,128 @@
+/**
+ * @file
+ */
+
+#include "voxel/PaletteVolume.h"
+#include "app/tests/AbstractTest.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Region.h"
+#include "voxel/Voxel.h"
+#include "voxelutil/VolumeVisitor.h"
+
+namespace voxel {
+
+class PaletteVolumeTest : public app::AbstractTest {};
+
+TEST_F(PaletteVolumeTest, testSetVoxels) {
+	PaletteVolume v(Region(0, 10));
+	EXPECT_TRUE(v.isAir(0, 0, 0));
+	ASSERT_TRUE(v.setVoxel(0, 0, 0, createVoxel(VoxelType::Generic, 42)));
+	ASSERT_TRUE(v.setVoxel(10, 10, 10, createVoxel(VoxelType::Transparent, 255)));
+	ASSERT_FALSE(v.setVoxel(11, 11, 11, createVoxel(VoxelType::Generic, 0)));
+	EXPECT_TRUE(v.voxel(0, 0, 0).isSame(createVoxel(VoxelType::Generic, 42)));
+	EXPECT_TRUE(v.voxel(10, 10, 10).isSame(createVoxel(VoxelType::Transparent, 255)));
+	EXPECT_EQ(42, v.colorIndex(0, 0, 0));
+	EXPECT_FALSE(v.isAir(0, 0, 0));
+	EXPECT_TRUE(v.isAir(1, 0, 0));
+	EXPECT_EQ(VoxelType::Air, v.voxel(11, 11, 11).getMaterial()) << "Expected the border voxel";
+	EXPECT_EQ(0u, v.extendedVoxels());
+	ASSERT_TRUE(v.setVoxel(0, 0, 0, Voxel()));
+	EXPECT_TRUE(v.isAir(0, 0, 0));
+}
+
+TEST_F(PaletteVolumeTest, testExtendedVoxels) {
+	PaletteVolume v(Region(0, 3));
+	const Voxel normal = createVoxel(VoxelType::Generic, 1, 17);
+	const Voxel noNormal(VoxelType::Generic, 2);
+	Voxel flags = createVoxel(VoxelType::Generic, 3);
+	flags.setOutline();
+	ASSERT_TRUE(v.setVoxel(0, 0, 0, normal));
+	ASSERT_TRUE(v.setVoxel(1, 0, 0, noNormal));
+	ASSERT_TRUE(v.setVoxel(2, 0, 0, flags));
+	EXPECT_EQ(2u, v.extendedVoxels()) << "Voxels without a normal must use the compact encoding";
+	EXPECT_TRUE(v.voxel(0, 0, 0).isSame(normal));
+	EXPECT_TRUE(v.voxel(1, 0, 0).isSame(noNormal));
+	EXPECT_EQ(NO_NORMAL, v.voxel(1, 0, 0).getNormal());
+	EXPECT_EQ(flags.getFlags(), v.voxel(2, 0, 0).getFlags());
+	EXPECT_EQ(2, v.colorIndex(1, 0, 0));
+
+	ASSERT_TRUE(v.setVoxel(0, 0, 0, createVoxel(VoxelType::Generic, 1)));
+	ASSERT_TRUE(v.setVoxel(1, 0, 0, Voxel()));
+	EXPECT_EQ(1u, v.extendedVoxels()) << "Overwritten voxels must be removed from the side channel";
+	EXPECT_EQ(0, v.voxel(0, 0, 0).getNormal());
+	EXPECT_LT(v.bytes(), (size_t)(v.width() * v.height() * v.depth()) * sizeof(Voxel));
+}
+
+TEST_F(PaletteVolumeTest, testCopyFromRawVolume) {
+	const Region region(-2, 5);
+	RawVolume rv(region);
+	int voxels = 0;
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				if ((x + y + z) % 3 == 0) {
+					rv.setVoxel(x, y, z, createVoxel(VoxelType::Generic, (uint8_t)(x * y * z), (uint8_t)(x & 1)));
+					++voxels;
+				}
+			}
+		}
+	}
+	PaletteVolume *v = PaletteVolume::create(rv);
+	ASSERT_NE(nullptr, v);
+	EXPECT_EQ(region, v->region());
+
+	int visited = 0;
+	voxelutil::visitVolume(*v, [&](int x, int y, int z, const Voxel &voxel) {
+		EXPECT_TRUE(rv.voxel(x, y, z).isSame(voxel)) << x << ":" << y << ":" << z;
+		++visited;
+	});
+	EXPECT_EQ(voxels, visited);
+
+	RawVolume copy(region);
+	v->copyTo(copy);
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				ASSERT_TRUE(rv.voxel(x, y, z).isSame(copy.voxel(x, y, z))) << x << ":" << y << ":" << z;
+			}
+		}
+	}
+	delete v;
+}
+
+TEST_F(PaletteVolumeTest, testSampler) {
+	const Region region(0, 7);
+	PaletteVolume v(region);
+	v.setVoxel(1, 1, 1, createVoxel(VoxelType::Generic, 1));
+	v.setVoxel(2, 1, 1, createVoxel(VoxelType::Generic, 2));
+	v.setVoxel(1, 2, 1, createVoxel(VoxelType::Generic, 3));
+	v.setVoxel(1, 1, 2, createVoxel(VoxelType::Generic, 4));
+
+	PaletteVolume::Sampler sampler(v);
+	ASSERT_TRUE(sampler.setPosition(1, 1, 1));
+	EXPECT_EQ(1, sampler.voxel().getColor());
+	EXPECT_EQ(2, sampler.peekVoxel1px0py0pz().getColor());
+	EXPECT_EQ(3, sampler.peekVoxel0px1py0pz().getColor());
+	EXPECT_EQ(4, sampler.peekVoxel0px0py1pz().getColor());
+	EXPECT_EQ(VoxelType::Air, sampler.peekVoxel1nx0py0pz().getMaterial());
+	sampler.movePositiveX();
+	EXPECT_EQ(2, sampler.voxel().getColor());
+	sampler.moveNegativeX();
+	sampler.movePositiveY();
+	EXPECT_EQ(3, sampler.voxel().getColor());
+	sampler.moveNegativeY();
+	sampler.movePositiveZ();
+	EXPECT_EQ(4, sampler.voxel().getColor());
+
+	ASSERT_FALSE(sampler.setPosition(-1, 1, 2));
+	EXPECT_FALSE(sampler.currentPositionValid());
+	sampler.movePositiveX(2);
+	EXPECT_TRUE(sampler.currentPositionValid());
+	EXPECT_EQ(4, sampler.voxel().getColor());
+
+	ASSERT_TRUE(sampler.setVoxel(createVoxel(VoxelType::Generic, 5, 3)));
+	EXPECT_EQ(5, v.voxel(1, 1, 2).getColor());
+	EXPECT_EQ(3, v.voxel(1, 1, 2).getNormal());
+}
+
+} // namespace voxel
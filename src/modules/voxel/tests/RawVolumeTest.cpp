@@ -245,4 +245,67 @@ TEST_F(RawVolumeTest, testFullSamplerLoop) {
 	}
 }
 
+TEST_F(RawVolumeTest, testCopyOnWrite) {
+	const Region region(0, 7);
+	RawVolume v(region);
+	v.setVoxel(1, 1, 1, createVoxel(VoxelType::Generic, 1));
+	EXPECT_FALSE(v.isShared());
+
+	RawVolume copy(v);
+	EXPECT_TRUE(v.isShared());
+	EXPECT_TRUE(copy.isShared());
+	EXPECT_EQ(v.data(), copy.data()) << "The data should be shared until it is modified";
+
+	copy.setVoxel(2, 2, 2, createVoxel(VoxelType::Generic, 2));
+	EXPECT_FALSE(v.isShared());
+	EXPECT_FALSE(copy.isShared());
+	EXPECT_NE(v.data(), copy.data());
+	EXPECT_EQ(VoxelType::Air, v.voxel(2, 2, 2).getMaterial()) << "The source volume must not be modified";
+	EXPECT_EQ(2, copy.voxel(2, 2, 2).getColor());
+	EXPECT_EQ(1, copy.voxel(1, 1, 1).getColor());
+}
+
+TEST_F(RawVolumeTest, testCopyOnWriteSampler) {
+	const Region region(0, 7);
+	RawVolume v(region);
+	RawVolume::Sampler sampler(v);
+	ASSERT_TRUE(sampler.setPosition(1, 1, 1));
+	{
+		RawVolume snapshot(&v);
+		ASSERT_TRUE(sampler.setVoxel(createVoxel(VoxelType::Generic, 1)));
+		EXPECT_EQ(VoxelType::Air, snapshot.voxel(1, 1, 1).getMaterial());
+		sampler.movePositiveX();
+		ASSERT_TRUE(sampler.setVoxel(createVoxel(VoxelType::Generic, 2)));
+		EXPECT_EQ(VoxelType::Air, snapshot.voxel(2, 1, 1).getMaterial());
+	}
+	EXPECT_EQ(1, v.voxel(1, 1, 1).getColor());
+	EXPECT_EQ(2, v.voxel(2, 1, 1).getColor());
+
+	// a sampler that was created before the data was detached by another write
+	RawVolume::Sampler stale(v);
+	ASSERT_TRUE(stale.setPosition(3, 1, 1));
+	RawVolume snapshot(v);
+	v.setVoxel(0, 0, 0, createVoxel(VoxelType::Generic, 3));
+	ASSERT_TRUE(stale.setVoxel(createVoxel(VoxelType::Generic, 4)));
+	EXPECT_EQ(4, v.voxel(3, 1, 1).getColor());
+	EXPECT_EQ(VoxelType::Air, snapshot.voxel(3, 1, 1).getMaterial());
+}
+
+TEST_F(RawVolumeTest, testCopyOnWriteSamplerRead) {
+	const Region region(0, 7);
+	RawVolume v(region);
+	RawVolume::Sampler sampler(v);
+	ASSERT_TRUE(sampler.setPosition(1, 1, 1));
+	{
+		// the write detaches the volume - the old data is freed together with the snapshot
+		RawVolume snapshot(v);
+		v.setVoxel(1, 1, 1, createVoxel(VoxelType::Generic, 1));
+		v.setVoxel(2, 1, 1, createVoxel(VoxelType::Generic, 2));
+	}
+	// reading through the sampler without moving it must see the data of the detached volume
+	EXPECT_EQ(1, sampler.voxel().getColor());
+	EXPECT_EQ(2, sampler.peekVoxel1px0py0pz().getColor());
+	EXPECT_EQ(VoxelType::Air, sampler.peekVoxel1nx0py0pz().getMaterial());
+}
+
 }
@@ -6,6 +6,8 @@
 #include "app/tests/AbstractTest.h"
 #include "voxel/ChunkMesh.h"
 #include "voxel/RawVolume.h"
+#include "voxel/private/MarchingCubesSurfaceExtractor.h"
+#include "palette/Palette.h"
 
 namespace voxel {
 
@@ -133,4 +135,48 @@ TEST_F(SurfaceExtractorTest, testMeshExtractionIssue445) {
 	EXPECT_EQ(8, (int)mesh.mesh[0].getNoOfVertices());
 }
 
+TEST_F(SurfaceExtractorTest, testMarchingCubesSlabs) {
+	palette::Palette pal;
+	pal.nippon();
+	const voxel::Region volumeRegion(0, 0, 0, 39, 29, 69);
+	voxel::RawVolume v(volumeRegion);
+	uint32_t seed = 42u;
+	for (int z = 0; z <= volumeRegion.getUpperZ(); ++z) {
+		for (int y = 0; y <= volumeRegion.getUpperY(); ++y) {
+			for (int x = 0; x <= volumeRegion.getUpperX(); ++x) {
+				seed = seed * 1664525u + 1013904223u;
+				if ((seed >> 24) < 100u) {
+					v.setVoxel(x, y, z, voxel::createVoxel(pal, (seed >> 8) & 0xFF));
+				}
+			}
+		}
+	}
+	// the extraction region reaches outside of the volume
+	voxel::Region region = volumeRegion;
+	region.grow(1);
+
+	voxel::ChunkMesh serial;
+	voxel::extractMarchingCubesMesh(&v, pal, region, &serial, false, 1);
+	ASSERT_GT(serial.mesh[0].getNoOfIndices(), 0u);
+
+	for (int slabs : {2, 5, 7}) {
+		voxel::ChunkMesh mesh;
+		voxel::extractMarchingCubesMesh(&v, pal, region, &mesh, false, slabs);
+		const voxel::Mesh &expected = serial.mesh[0];
+		const voxel::Mesh &actual = mesh.mesh[0];
+		ASSERT_EQ(expected.getNoOfVertices(), actual.getNoOfVertices()) << "slabs: " << slabs;
+		ASSERT_EQ(expected.getNoOfIndices(), actual.getNoOfIndices()) << "slabs: " << slabs;
+		for (size_t i = 0; i < expected.getNoOfVertices(); ++i) {
+			const voxel::VoxelVertex &e = expected.getVertexVector()[i];
+			const voxel::VoxelVertex &a = actual.getVertexVector()[i];
+			ASSERT_EQ(e.position, a.position) << "slabs: " << slabs << ", vertex: " << i;
+			ASSERT_EQ(e.colorIndex, a.colorIndex) << "slabs: " << slabs << ", vertex: " << i;
+			ASSERT_EQ(expected.getNormalVector()[i], actual.getNormalVector()[i]) << "slabs: " << slabs;
+		}
+		for (size_t i = 0; i < expected.getNoOfIndices(); ++i) {
+			ASSERT_EQ(expected.getIndexVector()[i], actual.getIndexVector()[i]) << "slabs: " << slabs << ", index: " << i;
+		}
+	}
+}
+
 } // namespace voxel
@@ -0,0 +1,364 @@
+/**
+ * @file
+ */
+
+#include "CollectionIndex.h"
+#include "core/FourCC.h"
+#include "core/Log.h"
+#include "core/collection/StringSet.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/FilesystemEntry.h"
+#include "io/Stream.h"
+#include "palette/Palette.h"
+#include "voxelformat/Format.h"
+
+namespace voxelcollection {
+
+#define wrap(read)                                                                                                     \
+	if ((read) != 0) {                                                                                                 \
+		Log::debug("Error: " CORE_STRINGIFY(read) " at " CORE_FILE ":%i", CORE_LINE);                               \
+		reset(localDir);                                                                                               \
+		return false;                                                                                                  \
+	}
+
+#define wrapBool(write)                                                                                                \
+	if (!(write)) {                                                                                                    \
+		Log::debug("Error: " CORE_STRINGIFY(write) " at " CORE_FILE ":%i", CORE_LINE);                              \
+		return false;                                                                                                  \
+	}
+
+namespace priv {
+
+static constexpr uint32_t Magic = FourCC('V', 'C', 'I', 'X');
+
+/**
+ * @brief The fixed-size record as it is stored in the index file
+ */
+struct IndexRecord {
+	uint32_t pathOffset;
+	uint32_t pathLength;
+	uint64_t mtime;
+	uint64_t size;
+	uint32_t flags;
+	int32_t dimensions[3];
+	int32_t nodeCount;
+	int32_t paletteIndex;
+	uint32_t thumbnailOffset;
+	uint32_t thumbnailLength;
+	uint32_t reserved[2];
+};
+static_assert(sizeof(IndexRecord) == 64, "Unexpected index record size");
+
+static uint32_t addString(core::String &stringTable, const core::String &str) {
+	const uint32_t offset = (uint32_t)stringTable.size();
+	stringTable += str;
+	return offset;
+}
+
+} // namespace priv
+
+void CollectionIndex::reset(const core::String &localDir) {
+	core::ScopedLock scoped(_lock);
+	_localDir = localDir;
+	_entries.clear();
+	_palettes.clear();
+	_dirty = false;
+}
+
+bool CollectionIndex::load(io::SeekableReadStream &in, const core::String &localDir) {
+	reset(localDir);
+	// read the whole file at once - the records are parsed from memory
+	io::BufferedReadWriteStream stream(in, in.size());
+	stream.seek(0);
+
+	uint32_t magic;
+	wrap(stream.readUInt32(magic))
+	if (magic != priv::Magic) {
+		Log::debug("Invalid collection index magic");
+		reset(localDir);
+		return false;
+	}
+	uint32_t version;
+	wrap(stream.readUInt32(version))
+	if (version != Version) {
+		Log::debug("Collection index version %u is outdated - expected %u", version, Version);
+		reset(localDir);
+		return false;
+	}
+	uint32_t entryCount;
+	wrap(stream.readUInt32(entryCount))
+	uint32_t paletteCount;
+	wrap(stream.readUInt32(paletteCount))
+	uint32_t stringTableSize;
+	wrap(stream.readUInt32(stringTableSize))
+	uint32_t localDirOffset;
+	wrap(stream.readUInt32(localDirOffset))
+	uint32_t localDirLength;
+	wrap(stream.readUInt32(localDirLength))
+
+	const int64_t stringTablePos = stream.pos() + (int64_t)entryCount * (int64_t)sizeof(priv::IndexRecord) +
+								   (int64_t)paletteCount * (int64_t)(sizeof(uint64_t) + sizeof(uint32_t) * 257);
+	if (stringTablePos + stringTableSize > stream.size()) {
+		Log::warn("Collection index is truncated");
+		reset(localDir);
+		return false;
+	}
+	const char *strings = (const char *)stream.getBuffer() + stringTablePos;
+	auto str = [strings, stringTableSize](uint32_t offset, uint32_t length) {
+		if (offset + length > stringTableSize) {
+			return core::String();
+		}
+		return core::String(strings + offset, length);
+	};
+	if (str(localDirOffset, localDirLength) != localDir) {
+		Log::debug("Collection index was written for a different directory");
+		reset(localDir);
+		return false;
+	}
+
+	core::ScopedLock scoped(_lock);
+	for (uint32_t i = 0; i < entryCount; ++i) {
+		priv::IndexRecord record;
+		wrap(stream.readUInt32(record.pathOffset))
+		wrap(stream.readUInt32(record.pathLength))
+		wrap(stream.readUInt64(record.mtime))
+		wrap(stream.readUInt64(record.size))
+		wrap(stream.readUInt32(record.flags))
+		for (int j = 0; j < 3; ++j) {
+			wrap(stream.readInt32(record.dimensions[j]))
+		}
+		wrap(stream.readInt32(record.nodeCount))
+		wrap(stream.readInt32(record.paletteIndex))
+		wrap(stream.readUInt32(record.thumbnailOffset))
+		wrap(stream.readUInt32(record.thumbnailLength))
+		for (int j = 0; j < 2; ++j) {
+			wrap(stream.readUInt32(record.reserved[j]))
+		}
+
+		CollectionIndexEntry entry;
+		entry.path = str(record.pathOffset, record.pathLength);
+		if (entry.path.empty()) {
+			continue;
+		}
+		entry.mtime = record.mtime;
+		entry.size = record.size;
+		entry.flags = record.flags;
+		entry.dimensions = glm::ivec3(record.dimensions[0], record.dimensions[1], record.dimensions[2]);
+		entry.nodeCount = record.nodeCount;
+		entry.paletteIndex = record.paletteIndex < (int32_t)paletteCount ? record.paletteIndex : -1;
+		entry.thumbnail = str(record.thumbnailOffset, record.thumbnailLength);
+		_entries.put(entry.path, entry);
+	}
+	_palettes.resize(paletteCount);
+	for (uint32_t i = 0; i < paletteCount; ++i) {
+		IndexPalette &p = _palettes[i];
+		wrap(stream.readUInt64(p.hash))
+		uint32_t colorCount;
+		wrap(stream.readUInt32(colorCount))
+		p.colorCount = (int)colorCount;
+		for (int j = 0; j < lengthof(p.colors); ++j) {
+			wrap(stream.readUInt32(p.colors[j]))
+		}
+	}
+	Log::debug("Loaded %i entries and %i palettes from the collection index", (int)_entries.size(),
+			   (int)_palettes.size());
+	return true;
+}
+
+bool CollectionIndex::save(io::SeekableWriteStream &out) {
+	core::ScopedLock scoped(_lock);
+	core::String stringTable;
+	const uint32_t localDirOffset = priv::addString(stringTable, _localDir);
+
+	io::BufferedReadWriteStream stream((int64_t)(28 + _entries.size() * sizeof(priv::IndexRecord)));
+	wrapBool(stream.writeUInt32(priv::Magic))
+	wrapBool(stream.writeUInt32(Version))
+	wrapBool(stream.writeUInt32((uint32_t)_entries.size()))
+	wrapBool(stream.writeUInt32((uint32_t)_palettes.size()))
+	// the string table size is patched after the records were written
+	const int64_t stringTableSizePos = stream.pos();
+	wrapBool(stream.writeUInt32(0u))
+	wrapBool(stream.writeUInt32(localDirOffset))
+	wrapBool(stream.writeUInt32((uint32_t)_localDir.size()))
+
+	for (const auto &e : _entries) {
+		const CollectionIndexEntry &entry = e->value;
+		wrapBool(stream.writeUInt32(priv::addString(stringTable, entry.path)))
+		wrapBool(stream.writeUInt32((uint32_t)entry.path.size()))
+		wrapBool(stream.writeUInt64(entry.mtime))
+		wrapBool(stream.writeUInt64(entry.size))
+		wrapBool(stream.writeUInt32(entry.flags))
+		for (int j = 0; j < 3; ++j) {
+			wrapBool(stream.writeInt32(entry.dimensions[j]))
+		}
+		wrapBool(stream.writeInt32(entry.nodeCount))
+		wrapBool(stream.writeInt32(entry.paletteIndex))
+		wrapBool(stream.writeUInt32(priv::addString(stringTable, entry.thumbnail)))
+		wrapBool(stream.writeUInt32((uint32_t)entry.thumbnail.size()))
+		wrapBool(stream.writeUInt32(0u))
+		wrapBool(stream.writeUInt32(0u))
+	}
+	for (const IndexPalette &p : _palettes) {
+		wrapBool(stream.writeUInt64(p.hash))
+		wrapBool(stream.writeUInt32((uint32_t)p.colorCount))
+		for (int j = 0; j < lengthof(p.colors); ++j) {
+			wrapBool(stream.writeUInt32(p.colors[j]))
+		}
+	}
+	if (stream.write(stringTable.c_str(), stringTable.size()) != (int)stringTable.size()) {
+		Log::error("Failed to write the string table of the collection index");
+		return false;
+	}
+	stream.seek(stringTableSizePos);
+	wrapBool(stream.writeUInt32((uint32_t)stringTable.size()))
+
+	if (out.write(stream.getBuffer(), stream.size()) != (int)stream.size()) {
+		Log::error("Failed to write the collection index");
+		return false;
+	}
+	_dirty = false;
+	return true;
+}
+
+#undef wrap
+#undef wrapBool
+
+bool CollectionIndex::get(const io::FilesystemEntry &fileEntry, CollectionIndexEntry &entry) const {
+	if (!get(fileEntry.fullPath, entry)) {
+		return false;
+	}
+	return entry.matches(fileEntry.mtime, fileEntry.size);
+}
+
+bool CollectionIndex::get(const core::String &path, CollectionIndexEntry &entry) const {
+	core::ScopedLock scoped(_lock);
+	return _entries.get(path, entry);
+}
+
+bool CollectionIndex::touch(const io::FilesystemEntry &fileEntry) {
+	core::ScopedLock scoped(_lock);
+	auto iter = _entries.find(fileEntry.fullPath);
+	if (iter != _entries.end()) {
+		CollectionIndexEntry &entry = iter->value;
+		if (entry.matches(fileEntry.mtime, fileEntry.size)) {
+			return entry.scanned();
+		}
+	}
+	CollectionIndexEntry entry;
+	entry.path = fileEntry.fullPath;
+	entry.mtime = fileEntry.mtime;
+	entry.size = fileEntry.size;
+	_entries.put(entry.path, entry);
+	_dirty = true;
+	return false;
+}
+
+int CollectionIndex::addPalette(const palette::Palette &palette) {
+	const uint64_t hash = palette.hash();
+	for (int i = 0; i < (int)_palettes.size(); ++i) {
+		const IndexPalette &p = _palettes[i];
+		if (p.hash == hash && p.colorCount == palette.colorCount()) {
+			return i;
+		}
+	}
+	IndexPalette p;
+	p.hash = hash;
+	p.colorCount = palette.colorCount();
+	for (int i = 0; i < palette.colorCount(); ++i) {
+		p.colors[i] = palette.color(i).rgba;
+	}
+	_palettes.push_back(p);
+	return (int)_palettes.size() - 1;
+}
+
+void CollectionIndex::update(const core::String &path, const voxelformat::SceneInfo &info) {
+	voxel::Region region = voxel::Region::InvalidRegion;
+	for (const voxelformat::SceneInfo::Node &node : info.nodes) {
+		if (!node.region.isValid()) {
+			continue;
+		}
+		if (region.isValid()) {
+			region.accumulate(node.region);
+		} else {
+			region = node.region;
+		}
+	}
+	core::ScopedLock scoped(_lock);
+	auto iter = _entries.find(path);
+	if (iter == _entries.end()) {
+		return;
+	}
+	CollectionIndexEntry &entry = iter->value;
+	entry.flags |= CollectionIndexEntry::FlagScanned;
+	entry.nodeCount = info.models();
+	entry.dimensions = region.isValid() ? region.getDimensionsInVoxels() : glm::ivec3(0);
+	entry.paletteIndex = info.hasPalette ? addPalette(info.palette) : -1;
+	_dirty = true;
+}
+
+void CollectionIndex::setThumbnail(const core::String &path, const core::String &thumbnail) {
+	core::ScopedLock scoped(_lock);
+	auto iter = _entries.find(path);
+	if (iter == _entries.end()) {
+		return;
+	}
+	iter->value.thumbnail = thumbnail;
+	_dirty = true;
+}
+
+void CollectionIndex::addFlags(const core::String &path, uint32_t flags) {
+	core::ScopedLock scoped(_lock);
+	auto iter = _entries.find(path);
+	if (iter == _entries.end()) {
+		return;
+	}
+	iter->value.flags |= flags;
+	_dirty = true;
+}
+
+int CollectionIndex::prune(const core::DynamicArray<core::String> &existing) {
+	core::StringSet keep;
+	for (const core::String &path : existing) {
+		keep.insert(path);
+	}
+	core::ScopedLock scoped(_lock);
+	core::DynamicArray<core::String> remove;
+	for (const auto &e : _entries) {
+		if (!keep.has(e->key)) {
+			remove.push_back(e->key);
+		}
+	}
+	for (const core::String &path : remove) {
+		_entries.remove(path);
+	}
+	if (!remove.empty()) {
+		_dirty = true;
+	}
+	return (int)remove.size();
+}
+
+bool CollectionIndex::palette(const CollectionIndexEntry &entry, palette::Palette &palette) const {
+	core::ScopedLock scoped(_lock);
+	if (entry.paletteIndex < 0 || entry.paletteIndex >= (int)_palettes.size()) {
+		return false;
+	}
+	const IndexPalette &p = _palettes[entry.paletteIndex];
+	palette.setSize(p.colorCount);
+	for (int i = 0; i < p.colorCount; ++i) {
+		palette.setColor(i, core::RGBA(p.colors[i]));
+	}
+	palette.markDirty();
+	return true;
+}
+
+bool CollectionIndex::dirty() const {
+	core::ScopedLock scoped(_lock);
+	return _dirty;
+}
+
+int CollectionIndex::size() const {
+	core::ScopedLock scoped(_lock);
+	return (int)_entries.size();
+}
+
+} // namespace voxelcollection
@@ -0,0 +1,146 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/StringMap.h"
+#include "core/concurrent/Lock.h"
+#include <glm/vec3.hpp>
+#include <stdint.h>
+
+namespace io {
+class SeekableReadStream;
+class SeekableWriteStream;
+struct FilesystemEntry;
+} // namespace io
+
+namespace palette {
+class Palette;
+}
+
+namespace voxelformat {
+struct SceneInfo;
+}
+
+namespace voxelcollection {
+
+/**
+ * @brief The cached meta data of a single file in the local collection
+ */
+struct CollectionIndexEntry {
+	enum Flags : uint32_t {
+		/** the meta data (dimensions, palette, nodes) was probed for the current mtime and size */
+		FlagScanned = 1u << 0,
+		/** the file doesn't have an embedded screenshot - don't try to extract it again */
+		FlagNoThumbnail = 1u << 1,
+		/** the file could not get loaded */
+		FlagFailed = 1u << 2
+	};
+
+	core::String path;
+	/** last modification time in millis */
+	uint64_t mtime = 0u;
+	/** file size in bytes */
+	uint64_t size = 0u;
+	uint32_t flags = 0u;
+	/** the dimensions of the accumulated model regions - the node transforms are not taken into account */
+	glm::ivec3 dimensions{0};
+	int nodeCount = 0;
+	/** index into the deduplicated palette table of the index - @c -1 if there is no palette */
+	int paletteIndex = -1;
+	/** the archive path of the cached thumbnail image - empty if there is none */
+	core::String thumbnail;
+
+	inline bool scanned() const {
+		return (flags & FlagScanned) != 0u;
+	}
+
+	inline bool matches(uint64_t fileMtime, uint64_t fileSize) const {
+		return mtime == fileMtime && size == fileSize;
+	}
+};
+
+/**
+ * @brief Persistent index of the local voxel collection directory
+ *
+ * Rescans of the local directory only have to look at files whose modification time or size changed since the index
+ * was written. All other entries reuse the cached meta data and thumbnail reference.
+ *
+ * The file layout is a small header followed by fixed-size little endian records, the deduplicated palette table and
+ * a string table that the records point into via offset and length. This allows to map the file and access the
+ * records without parsing every entry.
+ *
+ * @note The index is thread safe - the scan and the thumbnail jobs update it concurrently.
+ */
+class CollectionIndex {
+public:
+	static constexpr uint32_t Version = 2u;
+
+private:
+	struct IndexPalette {
+		uint64_t hash = 0u;
+		int colorCount = 0;
+		uint32_t colors[256]{};
+	};
+
+	mutable core_trace_mutex(core::Lock, _lock, "CollectionIndex");
+	core::String _localDir;
+	core::StringMap<CollectionIndexEntry, 4096> _entries;
+	core::DynamicArray<IndexPalette> _palettes;
+	bool _dirty = false;
+
+	int addPalette(const palette::Palette &palette);
+
+public:
+	/**
+	 * @brief Removes all entries and binds the index to the given local directory
+	 */
+	void reset(const core::String &localDir);
+	/**
+	 * @brief Reads the index from the given stream. If the index was written for a different local directory or with
+	 * a different version, the index is reset and @c false is returned.
+	 */
+	bool load(io::SeekableReadStream &stream, const core::String &localDir);
+	bool save(io::SeekableWriteStream &stream);
+
+	/**
+	 * @brief Get the cached entry for the given filesystem entry.
+	 * @return @c true if the file wasn't modified since the entry was created and the cached data can get used.
+	 */
+	bool get(const io::FilesystemEntry &fileEntry, CollectionIndexEntry &entry) const;
+	bool get(const core::String &path, CollectionIndexEntry &entry) const;
+	/**
+	 * @brief Remember the modification time and size of the given file. If the file changed since the last scan, the
+	 * cached meta data and thumbnail reference are dropped.
+	 * @return @c true if the entry is up to date, @c false if the file needs a rescan.
+	 */
+	bool touch(const io::FilesystemEntry &fileEntry);
+	/**
+	 * @brief Store the meta data of the given probed scene for the given file.
+	 * @sa voxelformat::probe()
+	 */
+	void update(const core::String &path, const voxelformat::SceneInfo &info);
+	void setThumbnail(const core::String &path, const core::String &thumbnail);
+	void addFlags(const core::String &path, uint32_t flags);
+	/**
+	 * @brief Remove all entries that are not part of the given list of existing paths
+	 * @return The amount of removed entries
+	 */
+	int prune(const core::DynamicArray<core::String> &existing);
+
+	bool palette(const CollectionIndexEntry &entry, palette::Palette &palette) const;
+
+	const core::String &localDir() const;
+	bool dirty() const;
+	int size() const;
+};
+
+inline const core::String &CollectionIndex::localDir() const {
+	return _localDir;
+}
+
+} // namespace voxelcollection
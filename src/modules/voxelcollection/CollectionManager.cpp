@@ -4,10 +4,12 @@
 
 #include "CollectionManager.h"
 #include "app/Async.h"
+#include "core/Hash.h"
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
 #include "core/Var.h"
+#include "core/concurrent/Concurrency.h"
 #include "http/HttpCacheStream.h"
 #include "image/Image.h"
 #include "io/Archive.h"
@@ -23,6 +25,7 @@ namespace voxelcollection {
 CollectionManager::CollectionManager(const io::FilesystemPtr &filesystem, const video::TexturePoolPtr &texturePool)
 	: _texturePool(texturePool), _filesystem(filesystem) {
 	_archive = io::openFilesystemArchive(filesystem, "", false);
+	_maxThumbnailJobs = (int)core_max(1u, core::cpus());
 }
 
 CollectionManager::~CollectionManager() {
@@ -48,7 +51,7 @@ bool CollectionManager::init() {
 	if (_localDir.empty()) {
 		var->setVal(documents);
 	}
-	return true;
+	return _downloadManager.init();
 }
 
 core::String CollectionManager::absolutePath(const VoxelFile &voxelFile) const {
@@ -71,6 +74,7 @@ bool CollectionManager::setLocalDir(const core::String &dir) {
 	}
 	if (_localDir.empty() || dir != _localDir) {
 		Log::debug("change local dir to %s", dir.c_str());
+		saveIndex();
 		_localDir = dir;
 		auto iter = _voxelFilesMap.find(LOCAL_SOURCE);
 		if (iter != _voxelFilesMap.end()) {
@@ -98,6 +102,7 @@ void CollectionManager::waitOnline() {
 
 void CollectionManager::shutdown() {
 	_shouldQuit = true;
+	_downloadManager.abort();
 	waitLocal();
 	waitOnline();
 	for (std::future<void> &f : _futures) {
@@ -106,6 +111,53 @@ void CollectionManager::shutdown() {
 		}
 	}
 	_futures.clear();
+	for (std::future<void> &f : _thumbnailFutures) {
+		if (f.valid()) {
+			f.wait();
+		}
+	}
+	_thumbnailFutures.clear();
+	_thumbnailQueue.clear();
+	_thumbnailQueuePos = 0;
+	_downloadManager.shutdown();
+	saveIndex();
+}
+
+core::String CollectionManager::indexFile(const core::String &localDir) const {
+	// relative to the home write path
+	const uint32_t hash = core::hash((const void *)localDir.c_str(), (int)localDir.size());
+	return core::string::format("collection-%08x.idx", hash);
+}
+
+bool CollectionManager::loadIndex(const core::String &localDir) {
+	if (_index.localDir() == localDir) {
+		return true;
+	}
+	const core::String &file = indexFile(localDir);
+	if (!_archive->exists(file)) {
+		_index.reset(localDir);
+		return false;
+	}
+	core::ScopedPtr<io::SeekableReadStream> stream(_archive->readStream(file));
+	if (!stream) {
+		_index.reset(localDir);
+		return false;
+	}
+	return _index.load(*stream, localDir);
+}
+
+bool CollectionManager::saveIndex() {
+	if (!_index.dirty() || _index.localDir().empty()) {
+		return false;
+	}
+	const core::String &file = indexFile(_index.localDir());
+	core::ScopedPtr<io::SeekableWriteStream> stream(_archive->writeStream(file));
+	if (!stream || !_index.save(*stream)) {
+		Log::warn("Failed to write the collection index %s", file.c_str());
+		return false;
+	}
+	Log::debug("Wrote collection index with %i entries to %s", _index.size(), file.c_str());
+	return true;
 }
 
 bool CollectionManager::local() {
@@ -122,11 +174,15 @@ bool CollectionManager::local() {
 		if (_shouldQuit) {
 			return;
 		}
+		loadIndex(localDir);
 		core::DynamicArray<io::FilesystemEntry> entities;
 		Log::info("Local document scanning (%s)...", localDir.c_str());
 		_archive->list(localDir, entities, "");
 		Log::debug("Found %i entries in %s", (int)entities.size(), localDir.c_str());
 
+		core::DynamicArray<core::String> existing;
+		existing.reserve(entities.size());
+		int changed = 0;
 		for (const io::FilesystemEntry &entry : entities) {
 			if (_shouldQuit) {
 				return;
@@ -134,6 +190,10 @@ bool CollectionManager::local() {
 			if (!io::isA(entry.name, voxelformat::voxelLoad())) {
 				continue;
 			}
+			existing.push_back(entry.fullPath);
+			if (!_index.touch(entry)) {
+				++changed;
+			}
 			VoxelFile voxelFile;
 			voxelFile.name = entry.fullPath.substr(localDir.size());
 			voxelFile.fullPath = entry.fullPath;
@@ -145,6 +205,8 @@ bool CollectionManager::local() {
 			voxelFile.downloaded = true;
 			_newVoxelFiles.push(voxelFile);
 		}
+		const int removed = _index.prune(existing);
+		Log::debug("Local collection index: %i files, %i changed, %i removed", (int)existing.size(), changed, removed);
 	});
 	return true;
 }
@@ -172,56 +234,124 @@ void CollectionManager::loadThumbnail(const VoxelFile &voxelFile) {
 	if (_texturePool->has(voxelFile.name)) {
 		return;
 	}
+	if (_shouldQuit) {
+		return;
+	}
+	_thumbnailQueue.push_back(voxelFile);
+}
+
+int CollectionManager::pendingThumbnails() const {
+	return (int)(_thumbnailQueue.size() - _thumbnailQueuePos + _thumbnailFutures.size());
+}
+
+void CollectionManager::updateThumbnails() {
+	for (size_t i = 0; i < _thumbnailFutures.size();) {
+		std::future<void> &f = _thumbnailFutures[i];
+		if (f.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			_thumbnailFutures.erase(i);
+		} else {
+			++i;
+		}
+	}
+	while (_thumbnailQueuePos < _thumbnailQueue.size() && (int)_thumbnailFutures.size() < _maxThumbnailJobs) {
+		const VoxelFile &voxelFile = _thumbnailQueue[_thumbnailQueuePos++];
+		if (_texturePool->has(voxelFile.name)) {
+			continue;
+		}
+		_thumbnailFutures.emplace_back(app::async([this, voxelFile]() { thumbnailJob(voxelFile); }));
+	}
+	if (_thumbnailQueuePos >= _thumbnailQueue.size()) {
+		_thumbnailQueue.clear();
+		_thumbnailQueuePos = 0;
+	}
+}
+
+void CollectionManager::thumbnailJob(const VoxelFile &voxelFile) {
 	if (_shouldQuit) {
 		return;
 	}
 	const core::String &targetImageFile = voxelFile.targetFile() + ".png";
 	io::ArchivePtr archive = _archive;
-	if (archive->exists(targetImageFile)) {
-		_futures.emplace_back(app::async([this, voxelFile, targetImageFile, archive]() {
-			if (_shouldQuit) {
-				return;
+	CollectionIndexEntry indexEntry;
+	const bool indexed = voxelFile.isLocal() && _index.get(voxelFile.fullPath, indexEntry) && indexEntry.scanned();
+	if (indexed) {
+		if (!indexEntry.thumbnail.empty() && archive->exists(indexEntry.thumbnail)) {
+			core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(indexEntry.thumbnail));
+			if (stream) {
+				image::ImagePtr image = image::loadImage(indexEntry.thumbnail, *stream);
+				if (image) {
+					image->setName(voxelFile.name);
+					_imageQueue.push(image);
+					return;
+				}
 			}
-			core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(targetImageFile));
-			image::ImagePtr image = image::loadImage(targetImageFile, *stream);
-			if (image) {
-				image->setName(voxelFile.name);
-				_imageQueue.push(image);
+		} else if (indexEntry.flags & (CollectionIndexEntry::FlagNoThumbnail | CollectionIndexEntry::FlagFailed)) {
+			return;
+		}
+	}
+
+	image::ImagePtr embeddedImage;
+	if (voxelFile.isLocal() && !indexed) {
+		// the file is new or was modified since the last scan - only read the header for the meta data in the
+		// index, the voxels are loaded once a thumbnail is rendered
+		io::FileDescription fileDesc;
+		fileDesc.set(voxelFile.fullPath);
+		voxelformat::LoadContext loadCtx;
+		voxelformat::SceneInfo info;
+		const bool probed = voxelformat::probe(fileDesc, archive, info, loadCtx);
+		_index.update(voxelFile.fullPath, info);
+		if (!probed) {
+			Log::debug("Failed to probe %s for the collection index", voxelFile.fullPath.c_str());
+			_index.addFlags(voxelFile.fullPath, CollectionIndexEntry::FlagFailed);
+		}
+		embeddedImage = info.thumbnail;
+		if (_shouldQuit) {
+			return;
+		}
+	}
+
+	if (archive->exists(targetImageFile)) {
+		core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(targetImageFile));
+		image::ImagePtr image = image::loadImage(targetImageFile, *stream);
+		if (image) {
+			if (voxelFile.isLocal()) {
+				_index.setThumbnail(voxelFile.fullPath, targetImageFile);
 			}
-		}));
+			image->setName(voxelFile.name);
+			_imageQueue.push(image);
+		}
 		return;
 	}
 	if (!voxelFile.thumbnailUrl.empty()) {
-		_futures.emplace_back(app::async([=]() {
-			if (_shouldQuit) {
-				return;
-			}
-			http::HttpCacheStream stream(archive, targetImageFile, voxelFile.thumbnailUrl);
-			this->_imageQueue.push(image::loadImage(voxelFile.name, stream));
-		}));
+		http::HttpCacheStream stream(archive, targetImageFile, voxelFile.thumbnailUrl);
+		_imageQueue.push(image::loadImage(voxelFile.name, stream));
+		return;
+	}
+	image::ImagePtr thumbnailImage = embeddedImage;
+	if (!thumbnailImage || !thumbnailImage->isLoaded()) {
+		http::HttpCacheStream stream(archive, voxelFile.targetFile(), voxelFile.url);
+		stream.close();
+		voxelformat::LoadContext loadCtx;
+		thumbnailImage = voxelformat::loadScreenshot(voxelFile.targetFile(), archive, loadCtx);
+	}
+	if (!thumbnailImage || !thumbnailImage->isLoaded()) {
+		Log::debug("Failed to load given input file: %s", voxelFile.fullPath.c_str());
+		if (voxelFile.isLocal()) {
+			_index.addFlags(voxelFile.fullPath, CollectionIndexEntry::FlagNoThumbnail);
+		}
+		return;
+	}
+	thumbnailImage->setName(voxelFile.name);
+	core::ScopedPtr<io::SeekableWriteStream> imageStream(archive->writeStream(targetImageFile));
+	if (!imageStream || !image::writeImage(thumbnailImage, *imageStream)) {
+		Log::warn("Failed to save thumbnail for %s to %s", voxelFile.name.c_str(), targetImageFile.c_str());
 	} else {
-		_futures.emplace_back(app::async([this, archive, voxelFile, targetImageFile]() {
-			if (_shouldQuit) {
-				return;
-			}
-			http::HttpCacheStream stream(archive, voxelFile.targetFile(), voxelFile.url);
-			stream.close();
-			voxelformat::LoadContext loadCtx;
-			image::ImagePtr thumbnailImage = voxelformat::loadScreenshot(voxelFile.targetFile(), archive, loadCtx);
-			if (!thumbnailImage || !thumbnailImage->isLoaded()) {
-				Log::debug("Failed to load given input file: %s", voxelFile.fullPath.c_str());
-				return;
-			}
-			thumbnailImage->setName(voxelFile.name);
-			core::ScopedPtr<io::SeekableWriteStream> imageStream(archive->writeStream(targetImageFile));
-			if (!image::writeImage(thumbnailImage, *imageStream)) {
-				Log::warn("Failed to save thumbnail for %s to %s", voxelFile.name.c_str(), targetImageFile.c_str());
-			} else {
-				Log::debug("Created thumbnail for %s at %s", voxelFile.name.c_str(), targetImageFile.c_str());
-			}
-			this->_imageQueue.push(thumbnailImage);
-		}));
+		Log::debug("Created thumbnail for %s at %s", voxelFile.name.c_str(), targetImageFile.c_str());
+		if (voxelFile.isLocal()) {
+			_index.setThumbnail(voxelFile.fullPath, targetImageFile);
+		}
 	}
+	_imageQueue.push(thumbnailImage);
 }
 
 bool CollectionManager::createThumbnail(const VoxelFile &voxelFile) {
@@ -287,7 +417,8 @@ void CollectionManager::update(double nowSeconds, int n) {
 		_shouldQuit = true;
 	}
 
-	if (_local.valid() && _local.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+	const bool localDone = _local.valid() && _local.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	if (localDone) {
 		if (_voxelFilesMap.find(LOCAL_SOURCE) == _voxelFilesMap.end()) {
 			VoxelCollection collection{{}, nowSeconds, true};
 			_voxelFilesMap.put(LOCAL_SOURCE, collection);
@@ -334,6 +465,12 @@ void CollectionManager::update(double nowSeconds, int n) {
 		collection.sorted = true;
 	}
 	_count += voxelFiles.size();
+
+	updateThumbnails();
+	// persist the index once the scan and all thumbnail jobs are done
+	if (localDone && _newVoxelFiles.empty() && pendingThumbnails() == 0) {
+		saveIndex();
+	}
 }
 
 void CollectionManager::downloadAll() {
@@ -344,20 +481,35 @@ void CollectionManager::downloadAll() {
 			all += (int)e->value.files.size();
 		}
 
+		// the downloads are running in parallel with the connection limit of the download manager
+		core::DynamicArray<std::future<http::CacheResult>> downloads;
+		downloads.reserve(all);
 		int current = 0;
 		for (const auto &e : voxelFilesMap) {
 			for (VoxelFile &voxelFile : e->value.files) {
 				if (_shouldQuit) {
 					return;
 				}
-				++current;
-				if (voxelFile.downloaded) {
+				if (voxelFile.downloaded || voxelFile.isLocal()) {
+					++current;
 					continue;
 				}
-				download(archive, voxelFile);
-				const float p = ((float)current / (float)all * 100.0f);
-				_downloadProgress = (int)p;
+				downloads.emplace_back(_downloadManager.download(archive, voxelFile.targetFile(), voxelFile.url));
+			}
+		}
+		for (std::future<http::CacheResult> &f : downloads) {
+			if (!f.valid()) {
+				continue;
+			}
+			// the queued downloads are dropped on shutdown - don't wait for them
+			while (f.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready) {
+				if (_shouldQuit) {
+					return;
+				}
 			}
+			++current;
+			const float p = ((float)current / (float)all * 100.0f);
+			_downloadProgress = (int)p;
 		}
 		_downloadProgress = 0;
 	}));
@@ -9,10 +9,12 @@
 #include "core/collection/DynamicArray.h"
 #include "core/collection/StringSet.h"
 #include "core/concurrent/Atomic.h"
+#include "http/DownloadManager.h"
 #include "io/Archive.h"
 #include "io/Filesystem.h"
 #include "video/Texture.h"
 #include "video/TexturePool.h"
+#include "voxelcollection/CollectionIndex.h"
 #include "voxelcollection/Downloader.h"
 #include <future>
 
@@ -35,13 +37,26 @@ private:
 
 	std::future<void> _local;
 	core::String _localDir;
+	CollectionIndex _index;
+
+	/** thumbnails that are waiting for a free slot in the thumbnail pipeline */
+	core::DynamicArray<VoxelFile> _thumbnailQueue;
+	size_t _thumbnailQueuePos = 0;
+	core::DynamicArray<std::future<void>> _thumbnailFutures;
+	int _maxThumbnailJobs = 1;
 
 	core::StringSet _onlineResolvedSources;
 	std::future<VoxelFiles> _onlineResolve;
 	VoxelSources _sources;
 	std::future<VoxelSources> _onlineSources;
 	core::DynamicArray<std::future<void>> _futures;
+	/** limits the parallel connections of downloadAll() */
+	http::DownloadManager _downloadManager;
 	bool download(const io::ArchivePtr &archive, VoxelFile &voxelFile);
+	void thumbnailJob(const VoxelFile &voxelFile);
+	void updateThumbnails();
+	core::String indexFile(const core::String &localDir) const;
+	bool loadIndex(const core::String &localDir);
 
 public:
 	CollectionManager(const io::FilesystemPtr &filesystem, const video::TexturePoolPtr &texturePool);
@@ -75,9 +90,20 @@ public:
 	/**
 	 * @brief Load existing thumbnails - either from png files or from the voxel format file itself (if supported)
 	 * @note This does NOT create thumbnails from vengi render shots
+	 * @note The thumbnails are queued and processed by a bounded amount of parallel jobs in @c update()
 	 */
 	void loadThumbnail(const VoxelFile &voxelFile);
 	bool createThumbnail(const VoxelFile &voxelFile);
+	/**
+	 * @return The amount of thumbnails that are queued or currently processed
+	 */
+	int pendingThumbnails() const;
+
+	/**
+	 * @brief Persist the index of the local collection directory if it was modified
+	 */
+	bool saveIndex();
+	const CollectionIndex &index() const;
 
 	void thumbnailAll();
 	void downloadAll();
@@ -99,6 +125,10 @@ inline const VoxelSources &CollectionManager::sources() const {
 	return _sources;
 }
 
+inline const CollectionIndex &CollectionManager::index() const {
+	return _index;
+}
+
 typedef core::SharedPtr<CollectionManager> CollectionManagerPtr;
 
 }; // namespace voxelcollection
@@ -12,8 +12,9 @@
 namespace voxelcollection {
 namespace github {
 
-static nlohmann::json cachedJson(const io::ArchivePtr &archive, const core::String &file, const core::String &url) {
-	const core::String json = http::HttpCacheStream::string(archive, file, url);
+static nlohmann::json cachedJson(const io::ArchivePtr &archive, const core::String &file, const core::String &url,
+								 bool revalidate = false) {
+	const core::String json = http::HttpCacheStream::string(archive, file, url, revalidate);
 	if (json.empty()) {
 		return {};
 	}
@@ -48,7 +49,7 @@ core::DynamicArray<TreeEntry> reposGitTrees(const io::ArchivePtr &archive, const
 	core::String file = "github-" + repository + "-" + branch + ".json";
 	core::string::replaceAllChars(file, '/', '-');
 	core::DynamicArray<TreeEntry> entries;
-	const auto &json = cachedJson(archive, file, url);
+	const auto &json = cachedJson(archive, file, url, true);
 	if (!json.contains("tree")) {
 		const core::String str = json.dump().c_str();
 		Log::error("Unexpected json data for url: '%s': %s", url.c_str(), str.c_str());
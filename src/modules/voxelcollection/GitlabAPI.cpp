@@ -15,8 +15,9 @@
 namespace voxelcollection {
 namespace gitlab {
 
-static nlohmann::json cachedJson(const io::ArchivePtr &archive, const core::String &file, const core::String &url) {
-	const core::String json = http::HttpCacheStream::string(archive, file, url);
+static nlohmann::json cachedJson(const io::ArchivePtr &archive, const core::String &file, const core::String &url,
+								 bool revalidate = false) {
+	const core::String json = http::HttpCacheStream::string(archive, file, url, revalidate);
 	if (json.empty()) {
 		return {};
 	}
@@ -57,7 +58,7 @@ core::DynamicArray<TreeEntry> reposGitTrees(const io::ArchivePtr &archive, const
 			encoded.c_str(), branch.c_str(), page, path.c_str());
 		core::String file = core::string::format("gitlab-%s-%s-page%i.json", repository.c_str(), branch.c_str(), page);
 		core::string::replaceAllChars(file, '/', '-');
-		const auto &json = cachedJson(archive, file, url);
+		const auto &json = cachedJson(archive, file, url, true);
 		if (!json.is_array()) {
 			const core::String str = json.dump().c_str();
 			Log::error("Unexpected json data for url: '%s': %s", url.c_str(), str.c_str());
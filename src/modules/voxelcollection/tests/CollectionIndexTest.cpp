@@ -0,0 +1,114 @@
+/**
+ * @file
+ */
+
+#include "voxelcollection/CollectionIndex.h"
+#include "app/tests/AbstractTest.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/FilesystemEntry.h"
+#include "palette/Palette.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxelformat/Format.h"
+
+namespace voxelcollection {
+
+class CollectionIndexTest : public app::AbstractTest {
+protected:
+	io::FilesystemEntry fileEntry(const core::String &path, uint64_t mtime, uint64_t size) {
+		io::FilesystemEntry entry;
+		entry.name = path;
+		entry.fullPath = path;
+		entry.mtime = mtime;
+		entry.size = size;
+		return entry;
+	}
+
+	void scanned(CollectionIndex &index, const core::String &path) {
+		voxelformat::SceneInfo info;
+		info.palette.nippon();
+		info.hasPalette = true;
+		voxelformat::SceneInfo::Node group;
+		group.type = scenegraph::SceneGraphNodeType::Group;
+		info.nodes.push_back(group);
+		voxelformat::SceneInfo::Node model;
+		model.type = scenegraph::SceneGraphNodeType::Model;
+		model.parent = 0;
+		model.region = voxel::Region(0, 0, 0, 3, 7, 1);
+		info.nodes.push_back(model);
+		index.update(path, info);
+	}
+};
+
+TEST_F(CollectionIndexTest, testTouch) {
+	CollectionIndex index;
+	index.reset("/collection/");
+	const io::FilesystemEntry &entry = fileEntry("/collection/a.vox", 1000u, 200u);
+	EXPECT_FALSE(index.touch(entry)) << "New files must be scanned";
+	EXPECT_FALSE(index.touch(entry)) << "The file wasn't scanned yet";
+	scanned(index, entry.fullPath);
+	EXPECT_TRUE(index.touch(entry));
+	EXPECT_FALSE(index.touch(fileEntry(entry.fullPath, 2000u, 200u))) << "Modified files must be rescanned";
+}
+
+TEST_F(CollectionIndexTest, testSaveLoad) {
+	CollectionIndex index;
+	index.reset("/collection/");
+	const io::FilesystemEntry &a = fileEntry("/collection/a.vox", 1000u, 200u);
+	const io::FilesystemEntry &b = fileEntry("/collection/b.qb", 1001u, 300u);
+	index.touch(a);
+	index.touch(b);
+	scanned(index, a.fullPath);
+	scanned(index, b.fullPath);
+	index.setThumbnail(a.fullPath, "/collection/a.vox.png");
+	index.addFlags(b.fullPath, CollectionIndexEntry::FlagNoThumbnail);
+	EXPECT_TRUE(index.dirty());
+
+	io::BufferedReadWriteStream stream;
+	ASSERT_TRUE(index.save(stream));
+	EXPECT_FALSE(index.dirty());
+
+	stream.seek(0);
+	CollectionIndex loaded;
+	ASSERT_TRUE(loaded.load(stream, "/collection/"));
+	ASSERT_EQ(2, loaded.size());
+
+	CollectionIndexEntry entry;
+	ASSERT_TRUE(loaded.get(a, entry));
+	EXPECT_TRUE(entry.scanned());
+	EXPECT_EQ(1, entry.nodeCount);
+	EXPECT_EQ(glm::ivec3(4, 8, 2), entry.dimensions);
+	EXPECT_EQ("/collection/a.vox.png", entry.thumbnail);
+
+	palette::Palette pal;
+	ASSERT_TRUE(loaded.palette(entry, pal));
+	palette::Palette nippon;
+	nippon.nippon();
+	EXPECT_EQ(nippon.colorCount(), pal.colorCount());
+	EXPECT_EQ(nippon.color(1), pal.color(1));
+
+	ASSERT_TRUE(loaded.get(b, entry));
+	EXPECT_EQ(0u, entry.flags & CollectionIndexEntry::FlagFailed);
+	EXPECT_NE(0u, entry.flags & CollectionIndexEntry::FlagNoThumbnail);
+	EXPECT_EQ(0, entry.paletteIndex) << "The palette should be deduplicated";
+	EXPECT_FALSE(loaded.get(fileEntry(b.fullPath, 1001u, 301u), entry));
+
+	stream.seek(0);
+	EXPECT_FALSE(loaded.load(stream, "/other/")) << "The index was written for a different directory";
+	EXPECT_EQ(0, loaded.size());
+}
+
+TEST_F(CollectionIndexTest, testPrune) {
+	CollectionIndex index;
+	index.reset("/collection/");
+	index.touch(fileEntry("/collection/a.vox", 1000u, 200u));
+	index.touch(fileEntry("/collection/b.vox", 1000u, 200u));
+	index.touch(fileEntry("/collection/c.vox", 1000u, 200u));
+	core::DynamicArray<core::String> existing;
+	existing.push_back("/collection/b.vox");
+	EXPECT_EQ(2, index.prune(existing));
+	EXPECT_EQ(1, index.size());
+	CollectionIndexEntry entry;
+	EXPECT_TRUE(index.get("/collection/b.vox", entry));
+}
+
+} // namespace voxelcollection
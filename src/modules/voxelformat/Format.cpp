@@ -5,13 +5,17 @@
 #include "Format.h"
 #include "VolumeFormat.h"
 #include "app/App.h"
+#include "app/Async.h"
+#include "core/Algorithm.h"
 #include "core/Color.h"
+#include "core/ColorHistogram.h"
 #include "core/Common.h"
 #include "core/ConfigVar.h"
 #include "core/Log.h"
 #include "core/StringUtil.h"
 #include "core/Var.h"
 #include "core/collection/DynamicArray.h"
+#include "core/concurrent/Atomic.h"
 #include "image/Image.h"
 #include "io/Archive.h"
 #include "math/Math.h"
@@ -22,6 +26,7 @@
 #include "palette/Palette.h"
 #include "voxel/RawVolume.h"
 #include "voxel/Voxel.h"
+#include "voxelutil/VolumeCropper.h"
 #include "voxelutil/VolumeVisitor.h"
 #include "voxelutil/VoxelUtil.h"
 
@@ -101,6 +106,51 @@ size_t PaletteFormat::loadPalette(const core::String &filename, const io::Archiv
 	return palette.size();
 }
 
+int SceneInfo::models() const {
+	int n = 0;
+	for (const Node &node : nodes) {
+		if (node.type == scenegraph::SceneGraphNodeType::Model) {
+			++n;
+		}
+	}
+	return n;
+}
+
+static void probeSceneGraph_r(const scenegraph::SceneGraph &sceneGraph, int nodeId, int parent, SceneInfo &info) {
+	const scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
+	for (int childId : node.children()) {
+		const scenegraph::SceneGraphNode &child = sceneGraph.node(childId);
+		SceneInfo::Node nodeInfo;
+		nodeInfo.name = child.name();
+		nodeInfo.type = child.type();
+		nodeInfo.parent = parent;
+		if (child.isModelNode()) {
+			nodeInfo.region = child.region();
+			if (const voxel::RawVolume *v = child.volume()) {
+				nodeInfo.voxels = voxelutil::visitVolume(*v, [](int, int, int, const voxel::Voxel &) {});
+			}
+			if (!info.hasPalette) {
+				info.palette = child.palette();
+				info.hasPalette = true;
+			}
+		}
+		info.nodes.push_back(nodeInfo);
+		probeSceneGraph_r(sceneGraph, childId, (int)info.nodes.size() - 1, info);
+	}
+}
+
+bool Format::probe(const core::String &filename, const io::ArchivePtr &archive, SceneInfo &info,
+				   const LoadContext &ctx) {
+	Log::debug("%s doesn't support probing - load the whole scene", filename.c_str());
+	scenegraph::SceneGraph sceneGraph;
+	if (!load(filename, archive, sceneGraph, ctx)) {
+		return false;
+	}
+	// the voxels are decoded anyway - so count them
+	probeSceneGraph_r(sceneGraph, sceneGraph.root().id(), -1, info);
+	return true;
+}
+
 image::ImagePtr Format::loadScreenshot(const core::String &filename, const io::ArchivePtr &, const LoadContext &) {
 	Log::debug("%s doesn't have a supported embedded screenshot", filename.c_str());
 	return image::ImagePtr();
@@ -181,6 +231,7 @@ bool Format::load(const core::String &filename, const io::ArchivePtr &archive, s
 	if (!loadGroups(filename, archive, sceneGraph, ctx)) {
 		return false;
 	}
+	applyLoadFilter(sceneGraph, ctx);
 	if (!sceneGraph.validate()) {
 		Log::warn("Failed to validate the scene graph - try to fix as much as we can");
 		sceneGraph.fixErrors();
@@ -196,6 +247,83 @@ bool Format::stopExecution() {
 	return app::App::getInstance()->shouldQuit();
 }
 
+bool Format::decodeParallel(int n, const std::function<bool(int)> &decode) {
+	core::AtomicBool failed{false};
+	// one payload per block - the payloads are usually of very different size
+	app::for_parallel(
+		0, n,
+		[&](int start, int end) {
+			for (int idx = start; idx < end; ++idx) {
+				if (failed || stopExecution()) {
+					return;
+				}
+				if (!decode(idx)) {
+					failed = true;
+				}
+			}
+		},
+		1);
+	return !failed && !stopExecution();
+}
+
+bool LoadContext::acceptsNode(const core::String &name) const {
+	return nodeFilter.empty() || core::string::matches(name, nodeFilter);
+}
+
+bool Format::needsDecoding(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node,
+						   const LoadContext &ctx) {
+	if (!ctx.acceptsNode(node.name())) {
+		return false;
+	}
+	return ctx.accepts(sceneGraph.sceneRegion(node, 0));
+}
+
+void Format::applyLoadFilter(scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx) {
+	if (!ctx.hasFilter()) {
+		return;
+	}
+	sceneGraph.updateTransforms();
+	core::DynamicArray<int> removed;
+	for (auto iter = sceneGraph.beginModel(); iter != sceneGraph.end(); ++iter) {
+		scenegraph::SceneGraphNode &node = *iter;
+		if (!needsDecoding(sceneGraph, node, ctx)) {
+			removed.push_back(node.id());
+			continue;
+		}
+		if (!ctx.region.isValid()) {
+			continue;
+		}
+		// convert the region filter into the coordinates of the volume
+		const voxel::Region &volumeRegion = node.region();
+		const glm::ivec3 offset = sceneGraph.sceneRegion(node, 0).getLowerCorner() - volumeRegion.getLowerCorner();
+		voxel::Region cropRegion = ctx.region;
+		cropRegion.shift(-offset);
+		if (cropRegion.containsRegion(volumeRegion)) {
+			continue;
+		}
+		cropRegion.cropTo(volumeRegion);
+		// the pivot is relative to the volume size - keep the node at its position in the scene
+		const glm::vec3 pivot = node.pivot() * glm::vec3(volumeRegion.getDimensionsInVoxels());
+		node.setVolume(voxelutil::copyRegion(*node.volume(), cropRegion), true);
+		node.setPivot(pivot / glm::vec3(cropRegion.getDimensionsInVoxels()));
+	}
+	if (removed.empty()) {
+		return;
+	}
+	// references to removed models would be dangling
+	for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::ModelReference); iter != sceneGraph.end();
+		 ++iter) {
+		const scenegraph::SceneGraphNode &node = *iter;
+		if (core::find(removed.begin(), removed.end(), node.reference()) != removed.end()) {
+			removed.push_back(node.id());
+		}
+	}
+	for (int nodeId : removed) {
+		sceneGraph.removeNode(nodeId, false);
+	}
+	Log::debug("Removed %i nodes by the load filter", (int)removed.size());
+}
+
 bool PaletteFormat::loadGroups(const core::String &filename, const io::ArchivePtr &archive,
 							   scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx) {
 	palette::Palette palette;
@@ -322,6 +450,37 @@ core::RGBA Format::flattenRGB(uint8_t r, uint8_t g, uint8_t b, uint8_t a) const
 	return core::Color::flattenRGB(r, g, b, a, _flattenFactor);
 }
 
+/**
+ * @brief The colors are counted in parallel for big inputs - the reduction only operates on the histogram
+ */
+static void quantize(const core::RGBA *colors, size_t colorCount, palette::Palette &palette) {
+	const size_t colorsPerHistogram = 65536;
+	const int histograms =
+		(int)core_min(colorCount / colorsPerHistogram, (size_t)app::App::getInstance()->threadPool().size());
+	if (histograms <= 1) {
+		palette.quantize(colors, colorCount);
+		return;
+	}
+	core::DynamicArray<core::ColorHistogram> partialHistograms;
+	partialHistograms.resize(histograms);
+	const size_t colorsPerTask = (colorCount + histograms - 1) / histograms;
+	app::for_parallel(
+		0, histograms,
+		[&](int start, int end) {
+			for (int i = start; i < end; ++i) {
+				const size_t offset = i * colorsPerTask;
+				const size_t n = core_min(colorsPerTask, colorCount - offset);
+				partialHistograms[i].add(colors + offset, n);
+			}
+		},
+		1);
+	core::ColorHistogram &histogram = partialHistograms[0];
+	for (int i = 1; i < histograms; ++i) {
+		histogram.merge(partialHistograms[i]);
+	}
+	palette.quantize(histogram);
+}
+
 int Format::createPalette(const RGBAMap &colors, palette::Palette &palette) const {
 	const size_t colorCount = (int)colors.size();
 	core::Buffer<core::RGBA, 1024> colorBuffer;
@@ -329,7 +488,7 @@ int Format::createPalette(const RGBAMap &colors, palette::Palette &palette) cons
 	for (const auto &e : colors) {
 		colorBuffer.push_back(e->first);
 	}
-	palette.quantize(colorBuffer.data(), colorBuffer.size());
+	quantize(colorBuffer.data(), colorBuffer.size(), palette);
 	return palette.colorCount();
 }
 
@@ -353,7 +512,7 @@ int Format::createPalette(const RGBAMaterialMap &colors, palette::Palette &palet
 	for (const auto &e : colors) {
 		colorBuffer.push_back(e->first);
 	}
-	palette.quantize(colorBuffer.data(), colorBuffer.size());
+	quantize(colorBuffer.data(), colorBuffer.size(), palette);
 	return palette.colorCount();
 }
 
@@ -16,6 +16,7 @@
 #include "palette/Palette.h"
 #include "voxel/RawVolume.h"
 #include "voxelformat/FormatThumbnail.h"
+#include <functional>
 #include <glm/fwd.hpp>
 
 namespace palette {
@@ -29,6 +30,7 @@ class Mesh;
 namespace scenegraph {
 class SceneGraph;
 class SceneGraphNode;
+enum class SceneGraphNodeType : uint8_t;
 } // namespace scenegraph
 
 namespace voxelformat {
@@ -47,12 +49,37 @@ typedef void (*ProgressMonitor)(const char *name, int cur, int max);
 
 struct LoadContext {
 	ProgressMonitor monitor = nullptr;
+	/**
+	 * Only load the voxels inside this region of the scene - an invalid region loads everything. Formats with a
+	 * spatial chunk table don't decode the chunks outside of the region, all other formats crop the volumes after
+	 * loading them.
+	 * @note Only the translation of the nodes is taken into account
+	 */
+	voxel::Region region = voxel::Region::InvalidRegion;
+	/**
+	 * Only load the model nodes with a matching name - supports wildcards. An empty filter loads all nodes.
+	 */
+	core::String nodeFilter;
+
 	inline void progress(const char *name, int cur, int max) const {
 		if (monitor == nullptr) {
 			return;
 		}
 		monitor(name, cur, max);
 	}
+
+	inline bool hasFilter() const {
+		return region.isValid() || !nodeFilter.empty();
+	}
+
+	/**
+	 * @return @c false if the given region of the scene is outside of the region filter
+	 */
+	inline bool accepts(const voxel::Region &sceneRegion) const {
+		return !region.isValid() || voxel::intersects(region, sceneRegion);
+	}
+
+	bool acceptsNode(const core::String &name) const;
 };
 struct SaveContext {
 	ProgressMonitor monitor = nullptr;
@@ -69,6 +96,32 @@ struct SaveContext {
 	ThumbnailCreator thumbnailCreator = nullptr;
 };
 
+/**
+ * @brief The structure of a scene that can be read without decoding the voxels
+ * @sa Format::probe()
+ */
+struct SceneInfo {
+	struct Node {
+		/** the name as stored in the file - might be empty */
+		core::String name;
+		scenegraph::SceneGraphNodeType type;
+		/** index of the parent in @c SceneInfo::nodes - @c -1 for the nodes below the root node */
+		int parent = -1;
+		/** the region of the volume of model nodes */
+		voxel::Region region = voxel::Region::InvalidRegion;
+		/** the amount of voxels if the format stores them in the header - otherwise @c -1 */
+		int64_t voxels = -1;
+	};
+	/** the parents are always in front of their children */
+	core::DynamicArray<Node> nodes;
+	/** only valid if @c hasPalette is @c true */
+	palette::Palette palette;
+	bool hasPalette = false;
+	image::ImagePtr thumbnail;
+
+	int models() const;
+};
+
 // the max amount of voxels - [0-255]
 static constexpr int MaxRegionSize = 256;
 
@@ -129,6 +182,34 @@ protected:
 	 */
 	static bool stopExecution();
 
+	/**
+	 * @brief Decode the voxel payload of independent nodes in parallel
+	 *
+	 * Formats with many models should load in three phases: parse the structure (header, chunk table, node
+	 * hierarchy) serially and remember where the payload of each node is located, decode the payloads with this
+	 * method into per-node volumes and finally assemble the scene graph serially again in the original order.
+	 *
+	 * The calling thread takes part in the decoding - this is safe to call from inside a thread pool task.
+	 *
+	 * @param[in] n The amount of payloads to decode
+	 * @param[in] decode Called once for every index in @c [0,n) - must only modify data that belongs to this index
+	 * @return @c false if any of the decode calls failed or the execution was stopped
+	 */
+	static bool decodeParallel(int n, const std::function<bool(int)> &decode);
+
+	/**
+	 * @brief Formats that decode the voxels of their model nodes after the scene graph structure is known can use
+	 * this to skip the nodes that are removed by the load filter of the context anyway
+	 * @note The transforms of the scene graph must be up to date
+	 */
+	static bool needsDecoding(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node,
+							  const LoadContext &ctx);
+	/**
+	 * @brief Removes the model nodes that don't match the load filter of the context and crops the volumes to the
+	 * region filter
+	 */
+	static void applyLoadFilter(scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx);
+
 	static core::String stringProperty(const scenegraph::SceneGraphNode *node, const core::String &name,
 									   const core::String &defaultVal = "");
 	static bool boolProperty(const scenegraph::SceneGraphNode *node, const core::String &name, bool defaultVal = false);
@@ -186,6 +267,14 @@ public:
 	 */
 	virtual size_t loadPalette(const core::String &filename, const io::ArchivePtr &archive, palette::Palette &palette,
 							   const LoadContext &ctx);
+
+	/**
+	 * @brief Reads the nodes with their regions, the palette and the embedded screenshot without decoding the voxels
+	 * @note The default implementation loads the whole scene graph. Formats should override this and only read the
+	 * headers and chunk tables of the file.
+	 */
+	virtual bool probe(const core::String &filename, const io::ArchivePtr &archive, SceneInfo &info,
+					   const LoadContext &ctx);
 	/**
 	 * @todo don't use a stream, but an archive for formats that are split over several files
 	 */
@@ -104,6 +104,12 @@ bool FormatConfig::init() {
 				   core::Var::boolValidator);
 	core::Var::get(cfg::VoxFormatGLTF_KHR_materials_specular, "false", core::CV_NOPERSIST,
 				   _("Apply KHR_materials_specular when saving into the gltf format"), core::Var::boolValidator);
+	core::Var::get(cfg::VoxFormatGLTF_KHR_mesh_quantization, "false", core::CV_NOPERSIST,
+				   _("Store integer positions and byte normals (KHR_mesh_quantization) when saving into the glb format"),
+				   core::Var::boolValidator);
+	core::Var::get(cfg::VoxFormatGLTF_EXT_meshopt_compression, "false", core::CV_NOPERSIST,
+				   _("Compress the vertex and index buffers (EXT_meshopt_compression) when saving into the glb format"),
+				   core::Var::boolValidator);
 	core::Var::get(cfg::VoxFormatWithMaterials, "true", core::CV_NOPERSIST,
 				   _("Try to export material properties if the formats support it"), core::Var::boolValidator);
 	core::Var::get(cfg::VoxformatImageVolumeMaxDepth, "1", core::CV_NOPERSIST,
@@ -10,6 +10,7 @@
 #include "core/StringUtil.h"
 #include "core/Trace.h"
 #include "core/collection/DynamicArray.h"
+#include "core/collection/StringMap.h"
 #include "io/Archive.h"
 #include "io/File.h"
 #include "io/FilesystemArchive.h"
@@ -256,6 +257,31 @@ static core::SharedPtr<Format> getFormat(const io::FormatDescription &desc, uint
 	return {};
 }
 
+/**
+ * @brief Counts the loaded or saved files per format type
+ *
+ * The metric ids are cached per thread - registering the metric for every file would lock the aggregator.
+ */
+static void countFormatMetric(const char *key, core::StringMap<metric::MetricId> &ids, const core::String &ext) {
+	const core::String &type = ext.toLower();
+	metric::MetricId id;
+	if (!ids.get(type, id)) {
+		id = metric::registerMetric(key, metric::MetricType::Counter, {{"type", type}});
+		ids.put(type, id);
+	}
+	metric::count(id);
+}
+
+static void countLoadMetric(const core::String &ext) {
+	static thread_local core::StringMap<metric::MetricId> ids;
+	countFormatMetric("load", ids, ext);
+}
+
+static void countSaveMetric(const core::String &ext) {
+	static thread_local core::StringMap<metric::MetricId> ids;
+	countFormatMetric("save", ids, ext);
+}
+
 static uint32_t loadMagic(const core::String &filename, const io::ArchivePtr &archive) {
 	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
 	if (!stream) {
@@ -326,6 +352,33 @@ size_t loadPalette(const core::String &filename, const io::ArchivePtr &archive,
 	return 0;
 }
 
+bool probe(const io::FileDescription &fileDesc, const io::ArchivePtr &archive, SceneInfo &info,
+		   const LoadContext &ctx) {
+	core_trace_scoped(ProbeVolumeFormat);
+	const uint32_t magic = loadMagic(fileDesc.name, archive);
+	const io::FormatDescription *desc = io::getDescription(fileDesc, magic, voxelLoad());
+	if (desc == nullptr) {
+		Log::warn("Format %s isn't supported", fileDesc.name.c_str());
+		return false;
+	}
+	const core::SharedPtr<Format> &f = getFormat(*desc, magic);
+	if (!f) {
+		Log::error("Failed to probe model file %s - unsupported file format", fileDesc.name.c_str());
+		return false;
+	}
+	if (!f->probe(fileDesc.name, archive, info, ctx)) {
+		Log::error("Failed to probe %s", fileDesc.name.c_str());
+		return false;
+	}
+	if (info.hasPalette) {
+		info.palette.markDirty();
+	}
+	if (!info.thumbnail && (desc->flags & VOX_FORMAT_FLAG_SCREENSHOT_EMBEDDED)) {
+		info.thumbnail = f->loadScreenshot(fileDesc.name, archive, ctx);
+	}
+	return true;
+}
+
 bool loadFormat(const io::FileDescription &fileDesc, const io::ArchivePtr &archive,
 				scenegraph::SceneGraph &newSceneGraph, const LoadContext &ctx) {
 	core_trace_scoped(LoadVolumeFormat);
@@ -358,7 +411,7 @@ bool loadFormat(const io::FileDescription &fileDesc, const io::ArchivePtr &archi
 	Log::info("Load file %s with %i model nodes and %i point nodes", filename.c_str(), models, points);
 	const core::String &ext = core::string::extractExtension(filename);
 	if (!ext.empty()) {
-		metric::count("load", 1, {{"type", ext.toLower()}});
+		countLoadMetric(ext);
 	}
 	return true;
 }
@@ -419,7 +472,7 @@ bool saveFormat(scenegraph::SceneGraph &sceneGraph, const core::String &filename
 		if (f) {
 			if (f->save(sceneGraph, filename, archive, ctx)) {
 				Log::debug("Saved file for format '%s' (ext: '%s')", desc->name.c_str(), ext.c_str());
-				metric::count("save", 1, {{"type", ext.toLower()}});
+				countSaveMetric(ext);
 				return true;
 			}
 			Log::error("Failed to save %s file", desc->name.c_str());
@@ -434,7 +487,7 @@ bool saveFormat(scenegraph::SceneGraph &sceneGraph, const core::String &filename
 		if (f) {
 			if (f->save(sceneGraph, filename, archive, ctx)) {
 				Log::debug("Saved file for format '%s' (ext: '%s')", desc->name.c_str(), ext.c_str());
-				metric::count("save", 1, {{"type", ext.toLower()}});
+				countSaveMetric(ext);
 				return true;
 			}
 			Log::error("Failed to save %s file", desc->name.c_str());
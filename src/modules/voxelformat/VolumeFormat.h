@@ -31,6 +31,12 @@ bool importPalette(const core::String &filename, palette::Palette &palette);
 size_t loadPalette(const core::String &filename, const io::ArchivePtr &archive, palette::Palette &palette,
 				   const LoadContext &ctx);
 image::ImagePtr loadScreenshot(const core::String &filename, const io::ArchivePtr &archive, const LoadContext &ctx);
+/**
+ * @brief Reads the structure of the file without decoding the voxels if the format supports this
+ * @sa Format::probe()
+ */
+bool probe(const io::FileDescription &fileDesc, const io::ArchivePtr &archive, SceneInfo &info,
+		   const LoadContext &ctx);
 bool loadFormat(const io::FileDescription &fileDesc, const io::ArchivePtr &archive, scenegraph::SceneGraph &sceneGraph,
 				const LoadContext &ctx);
 
@@ -56,6 +56,11 @@ static inline uint8_t vxl_red(uint32_t c) {
 bool AoSVXLFormat::loadGroupsRGBA(const core::String &filename, const io::ArchivePtr &archive,
 								  scenegraph::SceneGraph &sceneGraph, const palette::Palette &palette,
 								  const LoadContext &ctx) {
+	const core::String &name = core::string::extractFilename(filename);
+	if (!ctx.acceptsNode(name)) {
+		Log::debug("The map %s doesn't match the node filter", name.c_str());
+		return true;
+	}
 	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
 	if (!stream) {
 		Log::error("Failed to open stream for file: %s", filename.c_str());
@@ -86,15 +91,28 @@ bool AoSVXLFormat::loadGroupsRGBA(const core::String &filename, const io::Archiv
 
 	Log::debug("Read vxl of size %i:%i:%i", (int)mapSize, (int)mapHeight, (int)mapSize);
 
-	const voxel::Region region(0, 0, 0, (int)mapSize - 1, (int)mapHeight - 1, (int)mapSize - 1);
+	voxel::Region region(0, 0, 0, (int)mapSize - 1, (int)mapHeight - 1, (int)mapSize - 1);
+	if (ctx.region.isValid()) {
+		// the map is not transformed - the region filter is given in the coordinates of the volume
+		if (!ctx.accepts(region)) {
+			Log::debug("The map is outside of the region filter");
+			libvxl_free(&map);
+			core_free(data);
+			return true;
+		}
+		region.cropTo(ctx.region);
+	}
 	voxel::RawVolume *volume = new voxel::RawVolume(region);
 	scenegraph::SceneGraphNode node;
 	node.setVolume(volume, true);
 	palette::PaletteLookup palLookup(palette);
 
-	for (int x = 0; x < (int)mapSize; x++) {
-		for (int y = 0; y < (int)mapSize; y++) {
-			for (int z = 0; z < (int)mapHeight; z++) {
+	// x and z of the volume are x and y of the map - the map height is flipped
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	for (int x = mins.x; x <= maxs.x; x++) {
+		for (int y = mins.z; y <= maxs.z; y++) {
+			for (int z = (int)mapHeight - 1 - maxs.y; z <= (int)mapHeight - 1 - mins.y; z++) {
 				if (!libvxl_map_issolid(&map, x, y, z)) {
 					continue;
 				}
@@ -108,7 +126,7 @@ bool AoSVXLFormat::loadGroupsRGBA(const core::String &filename, const io::Archiv
 	libvxl_free(&map);
 	core_free(data);
 
-	node.setName(core::string::extractFilename(filename));
+	node.setName(name);
 	node.setPalette(palLookup.palette());
 	sceneGraph.emplace(core::move(node));
 	return true;
@@ -13,6 +13,9 @@ namespace voxelformat {
  *
  * https://silverspaceship.com/aosmap/
  *
+ * The columns are run length encoded without an offset table - the whole map has to be parsed, but only the voxels
+ * inside the region filter of the load context are converted.
+ *
  * @ingroup Formats
  */
 class AoSVXLFormat : public RGBASinglePaletteFormat {
@@ -11,6 +11,7 @@
 #include "io/Stream.h"
 #include "scenegraph/SceneGraph.h"
 #include "palette/Palette.h"
+#include "voxelutil/VolumeImporter.h"
 
 namespace voxelformat {
 
@@ -34,15 +35,20 @@ bool BinVoxFormat::readData(State &state, const core::String &filename, io::Seek
 		return false;
 	}
 
-	voxel::RawVolume *volume = new voxel::RawVolume(region);
+	// the width is running fastest and is our y axis, the depth is our x axis
+	voxelutil::GridLayout layout;
+	layout.size = glm::ivec3(state._w, state._h, state._d);
+	layout.volumeAxis = glm::ivec3(1, 2, 0);
+	voxelutil::VolumeImporter importer(layout);
+	if (!importer.isValid() || importer.region() != region) {
+		Log::error("Could not allocate the volume for region %s", region.toString().c_str());
+		return false;
+	}
 	scenegraph::SceneGraphNode node;
-	node.setVolume(volume, true);
-	node.setName(core::string::extractFilename(filename));
-	sceneGraph.emplace(core::move(node));
+	const palette::Palette &palette = node.palette();
 	const uint32_t numVoxels = state._w * state._h * state._d;
 	uint32_t index = 0;
 	uint32_t endIndex = 0;
-	const palette::Palette &palette = node.palette();
 	while (endIndex < numVoxels) {
 		uint8_t value;
 		uint8_t count;
@@ -54,19 +60,13 @@ bool BinVoxFormat::readData(State &state, const core::String &filename, io::Seek
 			return false;
 		}
 		if (value != 0u) {
-			const voxel::Voxel voxel = voxel::createVoxel(palette, value);
-			for (uint32_t i = index; i < endIndex; ++i) {
-				const int32_t iy = (int32_t)(i % state._w);
-				const int32_t iz = (int32_t)((i / state._w) % state._h);
-				const int32_t ix = (int32_t)(i / (state._w * state._h));
-				if (!volume->setVoxel(ix, iy, iz, voxel)) {
-					Log::debug("Failed to store voxel at x: %i, y: %i, z: %i (region: %s)", ix, iy, iz,
-							   region.toString().c_str());
-				}
-			}
+			importer.setRun(index, count, voxel::createVoxel(palette, value));
 		}
 		index = endIndex;
 	}
+	node.setVolume(importer.release(), true);
+	node.setName(core::string::extractFilename(filename));
+	sceneGraph.emplace(core::move(node));
 	return true;
 }
 
@@ -485,11 +485,15 @@ bool VXLFormat::readLayer(io::SeekableReadStream &stream, vxl::VXLModel &mdl, ui
 }
 
 bool VXLFormat::readLayers(io::SeekableReadStream &stream, vxl::VXLModel &mdl, scenegraph::SceneGraph &sceneGraph,
-						   const palette::Palette &palette) const {
+						   const palette::Palette &palette, const LoadContext &ctx) const {
 	const vxl::VXLHeader &hdr = mdl.header;
 	sceneGraph.reserve(hdr.layerCount);
 	const int64_t bodyPos = stream.pos();
 	for (uint32_t i = 0; i < hdr.layerCount; ++i) {
+		if (!ctx.acceptsNode(mdl.layerHeaders[i].name)) {
+			Log::debug("Skip layer %s", mdl.layerHeaders[i].name);
+			continue;
+		}
 		if (stream.seek(bodyPos) == -1) {
 			Log::error("Failed to seek for layer %u", i);
 			return false;
@@ -677,7 +681,7 @@ bool VXLFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 		Log::error("Failed to seek");
 		return false;
 	}
-	wrapBool(readLayers(*stream, mdl, sceneGraph, palette))
+	wrapBool(readLayers(*stream, mdl, sceneGraph, palette, ctx))
 
 	const core::String &basename = core::string::stripExtension(filename);
 
@@ -40,8 +40,12 @@ private:
 	bool readLayerInfo(io::SeekableReadStream &stream, vxl::VXLModel &mdl, uint32_t nodeIdx) const;
 	bool readLayer(io::SeekableReadStream &stream, vxl::VXLModel &mdl, uint32_t nodeIdx,
 				   scenegraph::SceneGraph &sceneGraph, const palette::Palette &palette) const;
+	/**
+	 * @note The layers that don't match the node filter of the load context are not read. The region filter is applied
+	 * after loading - the hva file that is loaded afterwards overrides the layer transforms.
+	 */
 	bool readLayers(io::SeekableReadStream &stream, vxl::VXLModel &mdl, scenegraph::SceneGraph &sceneGraph,
-					const palette::Palette &palette) const;
+					const palette::Palette &palette, const LoadContext &ctx) const;
 	bool readLayerInfos(io::SeekableReadStream &stream, vxl::VXLModel &mdl) const;
 	bool readLayerHeaders(io::SeekableReadStream &stream, vxl::VXLModel &mdl) const;
 
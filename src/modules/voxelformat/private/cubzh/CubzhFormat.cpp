@@ -8,6 +8,7 @@
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
 #include "io/Archive.h"
+#include "io/MemoryReadStream.h"
 #include "io/ZipReadStream.h"
 #include "palette/Palette.h"
 #include "scenegraph/SceneGraph.h"
@@ -402,7 +403,9 @@ bool CubzhFormat::loadPCubes(const core::String &filename, const Header &header,
 		case priv::CHUNK_ID_SHAPE_V6: {
 			Log::debug("load shape");
 			CubzhReadStream zhs(header, chunk, stream);
-			wrapBool(loadShape6(filename, header, chunk, zhs, sceneGraph, palette, ctx))
+			Shape shape;
+			wrapBool(loadShape6(filename, header, chunk, zhs, palette, shape))
+			wrapBool(addShape6(shape, sceneGraph))
 			break;
 		}
 		default:
@@ -440,13 +443,12 @@ bool CubzhFormat::loadSubChunkHeader(const Header &header, io::ReadStream &strea
 }
 
 bool CubzhFormat::loadShape6(const core::String &filename, const Header &header, const Chunk &chunk,
-							 CubzhReadStream &stream, scenegraph::SceneGraph &sceneGraph,
-							 const palette::Palette &palette, const LoadContext &ctx) const {
+							 CubzhReadStream &stream, const palette::Palette &palette, Shape &shape) const {
 	uint16_t width = 0, depth = 0, height = 0;
-	scenegraph::SceneGraphNode node;
+	scenegraph::SceneGraphNode &node = shape.node;
 	node.setName(core::string::extractFilename(filename));
 	uint16_t shapeId = 1;
-	uint16_t parentShapeId = 0;
+	uint16_t &parentShapeId = shape.parentShapeId;
 	glm::vec3 pivot{0.5f}; // default is center of shape
 	glm::vec3 pos{0};
 	glm::vec3 eulerAngles{0};
@@ -454,7 +456,7 @@ bool CubzhFormat::loadShape6(const core::String &filename, const Header &header,
 	palette::Palette nodePalette = palette;
 	bool hasPivot = false;
 	bool sizeChunkFound = false;
-	bool paletteFound = false;
+	bool &paletteFound = shape.paletteFound;
 	bool nameFound = false;
 	while (!stream.eos()) {
 		if (stream.remaining() == 4 && nameFound) {
@@ -612,17 +614,7 @@ bool CubzhFormat::loadShape6(const core::String &filename, const Header &header,
 			wrap(stream.readFloat(poiPos.x))
 			wrap(stream.readFloat(poiPos.y))
 			wrap(stream.readFloat(poiPos.z))
-			if (scenegraph::SceneGraphNode *existingNode = sceneGraph.findNodeByName(name)) {
-				scenegraph::SceneGraphTransform &transform = existingNode->transform(0);
-				transform.setLocalTranslation(poiPos);
-			} else {
-				scenegraph::SceneGraphNode pointNode(scenegraph::SceneGraphNodeType::Point);
-				pointNode.setName(name);
-				scenegraph::SceneGraphTransform transform;
-				transform.setLocalTranslation(poiPos);
-				pointNode.setTransform(0, transform);
-				sceneGraph.emplace(core::move(pointNode), node.id());
-			}
+			shape.points.push_back({name, poiPos, false});
 			break;
 		}
 		case priv::CHUNK_ID_SHAPE_POINT_ROTATION_V6: {
@@ -633,17 +625,7 @@ bool CubzhFormat::loadShape6(const core::String &filename, const Header &header,
 			wrap(stream.readFloat(poiAngles.x))
 			wrap(stream.readFloat(poiAngles.y))
 			wrap(stream.readFloat(poiAngles.z))
-			if (scenegraph::SceneGraphNode *existingNode = sceneGraph.findNodeByName(name)) {
-				scenegraph::SceneGraphTransform &transform = existingNode->transform(0);
-				transform.setLocalOrientation(glm::quat(poiAngles));
-			} else {
-				scenegraph::SceneGraphNode pointNode(scenegraph::SceneGraphNodeType::Point);
-				pointNode.setName(name);
-				scenegraph::SceneGraphTransform transform;
-				transform.setLocalTranslation(poiAngles);
-				pointNode.setTransform(0, transform);
-				sceneGraph.emplace(core::move(pointNode), node.id());
-			}
+			shape.points.push_back({name, poiAngles, true});
 			break;
 		}
 		case priv::CHUNK_ID_SHAPE_BAKED_LIGHTING_V6:
@@ -678,24 +660,76 @@ bool CubzhFormat::loadShape6(const core::String &filename, const Header &header,
 	}
 	node.setPivot(pivot);
 	node.setPalette(nodePalette);
+	return true;
+}
+
+bool CubzhFormat::addShape6(Shape &shape, scenegraph::SceneGraph &sceneGraph) const {
+	scenegraph::SceneGraphNode &node = shape.node;
 	int parent = 0;
-	if (parentShapeId != 0) {
+	if (shape.parentShapeId != 0) {
 		if (scenegraph::SceneGraphNode *parentNode =
-				sceneGraph.findNodeByPropertyValue("shapeId", core::string::format("%d", parentShapeId))) {
+				sceneGraph.findNodeByPropertyValue("shapeId", core::string::format("%d", shape.parentShapeId))) {
 			parent = parentNode->id();
-			if (!paletteFound) {
+			if (!shape.paletteFound) {
 				node.setPalette(parentNode->palette());
 			}
 		} else {
-			Log::warn("Could not find node with parent shape id %d", parentShapeId);
+			Log::warn("Could not find node with parent shape id %d", shape.parentShapeId);
+		}
+	}
+	const int nodeId = sceneGraph.emplace(core::move(node), parent);
+	if (nodeId == InvalidNodeId) {
+		return false;
+	}
+	for (const ShapePoint &point : shape.points) {
+		if (scenegraph::SceneGraphNode *existingNode = sceneGraph.findNodeByName(point.name)) {
+			scenegraph::SceneGraphTransform &transform = existingNode->transform(0);
+			if (point.rotation) {
+				transform.setLocalOrientation(glm::quat(point.value));
+			} else {
+				transform.setLocalTranslation(point.value);
+			}
+		} else {
+			scenegraph::SceneGraphNode pointNode(scenegraph::SceneGraphNodeType::Point);
+			pointNode.setName(point.name);
+			scenegraph::SceneGraphTransform transform;
+			transform.setLocalTranslation(point.value);
+			pointNode.setTransform(0, transform);
+			sceneGraph.emplace(core::move(pointNode), nodeId);
 		}
 	}
-	return sceneGraph.emplace(core::move(node), parent) != InvalidNodeId;
+	return true;
+}
+
+bool CubzhFormat::loadShapes6(const core::String &filename, const Header &header,
+							  core::DynamicArray<ShapeChunk> &shapes, scenegraph::SceneGraph &sceneGraph) const {
+	if (shapes.empty()) {
+		return true;
+	}
+	const bool decoded = decodeParallel((int)shapes.size(), [&](int idx) {
+		ShapeChunk &shapeChunk = shapes[idx];
+		io::MemoryReadStream memStream(shapeChunk.data.data(), shapeChunk.data.size());
+		CubzhReadStream zhs(header, shapeChunk.chunk, memStream);
+		const bool success = loadShape6(filename, header, shapeChunk.chunk, zhs, shapeChunk.palette, shapeChunk.shape);
+		shapeChunk.data.release();
+		return success;
+	});
+	if (decoded) {
+		for (ShapeChunk &shapeChunk : shapes) {
+			if (!addShape6(shapeChunk.shape, sceneGraph)) {
+				shapes.clear();
+				return false;
+			}
+		}
+	}
+	shapes.clear();
+	return decoded;
 }
 
 bool CubzhFormat::loadVersion6(const core::String &filename, const Header &header, io::SeekableReadStream &stream,
 							   scenegraph::SceneGraph &sceneGraph, palette::Palette &palette,
 							   const LoadContext &ctx) const {
+	core::DynamicArray<ShapeChunk> shapes;
 	while (!stream.eos()) {
 		Log::debug("Remaining stream data: %d", (int)stream.remaining());
 		Chunk chunk;
@@ -705,6 +739,10 @@ bool CubzhFormat::loadVersion6(const core::String &filename, const Header &heade
 			Log::warn("Invalid chunk id found: %u", chunk.chunkId);
 			break;
 		}
+		if (chunk.chunkId != priv::CHUNK_ID_SHAPE_V6) {
+			// the shapes are decoded with the palette that was active when the chunk was found
+			wrapBool(loadShapes6(filename, header, shapes, sceneGraph))
+		}
 		switch (chunk.chunkId) {
 		case priv::CHUNK_ID_PALETTE_V6: {
 			Log::debug("load v6 palette");
@@ -720,8 +758,16 @@ bool CubzhFormat::loadVersion6(const core::String &filename, const Header &heade
 		}
 		case priv::CHUNK_ID_SHAPE_V6: {
 			Log::debug("load shape");
-			CubzhReadStream zhs(header, chunk, stream);
-			wrapBool(loadShape6(filename, header, chunk, zhs, sceneGraph, palette, ctx))
+			// only read the raw chunk data here - the shapes are decompressed and decoded in parallel
+			shapes.emplace_back();
+			ShapeChunk &shapeChunk = shapes.back();
+			shapeChunk.chunk = chunk;
+			shapeChunk.palette = palette;
+			shapeChunk.data.resize(chunk.chunkSize);
+			if (chunk.chunkSize > 0 && stream.read(shapeChunk.data.data(), chunk.chunkSize) != (int)chunk.chunkSize) {
+				Log::error("Could not load 3zh file: Not enough data in stream for shape chunk");
+				return false;
+			}
 			break;
 		}
 		case priv::CHUNK_ID_CAMERA_V6: {
@@ -746,7 +792,7 @@ bool CubzhFormat::loadVersion6(const core::String &filename, const Header &heade
 		}
 	}
 
-	return true;
+	return loadShapes6(filename, header, shapes, sceneGraph);
 }
 
 bool CubzhFormat::loadGroupsPalette(const core::String &filename, const io::ArchivePtr &archive,
@@ -5,7 +5,10 @@
 #pragma once
 
 #include "core/Log.h"
+#include "core/collection/DynamicArray.h"
 #include "io/Stream.h"
+#include "palette/Palette.h"
+#include "scenegraph/SceneGraphNode.h"
 #include "voxelformat/Format.h"
 
 namespace voxelformat {
@@ -339,8 +342,46 @@ protected:
 
 	bool loadVersion6(const core::String &filename, const Header &header, io::SeekableReadStream &stream,
 					  scenegraph::SceneGraph &sceneGraph, palette::Palette &palette, const LoadContext &ctx) const;
+	/**
+	 * @brief A named point or rotation of a shape
+	 */
+	struct ShapePoint {
+		core::String name;
+		glm::vec3 value{0.0f};
+		bool rotation = false;
+	};
+
+	/**
+	 * @brief A decoded shape chunk that wasn't yet added to the scene graph
+	 */
+	struct Shape {
+		scenegraph::SceneGraphNode node;
+		uint16_t parentShapeId = 0;
+		bool paletteFound = false;
+		core::DynamicArray<ShapePoint> points;
+	};
+
+	/**
+	 * @brief The raw (maybe compressed) data of a shape chunk - decoded in parallel with the other shapes
+	 */
+	struct ShapeChunk {
+		Chunk chunk;
+		core::DynamicArray<uint8_t> data;
+		palette::Palette palette;
+		Shape shape;
+	};
+
 	bool loadShape6(const core::String &filename, const Header &header, const Chunk &chunk, CubzhReadStream &stream,
-					scenegraph::SceneGraph &sceneGraph, const palette::Palette &palette, const LoadContext &ctx) const;
+					const palette::Palette &palette, Shape &shape) const;
+	/**
+	 * @brief Add the decoded shape to the scene graph - the parent shape must already be part of the scene graph
+	 */
+	bool addShape6(Shape &shape, scenegraph::SceneGraph &sceneGraph) const;
+	/**
+	 * @brief Decode the given shape chunks in parallel and add them to the scene graph in the order of the file
+	 */
+	bool loadShapes6(const core::String &filename, const Header &header, core::DynamicArray<ShapeChunk> &shapes,
+					 scenegraph::SceneGraph &sceneGraph) const;
 
 	bool loadVersion5(const core::String &filename, const Header &header, io::SeekableReadStream &stream,
 					  scenegraph::SceneGraph &sceneGraph, palette::Palette &palette, const LoadContext &ctx) const;
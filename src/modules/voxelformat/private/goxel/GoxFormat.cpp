@@ -184,113 +184,58 @@ image::ImagePtr GoxFormat::loadScreenshot(const core::String &filename, const io
 
 bool GoxFormat::loadChunk_LAYR(State &state, const GoxChunk &c, io::SeekableReadStream &stream,
 							   scenegraph::SceneGraph &sceneGraph, const palette::Palette &palette) {
-	const int size = (int)sceneGraph.size();
-	voxel::RawVolume *modelVolume = new voxel::RawVolume(voxel::Region(0, 0, 0, 1, 1, 1));
+	const int size = (int)sceneGraph.size() + (int)state.layers.size();
 	uint32_t blockCount;
 
-	palette::PaletteLookup palLookup(palette);
 	if ((stream.readUInt32(blockCount)) != 0) {
 		Log::error("Could not load gox file: Failed to read blockCount");
-		delete modelVolume;
 		return false;
 	}
 	Log::debug("Found LAYR chunk with %i blocks", blockCount);
+	state.layers.emplace_back();
+	Layer &layer = state.layers.back();
+	layer.blocks.reserve(blockCount);
 	for (uint32_t i = 0; i < blockCount; ++i) {
-		uint32_t index;
-		if ((stream.readUInt32(index)) != 0) {
+		LayerBlock block;
+		if ((stream.readUInt32(block.index)) != 0) {
 			Log::error("Could not load gox file: Failure to read block index");
-			delete modelVolume;
-			return false;
-		}
-		if (index > state.images.size()) {
-			Log::error("Index out of bounds: %u", index);
-			delete modelVolume;
 			return false;
 		}
-		const image::ImagePtr &img = state.images[index];
-		if (!img) {
-			Log::error("Invalid image index: %u", index);
-			delete modelVolume;
+		if (block.index >= state.pngs.size()) {
+			Log::error("Index out of bounds: %u", block.index);
 			return false;
 		}
-		Log::debug("LAYR references BL16 image with index %i", index);
-		const uint8_t *rgba = img->data();
-		int bpp = img->depth();
-		int w = img->width();
-		int h = img->height();
-		core_assert(w == 64 && h == 64 && bpp == 4);
-		(void)bpp;(void)w;(void)h;
-
-		int32_t x, y, z;
-		if (stream.readInt32(x) != 0) {
+		Log::debug("LAYR references BL16 image with index %i", block.index);
+
+		if (stream.readInt32(block.pos.x) != 0) {
 			Log::error("Could not load gox file: Failure to read block coordinate");
-			delete modelVolume;
 			return false;
 		}
-		if (stream.readInt32(y) != 0) {
+		if (stream.readInt32(block.pos.y) != 0) {
 			Log::error("Could not load gox file: Failure to read block coordinate");
-			delete modelVolume;
 			return false;
 		}
-		if (stream.readInt32(z) != 0) {
+		if (stream.readInt32(block.pos.z) != 0) {
 			Log::error("Could not load gox file: Failure to read block coordinate");
-			delete modelVolume;
 			return false;
 		}
 		// Previous version blocks pos.
 		if (state.version == 1) {
-			x -= 8;
-			y -= 8;
-			z -= 8;
+			block.pos -= 8;
 		}
 
 		if (stream.skip(4) == -1) {
 			Log::error("Could not load gox file: Failed to skip");
-			delete modelVolume;
 			return false;
 		}
-		const voxel::Region blockRegion(x, z, y, x + (BlockSize - 1), z + (BlockSize - 1), y + (BlockSize - 1));
-		core_assert(blockRegion.isValid());
-		voxel::RawVolume *blockVolume = new voxel::RawVolume(blockRegion);
-		const uint8_t *v = rgba;
-		bool empty = true;
-		for (int z1 = 0; z1 < BlockSize; ++z1) {
-			for (int y1 = 0; y1 < BlockSize; ++y1) {
-				for (int x1 = 0; x1 < BlockSize; ++x1) {
-					// x running fastest
-					voxel::Voxel voxel;
-					if (v[3] != 0u) {
-						const core::RGBA color(v[0], v[1], v[2], v[3]);
-						empty = false;
-						voxel = voxel::createVoxel(palette, palLookup.findClosestIndex(color));
-					}
-					blockVolume->setVoxel(x + x1, z + z1, y + y1, voxel);
-					v += 4;
-				}
-			}
-		}
-		// TODO: VOXELFORMAT: it looks like the whole node gets the same material in gox...
-		// this will remove empty blocks and the final volume might have a smaller region.
-		// TODO: VOXELFORMAT: we should remove this once we have sparse volumes support
-		if (!empty) {
-			voxel::Region destReg(modelVolume->region());
-			if (!destReg.containsRegion(blockRegion)) {
-				destReg.accumulate(blockRegion);
-				voxel::RawVolume *newVolume = new voxel::RawVolume(destReg);
-				voxelutil::copyIntoRegion(*modelVolume, *newVolume, modelVolume->region());
-				delete modelVolume;
-				modelVolume = newVolume;
-			}
-			voxelutil::mergeVolumes(modelVolume, blockVolume, blockRegion, blockRegion);
-		}
-		delete blockVolume;
+		layer.blocks.push_back(block);
 	}
 	bool visible = true;
 	char dictKey[256];
 	char dictValue[256];
 	int valueLength = 0;
 	scenegraph::KeyFrameIndex keyFrameIdx = 0;
-	scenegraph::SceneGraphNode node;
+	scenegraph::SceneGraphNode &node = layer.node;
 	node.setName(core::string::format("model %i", size));
 	while (loadChunk_DictEntry(c, stream, dictKey, dictValue, valueLength)) {
 		if (!strcmp(dictKey, "name")) {
@@ -333,41 +278,134 @@ bool GoxFormat::loadChunk_LAYR(State &state, const GoxChunk &c, io::SeekableRead
 			Log::debug("LAYR chunk with key: %s and size %i", dictKey, valueLength);
 		}
 	}
+	node.setVisible(visible);
+	return true;
+}
 
-	voxel::RawVolume *mirrored = voxelutil::mirrorAxis(modelVolume, math::Axis::X);
-	voxel::RawVolume *cropped = voxelutil::cropVolume(mirrored);
-	const glm::ivec3 mins = cropped->region().getLowerCorner();
-	cropped->translate(-mins);
-
-	scenegraph::SceneGraphTransform &transform = node.transform(keyFrameIdx);
-	transform.setWorldTranslation(mins);
+bool GoxFormat::decodeLayer(const State &state, Layer &layer, const palette::Palette &palette) const {
+	voxel::RawVolume *modelVolume = new voxel::RawVolume(voxel::Region(0, 0, 0, 1, 1, 1));
+	palette::PaletteLookup palLookup(palette);
+	for (const LayerBlock &block : layer.blocks) {
+		const image::ImagePtr &img = state.images[block.index];
+		if (!img) {
+			Log::error("Invalid image index: %u", block.index);
+			delete modelVolume;
+			return false;
+		}
+		const uint8_t *rgba = img->data();
+		const int x = block.pos.x;
+		const int y = block.pos.y;
+		const int z = block.pos.z;
+		const voxel::Region blockRegion(x, z, y, x + (BlockSize - 1), z + (BlockSize - 1), y + (BlockSize - 1));
+		core_assert(blockRegion.isValid());
+		voxel::RawVolume *blockVolume = new voxel::RawVolume(blockRegion);
+		const uint8_t *v = rgba;
+		bool empty = true;
+		for (int z1 = 0; z1 < BlockSize; ++z1) {
+			for (int y1 = 0; y1 < BlockSize; ++y1) {
+				for (int x1 = 0; x1 < BlockSize; ++x1) {
+					// x running fastest
+					voxel::Voxel voxel;
+					if (v[3] != 0u) {
+						const core::RGBA color(v[0], v[1], v[2], v[3]);
+						empty = false;
+						voxel = voxel::createVoxel(palette, palLookup.findClosestIndex(color));
+					}
+					blockVolume->setVoxel(x + x1, z + z1, y + y1, voxel);
+					v += 4;
+				}
+			}
+		}
+		// TODO: VOXELFORMAT: it looks like the whole node gets the same material in gox...
+		// this will remove empty blocks and the final volume might have a smaller region.
+		// TODO: VOXELFORMAT: we should remove this once we have sparse volumes support
+		if (!empty) {
+			voxel::Region destReg(modelVolume->region());
+			if (!destReg.containsRegion(blockRegion)) {
+				destReg.accumulate(blockRegion);
+				voxel::RawVolume *newVolume = new voxel::RawVolume(destReg);
+				voxelutil::copyIntoRegion(*modelVolume, *newVolume, modelVolume->region());
+				delete modelVolume;
+				modelVolume = newVolume;
+			}
+			voxelutil::mergeVolumes(modelVolume, blockVolume, blockRegion, blockRegion);
+		}
+		delete blockVolume;
+	}
 
-	node.setVolume(cropped, true);
-	node.setVisible(visible);
-	node.setPalette(palLookup.palette());
-	sceneGraph.emplace(core::move(node));
+	voxel::RawVolume *mirrored = voxelutil::mirrorAxis(modelVolume, math::Axis::X);
 	delete modelVolume;
+	layer.volume = voxelutil::cropVolume(mirrored);
 	delete mirrored;
-	return true;
+	return layer.volume != nullptr;
 }
 
 bool GoxFormat::loadChunk_BL16(State &state, const GoxChunk &c, io::SeekableReadStream &stream) {
-	uint8_t *png = (uint8_t *)core_malloc(c.length);
-	wrapBool(loadChunk_ReadData(stream, (char *)png, c.length))
-	image::ImagePtr img = image::createEmptyImage("gox-voxeldata");
-	bool success = img->load(png, c.length);
-	core_free(png);
-	if (!success) {
-		Log::error("Failed to load png chunk");
+	if (c.length <= 0) {
+		Log::error("Invalid png chunk size: %i", c.length);
 		return false;
 	}
-	if (img->width() != 64 || img->height() != 64 || img->depth() != 4) {
-		Log::error("Invalid image dimensions: %i:%i", img->width(), img->height());
+	// the png data is decoded in parallel once the blocks are referenced by the layers
+	state.pngs.emplace_back();
+	core::DynamicArray<uint8_t> &png = state.pngs.back();
+	png.resize(c.length);
+	wrapBool(loadChunk_ReadData(stream, (char *)png.data(), c.length))
+	Log::debug("Found BL16 with index %i", (int)state.pngs.size() - 1);
+	return true;
+}
+
+bool GoxFormat::decodeBlocks(State &state) {
+	const int start = (int)state.images.size();
+	const int n = (int)state.pngs.size() - start;
+	state.images.resize(state.pngs.size());
+	return decodeParallel(n, [&](int idx) {
+		core::DynamicArray<uint8_t> &png = state.pngs[start + idx];
+		image::ImagePtr img = image::createEmptyImage("gox-voxeldata");
+		const bool success = img->load(png.data(), (int)png.size());
+		png.release();
+		if (!success) {
+			Log::error("Failed to load png chunk");
+			return false;
+		}
+		if (img->width() != 64 || img->height() != 64 || img->depth() != 4) {
+			Log::error("Invalid image dimensions: %i:%i", img->width(), img->height());
+			return false;
+		}
+		state.images[start + idx] = img;
+		return true;
+	});
+}
+
+bool GoxFormat::loadLayers(State &state, scenegraph::SceneGraph &sceneGraph, const palette::Palette &palette) {
+	if (state.layers.empty()) {
+		return true;
+	}
+	if (!decodeBlocks(state)) {
 		return false;
 	}
-	Log::debug("Found BL16 with index %i", (int)state.images.size());
-	state.images.push_back(img);
-	return true;
+	const bool decoded = decodeParallel((int)state.layers.size(),
+										[&](int idx) { return decodeLayer(state, state.layers[idx], palette); });
+	const palette::PaletteLookup palLookup(palette);
+	for (Layer &layer : state.layers) {
+		if (!decoded) {
+			delete layer.volume;
+			continue;
+		}
+		scenegraph::SceneGraphNode &node = layer.node;
+		voxel::RawVolume *cropped = layer.volume;
+		const glm::ivec3 mins = cropped->region().getLowerCorner();
+		cropped->translate(-mins);
+
+		const scenegraph::KeyFrameIndex keyFrameIdx = 0;
+		scenegraph::SceneGraphTransform &transform = node.transform(keyFrameIdx);
+		transform.setWorldTranslation(mins);
+
+		node.setVolume(cropped, true);
+		node.setPalette(palLookup.palette());
+		sceneGraph.emplace(core::move(node));
+	}
+	state.layers.clear();
+	return decoded;
 }
 
 bool GoxFormat::loadChunk_MATE(State &state, const GoxChunk &c, io::SeekableReadStream &stream,
@@ -555,6 +593,7 @@ size_t GoxFormat::loadPalette(const core::String &filename, const io::ArchivePtr
 		}
 		loadChunk_ValidateCRC(*stream);
 	}
+	wrapBool(decodeBlocks(state))
 
 	RGBAMap colors;
 	for (image::ImagePtr &img : state.images) {
@@ -598,6 +637,10 @@ bool GoxFormat::loadGroupsRGBA(const core::String &filename, const io::ArchivePt
 
 	GoxChunk c;
 	while (loadChunk_Header(c, *stream)) {
+		if (c.type != FourCC('L', 'A', 'Y', 'R')) {
+			// keep the order of the nodes - add the pending layers before e.g. the camera is added
+			wrapBool(loadLayers(state, sceneGraph, palette))
+		}
 		if (c.type == FourCC('B', 'L', '1', '6')) {
 			wrapBool(loadChunk_BL16(state, c, *stream))
 		} else if (c.type == FourCC('L', 'A', 'Y', 'R')) {
@@ -615,6 +658,7 @@ bool GoxFormat::loadGroupsRGBA(const core::String &filename, const io::ArchivePt
 		}
 		loadChunk_ValidateCRC(*stream);
 	}
+	wrapBool(loadLayers(state, sceneGraph, palette))
 	return !sceneGraph.empty();
 }
 
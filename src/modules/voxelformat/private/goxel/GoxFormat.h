@@ -9,6 +9,7 @@
 #include "voxelformat/Format.h"
 #include "core/collection/DynamicArray.h"
 #include "io/Stream.h"
+#include "scenegraph/SceneGraphNode.h"
 
 namespace voxelformat {
 /**
@@ -81,12 +82,37 @@ private:
 		int32_t length = 0u;
 	};
 
+	struct LayerBlock {
+		/** index of the BL16 image */
+		uint32_t index = 0u;
+		glm::ivec3 pos{0};
+	};
+
+	/**
+	 * @brief A parsed LAYR chunk - the volume is assembled from the blocks after all layers of a sequence are known
+	 */
+	struct Layer {
+		scenegraph::SceneGraphNode node;
+		core::DynamicArray<LayerBlock> blocks;
+		voxel::RawVolume *volume = nullptr;
+	};
+
 	struct State {
 		int32_t version = 0;
+		/** png encoded BL16 chunks that were not yet decoded into @c images */
+		core::DynamicArray<core::DynamicArray<uint8_t>> pngs;
 		core::DynamicArray<image::ImagePtr> images;
+		core::DynamicArray<Layer> layers;
 		core::StringMap<palette::Material> materials;
 	};
 
+	bool decodeBlocks(State &state);
+	bool decodeLayer(const State &state, Layer &layer, const palette::Palette &palette) const;
+	/**
+	 * @brief Decode the pending layers in parallel and add them to the scene graph in the order of the file
+	 */
+	bool loadLayers(State &state, scenegraph::SceneGraph &sceneGraph, const palette::Palette &palette);
+
 	bool loadChunk_Header(GoxChunk &c, io::SeekableReadStream &stream);
 	bool loadChunk_ReadData(io::SeekableReadStream &stream, char *buff, int size);
 	void loadChunk_ValidateCRC(io::SeekableReadStream &stream);
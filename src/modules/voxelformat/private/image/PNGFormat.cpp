@@ -3,11 +3,15 @@
  */
 
 #include "PNGFormat.h"
+#include "app/Async.h"
 #include "core/ConfigVar.h"
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
 #include "core/Var.h"
+#include "core/collection/Buffer.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Atomic.h"
 #include "image/Image.h"
 #include "io/Archive.h"
 #include "io/FilesystemEntry.h"
@@ -16,6 +20,7 @@
 #include "palette/PaletteLookup.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
+#include "voxel/RawVolume.h"
 #include "voxel/RawVolumeWrapper.h"
 #include "voxel/Voxel.h"
 #include "voxelutil/ImageUtils.h"
@@ -65,30 +70,67 @@ bool PNGFormat::importSlices(scenegraph::SceneGraph &sceneGraph, const palette::
 	node.setName(core::string::extractFilename(filename));
 	node.setPalette(palette);
 
+	// every slice is decoded and imported by one task - the decoding of the slices overlaps with the filling of the
+	// other slices. Slices with the same layer number would write into the same memory - only the first one is used.
+	core::DynamicArray<int> layers;
+	layers.reserve(entities.size());
+	core::Buffer<bool> usedLayers;
+	usedLayers.resize(maxsZ - minsZ + 1);
+	for (int i = 0; i < (int)usedLayers.size(); ++i) {
+		usedLayers[i] = false;
+	}
 	for (const auto &entity : entities) {
-		const core::String &layetFilename = entity.fullPath;
-		const image::ImagePtr &image = image::loadImage(layetFilename);
-		if (!image || !image->isLoaded()) {
-			Log::error("Failed to load image %s", layetFilename.c_str());
-			return false;
-		}
-		if (imageWidth != image->width() || imageHeight != image->height()) {
-			Log::error("Image %s has different dimensions than the first image (%d:%d) vs (%d:%d)", layetFilename.c_str(),
-					   image->width(), image->height(), imageWidth, imageHeight);
-			return false;
+		const int layer = extractLayerFromFilename(entity.fullPath);
+		if (usedLayers[layer - minsZ]) {
+			Log::warn("Skip image %s - layer %i is already used", entity.fullPath.c_str(), layer);
+			layers.push_back(minsZ - 1);
+			continue;
 		}
-		const int layer = extractLayerFromFilename(layetFilename);
-		Log::debug("Import layer %i of image %s", layer, layetFilename.c_str());
-		for (int y = 0; y < imageHeight; ++y) {
-			for (int x = 0; x < imageWidth; ++x) {
-				const core::RGBA &color = flattenRGB(image->colorAt(x, y));
-				if (color.a == 0) {
+		usedLayers[layer - minsZ] = true;
+		layers.push_back(layer);
+	}
+
+	core::AtomicBool failed{false};
+	app::for_parallel(
+		0, (int)entities.size(),
+		[&](int start, int end) {
+			palette::PaletteLookup palLookup(palette, 4096);
+			voxel::RawVolume::Sampler sampler(volume);
+			for (int i = start; i < end; ++i) {
+				const int layer = layers[i];
+				if (failed || layer < minsZ) {
 					continue;
 				}
-				const int palIdx = palette.getClosestMatch(color);
-				volume->setVoxel(x, y, layer, voxel::createVoxel(palette, palIdx));
+				const core::String &layetFilename = entities[i].fullPath;
+				const image::ImagePtr &image = image::loadImage(layetFilename);
+				if (!image || !image->isLoaded()) {
+					Log::error("Failed to load image %s", layetFilename.c_str());
+					failed = true;
+					return;
+				}
+				if (imageWidth != image->width() || imageHeight != image->height()) {
+					Log::error("Image %s has different dimensions than the first image (%d:%d) vs (%d:%d)",
+							   layetFilename.c_str(), image->width(), image->height(), imageWidth, imageHeight);
+					failed = true;
+					return;
+				}
+				Log::debug("Import layer %i of image %s", layer, layetFilename.c_str());
+				for (int y = 0; y < imageHeight; ++y) {
+					sampler.setPosition(0, y, layer);
+					for (int x = 0; x < imageWidth; ++x, sampler.movePositiveX()) {
+						const core::RGBA &color = flattenRGB(image->colorAt(x, y));
+						if (color.a == 0) {
+							continue;
+						}
+						const uint8_t palIdx = palLookup.findClosestIndex(color);
+						sampler.setVoxel(voxel::createVoxel(palette, palIdx));
+					}
+				}
 			}
-		}
+		},
+		1);
+	if (failed) {
+		return false;
 	}
 	if (sceneGraph.emplace(core::move(node)) == InvalidNodeId) {
 		Log::error("Failed to add node to scene graph");
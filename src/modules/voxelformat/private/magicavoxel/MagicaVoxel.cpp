@@ -3,6 +3,7 @@
  */
 
 #include "MagicaVoxel.h"
+#include "app/Async.h"
 #include "core/Color.h"
 #include "core/GLMConst.h"
 #include "core/Log.h"
@@ -12,6 +13,7 @@
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxel/RawVolume.h"
+#include "voxelutil/VolumeImporter.h"
 #include "core/Endian.h"
 #ifndef GLM_ENABLE_EXPERIMENTAL
 #define GLM_ENABLE_EXPERIMENTAL
@@ -277,33 +279,40 @@ bool instanceHidden(const ogt_vox_scene *scene, const ogt_vox_instance &instance
 	return false;
 }
 
+void fillVoxelRemap(const palette::Palette &palette, voxel::Voxel *remap) {
+	remap[0] = voxel::Voxel();
+	for (int i = 1; i < 256; ++i) {
+		remap[i] = voxel::createVoxel(palette, (uint8_t)(i - 1));
+	}
+}
+
 core::DynamicArray<MVModelToNode> loadModels(const ogt_vox_scene *scene, const palette::Palette &palette) {
 	core::DynamicArray<MVModelToNode> models;
-	models.reserve(scene->num_models);
-	for (uint32_t i = 0; i < scene->num_models; ++i) {
-		const ogt_vox_model *ogtModel = scene->models[i];
-		if (ogtModel == nullptr) {
-			models.emplace_back(nullptr, InvalidNodeId);
-			continue;
-		}
-		voxel::Region region(glm::ivec3(0),
-							 glm::ivec3(ogtModel->size_x - 1, ogtModel->size_z - 1, ogtModel->size_y - 1));
-		voxel::RawVolume *v = new voxel::RawVolume(region);
-
-		const uint8_t *ogtVoxel = ogtModel->voxel_data;
-		for (uint32_t z = 0; z < ogtModel->size_z; ++z) {
-			for (uint32_t y = 0; y < ogtModel->size_y; ++y) {
-				for (uint32_t x = 0; x < ogtModel->size_x; ++x, ++ogtVoxel) {
-					if (ogtVoxel[0] == 0) {
-						continue;
-					}
-					const voxel::Voxel voxel = voxel::createVoxel(palette, ogtVoxel[0] - 1);
-					v->setVoxel(region.getUpperX() - (int)x, (int)z, (int)y, voxel);
+	models.resize(scene->num_models);
+	voxel::Voxel remap[256];
+	fillVoxelRemap(palette, remap);
+	app::for_parallel(
+		0, (int)scene->num_models,
+		[&](int start, int end) {
+			for (int i = start; i < end; ++i) {
+				const ogt_vox_model *ogtModel = scene->models[i];
+				if (ogtModel == nullptr) {
+					continue;
+				}
+				// the vox z axis is our y axis and the x axis is mirrored
+				voxelutil::GridLayout layout;
+				layout.size = glm::ivec3(ogtModel->size_x, ogtModel->size_y, ogtModel->size_z);
+				layout.volumeAxis = glm::ivec3(0, 2, 1);
+				layout.flip = glm::bvec3(true, false, false);
+				voxelutil::VolumeImporter importer(layout);
+				if (!importer.isValid()) {
+					continue;
 				}
+				importer.setGrid(ogtModel->voxel_data, remap);
+				models[i].volume = importer.release();
 			}
-		}
-		models.emplace_back(v, InvalidNodeId);
-	}
+		},
+		1);
 	return models;
 }
 
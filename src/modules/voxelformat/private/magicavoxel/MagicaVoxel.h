@@ -19,6 +19,7 @@ class Palette;
 
 namespace voxel {
 class RawVolume;
+class Voxel;
 } // namespace voxel
 
 namespace scenegraph {
@@ -96,6 +97,11 @@ struct MVModelToNode {
 	voxel::RawVolume *volume;
 	int nodeId;
 };
+/**
+ * @brief Fills the voxels for all 256 color indices of the vox file - index @c 0 is air
+ * @param remap The target buffer for 256 voxels
+ */
+void fillVoxelRemap(const palette::Palette &palette, voxel::Voxel *remap);
 core::DynamicArray<MVModelToNode> loadModels(const ogt_vox_scene *scene, const palette::Palette &palette);
 
 } // namespace voxelformat
@@ -4,14 +4,18 @@
 
 #include "VoxFormat.h"
 #include "core/ConfigVar.h"
+#include "core/FourCC.h"
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
 #include "core/Var.h"
+#include "core/collection/DynamicMap.h"
+#include "core/collection/DynamicStringMap.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxel/RawVolume.h"
 #include "voxelformat/external/ogt_vox.h"
+#include "voxelutil/VolumeImporter.h"
 #include "voxelutil/VolumeVisitor.h"
 #include "MagicaVoxel.h"
 #include "palette/Palette.h"
@@ -50,22 +54,334 @@ size_t VoxFormat::loadPalette(const core::String &filename, const io::ArchivePtr
 	return palette.colorCount();
 }
 
-bool VoxFormat::loadInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceIdx, scenegraph::SceneGraph &sceneGraph,
-							 int parent, core::DynamicArray<MVModelToNode> &models, const palette::Palette &palette) {
+namespace {
+
+struct VoxProbeTransform {
+	core::String name;
+	int32_t child = -1;
+	int32_t layer = -1;
+	/** the default rotation is the identity matrix */
+	uint8_t rotation = 4u;
+};
+
+struct VoxProbeModel {
+	glm::ivec3 size{0};
+	int64_t voxels = -1;
+};
+
+/**
+ * @brief The chunks of a vox file that describe the scene - the voxel data of the models is skipped
+ */
+struct VoxProbeContext {
+	core::DynamicArray<VoxProbeModel> models;
+	core::DynamicMap<int32_t, VoxProbeTransform> transforms;
+	core::DynamicMap<int32_t, core::DynamicArray<int32_t>> groups;
+	core::DynamicMap<int32_t, core::DynamicArray<int32_t>> shapes;
+	core::DynamicMap<int32_t, core::String> layers;
+};
+
+} // namespace
+
+static bool readDict(io::SeekableReadStream &stream, core::DynamicStringMap<core::String> &dict) {
+	int32_t entries;
+	if (stream.readInt32(entries) != 0 || entries < 0) {
+		return false;
+	}
+	for (int32_t i = 0; i < entries; ++i) {
+		core::String key;
+		core::String value;
+		if (!stream.readPascalStringUInt32LE(key) || !stream.readPascalStringUInt32LE(value)) {
+			return false;
+		}
+		dict.put(key, value);
+	}
+	return true;
+}
+
+static bool probeChunk(io::SeekableReadStream &stream, uint32_t chunkId, VoxProbeContext &ctx) {
+	core::DynamicStringMap<core::String> dict;
+	int32_t nodeId;
+	switch (chunkId) {
+	case FourCC('S', 'I', 'Z', 'E'): {
+		VoxProbeModel model;
+		if (stream.readInt32(model.size.x) != 0 || stream.readInt32(model.size.y) != 0 ||
+			stream.readInt32(model.size.z) != 0) {
+			return false;
+		}
+		ctx.models.push_back(model);
+		return true;
+	}
+	case FourCC('X', 'Y', 'Z', 'I'): {
+		int32_t voxels;
+		if (ctx.models.empty() || stream.readInt32(voxels) != 0) {
+			return false;
+		}
+		ctx.models.back().voxels = voxels;
+		return true;
+	}
+	case FourCC('n', 'T', 'R', 'N'): {
+		VoxProbeTransform transform;
+		int32_t reserved;
+		int32_t frames;
+		if (stream.readInt32(nodeId) != 0 || !readDict(stream, dict) || stream.readInt32(transform.child) != 0 ||
+			stream.readInt32(reserved) != 0 || stream.readInt32(transform.layer) != 0 ||
+			stream.readInt32(frames) != 0) {
+			return false;
+		}
+		dict.get("_name", transform.name);
+		if (frames > 0) {
+			core::DynamicStringMap<core::String> frame;
+			if (!readDict(stream, frame)) {
+				return false;
+			}
+			core::String rotation;
+			if (frame.get("_r", rotation)) {
+				transform.rotation = (uint8_t)rotation.toInt();
+			}
+		}
+		ctx.transforms.put(nodeId, transform);
+		return true;
+	}
+	case FourCC('n', 'G', 'R', 'P'):
+	case FourCC('n', 'S', 'H', 'P'): {
+		int32_t children;
+		if (stream.readInt32(nodeId) != 0 || !readDict(stream, dict) || stream.readInt32(children) != 0 ||
+			children < 0) {
+			return false;
+		}
+		core::DynamicArray<int32_t> ids;
+		ids.reserve(children);
+		for (int32_t i = 0; i < children; ++i) {
+			int32_t id;
+			if (stream.readInt32(id) != 0) {
+				return false;
+			}
+			ids.push_back(id);
+			if (chunkId == FourCC('n', 'S', 'H', 'P')) {
+				// the model attributes
+				core::DynamicStringMap<core::String> modelDict;
+				if (!readDict(stream, modelDict)) {
+					return false;
+				}
+			}
+		}
+		if (chunkId == FourCC('n', 'G', 'R', 'P')) {
+			ctx.groups.put(nodeId, ids);
+		} else {
+			ctx.shapes.put(nodeId, ids);
+		}
+		return true;
+	}
+	case FourCC('L', 'A', 'Y', 'R'): {
+		if (stream.readInt32(nodeId) != 0 || !readDict(stream, dict)) {
+			return false;
+		}
+		core::String name;
+		dict.get("_name", name);
+		ctx.layers.put(nodeId, name);
+		return true;
+	}
+	default:
+		return true;
+	}
+}
+
+static voxel::Region probeModelRegion(const VoxProbeModel &model, uint8_t rotation) {
+	// the rotation is stored as the column index of the non-zero entry of the first and second row
+	const int row0 = rotation & 3;
+	const int row1 = (rotation >> 2) & 3;
+	const int row2 = 3 - row0 - row1;
+	if (row0 > 2 || row1 > 2 || row0 == row1) {
+		return voxel::Region(glm::ivec3(0), glm::ivec3(model.size.x, model.size.z, model.size.y) - 1);
+	}
+	const glm::ivec3 size(model.size[row0], model.size[row1], model.size[row2]);
+	// z is pointing upwards in magicavoxel
+	return voxel::Region(glm::ivec3(0), glm::ivec3(size.x, size.z, size.y) - 1);
+}
+
+static void probeTransform_r(const VoxProbeContext &ctx, int32_t transformId, int parent, SceneInfo &info,
+							 int depth) {
+	VoxProbeTransform transform;
+	if (depth > 64 || !ctx.transforms.get(transformId, transform)) {
+		return;
+	}
+	core::String layerName;
+	ctx.layers.get(transform.layer, layerName);
+	core::DynamicArray<int32_t> children;
+	if (ctx.groups.get(transform.child, children)) {
+		int groupIdx = parent;
+		if (depth > 0) {
+			SceneInfo::Node node;
+			node.type = scenegraph::SceneGraphNodeType::Group;
+			node.name = !layerName.empty() ? layerName : (!transform.name.empty() ? transform.name : "Group");
+			node.parent = parent;
+			info.nodes.push_back(node);
+			groupIdx = (int)info.nodes.size() - 1;
+		}
+		// same order as the scene graph: the groups first, the models afterwards
+		for (int pass = 0; pass < 2; ++pass) {
+			for (int32_t child : children) {
+				VoxProbeTransform childTransform;
+				if (!ctx.transforms.get(child, childTransform)) {
+					continue;
+				}
+				if (ctx.groups.hasKey(childTransform.child) == (pass == 0)) {
+					probeTransform_r(ctx, child, groupIdx, info, depth + 1);
+				}
+			}
+		}
+		return;
+	}
+	core::DynamicArray<int32_t> models;
+	if (!ctx.shapes.get(transform.child, models)) {
+		return;
+	}
+	for (int32_t modelIdx : models) {
+		if (modelIdx < 0 || modelIdx >= (int32_t)ctx.models.size()) {
+			continue;
+		}
+		const VoxProbeModel &model = ctx.models[modelIdx];
+		SceneInfo::Node node;
+		node.type = scenegraph::SceneGraphNodeType::Model;
+		node.name = transform.name.empty() ? layerName : transform.name;
+		node.parent = parent;
+		node.region = probeModelRegion(model, transform.rotation);
+		node.voxels = model.voxels;
+		info.nodes.push_back(node);
+	}
+}
+
+bool VoxFormat::probe(const core::String &filename, const io::ArchivePtr &archive, SceneInfo &info,
+					  const LoadContext &ctx) {
+	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
+	if (!stream) {
+		Log::error("Could not open file %s", filename.c_str());
+		return false;
+	}
+	uint32_t magic;
+	uint32_t version;
+	if (stream->readUInt32(magic) != 0 || magic != FourCC('V', 'O', 'X', ' ') || stream->readUInt32(version) != 0) {
+		Log::error("Invalid vox file %s", filename.c_str());
+		return false;
+	}
+
+	VoxProbeContext probeCtx;
+	bool hasPalette = false;
+	core::RGBA colors[palette::PaletteMaxColors];
+	// only the chunk headers and the scene description is read - the voxel data is skipped
+	while (!stream->eos()) {
+		uint32_t chunkId;
+		uint32_t contentSize;
+		uint32_t childrenSize;
+		if (stream->readUInt32(chunkId) != 0 || stream->readUInt32(contentSize) != 0 ||
+			stream->readUInt32(childrenSize) != 0) {
+			break;
+		}
+		if (chunkId == FourCC('M', 'A', 'I', 'N')) {
+			// the children of the main chunk are the following chunks
+			stream->skip(contentSize);
+			continue;
+		}
+		const int64_t chunkEnd = stream->pos() + (int64_t)contentSize;
+		if (chunkId == FourCC('R', 'G', 'B', 'A')) {
+			for (int i = 0; i < palette::PaletteMaxColors; ++i) {
+				if (stream->readUInt32(colors[i].rgba) != 0) {
+					Log::error("Failed to read the palette of %s", filename.c_str());
+					return false;
+				}
+			}
+			hasPalette = true;
+		} else if (!probeChunk(*stream, chunkId, probeCtx)) {
+			Log::error("Failed to read the chunk %u of %s", chunkId, filename.c_str());
+			return false;
+		}
+		if (stream->seek(chunkEnd + (int64_t)childrenSize) == -1) {
+			break;
+		}
+	}
+
+	if (probeCtx.transforms.hasKey(0)) {
+		probeTransform_r(probeCtx, 0, -1, info, 0);
+	} else {
+		// old files without a scene graph
+		for (const VoxProbeModel &model : probeCtx.models) {
+			SceneInfo::Node node;
+			node.type = scenegraph::SceneGraphNodeType::Model;
+			node.region = probeModelRegion(model, 4u);
+			node.voxels = model.voxels;
+			info.nodes.push_back(node);
+		}
+	}
+
+	// see loadPaletteFromScene() - the first color of the vox palette is the empty voxel
+	if (hasPalette) {
+		info.palette.setSize(0);
+		int n = 0;
+		for (int i = 0; i < palette::PaletteMaxColors - 1; ++i) {
+			info.palette.setColor(i, colors[i]);
+			if (colors[i].a > 0) {
+				n = i + 1;
+			}
+		}
+		if (n > 0) {
+			info.palette.setSize(n);
+		}
+	} else {
+		info.palette.magicaVoxel();
+	}
+	info.hasPalette = true;
+	return true;
+}
+
+void VoxFormat::decodeInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceIdx, const voxel::Voxel *remap,
+							   InstanceVolume &instanceVolume) {
 	const ogt_vox_instance &ogtInstance = scene->instances[ogt_instanceIdx];
 	const ogt_vox_model *ogtModel = scene->models[ogtInstance.model_index];
 	const glm::mat4 &ogtMat = ogtTransformToMat(ogtInstance, 0, scene, ogtModel);
-	const glm::ivec3 &ogtMins = calcTransform(ogtMat, glm::vec3(0));
-	const glm::ivec3 &ogtMaxs = calcTransform(ogtMat, ogtVolumeSize(ogtModel));
-	const glm::ivec3 mins(-(ogtMins.x + 1), ogtMins.z, ogtMins.y);
-	const glm::ivec3 maxs(-(ogtMaxs.x + 1), ogtMaxs.z, ogtMaxs.y);
+	auto volumePos = [&ogtMat](const glm::vec3 &pos) {
+		const glm::ivec3 &ogtPos = calcTransform(ogtMat, pos);
+		return glm::ivec3(-(ogtPos.x + 1), ogtPos.z, ogtPos.y);
+	};
+	const glm::ivec3 &mins = volumePos(glm::vec3(0));
+	const glm::ivec3 &maxs = volumePos(ogtVolumeSize(ogtModel));
 	voxel::Region region(glm::min(mins, maxs), glm::max(mins, maxs));
 	const glm::ivec3 shift = region.getLowerCorner();
 	region.shift(-shift);
-	voxel::RawVolume *v = new voxel::RawVolume(region);
-	scenegraph::SceneGraphTransform transform;
-	transform.setWorldTranslation(shift);
+	instanceVolume.shift = shift;
+
+	// the transform is a rotation by multiples of 90 degrees - every step along a model axis is a step along one of
+	// the volume axes and the whole model can be copied with fixed strides
+	voxelutil::GridLayout layout;
+	layout.size = glm::ivec3(ogtModel->size_x, ogtModel->size_y, ogtModel->size_z);
+	const glm::ivec3 origin = mins - shift;
+	bool gridLayout = true;
+	for (int i = 0; i < 3; ++i) {
+		glm::vec3 step(0.0f);
+		step[i] = 1.0f;
+		const glm::ivec3 delta = volumePos(step) - mins;
+		const glm::ivec3 absDelta = glm::abs(delta);
+		if (absDelta.x + absDelta.y + absDelta.z != 1) {
+			gridLayout = false;
+			break;
+		}
+		const int axis = absDelta.x ? 0 : (absDelta.y ? 1 : 2);
+		layout.volumeAxis[i] = axis;
+		layout.flip[i] = delta[axis] < 0;
+		if (origin[axis] != (layout.flip[i] ? layout.size[i] - 1 : 0)) {
+			gridLayout = false;
+			break;
+		}
+	}
+	if (gridLayout) {
+		voxelutil::VolumeImporter importer(layout);
+		if (importer.isValid() && importer.region() == region) {
+			importer.setGrid(ogtModel->voxel_data, remap);
+			instanceVolume.volume = importer.release();
+			return;
+		}
+	}
 
+	voxel::RawVolume *v = new voxel::RawVolume(region);
 	const uint8_t *ogtVoxel = ogtModel->voxel_data;
 	for (uint32_t k = 0; k < ogtModel->size_z; ++k) {
 		for (uint32_t j = 0; j < ogtModel->size_y; ++j) {
@@ -73,13 +389,25 @@ bool VoxFormat::loadInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceId
 				if (ogtVoxel[0] == 0) {
 					continue;
 				}
-				const voxel::Voxel voxel = voxel::createVoxel(palette, ogtVoxel[0] - 1);
-				const glm::ivec3 &ogtPos = calcTransform(ogtMat, glm::vec3(i, j, k));
-				const glm::ivec3 pos(-(ogtPos.x + 1), ogtPos.z, ogtPos.y);
-				v->setVoxel(pos - shift, voxel);
+				v->setVoxel(volumePos(glm::vec3(i, j, k)) - shift, remap[ogtVoxel[0]]);
 			}
 		}
 	}
+	instanceVolume.volume = v;
+}
+
+bool VoxFormat::loadInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceIdx, scenegraph::SceneGraph &sceneGraph,
+							 int parent, InstanceVolumes &instanceVolumes, const palette::Palette &palette) {
+	const ogt_vox_instance &ogtInstance = scene->instances[ogt_instanceIdx];
+	InstanceVolume &instanceVolume = instanceVolumes[ogt_instanceIdx];
+	voxel::RawVolume *v = instanceVolume.volume;
+	if (v == nullptr) {
+		Log::error("No volume for instance %u", ogt_instanceIdx);
+		return false;
+	}
+	instanceVolume.volume = nullptr;
+	scenegraph::SceneGraphTransform transform;
+	transform.setWorldTranslation(instanceVolume.shift);
 
 	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
 	loadKeyFrames(sceneGraph, node, ogtInstance, scene);
@@ -98,7 +426,6 @@ bool VoxFormat::loadInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceId
 	node.setVisible(!instanceHidden(scene, ogtInstance));
 	node.setVolume(v, true);
 	// TODO: VOXELFORMAT: use already loaded models and create a model reference if needed
-	// TODO: VOXELFORMAT: node.setVolume(new voxel::RawVolume(models[ogtInstance.model_index].volume), true);
 	// TODO: VOXELFORMAT: set correct pivot
 	// TODO: VOXELFORMAT: node.setPivot({ogtPivot.x / (float)ogtModel->size_x, ogtPivot.z / (float)ogtModel->size_z, ogtPivot.y / (float)ogtModel->size_y});
 	// TODO: VOXELFORMAT: node.setPivot({(ogtPivot.x + 0.5f) / (float)ogtModel->size_x, (ogtPivot.z + 0.5f) / (float)ogtModel->size_z, (ogtPivot.y + 0.5f) / (float)ogtModel->size_y});
@@ -107,7 +434,7 @@ bool VoxFormat::loadInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceId
 }
 
 bool VoxFormat::loadGroup(const ogt_vox_scene *scene, uint32_t ogt_groupIdx, scenegraph::SceneGraph &sceneGraph,
-						  int parent, core::DynamicArray<MVModelToNode> &models, core::Set<uint32_t> &addedInstances,
+						  int parent, InstanceVolumes &instanceVolumes, core::Set<uint32_t> &addedInstances,
 						  const palette::Palette &palette) {
 	const ogt_vox_group &ogt_group = scene->groups[ogt_groupIdx];
 	bool hidden = ogt_group.hidden;
@@ -138,7 +465,7 @@ bool VoxFormat::loadGroup(const ogt_vox_scene *scene, uint32_t ogt_groupIdx, sce
 			continue;
 		}
 		Log::debug("Found matching group (%u) with scene graph parent: %i", groupIdx, groupId);
-		if (!loadGroup(scene, groupIdx, sceneGraph, groupId, models, addedInstances, palette)) {
+		if (!loadGroup(scene, groupIdx, sceneGraph, groupId, instanceVolumes, addedInstances, palette)) {
 			return false;
 		}
 	}
@@ -151,7 +478,7 @@ bool VoxFormat::loadGroup(const ogt_vox_scene *scene, uint32_t ogt_groupIdx, sce
 		if (!addedInstances.insert(n)) {
 			continue;
 		}
-		if (!loadInstance(scene, n, sceneGraph, groupId, models, palette)) {
+		if (!loadInstance(scene, n, sceneGraph, groupId, instanceVolumes, palette)) {
 			return false;
 		}
 	}
@@ -203,30 +530,43 @@ bool VoxFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 
 bool VoxFormat::loadScene(const ogt_vox_scene *scene, scenegraph::SceneGraph &sceneGraph,
 						  const palette::Palette &palette) {
-	core::DynamicArray<MVModelToNode> models = loadModels(scene, palette);
+	// the instances are independent of each other - decode the voxels in parallel and assemble the scene graph
+	// afterwards in the order of the vox file
+	InstanceVolumes instanceVolumes;
+	instanceVolumes.resize(scene->num_instances);
+	voxel::Voxel remap[256];
+	fillVoxelRemap(palette, remap);
+	const bool decoded = decodeParallel((int)scene->num_instances, [&](int idx) {
+		decodeInstance(scene, (uint32_t)idx, remap, instanceVolumes[idx]);
+		return true;
+	});
+	bool success = decoded;
 	core::Set<uint32_t> addedInstances;
-	for (uint32_t i = 0; i < scene->num_groups; ++i) {
+	for (uint32_t i = 0; success && i < scene->num_groups; ++i) {
 		const ogt_vox_group &group = scene->groups[i];
 		// find the main group nodes
 		if (group.parent_group_index != k_invalid_group_index) {
 			continue;
 		}
 		Log::debug("Add root group %u/%u", i, scene->num_groups);
-		if (!loadGroup(scene, i, sceneGraph, -1, models, addedInstances, palette)) {
-			return false;
-		}
+		success = loadGroup(scene, i, sceneGraph, -1, instanceVolumes, addedInstances, palette);
 		break;
 	}
-	for (uint32_t n = 0; n < scene->num_instances; ++n) {
+	for (uint32_t n = 0; success && n < scene->num_instances; ++n) {
 		if (addedInstances.has(n)) {
 			continue;
 		}
 		// TODO: VOXELFORMAT: the parent is wrong
-		if (!loadInstance(scene, n, sceneGraph, sceneGraph.root().id(), models, palette)) {
-			return false;
-		}
+		success = loadInstance(scene, n, sceneGraph, sceneGraph.root().id(), instanceVolumes, palette);
+	}
+	for (InstanceVolume &instanceVolume : instanceVolumes) {
+		delete instanceVolume.volume;
+	}
+	if (!success) {
+		return false;
 	}
 	if (scene->num_instances == 0 && scene->num_models > 0) {
+		core::DynamicArray<MVModelToNode> models = loadModels(scene, palette);
 		for (MVModelToNode &m : models) {
 			scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
 			node.setVolume(m.volume, true);
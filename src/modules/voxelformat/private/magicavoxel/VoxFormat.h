@@ -30,13 +30,28 @@ protected:
 	glm::ivec3 maxSize() const override;
 	int emptyPaletteIndex() const override;
 private:
+	/**
+	 * @brief The decoded volume of an instance - the volume is owned by this struct until it is handed over to a
+	 * scene graph node
+	 */
+	struct InstanceVolume {
+		voxel::RawVolume *volume = nullptr;
+		glm::ivec3 shift{0};
+	};
+	using InstanceVolumes = core::DynamicArray<InstanceVolume>;
+
 	void saveInstance(const scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, MVSceneContext &ctx,
 					 uint32_t parentGroupIdx, uint32_t layerIdx, uint32_t modelIdx);
 	bool loadScene(const ogt_vox_scene *scene, scenegraph::SceneGraph &sceneGraph, const palette::Palette &palette);
+	/**
+	 * @param remap The voxels for the 256 color indices of the vox file
+	 */
+	static void decodeInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceIdx, const voxel::Voxel *remap,
+							   InstanceVolume &instanceVolume);
 	bool loadInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceIdx, scenegraph::SceneGraph &sceneGraph,
-					  int parent, core::DynamicArray<MVModelToNode> &models, const palette::Palette &palette);
+					  int parent, InstanceVolumes &instanceVolumes, const palette::Palette &palette);
 	bool loadGroup(const ogt_vox_scene *scene, uint32_t ogt_parentGroupIdx, scenegraph::SceneGraph &sceneGraph,
-				   int parent, core::DynamicArray<MVModelToNode> &models, core::Set<uint32_t> &addedInstances,
+				   int parent, InstanceVolumes &instanceVolumes, core::Set<uint32_t> &addedInstances,
 				   const palette::Palette &palette);
 	bool loadGroupsPalette(const core::String &filename, const io::ArchivePtr &archive,
 						   scenegraph::SceneGraph &sceneGraph, palette::Palette &palette,
@@ -50,6 +65,11 @@ public:
 	VoxFormat();
 	size_t loadPalette(const core::String &filename, const io::ArchivePtr &archive, palette::Palette &palette,
 					   const LoadContext &ctx) override;
+	/**
+	 * @note The palette doesn't contain the materials
+	 */
+	bool probe(const core::String &filename, const io::ArchivePtr &archive, SceneInfo &info,
+			   const LoadContext &ctx) override;
 
 	static const io::FormatDescription &format() {
 		static io::FormatDescription f{
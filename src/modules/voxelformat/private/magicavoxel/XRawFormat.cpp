@@ -7,12 +7,14 @@
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
+#include "core/collection/Buffer.h"
 #include "io/Stream.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxel/MaterialColor.h"
 #include "palette/Palette.h"
 #include "voxel/RawVolume.h"
+#include "voxelutil/VolumeImporter.h"
 #include "voxelutil/VolumeVisitor.h"
 
 namespace voxelformat {
@@ -220,20 +222,48 @@ bool XRawFormat::loadGroupsRGBA(const core::String &filename, const io::ArchiveP
 		Log::error("Invalid region: %i:%i:%i", width, height, depth);
 		return false;
 	}
-	voxel::RawVolume *volume = new voxel::RawVolume(region);
-	for (uint32_t h = 0u; h < height; ++h) {
-		for (uint32_t d = 0u; d < depth; ++d) {
-			for (uint32_t w = 0u; w < width; ++w) {
-				const int index = readVoxel(*stream, palette, paletteSize, bitsPerIndex);
-				if (index == 0 || index == ~(uint16_t)0) {
-					continue;
+	// we have to flip depth with height for our own coordinate system
+	voxelutil::GridLayout layout;
+	layout.size = glm::ivec3(width, depth, height);
+	layout.volumeAxis = glm::ivec3(0, 2, 1);
+	layout.flip = glm::bvec3(true, false, false);
+	voxelutil::VolumeImporter importer(layout);
+	if (!importer.isValid()) {
+		Log::error("Could not allocate the volume for %i:%i:%i", width, height, depth);
+		return false;
+	}
+	if (paletteSize != 0 && bitsPerIndex == 8) {
+		// the indices of a whole slice are read at once and copied with the precomputed voxels
+		voxel::Voxel remap[256];
+		remap[0] = voxel::Voxel();
+		for (int i = 1; i < 256; ++i) {
+			remap[i] = voxel::createVoxel(palette, (uint8_t)i);
+		}
+		core::Buffer<uint8_t> slice;
+		slice.resize((size_t)width * depth);
+		for (uint32_t h = 0u; h < height; ++h) {
+			if (stream->read(slice.data(), slice.size()) != (int)slice.size()) {
+				Log::error("Could not load xraw file: Not enough data in stream");
+				return false;
+			}
+			for (uint32_t d = 0u; d < depth; ++d) {
+				importer.setRow((int)d, (int)h, slice.data() + (size_t)d * width, remap);
+			}
+		}
+	} else {
+		for (uint32_t h = 0u; h < height; ++h) {
+			for (uint32_t d = 0u; d < depth; ++d) {
+				for (uint32_t w = 0u; w < width; ++w) {
+					const int index = readVoxel(*stream, palette, paletteSize, bitsPerIndex);
+					if (index == 0 || index == ~(uint16_t)0) {
+						continue;
+					}
+					importer.setVoxel((int)w, (int)d, (int)h, voxel::createVoxel(palette, index));
 				}
-				const voxel::Voxel &voxel = voxel::createVoxel(palette, index);
-				// we have to flip depth with height for our own coordinate system
-				volume->setVoxel((int)width - 1 - (int)w, (int)h, (int)d, voxel);
 			}
 		}
 	}
+	voxel::RawVolume *volume = importer.release();
 	scenegraph::SceneGraphNode node;
 	node.setVolume(volume, true);
 	node.setName(core::string::extractFilename(filename));
@@ -17,6 +17,7 @@
 #include "engine-config.h"
 #include "image/Image.h"
 #include "io/BufferedReadWriteStream.h"
+#include "io/BufferedWriteStream.h"
 #include "io/MemoryReadStream.h"
 #include "io/StdStreamBuf.h"
 #include "io/Stream.h"
@@ -34,6 +35,7 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <limits.h>
+#include <meshoptimizer.h>
 
 #define TINYGLTF_IMPLEMENTATION
 // #define TINYGLTF_NO_FS // TODO: VOXELFORMAT: use our own file abstraction
@@ -45,6 +47,16 @@ namespace voxelformat {
 namespace _priv {
 
 const float FPS = 24.0f;
+/** marks the buffer views of the streamed glb binary chunk until the buffers are assigned */
+const int GlbBinBuffer = -2;
+/** marks the buffer views of the EXT_meshopt_compression fallback buffer */
+const int GlbFallbackBuffer = -3;
+
+// the glb chunks and the buffer views are aligned to 4 bytes
+template<typename T>
+static inline T align4(T value) {
+	return (value + (T)3) & ~(T)3;
+}
 
 static int addBuffer(tinygltf::Model &gltfModel, io::BufferedReadWriteStream &stream, const char *name) {
 	tinygltf::Buffer gltfBuffer;
@@ -54,6 +66,28 @@ static int addBuffer(tinygltf::Model &gltfModel, io::BufferedReadWriteStream &st
 	return (int)(gltfModel.buffers.size() - 1);
 }
 
+/**
+ * @brief Model references share the mesh of the referenced model - the gltf mesh is only written once for all nodes
+ * that would produce the same vertices
+ */
+struct MeshInstanceKey {
+	const voxel::Mesh *mesh;
+	glm::vec3 pivotOffset;
+	uint64_t paletteHash;
+	bool applyTransform;
+
+	inline bool operator==(const MeshInstanceKey &other) const {
+		return mesh == other.mesh && pivotOffset == other.pivotOffset && paletteHash == other.paletteHash &&
+			   applyTransform == other.applyTransform;
+	}
+};
+
+struct MeshInstanceKeyHasher {
+	inline size_t operator()(const MeshInstanceKey &key) const {
+		return (size_t)(intptr_t)key.mesh ^ (size_t)key.paletteHash;
+	}
+};
+
 static image::TextureWrap convertTextureWrap(int wrap) {
 	if (wrap == TINYGLTF_TEXTURE_WRAP_REPEAT) {
 		return image::TextureWrap::Repeat;
@@ -66,6 +100,53 @@ static image::TextureWrap convertTextureWrap(int wrap) {
 	return image::TextureWrap::Repeat;
 }
 
+// KHR_mesh_quantization allows integer component types for the positions
+static glm::vec3 toVec3(const tinygltf::Accessor *gltfAttributeAccessor, const uint8_t *buf) {
+	const bool normalized = gltfAttributeAccessor->normalized;
+	glm::vec3 vec{0.0f};
+	switch (gltfAttributeAccessor->componentType) {
+	case TINYGLTF_COMPONENT_TYPE_FLOAT: {
+		io::MemoryReadStream vecStream(buf, 3 * sizeof(float));
+		vecStream.readFloat(vec.x);
+		vecStream.readFloat(vec.y);
+		vecStream.readFloat(vec.z);
+		break;
+	}
+	case TINYGLTF_COMPONENT_TYPE_BYTE: {
+		const glm::i8vec3 v(((const int8_t *)buf)[0], ((const int8_t *)buf)[1], ((const int8_t *)buf)[2]);
+		vec = normalized ? glm::max(glm::vec3(v) / 127.0f, -1.0f) : glm::vec3(v);
+		break;
+	}
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+		const glm::u8vec3 v(buf[0], buf[1], buf[2]);
+		vec = normalized ? glm::vec3(v) / 255.0f : glm::vec3(v);
+		break;
+	}
+	case TINYGLTF_COMPONENT_TYPE_SHORT: {
+		io::MemoryReadStream vecStream(buf, 3 * sizeof(int16_t));
+		glm::i16vec3 v;
+		vecStream.readInt16(v.x);
+		vecStream.readInt16(v.y);
+		vecStream.readInt16(v.z);
+		vec = normalized ? glm::max(glm::vec3(v) / 32767.0f, -1.0f) : glm::vec3(v);
+		break;
+	}
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+		io::MemoryReadStream vecStream(buf, 3 * sizeof(uint16_t));
+		glm::u16vec3 v;
+		vecStream.readUInt16(v.x);
+		vecStream.readUInt16(v.y);
+		vecStream.readUInt16(v.z);
+		vec = normalized ? glm::vec3(v) / 65535.0f : glm::vec3(v);
+		break;
+	}
+	default:
+		Log::warn("Unsupported component type %i", gltfAttributeAccessor->componentType);
+		break;
+	}
+	return vec;
+}
+
 static core::RGBA toColor(const tinygltf::Accessor *gltfAttributeAccessor, const uint8_t *buf) {
 	const bool hasAlpha = gltfAttributeAccessor->type == TINYGLTF_TYPE_VEC4;
 	if (gltfAttributeAccessor->componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) {
@@ -219,10 +300,11 @@ void GLTFFormat::createPointMesh(tinygltf::Model &gltfModel, const scenegraph::S
 
 void GLTFFormat::saveGltfNode(core::Map<int, int> &nodeMapping, tinygltf::Model &gltfModel, tinygltf::Scene &gltfScene,
 							  const scenegraph::SceneGraphNode &node, Stack &stack,
-							  const scenegraph::SceneGraph &sceneGraph, const glm::vec3 &scale, bool exportAnimations) {
+							  const scenegraph::SceneGraph &sceneGraph, const glm::vec3 &scale, bool exportAnimations,
+							  int gltfMeshIdx) {
 	tinygltf::Node gltfNode;
 	if (node.isAnyModelNode()) {
-		gltfNode.mesh = (int)gltfModel.meshes.size();
+		gltfNode.mesh = gltfMeshIdx >= 0 ? gltfMeshIdx : (int)gltfModel.meshes.size();
 	}
 	if (node.type() == scenegraph::SceneGraphNodeType::Point) {
 		createPointMesh(gltfModel, node);
@@ -491,6 +573,471 @@ static void addExtension(tinygltf::Model &gltfModel, const core::String &extensi
 	}
 }
 
+static void addRequiredExtension(tinygltf::Model &gltfModel, const core::String &extension) {
+	addExtension(gltfModel, extension);
+	std::string ext = extension.c_str();
+	if (core::find(gltfModel.extensionsRequired.begin(), gltfModel.extensionsRequired.end(), ext) ==
+		gltfModel.extensionsRequired.end()) {
+		gltfModel.extensionsRequired.push_back(ext);
+	}
+}
+
+void GLTFFormat::fillGlbMeshData(const GlbMeshData &data, uint8_t *out) const {
+	const voxel::VertexArray &vertices = data.mesh->getVertexVector();
+	const voxel::NormalArray &normals = data.mesh->getNormalVector();
+	const voxel::IndexArray &indices = data.mesh->getIndexVector();
+	const size_t nv = vertices.size();
+	const size_t ni = indices.size();
+
+	for (size_t i = 0; i < nv; i++) {
+		uint8_t *vertex = out + i * data.stride;
+		glm::vec3 pos = vertices[i].position;
+		if (data.applyTransform) {
+			pos += data.pivotOffset;
+		}
+		if (data.positionType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) {
+			const glm::u8vec3 quantized(pos);
+			core_memcpy(vertex, &quantized, sizeof(quantized));
+		} else if (data.positionType == TINYGLTF_COMPONENT_TYPE_SHORT) {
+			const glm::i16vec3 quantized(pos);
+			core_memcpy(vertex, &quantized, sizeof(quantized));
+		} else {
+			core_memcpy(vertex, &pos, sizeof(pos));
+		}
+
+		if (data.exportNormals) {
+			if (data.byteNormals) {
+				const glm::i8vec3 normal(glm::round(glm::clamp(normals[i], -1.0f, 1.0f) * 127.0f));
+				core_memcpy(vertex + data.normalOffset, &normal, sizeof(normal));
+			} else {
+				const glm::vec3 normal = normals[i];
+				core_memcpy(vertex + data.normalOffset, &normal, sizeof(normal));
+			}
+		}
+
+		if (data.withTexCoords) {
+			const glm::vec2 &uv = paletteUV(vertices[i].colorIndex);
+			core_memcpy(vertex + data.colorOffset, &uv, sizeof(uv));
+		} else if (data.withColor) {
+			const core::RGBA paletteColor = data.palette->color(vertices[i].colorIndex);
+			if (data.colorAsFloat) {
+				const glm::vec4 &color = core::Color::fromRGBA(paletteColor);
+				core_memcpy(vertex + data.colorOffset, &color, sizeof(color));
+			} else {
+				core_memcpy(vertex + data.colorOffset, &paletteColor, sizeof(paletteColor));
+			}
+		}
+	}
+
+	// scatter the triangles into the index buffer views of their palette color
+	uint8_t *targets[palette::PaletteMaxColors];
+	core_memset(targets, 0, sizeof(targets));
+	for (const GlbIndices &glbIndices : data.indices) {
+		targets[glbIndices.colorIndex] = out + glbIndices.offset;
+	}
+	for (size_t i = 0; i + 2 < ni; i += 3) {
+		uint8_t *&target = targets[vertices[indices[i]].colorIndex];
+		if (target == nullptr) {
+			continue;
+		}
+		for (size_t j = 0; j < 3; ++j) {
+			if (data.indexSize == sizeof(uint16_t)) {
+				const uint16_t index = (uint16_t)indices[i + j];
+				core_memcpy(target, &index, sizeof(index));
+			} else {
+				const uint32_t index = indices[i + j];
+				core_memcpy(target, &index, sizeof(index));
+			}
+			target += data.indexSize;
+		}
+	}
+}
+
+bool GLTFFormat::saveGlbPrimitives(GlbState &state, const glm::vec3 &pivotOffset, tinygltf::Model &gltfModel,
+								   tinygltf::Mesh &gltfMesh, const voxel::Mesh *mesh,
+								   const palette::Palette &palette, bool withColor, bool withTexCoords,
+								   bool colorAsFloat, bool exportNormals, bool applyTransform, int texcoordIndex,
+								   const MaterialMap &paletteMaterialIndices) const {
+	const voxel::VertexArray &vertices = mesh->getVertexVector();
+	const voxel::IndexArray &indices = mesh->getIndexVector();
+	const uint32_t nv = (uint32_t)vertices.size();
+	const size_t ni = indices.size();
+
+	auto paletteMaterialIter = paletteMaterialIndices.find(palette.hash());
+	core_assert(paletteMaterialIter != paletteMaterialIndices.end());
+
+	uint32_t counts[palette::PaletteMaxColors];
+	uint32_t minIndex[palette::PaletteMaxColors];
+	uint32_t maxIndex[palette::PaletteMaxColors];
+	core_memset(counts, 0, sizeof(counts));
+	core_memset(maxIndex, 0, sizeof(maxIndex));
+	core_memset(minIndex, 0xff, sizeof(minIndex));
+	for (size_t i = 0; i + 2 < ni; i += 3) {
+		const uint8_t colorIndex = vertices[indices[i]].colorIndex;
+		counts[colorIndex] += 3u;
+		for (size_t j = 0; j < 3; ++j) {
+			minIndex[colorIndex] = core_min(minIndex[colorIndex], indices[i + j]);
+			maxIndex[colorIndex] = core_max(maxIndex[colorIndex], indices[i + j]);
+		}
+	}
+
+	GlbMeshData data;
+	data.mesh = mesh;
+	data.palette = &palette;
+	data.pivotOffset = pivotOffset;
+	data.applyTransform = applyTransform;
+	data.withColor = withColor;
+	data.withTexCoords = withTexCoords;
+	data.colorAsFloat = colorAsFloat;
+	data.exportNormals = exportNormals;
+	// the maximum value of the component type is not allowed as index
+	data.indexSize = nv <= UINT16_MAX ? sizeof(uint16_t) : sizeof(uint32_t);
+
+	glm::vec3 minVertex{FLT_MAX};
+	glm::vec3 maxVertex{-FLT_MAX};
+	bool integral = true;
+	for (uint32_t i = 0; i < nv; ++i) {
+		glm::vec3 pos = vertices[i].position;
+		if (applyTransform) {
+			pos += pivotOffset;
+		}
+		minVertex = glm::min(minVertex, pos);
+		maxVertex = glm::max(maxVertex, pos);
+		integral &= glm::all(glm::equal(glm::floor(pos), pos));
+	}
+
+	// vertex attributes must be aligned to 4 bytes - the quantized positions are padded
+	data.positionType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+	data.stride = 3 * sizeof(float);
+	if (state.quantize && integral) {
+		if (glm::all(glm::greaterThanEqual(minVertex, glm::vec3(0.0f))) &&
+			glm::all(glm::lessThanEqual(maxVertex, glm::vec3((float)UINT8_MAX)))) {
+			data.positionType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+			data.stride = 4 * sizeof(uint8_t);
+		} else if (glm::all(glm::greaterThanEqual(minVertex, glm::vec3((float)INT16_MIN))) &&
+				   glm::all(glm::lessThanEqual(maxVertex, glm::vec3((float)INT16_MAX)))) {
+			data.positionType = TINYGLTF_COMPONENT_TYPE_SHORT;
+			data.stride = 4 * sizeof(int16_t);
+		}
+	}
+	if (exportNormals) {
+		data.normalOffset = data.stride;
+		data.byteNormals = state.quantize;
+		data.stride += data.byteNormals ? 4 * sizeof(int8_t) : 3 * sizeof(float);
+	}
+	if (withTexCoords) {
+		data.colorOffset = data.stride;
+		data.stride += 2 * sizeof(float);
+	} else if (withColor) {
+		data.colorOffset = data.stride;
+		data.stride += colorAsFloat ? 4 * sizeof(float) : 4 * sizeof(uint8_t);
+	}
+
+	uint32_t size = nv * data.stride;
+	for (int i = 0; i < palette.colorCount(); ++i) {
+		if (counts[i] == 0u || palette.color(i).a == 0) {
+			continue;
+		}
+		if (paletteMaterialIter->value[i] < 0) {
+			continue;
+		}
+		GlbIndices glbIndices;
+		glbIndices.colorIndex = (uint8_t)i;
+		glbIndices.count = counts[i];
+		glbIndices.offset = size;
+		data.indices.push_back(glbIndices);
+		size += _priv::align4(counts[i] * data.indexSize);
+	}
+	if (data.indices.empty()) {
+		Log::debug("No visible primitives in the mesh");
+		return true;
+	}
+	data.size = size;
+
+	// the buffer views reference the binary chunk or the meshopt fallback buffer - the offsets are relative to the
+	// start of the mesh data here
+	const int bufferIndex = state.meshopt ? _priv::GlbFallbackBuffer : _priv::GlbBinBuffer;
+	const size_t firstBufferView = gltfModel.bufferViews.size();
+	const size_t firstAccessor = gltfModel.accessors.size();
+	const int vertexBufferView = (int)gltfModel.bufferViews.size();
+	{
+		tinygltf::BufferView gltfVerticesBufferView;
+		gltfVerticesBufferView.buffer = bufferIndex;
+		gltfVerticesBufferView.byteOffset = 0;
+		gltfVerticesBufferView.byteLength = nv * data.stride;
+		gltfVerticesBufferView.byteStride = data.stride;
+		gltfVerticesBufferView.target = TINYGLTF_TARGET_ARRAY_BUFFER;
+		gltfModel.bufferViews.emplace_back(core::move(gltfVerticesBufferView));
+	}
+
+	std::map<std::string, int> attributes;
+	{
+		tinygltf::Accessor gltfVerticesAccessor;
+		gltfVerticesAccessor.bufferView = vertexBufferView;
+		gltfVerticesAccessor.byteOffset = 0;
+		gltfVerticesAccessor.componentType = data.positionType;
+		gltfVerticesAccessor.count = nv;
+		gltfVerticesAccessor.type = TINYGLTF_TYPE_VEC3;
+		gltfVerticesAccessor.maxValues = {maxVertex[0], maxVertex[1], maxVertex[2]};
+		gltfVerticesAccessor.minValues = {minVertex[0], minVertex[1], minVertex[2]};
+		attributes["POSITION"] = (int)gltfModel.accessors.size();
+		gltfModel.accessors.emplace_back(core::move(gltfVerticesAccessor));
+	}
+	if (exportNormals) {
+		tinygltf::Accessor gltfNormalAccessor;
+		gltfNormalAccessor.bufferView = vertexBufferView;
+		gltfNormalAccessor.byteOffset = data.normalOffset;
+		if (data.byteNormals) {
+			gltfNormalAccessor.componentType = TINYGLTF_COMPONENT_TYPE_BYTE;
+			gltfNormalAccessor.normalized = true;
+		} else {
+			gltfNormalAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+		}
+		gltfNormalAccessor.count = nv;
+		gltfNormalAccessor.type = TINYGLTF_TYPE_VEC3;
+		attributes["NORMAL"] = (int)gltfModel.accessors.size();
+		gltfModel.accessors.emplace_back(core::move(gltfNormalAccessor));
+	}
+	if (withTexCoords) {
+		tinygltf::Accessor gltfColorAccessor;
+		gltfColorAccessor.bufferView = vertexBufferView;
+		gltfColorAccessor.byteOffset = data.colorOffset;
+		gltfColorAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+		gltfColorAccessor.count = nv;
+		gltfColorAccessor.type = TINYGLTF_TYPE_VEC2;
+		const core::String &texcoordsKey = core::String::format("TEXCOORD_%i", texcoordIndex);
+		attributes[texcoordsKey.c_str()] = (int)gltfModel.accessors.size();
+		gltfModel.accessors.emplace_back(core::move(gltfColorAccessor));
+	} else if (withColor) {
+		tinygltf::Accessor gltfColorAccessor;
+		gltfColorAccessor.bufferView = vertexBufferView;
+		gltfColorAccessor.byteOffset = data.colorOffset;
+		if (colorAsFloat) {
+			gltfColorAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+		} else {
+			gltfColorAccessor.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+		}
+		gltfColorAccessor.count = nv;
+		gltfColorAccessor.type = TINYGLTF_TYPE_VEC4;
+		attributes["COLOR_0"] = (int)gltfModel.accessors.size();
+		gltfModel.accessors.emplace_back(core::move(gltfColorAccessor));
+	}
+
+	for (const GlbIndices &glbIndices : data.indices) {
+		tinygltf::BufferView gltfIndicesBufferView;
+		gltfIndicesBufferView.buffer = bufferIndex;
+		gltfIndicesBufferView.byteOffset = glbIndices.offset;
+		gltfIndicesBufferView.byteLength = glbIndices.count * data.indexSize;
+		gltfIndicesBufferView.target = TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER;
+
+		tinygltf::Accessor gltfIndicesAccessor;
+		gltfIndicesAccessor.bufferView = (int)gltfModel.bufferViews.size();
+		gltfIndicesAccessor.byteOffset = 0;
+		if (data.indexSize == sizeof(uint16_t)) {
+			gltfIndicesAccessor.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT;
+		} else {
+			gltfIndicesAccessor.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT;
+		}
+		gltfIndicesAccessor.count = glbIndices.count;
+		gltfIndicesAccessor.type = TINYGLTF_TYPE_SCALAR;
+		gltfIndicesAccessor.maxValues.push_back(maxIndex[glbIndices.colorIndex]);
+		gltfIndicesAccessor.minValues.push_back(minIndex[glbIndices.colorIndex]);
+
+		tinygltf::Primitive gltfMeshPrimitive;
+		gltfMeshPrimitive.indices = (int)gltfModel.accessors.size();
+		gltfMeshPrimitive.attributes = attributes;
+		gltfMeshPrimitive.material = paletteMaterialIter->value[glbIndices.colorIndex];
+		gltfMeshPrimitive.mode = TINYGLTF_MODE_TRIANGLES;
+		gltfMesh.primitives.emplace_back(core::move(gltfMeshPrimitive));
+
+		gltfModel.bufferViews.emplace_back(core::move(gltfIndicesBufferView));
+		gltfModel.accessors.emplace_back(core::move(gltfIndicesAccessor));
+	}
+
+	uint32_t baseOffset = state.binSize;
+	if (state.meshopt) {
+		// the compressed buffer views are encoded here - only the compressed data is kept until the file is written
+		baseOffset = state.fallbackSize;
+		state.fallbackSize += size;
+
+		core::Buffer<uint8_t> raw;
+		raw.resizeIfNeeded(size);
+		core_memset(raw.data(), 0, size);
+		fillGlbMeshData(data, raw.data());
+
+		size_t encodedSize = 0u;
+		for (size_t i = firstBufferView; i < gltfModel.bufferViews.size(); ++i) {
+			tinygltf::BufferView &gltfBufferView = gltfModel.bufferViews[i];
+			const uint8_t *src = raw.data() + gltfBufferView.byteOffset;
+			tinygltf::Value::Object meshopt;
+			size_t length;
+			if (gltfBufferView.target == TINYGLTF_TARGET_ARRAY_BUFFER) {
+				data.encoded.resizeIfNeeded(encodedSize + meshopt_encodeVertexBufferBound(nv, data.stride));
+				length = meshopt_encodeVertexBuffer(data.encoded.data() + encodedSize, data.encoded.size() - encodedSize,
+													src, nv, data.stride);
+				meshopt["byteStride"] = tinygltf::Value((int)data.stride);
+				meshopt["count"] = tinygltf::Value((int)nv);
+				meshopt["mode"] = tinygltf::Value(std::string("ATTRIBUTES"));
+			} else {
+				const size_t count = gltfBufferView.byteLength / data.indexSize;
+				data.encoded.resizeIfNeeded(encodedSize + meshopt_encodeIndexBufferBound(count, nv));
+				uint8_t *dst = data.encoded.data() + encodedSize;
+				const size_t dstSize = data.encoded.size() - encodedSize;
+				if (data.indexSize == sizeof(uint16_t)) {
+					length = meshopt_encodeIndexBuffer(dst, dstSize, (const uint16_t *)src, count);
+				} else {
+					length = meshopt_encodeIndexBuffer(dst, dstSize, (const uint32_t *)src, count);
+				}
+				meshopt["byteStride"] = tinygltf::Value((int)data.indexSize);
+				meshopt["count"] = tinygltf::Value((int)count);
+				meshopt["mode"] = tinygltf::Value(std::string("TRIANGLES"));
+			}
+			if (length == 0u) {
+				Log::error("Failed to encode the buffer view %i", (int)i);
+				// don't leave any references to the mesh data in the model
+				gltfModel.bufferViews.erase(gltfModel.bufferViews.begin() + firstBufferView, gltfModel.bufferViews.end());
+				gltfModel.accessors.erase(gltfModel.accessors.begin() + firstAccessor, gltfModel.accessors.end());
+				gltfMesh.primitives.clear();
+				state.fallbackSize = baseOffset;
+				return false;
+			}
+			meshopt["buffer"] = tinygltf::Value(0);
+			meshopt["byteOffset"] = tinygltf::Value((int)(state.binSize + encodedSize));
+			meshopt["byteLength"] = tinygltf::Value((int)length);
+			gltfBufferView.extensions["EXT_meshopt_compression"] = tinygltf::Value(core::move(meshopt));
+
+			const size_t alignedLength = _priv::align4(length);
+			data.encoded.resizeIfNeeded(encodedSize + alignedLength);
+			core_memset(data.encoded.data() + encodedSize + length, 0, alignedLength - length);
+			encodedSize += alignedLength;
+		}
+		data.binOffset = state.binSize;
+		state.binSize += (uint32_t)encodedSize;
+	} else {
+		data.binOffset = state.binSize;
+		state.binSize += size;
+	}
+	for (size_t i = firstBufferView; i < gltfModel.bufferViews.size(); ++i) {
+		gltfModel.bufferViews[i].byteOffset += baseOffset;
+	}
+	state.quantized |= data.positionType != TINYGLTF_COMPONENT_TYPE_FLOAT || data.byteNormals;
+	state.meshes.emplace_back(core::move(data));
+	return true;
+}
+
+bool GLTFFormat::writeGlb(io::SeekableWriteStream &stream, tinygltf::Model &gltfModel, const GlbState &state) const {
+	// the buffers that were created in memory (animations, points) are appended to the mesh data
+	core::DynamicArray<uint32_t> bufferOffsets;
+	bufferOffsets.reserve(gltfModel.buffers.size());
+	uint32_t binSize = state.binSize;
+	for (const tinygltf::Buffer &gltfBuffer : gltfModel.buffers) {
+		bufferOffsets.push_back(binSize);
+		binSize += _priv::align4((uint32_t)gltfBuffer.data.size());
+	}
+	for (tinygltf::BufferView &gltfBufferView : gltfModel.bufferViews) {
+		if (gltfBufferView.buffer == _priv::GlbBinBuffer) {
+			gltfBufferView.buffer = 0;
+		} else if (gltfBufferView.buffer == _priv::GlbFallbackBuffer) {
+			gltfBufferView.buffer = 1;
+		} else {
+			gltfBufferView.byteOffset += bufferOffsets[gltfBufferView.buffer];
+			gltfBufferView.buffer = 0;
+		}
+	}
+	if (state.quantized) {
+		addRequiredExtension(gltfModel, "KHR_mesh_quantization");
+	}
+	if (state.fallbackSize > 0u) {
+		addRequiredExtension(gltfModel, "EXT_meshopt_compression");
+	}
+
+	tinygltf::detail::JsonDocument output;
+	tinygltf::SerializeGltfModel(&gltfModel, output);
+	if (binSize > 0u) {
+		tinygltf::detail::json buffers;
+		tinygltf::detail::JsonReserveArray(buffers, 2);
+		tinygltf::detail::json binBuffer;
+		tinygltf::SerializeNumberProperty("byteLength", binSize, binBuffer);
+		tinygltf::detail::JsonPushBack(buffers, core::move(binBuffer));
+		if (state.fallbackSize > 0u) {
+			// the uncompressed data is not part of the file - loaders must support EXT_meshopt_compression
+			tinygltf::detail::json fallbackBuffer;
+			tinygltf::SerializeNumberProperty("byteLength", state.fallbackSize, fallbackBuffer);
+			tinygltf::Value::Object fallback;
+			fallback["fallback"] = tinygltf::Value(true);
+			tinygltf::ExtensionMap extensions;
+			extensions["EXT_meshopt_compression"] = tinygltf::Value(core::move(fallback));
+			tinygltf::SerializeExtensionMap(extensions, fallbackBuffer);
+			tinygltf::detail::JsonPushBack(buffers, core::move(fallbackBuffer));
+		}
+		tinygltf::detail::JsonAddMember(output, "buffers", core::move(buffers));
+	}
+	if (!gltfModel.images.empty()) {
+		tinygltf::detail::json images;
+		tinygltf::detail::JsonReserveArray(images, gltfModel.images.size());
+		for (const tinygltf::Image &gltfImage : gltfModel.images) {
+			tinygltf::detail::json image;
+			tinygltf::SerializeGltfImage(gltfImage, gltfImage.uri, image);
+			tinygltf::detail::JsonPushBack(images, core::move(image));
+		}
+		tinygltf::detail::JsonAddMember(output, "images", core::move(images));
+	}
+	const std::string &json = tinygltf::detail::JsonToString(output);
+	const uint32_t jsonSize = (uint32_t)json.size();
+	const uint32_t jsonChunkSize = _priv::align4(jsonSize);
+	uint32_t totalSize = 12u + 8u + jsonChunkSize;
+	if (binSize > 0u) {
+		totalSize += 8u + binSize;
+	}
+
+	io::BufferedWriteStream out(stream);
+	out.writeUInt32(FourCC('g', 'l', 'T', 'F'));
+	out.writeUInt32(2u);
+	out.writeUInt32(totalSize);
+	out.writeUInt32(jsonChunkSize);
+	out.writeUInt32(FourCC('J', 'S', 'O', 'N'));
+	if (out.write(json.data(), jsonSize) == -1) {
+		Log::error("Failed to write the json chunk");
+		return false;
+	}
+	for (uint32_t i = jsonSize; i < jsonChunkSize; ++i) {
+		out.writeUInt8(' ');
+	}
+	if (binSize == 0u) {
+		return out.flush();
+	}
+
+	out.writeUInt32(binSize);
+	out.writeUInt32(FourCC('B', 'I', 'N', '\0'));
+	core::Buffer<uint8_t> block;
+	for (const GlbMeshData &data : state.meshes) {
+		if (!data.encoded.empty()) {
+			if (out.write(data.encoded.data(), data.encoded.size()) == -1) {
+				Log::error("Failed to write the compressed mesh data");
+				return false;
+			}
+			continue;
+		}
+		block.resizeIfNeeded(data.size);
+		core_memset(block.data(), 0, data.size);
+		fillGlbMeshData(data, block.data());
+		if (out.write(block.data(), data.size) == -1) {
+			Log::error("Failed to write the mesh data");
+			return false;
+		}
+	}
+	for (const tinygltf::Buffer &gltfBuffer : gltfModel.buffers) {
+		if (out.write(gltfBuffer.data.data(), gltfBuffer.data.size()) == -1) {
+			Log::error("Failed to write the buffer data");
+			return false;
+		}
+		for (size_t i = gltfBuffer.data.size(); i < _priv::align4(gltfBuffer.data.size()); ++i) {
+			out.writeUInt8(0u);
+		}
+	}
+	return out.flush();
+}
+
 void GLTFFormat::save_KHR_materials_emissive_strength(const palette::Material &material,
 													  tinygltf::Material &gltfMaterial,
 													  tinygltf::Model &gltfModel) const {
@@ -726,11 +1273,6 @@ void GLTFFormat::generateMaterials(bool withTexCoords, tinygltf::Model &gltfMode
 bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const scenegraph::SceneGraph &sceneGraph,
 							const Meshes &meshes, const core::String &filename, const io::ArchivePtr &archive,
 							const glm::vec3 &scale, bool quad, bool withColor, bool withTexCoords) {
-	core::ScopedPtr<io::SeekableWriteStream> stream(archive->writeStream(filename));
-	if (!stream) {
-		Log::error("Could not open file %s", filename.c_str());
-		return false;
-	}
 	const core::String &ext = core::string::extractExtension(filename);
 	const bool writeBinary = ext == "glb";
 
@@ -745,6 +1287,12 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 		Log::debug("Export colors as byte");
 	}
 
+	GlbState glbState;
+	if (writeBinary) {
+		glbState.quantize = core::Var::getSafe(cfg::VoxFormatGLTF_KHR_mesh_quantization)->boolVal();
+		glbState.meshopt = core::Var::getSafe(cfg::VoxFormatGLTF_EXT_meshopt_compression)->boolVal();
+	}
+
 	const size_t modelNodes = meshes.size();
 	const core::String &appname = app::App::getInstance()->fullAppname();
 	const core::String &generator = core::string::format("%s " PROJECT_VERSION, appname.c_str());
@@ -761,6 +1309,7 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 
 	MaterialMap paletteMaterialIndices((int)sceneGraph.size());
 	core::Map<int, int> nodeMapping((int)sceneGraph.nodeSize());
+	core::Map<_priv::MeshInstanceKey, int, 64, _priv::MeshInstanceKeyHasher> meshInstances((int)meshes.size());
 	while (!stack.empty()) {
 		const int nodeId = stack.back().first;
 		const scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
@@ -813,15 +1362,34 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 			const glm::vec3 &offset = mesh->getOffset();
 			const glm::vec3 pivotOffset = offset - meshExt.pivot * meshExt.size;
 
+			const _priv::MeshInstanceKey instanceKey{mesh, pivotOffset, palette.hash(), meshExt.applyTransform};
+			int gltfMeshIdx = -1;
+			if (meshInstances.get(instanceKey, gltfMeshIdx)) {
+				Log::debug("Reuse mesh %i for node %s", gltfMeshIdx, objectName);
+				saveGltfNode(nodeMapping, gltfModel, gltfScene, node, stack, sceneGraph, scale, exportAnimations,
+							 gltfMeshIdx);
+				continue;
+			}
+			meshInstances.put(instanceKey, (int)gltfModel.meshes.size());
+
 			tinygltf::Mesh gltfMesh;
 			gltfMesh.name = objectName;
-			for (int j = 0; j < palette.colorCount(); ++j) {
-				if (palette.color(j).a == 0) {
-					continue;
+			if (writeBinary) {
+				if (!saveGlbPrimitives(glbState, pivotOffset, gltfModel, gltfMesh, mesh, node.palette(), withColor,
+									   withTexCoords, colorAsFloat, exportNormals, meshExt.applyTransform,
+									   texcoordIndex, paletteMaterialIndices)) {
+					Log::error("Failed to export the mesh of node %s", objectName);
+					return false;
+				}
+			} else {
+				for (int j = 0; j < palette.colorCount(); ++j) {
+					if (palette.color(j).a == 0) {
+						continue;
+					}
+					savePrimitivesPerMaterial(j, pivotOffset, gltfModel, gltfMesh, mesh, palette, withColor,
+											  withTexCoords, colorAsFloat, exportNormals, meshExt.applyTransform,
+											  texcoordIndex, paletteMaterialIndices);
 				}
-				savePrimitivesPerMaterial(j, pivotOffset, gltfModel, gltfMesh, mesh, palette, withColor, withTexCoords,
-										  colorAsFloat, exportNormals, meshExt.applyTransform, texcoordIndex,
-										  paletteMaterialIndices);
 			}
 			saveGltfNode(nodeMapping, gltfModel, gltfScene, node, stack, sceneGraph, scale, exportAnimations);
 			gltfModel.meshes.emplace_back(core::move(gltfMesh));
@@ -854,9 +1422,23 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 		gltfModel.cameras.push_back(gltfCamera);
 	}
 
+	// the file is only created once the model was built successfully
+	core::ScopedPtr<io::SeekableWriteStream> stream(archive->writeStream(filename));
+	if (!stream) {
+		Log::error("Could not open file %s", filename.c_str());
+		return false;
+	}
+	if (writeBinary) {
+		if (!writeGlb(*stream, gltfModel, glbState)) {
+			Log::error("Could not save to file");
+			return false;
+		}
+		return true;
+	}
+
 	io::StdOStreamBuf buf(*stream);
 	std::ostream gltfStream(&buf);
-	if (!gltf.WriteGltfSceneToStream(&gltfModel, gltfStream, false, writeBinary)) {
+	if (!gltf.WriteGltfSceneToStream(&gltfModel, gltfStream, false, false)) {
 		Log::error("Could not save to file");
 		return false;
 	}
@@ -1374,19 +1956,15 @@ bool GLTFFormat::loadAttributes(const core::String &filename, const tinygltf::Mo
 				   (int)stride);
 		const uint8_t *buf = gltfAttributeBuffer.data.data() + offset;
 		if (attrType == "POSITION") {
-			if (gltfAttributeAccessor->componentType != TINYGLTF_COMPONENT_TYPE_FLOAT) {
-				Log::debug("Skip non float type for %s", attrType.c_str());
+			if (gltfAttributeAccessor->componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT ||
+				gltfAttributeAccessor->componentType == TINYGLTF_COMPONENT_TYPE_INT) {
+				Log::debug("Skip unsupported component type for %s", attrType.c_str());
 				continue;
 			}
 			foundPositions = gltfAttributeAccessor->count;
 			core_assert(gltfAttributeAccessor->type == TINYGLTF_TYPE_VEC3);
 			for (size_t i = 0; i < gltfAttributeAccessor->count; i++) {
-				io::MemoryReadStream posStream(buf, stride);
-				glm::vec3 pos;
-				posStream.readFloat(pos.x);
-				posStream.readFloat(pos.y);
-				posStream.readFloat(pos.z);
-				vertices[verticesOffset + i].pos = pos;
+				vertices[verticesOffset + i].pos = _priv::toVec3(gltfAttributeAccessor, buf);
 				vertices[verticesOffset + i].meshMaterial = gltfMaterial.meshMaterial;
 				buf += stride;
 			}
@@ -7,6 +7,7 @@
 #include "MeshFormat.h"
 #include "MeshMaterial.h"
 #include "core/Pair.h"
+#include "core/collection/Buffer.h"
 #include "palette/Palette.h"
 
 namespace tinygltf {
@@ -86,7 +87,8 @@ private:
 	using MaterialMap = core::Map<uint64_t, core::Array<int, palette::PaletteMaxColors>>;
 	void saveGltfNode(core::Map<int, int> &nodeMapping, tinygltf::Model &gltfModel, tinygltf::Scene &gltfScene,
 					  const scenegraph::SceneGraphNode &graphNode, Stack &stack,
-					  const scenegraph::SceneGraph &sceneGraph, const glm::vec3 &scale, bool exportAnimations);
+					  const scenegraph::SceneGraph &sceneGraph, const glm::vec3 &scale, bool exportAnimations,
+					  int gltfMeshIdx = -1);
 	uint32_t writeBuffer(const voxel::Mesh *mesh, uint8_t idx, io::SeekableWriteStream &os, bool withColor,
 						 bool withTexCoords, bool colorAsFloat, bool exportNormals, bool applyTransform,
 						 const glm::vec3 &pivotOffset, const palette::Palette &palette, Bounds &bounds);
@@ -100,6 +102,72 @@ private:
 								   bool withColor, bool withTexCoords, bool colorAsFloat, bool exportNormals,
 								   bool applyTransform, int texcoordIndex, const MaterialMap &paletteMaterialIndices);
 
+	// streamed glb export
+	/**
+	 * @brief The indices of one palette color - they are stored in their own buffer view
+	 */
+	struct GlbIndices {
+		uint8_t colorIndex = 0u;
+		uint32_t count = 0u;
+		/** the byte offset relative to the start of the mesh data */
+		uint32_t offset = 0u;
+	};
+	/**
+	 * @brief The mesh data that is written into the binary chunk of the glb file
+	 *
+	 * All primitives of a mesh share one interleaved vertex buffer view. The vertex and index data is only generated
+	 * while the binary chunk is written.
+	 */
+	struct GlbMeshData {
+		const voxel::Mesh *mesh = nullptr;
+		const palette::Palette *palette = nullptr;
+		glm::vec3 pivotOffset{0.0f};
+		bool applyTransform = false;
+		bool withColor = false;
+		bool withTexCoords = false;
+		bool colorAsFloat = false;
+		bool exportNormals = false;
+		/** TINYGLTF_COMPONENT_TYPE_* of the positions - KHR_mesh_quantization allows integer types */
+		int positionType = 0;
+		/** KHR_mesh_quantization normalized byte normals */
+		bool byteNormals = false;
+		uint32_t stride = 0u;
+		uint32_t normalOffset = 0u;
+		uint32_t colorOffset = 0u;
+		/** size of an index in bytes */
+		uint32_t indexSize = 4u;
+		/** size of the vertex and index data of the mesh */
+		uint32_t size = 0u;
+		/** the byte offset in the binary chunk */
+		uint32_t binOffset = 0u;
+		core::DynamicArray<GlbIndices> indices;
+		/** the EXT_meshopt_compression encoded vertex and index buffer views */
+		core::Buffer<uint8_t> encoded;
+	};
+	struct GlbState {
+		core::DynamicArray<GlbMeshData> meshes;
+		/** size of the mesh data in the binary chunk */
+		uint32_t binSize = 0u;
+		/** size of the uncompressed EXT_meshopt_compression fallback buffer */
+		uint32_t fallbackSize = 0u;
+		bool quantize = false;
+		bool meshopt = false;
+		bool quantized = false;
+	};
+	void fillGlbMeshData(const GlbMeshData &data, uint8_t *out) const;
+	/**
+	 * @return @c false if the mesh data could not get encoded - the model doesn't reference the mesh data in this case
+	 */
+	bool saveGlbPrimitives(GlbState &state, const glm::vec3 &pivotOffset, tinygltf::Model &gltfModel,
+						   tinygltf::Mesh &gltfMesh, const voxel::Mesh *mesh, const palette::Palette &palette,
+						   bool withColor, bool withTexCoords, bool colorAsFloat, bool exportNormals,
+						   bool applyTransform, int texcoordIndex, const MaterialMap &paletteMaterialIndices) const;
+	/**
+	 * @brief Writes the glb file without keeping all buffers in memory. The json chunk is written first and the mesh
+	 * data is generated while the binary chunk is written.
+	 */
+	bool writeGlb(io::SeekableWriteStream &stream, tinygltf::Model &gltfModel, const GlbState &state) const;
+
 	void saveAnimation(int targetNode, tinygltf::Model &m, const scenegraph::SceneGraphNode &node,
 					   tinygltf::Animation &gltfAnimation);
 
@@ -121,7 +121,7 @@ void MeshFormat::addToPosMap(PosMap &posMap, core::RGBA rgba, uint32_t area, uin
 }
 
 void MeshFormat::transformTris(const voxel::Region &region, const MeshTriCollection &tris, PosMap &posMap,
-							   const palette::NormalPalette &normalPalette) {
+							   const palette::NormalPaletteLookup &normalLookup) {
 	Log::debug("subdivided into %i triangles", (int)tris.size());
 	for (const voxelformat::MeshTri &meshTri : tris) {
 		if (stopExecution()) {
@@ -135,7 +135,7 @@ void MeshFormat::transformTris(const voxel::Region &region, const MeshTriCollect
 		glm::vec3 c = meshTri.center();
 		convertToVoxelGrid(c);
 
-		const uint8_t normalIdx = normalPalette.getClosestMatch(meshTri.normal());
+		const uint8_t normalIdx = normalLookup.getClosestMatch(meshTri.normal());
 
 		const glm::ivec3 p(c);
 		core_assert_msg(region.containsPoint(p), "Failed to transform tri %i:%i:%i (region: %s)", p.x, p.y, p.z,
@@ -144,7 +144,7 @@ void MeshFormat::transformTris(const voxel::Region &region, const MeshTriCollect
 	}
 }
 
-void MeshFormat::transformTrisAxisAligned(const voxel::Region &region, const MeshTriCollection &tris, PosMap &posMap, const palette::NormalPalette &normalPalette) {
+void MeshFormat::transformTrisAxisAligned(const voxel::Region &region, const MeshTriCollection &tris, PosMap &posMap, const palette::NormalPaletteLookup &normalLookup) {
 	Log::debug("axis aligned %i triangles", (int)tris.size());
 	for (const voxelformat::MeshTri &meshTri : tris) {
 		if (stopExecution()) {
@@ -163,7 +163,7 @@ void MeshFormat::transformTrisAxisAligned(const voxel::Region &region, const Mes
 		Log::trace("maxs: %i:%i:%i", maxs.x, maxs.y, maxs.z);
 		Log::trace("normal: %f:%f:%f", normal.x, normal.y, normal.z);
 		Log::trace("sideDelta: %i:%i:%i", sideDelta.x, sideDelta.y, sideDelta.z);
-		const uint8_t normalIdx = normalPalette.getClosestMatch(normal);
+		const uint8_t normalIdx = normalLookup.getClosestMatch(normal);
 		for (int x = mins.x; x < maxs.x; x++) {
 			for (int y = mins.y; y < maxs.y; y++) {
 				for (int z = mins.z; z < maxs.z; z++) {
@@ -278,6 +278,8 @@ int MeshFormat::voxelizeNode(const core::String &uuid, const core::String &name,
 	}
 	// TODO: VOXELFORMAT: auto generate the normal palette from the input tris?
 	node.setNormalPalette(normalPalette);
+	// every voxel gets the closest normal of the palette - don't search the whole palette for each of them
+	const palette::NormalPaletteLookup normalLookup(normalPalette);
 
 	const int voxelizeMode = core::Var::getSafe(cfg::VoxformatVoxelizeMode)->intVal();
 	const bool fillHollow = core::Var::getSafe(cfg::VoxformatFillHollow)->boolVal();
@@ -285,7 +287,7 @@ int MeshFormat::voxelizeNode(const core::String &uuid, const core::String &name,
 		const int maxVoxels = vdim.x * vdim.y * vdim.z;
 		Log::debug("max voxels: %i (%i:%i:%i)", maxVoxels, vdim.x, vdim.y, vdim.z);
 		PosMap posMap(maxVoxels);
-		transformTrisAxisAligned(region, tris, posMap, normalPalette);
+		transformTrisAxisAligned(region, tris, posMap, normalLookup);
 		voxelizeTris(node, posMap, fillHollow);
 	} else if (voxelizeMode == VoxelizeMode::Fast) {
 		voxel::RawVolumeWrapper wrapper(node.volume());
@@ -317,7 +319,7 @@ int MeshFormat::voxelizeNode(const core::String &uuid, const core::String &name,
 			voxelizeTriangle(trisMins, meshTri, [&] (const voxelformat::MeshTri &tri, const glm::vec2 &uv, int x, int y, int z) {
 				const core::RGBA color = flattenRGB(tri.colorAt(uv));
 				const glm::vec3 &normal = tri.normal();
-				const uint8_t normalIndex = normalPalette.getClosestMatch(normal);
+				const uint8_t normalIndex = normalLookup.getClosestMatch(normal);
 				const voxel::Voxel voxel = voxel::createVoxel(palette, palLookup.findClosestIndex(color), normalIndex);
 				wrapper.setVoxel(x, y, z, voxel);
 			});
@@ -359,7 +361,7 @@ int MeshFormat::voxelizeNode(const core::String &uuid, const core::String &name,
 		}
 
 		PosMap posMap((int)subdivided.size() * 3);
-		transformTris(region, subdivided, posMap, normalPalette);
+		transformTris(region, subdivided, posMap, normalLookup);
 		voxelizeTris(node, posMap, fillHollow);
 	}
 
@@ -497,6 +499,25 @@ bool MeshFormat::voxelizeGroups(const core::String &filename, const io::ArchiveP
 	return false;
 }
 
+namespace {
+
+struct MeshSourceKey {
+	const voxel::RawVolume *volume;
+	uint64_t paletteHash;
+
+	inline bool operator==(const MeshSourceKey &other) const {
+		return volume == other.volume && paletteHash == other.paletteHash;
+	}
+};
+
+struct MeshSourceKeyHasher {
+	inline size_t operator()(const MeshSourceKey &key) const {
+		return (size_t)(intptr_t)key.volume ^ (size_t)key.paletteHash;
+	}
+};
+
+} // namespace
+
 bool MeshFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename,
 							const io::ArchivePtr &archive, const SaveContext &saveCtx) {
 	const bool mergeQuads = core::Var::getSafe(cfg::VoxformatMergequads)->boolVal();
@@ -511,21 +532,42 @@ bool MeshFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core
 
 	const voxel::SurfaceExtractionType type = (voxel::SurfaceExtractionType)core::Var::getSafe(cfg::VoxelMeshMode)->intVal();
 
-	const size_t models = sceneGraph.size(scenegraph::SceneGraphNodeType::AllModels);
-	Meshes meshes;
-	core::Map<int, int> meshIdxNodeMap;
+	// model references share the volume of the referenced model - every volume is only meshed once per palette and
+	// the exporters get the same mesh instance for all nodes that use it
+	core::DynamicArray<int> sourceNodeIds;
+	core::Map<int, int> nodeSourceMap((int)sceneGraph.nodeSize());
+	{
+		core::Map<MeshSourceKey, int, 64, MeshSourceKeyHasher> sourceMap((int)sceneGraph.nodeSize());
+		for (auto iter = sceneGraph.beginAllModels(); iter != sceneGraph.end(); ++iter) {
+			const scenegraph::SceneGraphNode &node = *iter;
+			const MeshSourceKey key{sceneGraph.resolveVolume(node), node.palette().hash()};
+			int sourceIdx;
+			if (!sourceMap.get(key, sourceIdx)) {
+				sourceIdx = (int)sourceNodeIds.size();
+				sourceNodeIds.push_back(node.id());
+				sourceMap.put(key, sourceIdx);
+			}
+			nodeSourceMap.put(node.id(), sourceIdx);
+		}
+	}
+	Log::debug("Mesh %i unique volumes for %i model nodes", (int)sourceNodeIds.size(),
+			   (int)sceneGraph.size(scenegraph::SceneGraphNodeType::AllModels));
+
+	core::DynamicArray<voxel::ChunkMesh *> chunkMeshes;
+	chunkMeshes.resize(sourceNodeIds.size());
+	size_t meshed = 0u;
 	core_trace_mutex(core::Lock, lock, "MeshFormat");
-	// TODO: VOXELFORMAT: this could get optimized by re-using the same mesh for multiple nodes (in case of reference nodes)
-	for (auto iter = sceneGraph.beginAllModels(); iter != sceneGraph.end(); ++iter) {
-		const scenegraph::SceneGraphNode &node = *iter;
-		app::async([&, volume = sceneGraph.resolveVolume(node), region = sceneGraph.resolveRegion(node)]() {
+	for (size_t i = 0; i < sourceNodeIds.size(); ++i) {
+		const scenegraph::SceneGraphNode &node = sceneGraph.node(sourceNodeIds[i]);
+		app::async([&, i, volume = sceneGraph.resolveVolume(node), region = sceneGraph.resolveRegion(node),
+					&palette = node.palette()]() {
 			voxel::ChunkMesh *mesh = new voxel::ChunkMesh();
 			voxel::Region regionExt = region;
 			// we are increasing the region by one voxel to ensure the inclusion of the boundary voxels in this mesh
 			regionExt.shiftUpperCorner(1, 1, 1);
 			voxel::SurfaceExtractionContext ctx =
-				voxel::createContext(type, volume, regionExt, node.palette(), *mesh, {0, 0, 0}, mergeQuads,
-									 reuseVertices, ambientOcclusion);
+				voxel::createContext(type, volume, regionExt, palette, *mesh, {0, 0, 0}, mergeQuads, reuseVertices,
+									 ambientOcclusion);
 			voxel::extractSurface(ctx);
 			if (withNormals) {
 				Log::debug("Calculate normals");
@@ -536,19 +578,29 @@ bool MeshFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core
 			}
 
 			core::ScopedLock scoped(lock);
-			meshes.emplace_back(mesh, node, applyTransform);
+			chunkMeshes[i] = mesh;
+			++meshed;
 		});
 	}
 	for (;;) {
 		lock.lock();
-		const size_t size = meshes.size();
+		const size_t size = meshed;
 		lock.unlock();
-		if (size < models) {
+		if (size < chunkMeshes.size()) {
 			app::App::getInstance()->wait(10);
 		} else {
 			break;
 		}
 	}
+	Meshes meshes;
+	meshes.reserve(nodeSourceMap.size());
+	for (auto iter = sceneGraph.beginAllModels(); iter != sceneGraph.end(); ++iter) {
+		const scenegraph::SceneGraphNode &node = *iter;
+		int sourceIdx = -1;
+		core_assert_always(nodeSourceMap.get(node.id(), sourceIdx));
+		meshes.emplace_back(chunkMeshes[sourceIdx], node, applyTransform);
+	}
+	core::Map<int, int> meshIdxNodeMap;
 	Meshes nonEmptyMeshes;
 	nonEmptyMeshes.reserve(meshes.size());
 
@@ -569,8 +621,8 @@ bool MeshFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core
 		state = saveMeshes(meshIdxNodeMap, sceneGraph, nonEmptyMeshes, filename, archive, {1.0f, 1.0f, 1.0f},
 						   type == voxel::SurfaceExtractionType::Cubic ? quads : false, withColor, withTexCoords);
 	}
-	for (MeshExt &meshext : meshes) {
-		delete meshext.mesh;
+	for (voxel::ChunkMesh *mesh : chunkMeshes) {
+		delete mesh;
 	}
 	return state;
 }
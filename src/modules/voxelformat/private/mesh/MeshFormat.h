@@ -10,6 +10,7 @@
 #include "core/collection/Map.h"
 #include "io/Archive.h"
 #include "palette/NormalPalette.h"
+#include "palette/NormalPaletteLookup.h"
 #include "voxel/ChunkMesh.h"
 #include "voxelformat/Format.h"
 
@@ -51,6 +52,10 @@ protected:
 
 	struct MeshExt {
 		MeshExt(voxel::ChunkMesh *mesh, const scenegraph::SceneGraphNode &node, bool applyTransform);
+		/**
+		 * @note Nodes that share a volume (model references) also share the mesh - exporters can write the mesh
+		 * once and instance it for the other nodes
+		 */
 		voxel::ChunkMesh *mesh;
 		core::String name;
 		bool applyTransform = false;
@@ -142,7 +147,7 @@ protected:
 	 * @sa voxelizeTris()
 	 */
 	static void transformTris(const voxel::Region &region, const MeshTriCollection &tris, PosMap &posMap,
-							  const palette::NormalPalette &normalPalette);
+							  const palette::NormalPaletteLookup &normalLookup);
 	/**
 	 * @brief Convert the given input triangles into a list of positions to place the voxels at. This version is for
 	 * aligned aligned triangles. This is usually the case for meshes that were exported from voxels.
@@ -153,7 +158,7 @@ protected:
 	 * @sa voxelizeTris()
 	 */
 	static void transformTrisAxisAligned(const voxel::Region &region, const MeshTriCollection &tris, PosMap &posMap,
-										 const palette::NormalPalette &normalPalette);
+										 const palette::NormalPaletteLookup &normalLookup);
 	/**
 	 * @brief Convert the given @c PosMap into a volume
 	 *
@@ -11,6 +11,7 @@
 #include "engine-config.h"
 #include "image/Image.h"
 #include "io/Archive.h"
+#include "io/TextWriteStream.h"
 #include "io/StdStreamBuf.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
@@ -36,6 +37,29 @@ namespace voxelformat {
 		return false;                                                                                                  \
 	}
 
+/**
+ * @brief Writes a face line - the texture coordinates and normals are optional (@c nullptr)
+ */
+static bool writeFace(io::TextWriteStream &stream, int n, const int *vertices, const int *texcoords,
+					  const int *normals) {
+	stream.writeChar('f');
+	for (int i = 0; i < n; ++i) {
+		stream.writeChar(' ');
+		stream.writeIntText(vertices[i]);
+		if (texcoords != nullptr || normals != nullptr) {
+			stream.writeChar('/');
+			if (texcoords != nullptr) {
+				stream.writeIntText(texcoords[i]);
+			}
+			if (normals != nullptr) {
+				stream.writeChar('/');
+				stream.writeIntText(normals[i]);
+			}
+		}
+	}
+	return stream.writeChar('\n');
+}
+
 // TODO: MATERIAL: one material entry per palette color
 // https://paulbourke.net/dataformats/mtl/
 bool OBJFormat::writeMtlFile(io::SeekableWriteStream &stream, const core::String &mtlId,
@@ -101,14 +125,15 @@ bool OBJFormat::writeMtlFile(io::SeekableWriteStream &stream, const core::String
 bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &sceneGraph, const Meshes &meshes,
 						   const core::String &filename, const io::ArchivePtr &archive, const glm::vec3 &scale,
 						   bool quad, bool withColor, bool withTexCoords) {
-	core::ScopedPtr<io::SeekableWriteStream> stream(archive->writeStream(filename));
-	if (!stream) {
+	core::ScopedPtr<io::SeekableWriteStream> outStream(archive->writeStream(filename));
+	if (!outStream) {
 		Log::error("Could not open file %s", filename.c_str());
 		return false;
 	}
-	stream->writeStringFormat(false, "# version " PROJECT_VERSION " github.com/vengi-voxel/vengi\n");
-	wrapBool(stream->writeStringFormat(false, "\n"))
-	wrapBool(stream->writeStringFormat(false, "g Model\n"))
+	io::TextWriteStream stream(*outStream);
+	stream.writeStringFormat(false, "# version " PROJECT_VERSION " github.com/vengi-voxel/vengi\n");
+	wrapBool(stream.writeStringFormat(false, "\n"))
+	wrapBool(stream.writeStringFormat(false, "g Model\n"))
 
 	Log::debug("Exporting %i layers", (int)meshes.size());
 
@@ -151,9 +176,9 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 			if (objectName[0] == '\0') {
 				objectName = "Noname";
 			}
-			stream->writeStringFormat(false, "o %s\n", objectName);
-			stream->writeStringFormat(false, "mtllib %s\n", core::string::extractFilenameWithExtension(mtlname).c_str());
-			if (!stream->writeStringFormat(false, "usemtl %s\n", hashId.c_str())) {
+			stream.writeStringFormat(false, "o %s\n", objectName);
+			stream.writeStringFormat(false, "mtllib %s\n", core::string::extractFilenameWithExtension(mtlname).c_str());
+			if (!stream.writeStringFormat(false, "usemtl %s\n", hashId.c_str())) {
 				Log::error("Failed to write obj usemtl %s\n", hashId.c_str());
 				return false;
 			}
@@ -168,17 +193,18 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 					pos = v.position;
 				}
 				pos *= scale;
-				stream->writeStringFormat(false, "v %.04f %.04f %.04f", pos.x, pos.y, pos.z);
 				if (withColor) {
+					stream.writeFloats("v", &pos.x, 3, 4, nullptr);
 					const glm::vec4 &color = core::Color::fromRGBA(palette.color(v.colorIndex));
-					stream->writeStringFormat(false, " %.03f %.03f %.03f", color.r, color.g, color.b);
+					wrapBool(stream.writeFloats(nullptr, &color.r, 3, 3))
+				} else {
+					wrapBool(stream.writeFloats("v", &pos.x, 3, 4))
 				}
-				wrapBool(stream->writeStringFormat(false, "\n"))
 			}
 			if (withNormals) {
 				for (int j = 0; j < nv; ++j) {
 					const glm::vec3 &norm = normals[j];
-					stream->writeStringFormat(false, "vn %.04f %.04f %.04f\n", norm.x, norm.y, norm.z);
+					stream.writeFloats("vn", &norm.x, 3, 4);
 				}
 			}
 
@@ -187,10 +213,10 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 					for (int j = 0; j < ni; j += 6) {
 						const voxel::VoxelVertex &v = vertices[indices[j]];
 						const glm::vec2 &uv = paletteUV(v.colorIndex);
-						stream->writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
-						stream->writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
-						stream->writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
-						stream->writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
+						stream.writeFloats("vt", &uv.x, 2, 6);
+						stream.writeFloats("vt", &uv.x, 2, 6);
+						stream.writeFloats("vt", &uv.x, 2, 6);
+						stream.writeFloats("vt", &uv.x, 2, 6);
 					}
 				}
 
@@ -200,24 +226,9 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 					const uint32_t two = idxOffset + indices[j + 1] + 1;
 					const uint32_t three = idxOffset + indices[j + 2] + 1;
 					const uint32_t four = idxOffset + indices[j + 5] + 1;
-					if (withTexCoords) {
-						if (withNormals) {
-							stream->writeStringFormat(false, "f %i/%i/%i %i/%i/%i %i/%i/%i %i/%i/%i\n", (int)one,
-													 uvi + 1, (int)one, (int)two, uvi + 2, (int)two, (int)three,
-													 uvi + 3, (int)three, (int)four, uvi + 4, (int)four);
-						} else {
-							stream->writeStringFormat(false, "f %i/%i %i/%i %i/%i %i/%i\n", (int)one, uvi + 1, (int)two,
-													 uvi + 2, (int)three, uvi + 3, (int)four, uvi + 4);
-						}
-					} else {
-						if (withNormals) {
-							stream->writeStringFormat(false, "f %i//%i %i//%i %i//%i %i//%i\n", (int)one, (int)two,
-													 (int)three, (int)four, (int)one, (int)two, (int)three, (int)four);
-						} else {
-							stream->writeStringFormat(false, "f %i %i %i %i\n", (int)one, (int)two, (int)three,
-													 (int)four);
-						}
-					}
+					const int face[]{(int)one, (int)two, (int)three, (int)four};
+					const int texcoords[]{uvi + 1, uvi + 2, uvi + 3, uvi + 4};
+					writeFace(stream, 4, face, withTexCoords ? texcoords : nullptr, withNormals ? face : nullptr);
 				}
 				texcoordOffset += ni / 6 * 4;
 			} else {
@@ -225,9 +236,9 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 					for (int j = 0; j < ni; j += 3) {
 						const voxel::VoxelVertex &v = vertices[indices[j]];
 						const glm::vec2 &uv = paletteUV(v.colorIndex);
-						stream->writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
-						stream->writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
-						stream->writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
+						stream.writeFloats("vt", &uv.x, 2, 6);
+						stream.writeFloats("vt", &uv.x, 2, 6);
+						stream.writeFloats("vt", &uv.x, 2, 6);
 					}
 				}
 
@@ -235,24 +246,9 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 					const uint32_t one = idxOffset + indices[j + 0] + 1;
 					const uint32_t two = idxOffset + indices[j + 1] + 1;
 					const uint32_t three = idxOffset + indices[j + 2] + 1;
-					if (withTexCoords) {
-						if (withNormals) {
-							stream->writeStringFormat(false, "f %i/%i/%i %i/%i/%i %i/%i/%i\n", (int)one,
-													 texcoordOffset + j + 1, (int)one, (int)two, texcoordOffset + j + 2,
-													 (int)two, (int)three, texcoordOffset + j + 3, (int)three);
-						} else {
-							stream->writeStringFormat(false, "f %i/%i %i/%i %i/%i\n", (int)one, texcoordOffset + j + 1,
-													 (int)two, texcoordOffset + j + 2, (int)three,
-													 texcoordOffset + j + 3);
-						}
-					} else {
-						if (withNormals) {
-							stream->writeStringFormat(false, "f %i//%i %i//%i %i//%i\n", (int)one, (int)two, (int)three,
-													 (int)one, (int)two, (int)three);
-						} else {
-							stream->writeStringFormat(false, "f %i %i %i\n", (int)one, (int)two, (int)three);
-						}
-					}
+					const int face[]{(int)one, (int)two, (int)three};
+					const int texcoords[]{texcoordOffset + j + 1, texcoordOffset + j + 2, texcoordOffset + j + 3};
+					writeFace(stream, 3, face, withTexCoords ? texcoords : nullptr, withNormals ? face : nullptr);
 				}
 				texcoordOffset += ni;
 			}
@@ -273,6 +269,10 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 			}
 		}
 	}
+	if (!stream.flush()) {
+		Log::error("Failed to write obj %s", filename.c_str());
+		return false;
+	}
 	return true;
 }
 
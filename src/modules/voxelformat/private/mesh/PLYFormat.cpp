@@ -11,6 +11,8 @@
 #include "engine-config.h"
 #include "io/Archive.h"
 #include "io/EndianStreamReadWrapper.h"
+#include "io/TextReadStream.h"
+#include "io/TextWriteStream.h"
 #include "palette/Palette.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
@@ -278,46 +280,53 @@ bool PLYFormat::parseHeader(io::SeekableReadStream &stream, Header &header) {
 	return true;
 }
 
-bool PLYFormat::parseFacesAscii(const Element &element, io::SeekableReadStream &stream,
+bool PLYFormat::parseFacesAscii(const Element &element, io::TextReadStream &stream,
 								core::DynamicArray<PLYFace> &faces, core::DynamicArray<PLYPolygon> &polygons) const {
-	core::DynamicArray<core::String> tokens;
-	tokens.reserve(32);
-
 	faces.reserve(element.count);
+	io::TextReadStream::Line line;
 	for (int idx = 0; idx < element.count; ++idx) {
-		core::String line;
 		wrapBool(stream.readLine(line))
-		tokens.clear();
-		core::string::splitString(line, tokens);
-		if (tokens.size() < element.properties.size()) {
-			Log::error("Invalid ply face: %s", line.c_str());
+		int indices = 0;
+		if (!line.readInt(indices)) {
+			Log::error("Invalid ply face in line %i", idx);
 			return false;
 		}
-		const int indices = core::string::toInt(tokens[0]);
 		if (indices == 3) {
 			PLYFace face;
-			face.indices[0] = core::string::toInt(tokens[1]);
-			face.indices[1] = core::string::toInt(tokens[2]);
-			face.indices[2] = core::string::toInt(tokens[3]);
+			if (!line.readInt(face.indices[0]) || !line.readInt(face.indices[1]) || !line.readInt(face.indices[2])) {
+				Log::error("Invalid ply face in line %i", idx);
+				return false;
+			}
 			faces.push_back(face);
 		} else if (indices == 4) {
+			int quad[4];
+			for (int i = 0; i < 4; ++i) {
+				if (!line.readInt(quad[i])) {
+					Log::error("Invalid ply face in line %i", idx);
+					return false;
+				}
+			}
 			// triangle fan
 			PLYFace face1;
-			face1.indices[0] = core::string::toInt(tokens[1]);
-			face1.indices[1] = core::string::toInt(tokens[2]);
-			face1.indices[2] = core::string::toInt(tokens[3]);
+			face1.indices[0] = quad[0];
+			face1.indices[1] = quad[1];
+			face1.indices[2] = quad[2];
 			faces.push_back(face1);
 
 			PLYFace face2;
-			face2.indices[0] = core::string::toInt(tokens[1]);
-			face2.indices[1] = core::string::toInt(tokens[3]);
-			face2.indices[2] = core::string::toInt(tokens[4]);
+			face2.indices[0] = quad[0];
+			face2.indices[1] = quad[2];
+			face2.indices[2] = quad[3];
 			faces.push_back(face2);
 		} else {
 			PLYPolygon polygon;
 			polygon.indices.reserve(indices);
 			for (int64_t i = 0; i < indices; ++i) {
-				const int polygonIdx = core::string::toInt(tokens[i + 1]);
+				int polygonIdx;
+				if (!line.readInt(polygonIdx)) {
+					Log::error("Invalid ply face in line %i", idx);
+					return false;
+				}
 				polygon.indices.push_back(polygonIdx);
 			}
 			polygons.push_back(polygon);
@@ -326,61 +335,72 @@ bool PLYFormat::parseFacesAscii(const Element &element, io::SeekableReadStream &
 	return true;
 }
 
-bool PLYFormat::parseVerticesAscii(const Element &element, io::SeekableReadStream &stream,
+bool PLYFormat::parseVerticesAscii(const Element &element, io::TextReadStream &stream,
 								   core::DynamicArray<PLYVertex> &vertices) const {
-	core::DynamicArray<core::String> tokens;
-	tokens.reserve(32);
-
 	vertices.reserve(element.count);
+	io::TextReadStream::Line line;
 	for (int idx = 0; idx < element.count; ++idx) {
-		core::String line;
 		wrapBool(stream.readLine(line))
-		tokens.clear();
-		core::string::splitString(line, tokens);
-		if (tokens.size() < element.properties.size()) {
-			Log::error("Invalid ply vertex: %s", line.c_str());
-			return false;
-		}
 		PLYVertex vertex;
 		for (size_t i = 0; i < element.properties.size(); ++i) {
 			const Property &prop = element.properties[i];
-			Log::trace("%s: %s", prop.name.c_str(), tokens[i].c_str());
+			float f = 0.0f;
+			int n = 0;
+			bool valid;
+			switch (prop.use) {
+			case PropertyUse::red:
+			case PropertyUse::green:
+			case PropertyUse::blue:
+			case PropertyUse::alpha:
+				valid = line.readInt(n);
+				break;
+			case PropertyUse::Max:
+				valid = line.skipToken();
+				break;
+			default:
+				valid = line.readFloat(f);
+				break;
+			}
+			if (!valid) {
+				Log::error("Invalid ply vertex in line %i: missing %s", idx, prop.name.c_str());
+				return false;
+			}
 			switch (prop.use) {
 			case PropertyUse::x:
-				vertex.position.x = core::string::toFloat(tokens[i]);
+				vertex.position.x = f;
 				break;
 			case PropertyUse::y:
-				vertex.position.y = core::string::toFloat(tokens[i]);
+				vertex.position.y = f;
 				break;
 			case PropertyUse::z:
-				vertex.position.z = core::string::toFloat(tokens[i]);
+				vertex.position.z = f;
 				break;
 			case PropertyUse::nx:
-				vertex.normal.x = core::string::toFloat(tokens[i]);
+				vertex.normal.x = f;
 				break;
 			case PropertyUse::ny:
-				vertex.normal.y = core::string::toFloat(tokens[i]);
+				vertex.normal.y = f;
 				break;
 			case PropertyUse::nz:
-				vertex.normal.z = core::string::toFloat(tokens[i]);
+				vertex.normal.z = f;
 				break;
 			case PropertyUse::red:
-				vertex.color.r = core::string::toInt(tokens[i]);
+				vertex.color.r = n;
 				break;
 			case PropertyUse::green:
-				vertex.color.g = core::string::toInt(tokens[i]);
+				vertex.color.g = n;
 				break;
 			case PropertyUse::blue:
-				vertex.color.b = core::string::toInt(tokens[i]);
+				vertex.color.b = n;
 				break;
 			case PropertyUse::alpha:
-				vertex.color.a = core::string::toInt(tokens[i]);
+				vertex.color.a = n;
 				break;
 			case PropertyUse::s:
-				vertex.texCoord.x = core::string::toFloat(tokens[i]);
+				vertex.texCoord.x = f;
 				break;
 			case PropertyUse::t:
-				vertex.texCoord.y = core::string::toFloat(tokens[i]);
+				vertex.texCoord.y = f;
 				break;
 			case PropertyUse::Max:
 				break;
@@ -412,16 +432,16 @@ bool PLYFormat::parsePointCloudBinary(const core::String &filename, io::Seekable
 bool PLYFormat::parsePointCloudAscii(const core::String &filename, io::SeekableReadStream &stream,
 									 scenegraph::SceneGraph &sceneGraph, const Header &header,
 									 core::DynamicArray<PLYVertex> &vertices) const {
+	io::TextReadStream text(stream);
 	for (int i = 0; i < (int)header.elements.size(); ++i) {
 		const Element &element = header.elements[i];
 		if (element.name != "vertex") {
 			for (int skip = 0; skip < element.count; ++skip) {
-				core::String line;
-				wrapBool(stream.readLine(line))
+				wrapBool(text.skipLine())
 			}
 			continue;
 		}
-		if (!parseVerticesAscii(element, stream, vertices)) {
+		if (!parseVerticesAscii(element, text, vertices)) {
 			return false;
 		}
 	}
@@ -690,20 +710,20 @@ bool PLYFormat::parseMeshAscii(const core::String &filename, io::SeekableReadStr
 	core::DynamicArray<PLYVertex> vertices;
 	core::DynamicArray<PLYFace> faces;
 	core::DynamicArray<PLYPolygon> polygons;
+	io::TextReadStream text(stream);
 	for (int i = 0; i < (int)header.elements.size(); ++i) {
 		const Element &element = header.elements[i];
 		if (element.name == "vertex") {
-			if (!parseVerticesAscii(element, stream, vertices)) {
+			if (!parseVerticesAscii(element, text, vertices)) {
 				return false;
 			}
 		} else if (element.name == "face") {
-			if (!parseFacesAscii(element, stream, faces, polygons)) {
+			if (!parseFacesAscii(element, text, faces, polygons)) {
 				return false;
 			}
 		} else {
 			for (int skip = 0; skip < element.count; ++skip) {
-				core::String line;
-				wrapBool(stream.readLine(line))
+				wrapBool(text.skipLine())
 			}
 			continue;
 		}
@@ -778,8 +798,8 @@ bool PLYFormat::voxelizeGroups(const core::String &filename, const io::ArchivePt
 bool PLYFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &sceneGraph, const Meshes &meshes,
 						   const core::String &filename, const io::ArchivePtr &archive, const glm::vec3 &scale,
 						   bool quad, bool withColor, bool withTexCoords) {
-	core::ScopedPtr<io::SeekableWriteStream> stream(archive->writeStream(filename));
-	if (!stream) {
+	core::ScopedPtr<io::SeekableWriteStream> outStream(archive->writeStream(filename));
+	if (!outStream) {
 		Log::error("Could not open file %s", filename.c_str());
 		return false;
 	}
@@ -800,24 +820,25 @@ bool PLYFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 		return false;
 	}
 
+	io::TextWriteStream stream(*outStream);
 	const core::String paletteName = core::string::replaceExtension(voxel::getPalette().name(), "png");
-	stream->writeStringFormat(false, "ply\nformat ascii 1.0\n");
-	stream->writeStringFormat(false, "comment version " PROJECT_VERSION " github.com/vengi-voxel/vengi\n");
-	stream->writeStringFormat(false, "comment TextureFile %s\n", paletteName.c_str());
-
-	stream->writeStringFormat(false, "element vertex %i\n", elementsCnt);
-	stream->writeStringFormat(false, "property float x\n");
-	stream->writeStringFormat(false, "property float z\n");
-	stream->writeStringFormat(false, "property float y\n");
+	stream.writeStringFormat(false, "ply\nformat ascii 1.0\n");
+	stream.writeStringFormat(false, "comment version " PROJECT_VERSION " github.com/vengi-voxel/vengi\n");
+	stream.writeStringFormat(false, "comment TextureFile %s\n", paletteName.c_str());
+
+	stream.writeStringFormat(false, "element vertex %i\n", elementsCnt);
+	stream.writeStringFormat(false, "property float x\n");
+	stream.writeStringFormat(false, "property float z\n");
+	stream.writeStringFormat(false, "property float y\n");
 	if (withTexCoords) {
-		stream->writeStringFormat(false, "property float s\n");
-		stream->writeStringFormat(false, "property float t\n");
+		stream.writeStringFormat(false, "property float s\n");
+		stream.writeStringFormat(false, "property float t\n");
 	}
 	if (withColor) {
-		stream->writeStringFormat(false, "property uchar red\n");
-		stream->writeStringFormat(false, "property uchar green\n");
-		stream->writeStringFormat(false, "property uchar blue\n");
-		stream->writeStringFormat(false, "property uchar alpha\n");
+		stream.writeStringFormat(false, "property uchar red\n");
+		stream.writeStringFormat(false, "property uchar green\n");
+		stream.writeStringFormat(false, "property uchar blue\n");
+		stream.writeStringFormat(false, "property uchar alpha\n");
 	}
 
 	int faces;
@@ -827,9 +848,9 @@ bool PLYFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 		faces = indicesCnt / 3;
 	}
 
-	stream->writeStringFormat(false, "element face %i\n", faces);
-	stream->writeStringFormat(false, "property list uchar uint vertex_indices\n");
-	stream->writeStringFormat(false, "end_header\n");
+	stream.writeStringFormat(false, "element face %i\n", faces);
+	stream.writeStringFormat(false, "property list uchar uint vertex_indices\n");
+	stream.writeStringFormat(false, "end_header\n");
 
 	for (const auto &meshExt : meshes) {
 		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
@@ -853,16 +874,18 @@ bool PLYFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 					pos = v.position;
 				}
 				pos *= scale;
-				stream->writeStringFormat(false, "%f %f %f", pos.x, pos.y, pos.z);
+				stream.writeFloatText(pos.x);
+				stream.writeFloats(nullptr, &pos.y, 2, 6, nullptr);
 				if (withTexCoords) {
 					const glm::vec2 &uv = paletteUV(v.colorIndex);
-					stream->writeStringFormat(false, " %f %f", uv.x, uv.y);
+					stream.writeFloats(nullptr, &uv.x, 2, 6, nullptr);
 				}
 				if (withColor) {
 					const core::RGBA color = palette.color(v.colorIndex);
-					stream->writeStringFormat(false, " %u %u %u %u", color.r, color.g, color.b, color.a);
+					const int rgba[]{color.r, color.g, color.b, color.a};
+					stream.writeInts(nullptr, rgba, 4, nullptr);
 				}
-				stream->writeStringFormat(false, "\n");
+				stream.writeChar('\n');
 			}
 		}
 	}
@@ -887,19 +910,25 @@ bool PLYFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 					const uint32_t two = idxOffset + indices[j + 1];
 					const uint32_t three = idxOffset + indices[j + 2];
 					const uint32_t four = idxOffset + indices[j + 5];
-					stream->writeStringFormat(false, "4 %i %i %i %i\n", (int)one, (int)two, (int)three, (int)four);
+					const int face[]{(int)one, (int)two, (int)three, (int)four};
+					stream.writeInts("4", face, 4);
 				}
 			} else {
 				for (int j = 0; j < ni; j += 3) {
 					const uint32_t one = idxOffset + indices[j + 0];
 					const uint32_t two = idxOffset + indices[j + 1];
 					const uint32_t three = idxOffset + indices[j + 2];
-					stream->writeStringFormat(false, "3 %i %i %i\n", (int)one, (int)two, (int)three);
+					const int face[]{(int)one, (int)two, (int)three};
+					stream.writeInts("3", face, 3);
 				}
 			}
 			idxOffset += nv;
 		}
 	}
+	if (!stream.flush()) {
+		Log::error("Failed to write ply %s", filename.c_str());
+		return false;
+	}
 	return sceneGraph.firstPalette().save(paletteName.c_str());
 }
 } // namespace voxelformat
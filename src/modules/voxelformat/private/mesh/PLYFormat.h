@@ -7,6 +7,10 @@
 #include "MeshFormat.h"
 #include "core/collection/DynamicArray.h"
 
+namespace io {
+class TextReadStream;
+}
+
 namespace voxelformat {
 
 /** TODO:
@@ -81,9 +85,9 @@ protected:
 	static DataType dataType(const core::String &in);
 	static PropertyUse use(const core::String &in);
 	static bool parseHeader(io::SeekableReadStream &stream, Header &header);
-	bool parseFacesAscii(const Element &element, io::SeekableReadStream &stream, core::DynamicArray<PLYFace> &faces,
+	bool parseFacesAscii(const Element &element, io::TextReadStream &stream, core::DynamicArray<PLYFace> &faces,
 						 core::DynamicArray<PLYPolygon> &polygons) const;
-	bool parseVerticesAscii(const Element &element, io::SeekableReadStream &stream,
+	bool parseVerticesAscii(const Element &element, io::TextReadStream &stream,
 							core::DynamicArray<PLYVertex> &vertices) const;
 	void triangulatePolygons(const core::DynamicArray<PLYPolygon> &polygons,
 							 const core::DynamicArray<PLYVertex> &vertices, core::DynamicArray<PLYFace> &faces) const;
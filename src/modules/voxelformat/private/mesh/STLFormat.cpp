@@ -9,6 +9,8 @@
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
 #include "io/Archive.h"
+#include "io/TextReadStream.h"
+#include "io/TextWriteStream.h"
 #include "scenegraph/SceneGraph.h"
 #include "voxel/Mesh.h"
 
@@ -19,57 +21,49 @@ static constexpr const size_t BinaryHeaderSize = 80;
 }
 
 bool STLFormat::parseAscii(io::SeekableReadStream &stream, MeshTriCollection &tris) {
-	char line[512];
 	const glm::vec3 &scale = getInputScale();
 	stream.seek(0);
-	while (stream.readLine(sizeof(line), line)) {
-		if (!strncmp(line, "solid", 5)) {
-			while (stream.readLine(sizeof(line), line)) {
-				const char *ptr = line;
-				while (*ptr == ' ') {
-					++ptr;
-				}
-				if (!strncmp(ptr, "endsolid", 8)) {
+	io::TextReadStream text(stream);
+	io::TextReadStream::Line line;
+	while (text.readLine(line)) {
+		if (!line.consume("solid")) {
+			continue;
+		}
+		while (text.readLine(line)) {
+			if (line.consume("endsolid")) {
+				break;
+			}
+			// the facet normal is not used - it's computed from the vertices
+			if (!line.consume("facet")) {
+				continue;
+			}
+			if (!text.readLine(line)) {
+				return false;
+			}
+			if (!line.consume("outer loop")) {
+				continue;
+			}
+			voxelformat::MeshTri meshTri;
+			int vi = 0;
+			while (text.readLine(line)) {
+				if (line.consume("endloop")) {
 					break;
 				}
-				if (!strncmp(ptr, "facet normal ", 13)) {
-					voxelformat::MeshTri meshTri;
-					glm::vec3 norm;
-					ptr += 13;
-					core::string::parseReal3(&norm.x, &norm.y, &norm.z, &ptr);
-					if (!stream.readLine(sizeof(line), line)) {
-						return false;
-					}
-					ptr = line;
-					while (*ptr == ' ') {
-						++ptr;
-					}
-					if (!strncmp(ptr, "outer loop", 10)) {
-						int vi = 0;
-						while (stream.readLine(sizeof(line), line)) {
-							ptr = line;
-							while (*ptr == ' ') {
-								++ptr;
-							}
-							if (!strncmp(ptr, "endloop", 7)) {
-								break;
-							}
-							if (vi >= 3) {
-								return false;
-							}
-							glm::vec3 &vert = meshTri.vertices[vi];
-							ptr += 7; // "vertex "
-							core::string::parseReal3(&vert.x, &vert.y, &vert.z, &ptr);
-							vert *= scale;
-							++vi;
-						}
-						if (vi != 3) {
-							return false;
-						}
-						tris.push_back(meshTri);
-					}
+				if (vi >= 3) {
+					return false;
+				}
+				glm::vec3 &vert = meshTri.vertices[vi];
+				line.consume("vertex");
+				if (!line.readFloat(vert.x) || !line.readFloat(vert.y) || !line.readFloat(vert.z)) {
+					return false;
 				}
+				vert *= scale;
+				++vi;
 			}
+			if (vi != 3) {
+				return false;
+			}
+			tris.push_back(meshTri);
 		}
 	}
 	return true;
@@ -147,7 +141,7 @@ bool STLFormat::voxelizeGroups(const core::String &filename, const io::ArchivePt
 
 #undef wrap
 
-bool STLFormat::writeVertex(io::SeekableWriteStream &stream, const MeshExt &meshExt, const voxel::VoxelVertex &v1,
+bool STLFormat::writeVertex(io::WriteStream &stream, const MeshExt &meshExt, const voxel::VoxelVertex &v1,
 							const scenegraph::SceneGraphTransform &transform, const glm::vec3 &scale) {
 	glm::vec3 pos;
 	if (meshExt.applyTransform) {
@@ -171,17 +165,19 @@ bool STLFormat::writeVertex(io::SeekableWriteStream &stream, const MeshExt &mesh
 bool STLFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &sceneGraph, const Meshes &meshes,
 						   const core::String &filename, const io::ArchivePtr &archive, const glm::vec3 &scale,
 						   bool quad, bool withColor, bool withTexCoords) {
-	core::ScopedPtr<io::SeekableWriteStream> stream(archive->writeStream(filename));
-	if (!stream) {
+	core::ScopedPtr<io::SeekableWriteStream> outStream(archive->writeStream(filename));
+	if (!outStream) {
 		Log::error("Could not open file %s", filename.c_str());
 		return false;
 	}
-	stream->writeStringFormat(false, "github.com/vengi-voxel/vengi");
-	const size_t delta = priv::BinaryHeaderSize - stream->pos();
-	for (size_t i = 0; i < delta; ++i) {
-		stream->writeUInt8(0);
+	// the binary format is written in a lot of small float writes - let them end up in a buffer
+	io::TextWriteStream stream(*outStream);
+	const char *header = "github.com/vengi-voxel/vengi";
+	const size_t headerLength = SDL_strlen(header);
+	stream.writeText(header);
+	for (size_t i = headerLength; i < priv::BinaryHeaderSize; ++i) {
+		stream.writeUInt8(0);
 	}
-	core_assert(stream->pos() == priv::BinaryHeaderSize);
 
 	int faceCount = 0;
 	for (const auto &meshExt : meshes) {
@@ -198,7 +194,7 @@ bool STLFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 			faceCount += ni / 3;
 		}
 	}
-	stream->writeUInt32(faceCount);
+	stream.writeUInt32(faceCount);
 
 	for (const auto &meshExt : meshes) {
 		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
@@ -228,27 +224,31 @@ bool STLFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 				const glm::vec3 edge2 = glm::vec3(v3.position - v1.position);
 				const glm::vec3 normal = glm::normalize(glm::cross(edge1, edge2));
 				for (int k = 0; k < 3; ++k) {
-					if (!stream->writeFloat(normal[k])) {
+					if (!stream.writeFloat(normal[k])) {
 						return false;
 					}
 				}
 
-				if (!writeVertex(*stream, meshExt, v1, transform, scale)) {
+				if (!writeVertex(stream, meshExt, v1, transform, scale)) {
 					return false;
 				}
 
-				if (!writeVertex(*stream, meshExt, v2, transform, scale)) {
+				if (!writeVertex(stream, meshExt, v2, transform, scale)) {
 					return false;
 				}
 
-				if (!writeVertex(*stream, meshExt, v3, transform, scale)) {
+				if (!writeVertex(stream, meshExt, v3, transform, scale)) {
 					return false;
 				}
 
-				stream->writeUInt16(0);
+				stream.writeUInt16(0);
 			}
 		}
 	}
+	if (!stream.flush()) {
+		Log::error("Failed to write stl %s", filename.c_str());
+		return false;
+	}
 	return true;
 }
 
@@ -36,7 +36,7 @@ namespace voxelformat {
  */
 class STLFormat : public MeshFormat {
 private:
-	bool writeVertex(io::SeekableWriteStream &stream, const MeshExt &meshExt, const voxel::VoxelVertex &v1,
+	bool writeVertex(io::WriteStream &stream, const MeshExt &meshExt, const voxel::VoxelVertex &v1,
 					 const scenegraph::SceneGraphTransform &transform, const glm::vec3 &scale);
 
 	bool parseBinary(io::SeekableReadStream &stream, MeshTriCollection &tris);
@@ -50,7 +50,8 @@ bool MCRFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 	int chunkX = 0;
 	int chunkZ = 0;
 	char type = 'a';
-	if (SDL_sscanf(name.c_str(), "r.%i.%i.mc%c", &chunkX, &chunkZ, &type) != 3) {
+	const bool knownPosition = SDL_sscanf(name.c_str(), "r.%i.%i.mc%c", &chunkX, &chunkZ, &type) == 3;
+	if (!knownPosition) {
 		Log::warn("Failed to parse the region chunk boundaries from filename %s (%i.%i.%c)", name.c_str(), chunkX,
 				  chunkZ, type);
 	}
@@ -86,7 +87,7 @@ bool MCRFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 			return false;
 		}
 
-		const bool success = loadMinecraftRegion(sceneGraph, *stream, palette);
+		const bool success = loadMinecraftRegion(sceneGraph, *stream, palette, ctx, chunkX, chunkZ, knownPosition);
 		return success;
 	}
 	}
@@ -95,11 +96,25 @@ bool MCRFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 }
 
 bool MCRFormat::loadMinecraftRegion(scenegraph::SceneGraph &sceneGraph, io::SeekableReadStream &stream,
-									const palette::Palette &palette) {
+									const palette::Palette &palette, const LoadContext &ctx, int regionX, int regionZ,
+									bool knownPosition) {
+	const bool filterChunks = knownPosition && ctx.region.isValid();
+	int skipped = 0;
 	for (int i = 0; i < SECTOR_INTS; ++i) {
 		if (_offsets[i].sectorCount == 0u || _offsets[i].offset < sizeof(_offsets)) {
 			continue;
 		}
+		if (filterChunks) {
+			// the chunk table holds 32x32 chunks - every chunk covers the whole height of the world
+			const int chunkX = (regionX * 32 + (i & 31)) * MAX_SIZE;
+			const int chunkZ = (regionZ * 32 + (i >> 5)) * MAX_SIZE;
+			const voxel::Region chunkRegion(chunkX, ctx.region.getLowerY(), chunkZ, chunkX + MAX_SIZE - 1,
+											ctx.region.getUpperY(), chunkZ + MAX_SIZE - 1);
+			if (!ctx.accepts(chunkRegion)) {
+				++skipped;
+				continue;
+			}
+		}
 		if (_offsets[i].offset + 6 >= (uint32_t)stream.size()) {
 			return false;
 		}
@@ -111,6 +126,9 @@ bool MCRFormat::loadMinecraftRegion(scenegraph::SceneGraph &sceneGraph, io::Seek
 			return false;
 		}
 	}
+	if (skipped > 0) {
+		Log::debug("Skipped %i chunks outside of the region filter", skipped);
+	}
 
 	return true;
 }
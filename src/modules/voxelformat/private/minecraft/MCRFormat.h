@@ -113,8 +113,15 @@ private:
 
 	bool readCompressedNBT(scenegraph::SceneGraph &sceneGraph, io::SeekableReadStream &stream, int sector,
 						   const palette::Palette &palette);
+	/**
+	 * @param regionX The region position from the file name - used to skip the chunks outside of the region filter
+	 * of the load context
+	 * @param knownPosition @c false if the region position couldn't be parsed from the file name - all chunks are
+	 * decoded in this case
+	 */
 	bool loadMinecraftRegion(scenegraph::SceneGraph &sceneGraph, io::SeekableReadStream &stream,
-							 const palette::Palette &palette);
+							 const palette::Palette &palette, const LoadContext &ctx, int regionX, int regionZ,
+							 bool knownPosition);
 
 	bool saveSections(const scenegraph::SceneGraph &sceneGraph, priv::NBTList &sections, int sector);
 	bool saveCompressedNBT(const scenegraph::SceneGraph &sceneGraph, io::SeekableWriteStream &stream, int sector);
@@ -7,8 +7,11 @@
 #include "core/Enum.h"
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
+#include "core/StandardLib.h"
 #include "core/Var.h"
 #include "core/collection/DynamicMap.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/MemoryReadStream.h"
 #include "io/Stream.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
@@ -16,6 +19,7 @@
 #include "palette/Palette.h"
 #include "palette/PaletteLookup.h"
 #include "voxelformat/Format.h"
+#include "voxelutil/VolumeImporter.h"
 #include "voxelutil/VolumeVisitor.h"
 
 namespace voxelformat {
@@ -252,13 +256,11 @@ bool QBFormat::readColor(State &state, io::SeekableReadStream &stream, core::RGB
 	return true;
 }
 
-bool QBFormat::readMatrix(State &state, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph,
-						  palette::PaletteLookup &palLookup) {
-	core::String name;
-	wrapBool(stream.readPascalStringUInt8(name))
-	Log::debug("Matrix name: %s", name.c_str());
+bool QBFormat::readMatrixHeader(State &state, io::SeekableReadStream &stream, Matrix &matrix) {
+	wrapBool(stream.readPascalStringUInt8(matrix.name))
+	Log::debug("Matrix name: %s", matrix.name.c_str());
 
-	glm::uvec3 size(0);
+	glm::uvec3 &size = matrix.size;
 	wrap(stream.readUInt32(size.x))
 	wrap(stream.readUInt32(size.y))
 	wrap(stream.readUInt32(size.z))
@@ -274,65 +276,96 @@ bool QBFormat::readMatrix(State &state, io::SeekableReadStream &stream, scenegra
 		return false;
 	}
 
-	scenegraph::SceneGraphTransform transform;
-	{
-		glm::ivec3 offset(0);
-		if (state._zAxisOrientation == ZAxisOrientation::LeftHanded) {
-			wrap(stream.readInt32(offset.x))
-			wrap(stream.readInt32(offset.y))
-			wrap(stream.readInt32(offset.z))
-		} else {
-			wrap(stream.readInt32(offset.z))
-			wrap(stream.readInt32(offset.y))
-			wrap(stream.readInt32(offset.x))
-		}
-		Log::debug("Matrix offset: %i:%i:%i", offset.x, offset.y, offset.z);
-		transform.setWorldTranslation(offset);
+	glm::ivec3 &offset = matrix.offset;
+	if (state._zAxisOrientation == ZAxisOrientation::LeftHanded) {
+		wrap(stream.readInt32(offset.x))
+		wrap(stream.readInt32(offset.y))
+		wrap(stream.readInt32(offset.z))
+	} else {
+		wrap(stream.readInt32(offset.z))
+		wrap(stream.readInt32(offset.y))
+		wrap(stream.readInt32(offset.x))
 	}
+	Log::debug("Matrix offset: %i:%i:%i", offset.x, offset.y, offset.z);
 
-	voxel::Region region;
 	if (state._zAxisOrientation == ZAxisOrientation::RightHanded) {
-		region = voxel::Region(0, 0, 0, (int)size.z - 1, (int)size.y - 1, (int)size.x - 1);
+		matrix.region = voxel::Region(0, 0, 0, (int)size.z - 1, (int)size.y - 1, (int)size.x - 1);
 	} else {
-		region = voxel::Region(0, 0, 0, (int)size.x - 1, (int)size.y - 1, (int)size.z - 1);
+		matrix.region = voxel::Region(0, 0, 0, (int)size.x - 1, (int)size.y - 1, (int)size.z - 1);
 	}
-	if (!region.isValid()) {
+	if (!matrix.region.isValid()) {
 		Log::error("Invalid region");
 		return false;
 	}
 
+	const voxel::Region &region = matrix.region;
 	if (region.getDepthInVoxels() >= 2048 || region.getHeightInVoxels() >= 2048 || region.getWidthInVoxels() >= 2048) {
 		Log::error("Region exceeds the max allowed boundaries");
 		return false;
 	}
+	matrix.dataPos = stream.pos();
+	return true;
+}
 
-	core::ScopedPtr<voxel::RawVolume> v(new voxel::RawVolume(region));
+bool QBFormat::skipMatrixData(State &state, io::SeekableReadStream &stream, const Matrix &matrix) {
+	const glm::uvec3 &size = matrix.size;
+	if (state._compressed == Compression::None) {
+		const int64_t dataSize = (int64_t)size.x * (int64_t)size.y * (int64_t)size.z * 4;
+		if (stream.skip(dataSize) == -1) {
+			Log::error("Could not load qb file: Not enough data in stream");
+			return false;
+		}
+		return true;
+	}
+	uint32_t z = 0u;
+	while (z < size.z) {
+		for (;;) {
+			uint32_t data;
+			wrap(stream.readUInt32(data))
+			if (data == qb::NEXT_SLICE_FLAG) {
+				break;
+			}
+			if (data == qb::RLE_FLAG) {
+				uint32_t count;
+				wrap(stream.readUInt32(count))
+				// the color
+				wrap(stream.readUInt32(data))
+			}
+		}
+		++z;
+	}
+	return true;
+}
+
+bool QBFormat::readMatrixData(State &state, io::SeekableReadStream &stream, Matrix &matrix,
+							  palette::PaletteLookup &palLookup) {
+	const glm::uvec3 &size = matrix.size;
+	voxelutil::GridLayout layout;
+	layout.size = glm::ivec3(size);
+	if (state._zAxisOrientation == ZAxisOrientation::RightHanded) {
+		layout.volumeAxis = glm::ivec3(2, 1, 0);
+	}
+	voxelutil::VolumeImporter importer(layout, matrix.region.getLowerCorner());
+	if (!importer.isValid()) {
+		Log::error("Could not allocate the volume for region %s", matrix.region.toString().c_str());
+		return false;
+	}
 	if (state._compressed == Compression::None) {
 		Log::debug("qb matrix uncompressed");
 		for (uint32_t z = 0; z < size.z; ++z) {
 			for (uint32_t y = 0; y < size.y; ++y) {
 				for (uint32_t x = 0; x < size.x; ++x) {
-					const voxel::Voxel &voxel = getVoxel(state, stream, palLookup);
-					if (state._zAxisOrientation == ZAxisOrientation::LeftHanded) {
-						v->setVoxel((int)x, (int)y, (int)z, voxel);
-					} else {
-						v->setVoxel((int)z, (int)y, (int)x, voxel);
-					}
+					importer.setVoxel((int)x, (int)y, (int)z, getVoxel(state, stream, palLookup));
 				}
 			}
 		}
-		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
-		node.setVolume(v.release(), true);
-		node.setName(name);
-		const scenegraph::KeyFrameIndex keyFrameIdx = 0;
-		node.setTransform(keyFrameIdx, transform);
-		node.setPalette(palLookup.palette());
-		sceneGraph.emplace(core::move(node));
+		matrix.volume = importer.release();
 		return true;
 	}
 
 	Log::debug("Matrix rle compressed");
 
+	const uint32_t sliceSize = size.x * size.y;
 	uint32_t z = 0u;
 	while (z < size.z) {
 		uint32_t index = 0;
@@ -356,26 +389,16 @@ bool QBFormat::readMatrix(State &state, io::SeekableReadStream &stream, scenegra
 				return false;
 			}
 			const voxel::Voxel &voxel = getVoxel(state, stream, palLookup);
-			for (uint32_t j = 0; j < count; ++j) {
-				const uint32_t x = (index + j) % size.x;
-				const uint32_t y = (index + j) / size.x;
-				if (state._zAxisOrientation == ZAxisOrientation::RightHanded) {
-					v->setVoxel((int)z, (int)y, (int)x, voxel);
-				} else {
-					v->setVoxel((int)x, (int)y, (int)z, voxel);
-				}
+			// runs are not crossing the slice - voxels outside of the slice are dropped
+			if (index < sliceSize) {
+				const uint32_t n = core_min(count, sliceSize - index);
+				importer.setRun((int64_t)z * sliceSize + index, n, voxel);
 			}
 			index += count;
 		}
 		++z;
 	}
-	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
-	node.setVolume(v.release(), true);
-	node.setName(name);
-	node.setPalette(palLookup.palette());
-	const scenegraph::KeyFrameIndex keyFrameIdx = 0;
-	node.setTransform(keyFrameIdx, transform);
-	sceneGraph.emplace(core::move(node));
+	matrix.volume = importer.release();
 	Log::debug("Matrix read");
 	return true;
 }
@@ -453,33 +476,75 @@ bool QBFormat::readPalette(State &state, io::SeekableReadStream &stream, RGBAMap
 	return true;
 }
 
-size_t QBFormat::loadPalette(const core::String &filename, const io::ArchivePtr &archive, palette::Palette &palette,
-							 const LoadContext &ctx) {
-	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
-	if (!stream) {
-		Log::error("Could not load file %s", filename.c_str());
-		return 0;
-	}
-
-	State state;
-	wrap(stream->readUInt32(state._version))
+bool QBFormat::readHeader(State &state, io::SeekableReadStream &stream, uint32_t &numMatrices) {
+	wrap(stream.readUInt32(state._version))
 	uint32_t colorFormat;
-	wrap(stream->readUInt32(colorFormat))
+	wrap(stream.readUInt32(colorFormat))
 	state._colorFormat = (ColorFormat)colorFormat;
 	uint32_t zAxisOrientation;
-	wrap(stream->readUInt32(zAxisOrientation))
+	wrap(stream.readUInt32(zAxisOrientation))
 	state._zAxisOrientation = (ZAxisOrientation)zAxisOrientation;
 	uint32_t compressed;
-	wrap(stream->readUInt32(compressed))
+	wrap(stream.readUInt32(compressed))
 	state._compressed = (Compression)compressed;
 	uint32_t visibilityMaskEncoded;
-	wrap(stream->readUInt32(visibilityMaskEncoded))
+	wrap(stream.readUInt32(visibilityMaskEncoded))
 	state._visibilityMaskEncoded = (VisibilityMask)visibilityMaskEncoded;
 
-	uint32_t numMatrices;
-	wrap(stream->readUInt32(numMatrices))
+	wrap(stream.readUInt32(numMatrices))
 	if (numMatrices > 16384) {
 		Log::error("Max allowed matrices exceeded: %u", numMatrices);
+		return false;
+	}
+
+	Log::debug("Version: %u", state._version);
+	Log::debug("ColorFormat: %u", core::enumVal(state._colorFormat));
+	Log::debug("ZAxisOrientation: %u", core::enumVal(state._zAxisOrientation));
+	Log::debug("Compressed: %u", core::enumVal(state._compressed));
+	Log::debug("VisibilityMaskEncoded: %u", core::enumVal(state._visibilityMaskEncoded));
+	Log::debug("NumMatrices: %u", numMatrices);
+	return true;
+}
+
+bool QBFormat::probe(const core::String &filename, const io::ArchivePtr &archive, SceneInfo &info,
+					 const LoadContext &ctx) {
+	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
+	if (!stream) {
+		Log::error("Could not load file %s", filename.c_str());
+		return false;
+	}
+	State state;
+	uint32_t numMatrices;
+	if (!readHeader(state, *stream, numMatrices)) {
+		return false;
+	}
+	// the colors are stored per voxel - there is no palette that could be read without decoding the voxels
+	for (uint32_t i = 0; i < numMatrices; i++) {
+		Matrix matrix;
+		if (!readMatrixHeader(state, *stream, matrix) || !skipMatrixData(state, *stream, matrix)) {
+			Log::error("Failed to probe the matrix %u", i);
+			return false;
+		}
+		SceneInfo::Node node;
+		node.name = matrix.name;
+		node.type = scenegraph::SceneGraphNodeType::Model;
+		node.region = matrix.region;
+		info.nodes.push_back(node);
+	}
+	return true;
+}
+
+size_t QBFormat::loadPalette(const core::String &filename, const io::ArchivePtr &archive, palette::Palette &palette,
+							 const LoadContext &ctx) {
+	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
+	if (!stream) {
+		Log::error("Could not load file %s", filename.c_str());
+		return 0;
+	}
+
+	State state;
+	uint32_t numMatrices;
+	if (!readHeader(state, *stream, numMatrices)) {
 		return 0;
 	}
 	RGBAMap colors;
@@ -502,42 +567,59 @@ bool QBFormat::loadGroupsRGBA(const core::String &filename, const io::ArchivePtr
 		return false;
 	}
 	State state;
-	wrap(stream->readUInt32(state._version))
-	uint32_t colorFormat;
-	wrap(stream->readUInt32(colorFormat))
-	state._colorFormat = (ColorFormat)colorFormat;
-	uint32_t zAxisOrientation;
-	wrap(stream->readUInt32(zAxisOrientation))
-	state._zAxisOrientation = (ZAxisOrientation)zAxisOrientation;
-	uint32_t compressed;
-	wrap(stream->readUInt32(compressed))
-	state._compressed = (Compression)compressed;
-	uint32_t visibilityMaskEncoded;
-	wrap(stream->readUInt32(visibilityMaskEncoded))
-	state._visibilityMaskEncoded = (VisibilityMask)visibilityMaskEncoded;
-
 	uint32_t numMatrices;
-	wrap(stream->readUInt32(numMatrices))
-	if (numMatrices > 16384) {
-		Log::error("Max allowed matrices exceeded: %u", numMatrices);
+	if (!readHeader(state, *stream, numMatrices)) {
 		return false;
 	}
 
-	Log::debug("Version: %u", state._version);
-	Log::debug("ColorFormat: %u", core::enumVal(state._colorFormat));
-	Log::debug("ZAxisOrientation: %u", core::enumVal(state._zAxisOrientation));
-	Log::debug("Compressed: %u", core::enumVal(state._compressed));
-	Log::debug("VisibilityMaskEncoded: %u", core::enumVal(state._visibilityMaskEncoded));
-	Log::debug("NumMatrices: %u", numMatrices);
+	// read the whole file - the matrices are decoded in parallel from memory
+	io::BufferedReadWriteStream buffer(*stream, stream->remaining());
+	buffer.seek(0);
 
-	sceneGraph.reserve(numMatrices);
-	palette::PaletteLookup palLookup(palette);
+	core::DynamicArray<Matrix> matrices;
+	matrices.reserve(numMatrices);
 	for (uint32_t i = 0; i < numMatrices; i++) {
 		Log::debug("Loading matrix: %u", i);
-		if (!readMatrix(state, *stream, sceneGraph, palLookup)) {
+		Matrix matrix;
+		if (!readMatrixHeader(state, buffer, matrix) || !skipMatrixData(state, buffer, matrix)) {
 			Log::error("Failed to load the matrix %u", i);
 			break;
 		}
+		matrices.push_back(matrix);
+	}
+
+	const uint8_t *data = buffer.getBuffer();
+	const int64_t dataSize = buffer.size();
+	decodeParallel((int)matrices.size(), [&](int idx) {
+		Matrix &matrix = matrices[idx];
+		io::MemoryReadStream matrixStream(data + matrix.dataPos, dataSize - matrix.dataPos);
+		palette::PaletteLookup palLookup(palette);
+		if (!readMatrixData(state, matrixStream, matrix, palLookup)) {
+			Log::error("Failed to load the matrix %i", idx);
+			return false;
+		}
+		return true;
+	});
+
+	sceneGraph.reserve(matrices.size());
+	const palette::PaletteLookup palLookup(palette);
+	bool failed = false;
+	for (Matrix &matrix : matrices) {
+		if (failed || matrix.volume == nullptr) {
+			// keep the matrices that were loaded before the first broken one
+			failed = true;
+			delete matrix.volume;
+			continue;
+		}
+		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+		node.setVolume(matrix.volume, true);
+		node.setName(matrix.name);
+		scenegraph::SceneGraphTransform transform;
+		transform.setWorldTranslation(matrix.offset);
+		const scenegraph::KeyFrameIndex keyFrameIdx = 0;
+		node.setTransform(keyFrameIdx, transform);
+		node.setPalette(palLookup.palette());
+		sceneGraph.emplace(core::move(node));
 	}
 	return true;
 }
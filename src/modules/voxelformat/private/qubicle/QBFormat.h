@@ -45,8 +45,23 @@ private:
 
 	bool readColor(State &state, io::SeekableReadStream &stream, core::RGBA &color);
 	voxel::Voxel getVoxel(State &state, io::SeekableReadStream &stream, palette::PaletteLookup &palLookup);
-	bool readMatrix(State &state, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph,
-					palette::PaletteLookup &palLookup);
+	/**
+	 * @brief The structure of a matrix - the voxel payload is decoded in a second step
+	 */
+	struct Matrix {
+		core::String name;
+		glm::uvec3 size{0};
+		glm::ivec3 offset{0};
+		voxel::Region region;
+		/** position of the voxel data in the stream */
+		int64_t dataPos = 0;
+		voxel::RawVolume *volume = nullptr;
+	};
+	bool readHeader(State &state, io::SeekableReadStream &stream, uint32_t &numMatrices);
+	bool readMatrixHeader(State &state, io::SeekableReadStream &stream, Matrix &matrix);
+	bool skipMatrixData(State &state, io::SeekableReadStream &stream, const Matrix &matrix);
+	bool readMatrixData(State &state, io::SeekableReadStream &stream, Matrix &matrix,
+						palette::PaletteLookup &palLookup);
 	bool readPalette(State &state, io::SeekableReadStream &stream, RGBAMap &colors);
 	bool loadGroupsRGBA(const core::String &filename, const io::ArchivePtr &archive,
 						scenegraph::SceneGraph &sceneGraph, const palette::Palette &palette,
@@ -59,6 +74,8 @@ private:
 public:
 	size_t loadPalette(const core::String &filename, const io::ArchivePtr &archive, palette::Palette &palette,
 					   const LoadContext &ctx) override;
+	bool probe(const core::String &filename, const io::ArchivePtr &archive, SceneInfo &info,
+			   const LoadContext &ctx) override;
 
 	static const io::FormatDescription &format() {
 		static io::FormatDescription f{"Qubicle Binary", {"qb"}, {}, VOX_FORMAT_FLAG_PALETTE_EMBEDDED | FORMAT_FLAG_SAVE};
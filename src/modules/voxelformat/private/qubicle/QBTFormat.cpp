@@ -12,6 +12,7 @@
 #include "core/ScopedPtr.h"
 #include "core/Var.h"
 #include "io/BufferedReadWriteStream.h"
+#include "io/MemoryReadStream.h"
 #include "io/Stream.h"
 #include "io/ZipReadStream.h"
 #include "io/ZipWriteStream.h"
@@ -427,50 +428,139 @@ bool QBTFormat::loadMatrix(io::SeekableReadStream &stream, scenegraph::SceneGrap
 		Log::warn("Size of matrix results in empty space - voxelDataSize: %u", voxelDataSize);
 		return false;
 	}
-	io::ZipReadStream zipStream(stream, voxelDataSize);
-
 	const voxel::Region region(glm::ivec3(0), glm::ivec3(size) - 1);
 	if (!region.isValid()) {
 		Log::error("Invalid region");
 		return false;
 	}
-	core::ScopedPtr<voxel::RawVolume> volume(new voxel::RawVolume(region));
+	// the voxel data is decoded in decodeMatrices() once the whole data tree is known
+	MatrixData matrix;
+	matrix.size = size;
+	matrix.dataPos = stream.pos();
+	matrix.dataSize = voxelDataSize;
+	if (stream.skip(voxelDataSize) == -1) {
+		Log::error("Could not load qbt file: Not enough data in stream for the voxel data");
+		return false;
+	}
+	voxel::RawVolume *volume = new voxel::RawVolume(region);
+	matrix.volume = volume;
+	scenegraph::SceneGraphNode node;
+	node.setVolume(volume, true);
+	node.setName(name);
+	node.setPivot(pivot);
+	node.setPalette(palette);
+	const scenegraph::KeyFrameIndex keyFrameIdx = 0;
+	node.setTransform(keyFrameIdx, transform);
+	const int id = sceneGraph.emplace(core::move(node), parent);
+	if (id == -1) {
+		return false;
+	}
+	matrix.nodeId = id;
+	state.matrices.push_back(matrix);
+	return true;
+}
+
+bool QBTFormat::decodeMatrix(MatrixData &matrix, const palette::Palette &palette, const Header &state) const {
+	const glm::uvec3 &size = matrix.size;
+	io::MemoryReadStream memStream(matrix.compressed.data(), matrix.dataSize);
+	io::ZipReadStream zipStream(memStream, (int)matrix.dataSize);
+	const size_t rgbmSize = (size_t)size.x * size.y * size.z * 4;
+	matrix.rgbm.resize(rgbmSize);
+	size_t offset = 0;
+	while (offset < rgbmSize) {
+		const int bytes = zipStream.read(matrix.rgbm.data() + offset, rgbmSize - offset);
+		if (bytes <= 0) {
+			Log::error("Could not load qbt file: Not enough voxel data in stream");
+			return false;
+		}
+		offset += bytes;
+	}
+	matrix.compressed.release();
+	if (state.colorFormat != ColorFormat::Palette) {
+		// the rgba colors are added to the palette in the order of the file - this is done serially
+		return true;
+	}
+	voxel::RawVolume *volume = matrix.volume;
+	const uint8_t *rgbm = matrix.rgbm.data();
 	for (int32_t x = 0; x < (int)size.x; x++) {
 		for (int32_t z = 0; z < (int)size.z; z++) {
-			for (int32_t y = 0; y < (int)size.y; y++) {
-				uint8_t red;
-				wrap(zipStream.readUInt8(red))
-				uint8_t green;
-				wrap(zipStream.readUInt8(green))
-				uint8_t blue;
-				wrap(zipStream.readUInt8(blue))
-				uint8_t mask;
-				wrap(zipStream.readUInt8(mask))
+			for (int32_t y = 0; y < (int)size.y; y++, rgbm += 4) {
+				const uint8_t mask = rgbm[3];
 				if (mask == 0u) {
 					continue;
 				}
-				if (state.colorFormat == ColorFormat::Palette) {
-					const voxel::Voxel &voxel = voxel::createVoxel(palette, red);
-					volume->setVoxel(x, y, z, voxel);
-				} else {
-					const core::RGBA color = flattenRGB(red, green, blue);
-					uint8_t index = 1;
-					palette.tryAdd(color, false, &index);
-					const voxel::Voxel &voxel = voxel::createVoxel(palette, index);
-					volume->setVoxel(x, y, z, voxel);
+				const voxel::Voxel &voxel = voxel::createVoxel(palette, rgbm[0]);
+				volume->setVoxel(x, y, z, voxel);
+			}
+		}
+	}
+	matrix.rgbm.release();
+	return true;
+}
+
+bool QBTFormat::decodeMatrices(io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph,
+							   palette::Palette &palette, Header &state, const LoadContext &ctx) {
+	if (ctx.hasFilter()) {
+		// the matrices that are removed by the load filter anyway are not read
+		sceneGraph.updateTransforms();
+		for (MatrixData &matrix : state.matrices) {
+			matrix.skip = !needsDecoding(sceneGraph, sceneGraph.node(matrix.nodeId), ctx);
+		}
+	}
+	// the stream can only be read by one thread - only the decompression is done in parallel
+	const int64_t pos = stream.pos();
+	for (MatrixData &matrix : state.matrices) {
+		if (matrix.skip) {
+			continue;
+		}
+		matrix.compressed.resize(matrix.dataSize);
+		if (stream.seek(matrix.dataPos) == -1 || stream.read(matrix.compressed.data(), matrix.dataSize) != (int)matrix.dataSize) {
+			Log::error("Could not load qbt file: Not enough data in stream for the voxel data");
+			state.matrices.clear();
+			return false;
+		}
+	}
+	if (stream.seek(pos) == -1) {
+		state.matrices.clear();
+		return false;
+	}
+	const bool decoded = decodeParallel((int)state.matrices.size(), [&](int idx) {
+		MatrixData &matrix = state.matrices[idx];
+		if (matrix.skip) {
+			return true;
+		}
+		return decodeMatrix(matrix, palette, state);
+	});
+	if (!decoded) {
+		state.matrices.clear();
+		return false;
+	}
+	if (state.colorFormat != ColorFormat::Palette) {
+		for (MatrixData &matrix : state.matrices) {
+			if (matrix.skip) {
+				continue;
+			}
+			const glm::uvec3 &size = matrix.size;
+			const uint8_t *rgbm = matrix.rgbm.data();
+			for (int32_t x = 0; x < (int)size.x; x++) {
+				for (int32_t z = 0; z < (int)size.z; z++) {
+					for (int32_t y = 0; y < (int)size.y; y++, rgbm += 4) {
+						if (rgbm[3] == 0u) {
+							continue;
+						}
+						const core::RGBA color = flattenRGB(rgbm[0], rgbm[1], rgbm[2]);
+						uint8_t index = 1;
+						palette.tryAdd(color, false, &index);
+						const voxel::Voxel &voxel = voxel::createVoxel(palette, index);
+						matrix.volume->setVoxel(x, y, z, voxel);
+					}
 				}
 			}
+			matrix.rgbm.release();
 		}
 	}
-	scenegraph::SceneGraphNode node;
-	node.setVolume(volume.release(), true);
-	node.setName(name);
-	node.setPivot(pivot);
-	node.setPalette(palette);
-	const scenegraph::KeyFrameIndex keyFrameIdx = 0;
-	node.setTransform(keyFrameIdx, transform);
-	const int id = sceneGraph.emplace(core::move(node), parent);
-	return id != -1;
+	state.matrices.clear();
+	return true;
 }
 
 /**
@@ -602,27 +692,28 @@ bool QBTFormat::loadHeader(io::SeekableReadStream &stream, Header &state) {
 
 size_t QBTFormat::loadPalette(const core::String &filename, const io::ArchivePtr &archive, palette::Palette &palette,
 							  const LoadContext &ctx) {
-	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
-	if (!stream) {
+	core::ScopedPtr<io::SeekableReadStream> file(archive->readStream(filename));
+	if (!file) {
 		Log::error("Could not load file %s", filename.c_str());
 		return 0;
 	}
+	io::SeekableReadStream &stream = *file;
 	Header state;
-	if (!loadHeader(*stream, state)) {
+	if (!loadHeader(stream, state)) {
 		Log::error("Could not load qbt file: Could not read header");
 		return 0u;
 	}
 
-	const int64_t pos = stream->pos();
+	const int64_t pos = stream.pos();
 
-	while (stream->remaining() > 0) {
+	while (stream.remaining() > 0) {
 		char buf[8];
-		if (!stream->readString(sizeof(buf), buf)) {
+		if (!stream.readString(sizeof(buf), buf)) {
 			Log::error("Could not load qbt file: Could not read chunk id");
 			return 0u;
 		}
 		if (0 == memcmp(buf, "COLORMAP", 7)) {
-			if (!loadColorMap(*stream, palette)) {
+			if (!loadColorMap(stream, palette)) {
 				Log::error("Failed to load color map");
 				return 0;
 			}
@@ -632,7 +723,7 @@ size_t QBTFormat::loadPalette(const core::String &filename, const io::ArchivePtr
 				return colorCount;
 			}
 		} else if (0 == memcmp(buf, "DATATREE", 8)) {
-			wrapBool(skipNode(*stream))
+			wrapBool(skipNode(stream))
 		} else {
 			Log::error("Unknown section found: %c%c%c%c%c%c%c%c", buf[0], buf[1], buf[2], buf[3], buf[4], buf[5],
 					   buf[6], buf[7]);
@@ -642,20 +733,25 @@ size_t QBTFormat::loadPalette(const core::String &filename, const io::ArchivePtr
 	Log::debug("no palette found");
 
 	// no COLORMAP data was found
-	stream->seek(pos);
+	stream.seek(pos);
 
-	while (stream->remaining() > 0) {
+	while (stream.remaining() > 0) {
 		char buf[8];
-		if (!stream->readString(sizeof(buf), buf)) {
+		if (!stream.readString(sizeof(buf), buf)) {
 			Log::error("Could not load qbt file: Could not read chunk id");
 			return 0u;
 		}
 		if (0 == memcmp(buf, "DATATREE", 8)) {
 			scenegraph::SceneGraph sceneGraph;
-			if (!loadNode(*stream, sceneGraph, sceneGraph.root().id(), palette, state)) {
+			if (!loadNode(stream, sceneGraph, sceneGraph.root().id(), palette, state)) {
 				Log::error("Failed to load node");
 				return 0u;
 			}
+			// the palette is built from the colors of all matrices - don't apply the load filter here
+			if (!decodeMatrices(stream, sceneGraph, palette, state, LoadContext())) {
+				Log::error("Failed to load the voxel data");
+				return 0u;
+			}
 		} else {
 			Log::error("Unknown section found: %c%c%c%c%c%c%c%c", buf[0], buf[1], buf[2], buf[3], buf[4], buf[5],
 					   buf[6], buf[7]);
@@ -669,19 +765,21 @@ size_t QBTFormat::loadPalette(const core::String &filename, const io::ArchivePtr
 
 bool QBTFormat::loadGroupsPalette(const core::String &filename, const io::ArchivePtr &archive,
 								  scenegraph::SceneGraph &sceneGraph, palette::Palette &palette, const LoadContext &ctx) {
-	core::ScopedPtr<io::SeekableReadStream> stream(archive->readStream(filename));
-	if (!stream) {
+	core::ScopedPtr<io::SeekableReadStream> file(archive->readStream(filename));
+	if (!file) {
 		Log::error("Could not load file %s", filename.c_str());
 		return false;
 	}
+	// the voxel data of the matrices is read after the data tree is known - and only for the matrices that are kept
+	io::SeekableReadStream &stream = *file;
 	Header state;
-	wrapBool(loadHeader(*stream, state))
+	wrapBool(loadHeader(stream, state))
 
-	while (stream->remaining() > 0) {
+	while (stream.remaining() > 0) {
 		char buf[8];
-		wrapBool(stream->readString(sizeof(buf), buf));
+		wrapBool(stream.readString(sizeof(buf), buf));
 		if (0 == memcmp(buf, "COLORMAP", 7)) {
-			if (!loadColorMap(*stream, palette)) {
+			if (!loadColorMap(stream, palette)) {
 				Log::error("Failed to load color map");
 				return false;
 			}
@@ -693,10 +791,14 @@ bool QBTFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 			}
 		} else if (0 == memcmp(buf, "DATATREE", 8)) {
 			Log::debug("load data tree");
-			if (!loadNode(*stream, sceneGraph, sceneGraph.root().id(), palette, state)) {
+			if (!loadNode(stream, sceneGraph, sceneGraph.root().id(), palette, state)) {
 				Log::error("Failed to load node");
 				return false;
 			}
+			if (!decodeMatrices(stream, sceneGraph, palette, state, ctx)) {
+				Log::error("Failed to load the voxel data");
+				return false;
+			}
 		} else {
 			Log::error("Unknown section found: %c%c%c%c%c%c%c%c", buf[0], buf[1], buf[2], buf[3], buf[4], buf[5],
 					   buf[6], buf[7]);
@@ -5,6 +5,11 @@
 #pragma once
 
 #include "voxelformat/Format.h"
+#include "core/collection/DynamicArray.h"
+
+namespace io {
+class BufferedReadWriteStream;
+}
 
 namespace voxelformat {
 
@@ -23,14 +28,39 @@ namespace voxelformat {
 class QBTFormat : public PaletteFormat {
 private:
 	enum class ColorFormat : uint8_t { RGBA, Palette };
+	/**
+	 * @brief A matrix whose zlib compressed voxel data is decoded after the data tree was parsed
+	 */
+	struct MatrixData {
+		voxel::RawVolume *volume = nullptr;
+		glm::uvec3 size{0};
+		int64_t dataPos = 0;
+		uint32_t dataSize = 0;
+		int nodeId = -1;
+		/** the node is removed by the load filter - the voxel data is not read */
+		bool skip = false;
+		/** the zlib compressed voxel data - read serially, decoded in parallel */
+		core::DynamicArray<uint8_t> compressed;
+		/** the uncompressed voxel data - only kept for rgba matrices that are converted to the palette afterwards */
+		core::DynamicArray<uint8_t> rgbm;
+	};
 	struct Header {
 		uint8_t versionMajor = 0;
 		uint8_t versionMinor = 0;
 		ColorFormat colorFormat = ColorFormat::RGBA;
 		glm::vec3 globalScale{0};
+		core::DynamicArray<MatrixData> matrices;
 	};
 
 	bool loadHeader(io::SeekableReadStream &stream, Header &state);
+	bool decodeMatrix(MatrixData &matrix, const palette::Palette &palette, const Header &state) const;
+	/**
+	 * @brief Decodes the voxel data of all matrices that were found while loading the data tree
+	 * @note The voxel data of the matrices that are removed by the load filter is not read from the stream. The
+	 * stream position is restored afterwards.
+	 */
+	bool decodeMatrices(io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph,
+						palette::Palette &palette, Header &state, const LoadContext &ctx);
 
 	bool skipNode(io::SeekableReadStream &stream);
 	bool loadMatrix(io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, int parent,
@@ -8,11 +8,12 @@
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
+#include "io/TextReadStream.h"
+#include "io/TextWriteStream.h"
 #include "scenegraph/SceneGraph.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Voxel.h"
 #include "palette/Palette.h"
-#include <SDL_stdinc.h>
 #include <glm/common.hpp>
 
 namespace voxelformat {
@@ -38,27 +39,28 @@ bool QEFFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 		Log::error("Could not load file %s", filename.c_str());
 		return false;
 	}
-	char buf[64];
-
-	wrapBool(stream->readLine(sizeof(buf), buf))
-	if (SDL_strcmp(buf, "Qubicle Exchange Format") != 0) {
-		Log::error("Unexpected magic line: '%s'", buf);
+	io::TextReadStream text(*stream);
+	core::String str;
+	wrapBool(text.readLine(str))
+	if (str != "Qubicle Exchange Format") {
+		Log::error("Unexpected magic line: '%s'", str.c_str());
 		return false;
 	}
-	wrapBool(stream->readLine(sizeof(buf), buf))
-	if (SDL_strcmp(buf, "Version 0.2") != 0) {
-		Log::error("Unexpected version line: '%s'", buf);
+	wrapBool(text.readLine(str))
+	if (str != "Version 0.2") {
+		Log::error("Unexpected version line: '%s'", str.c_str());
 		return false;
 	}
-	wrapBool(stream->readLine(sizeof(buf), buf))
-	if (SDL_strcmp(buf, "www.minddesk.com") != 0) {
-		Log::error("Unexpected url line: '%s'", buf);
+	wrapBool(text.readLine(str))
+	if (str != "www.minddesk.com") {
+		Log::error("Unexpected url line: '%s'", str.c_str());
 		return false;
 	}
 
+	io::TextReadStream::Line line;
 	int width, height, depth;
-	wrapBool(stream->readLine(sizeof(buf), buf))
-	if (SDL_sscanf(buf, "%i %i %i", &width, &depth, &height) != 3) {
+	wrapBool(text.readLine(line))
+	if (!line.readInt(width) || !line.readInt(depth) || !line.readInt(height)) {
 		Log::error("Failed to parse dimensions");
 		return false;
 	}
@@ -80,8 +82,8 @@ bool QEFFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 	}
 
 	int paletteSize;
-	wrapBool(stream->readLine(sizeof(buf), buf))
-	if (SDL_sscanf(buf, "%i", &paletteSize) != 1) {
+	wrapBool(text.readLine(line))
+	if (!line.readInt(paletteSize)) {
 		Log::error("Failed to parse palette size");
 		return false;
 	}
@@ -95,8 +97,8 @@ bool QEFFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 
 	for (int i = 0; i < paletteSize; ++i) {
 		float r, g, b;
-		wrapBool(stream->readLine(sizeof(buf), buf))
-		if (SDL_sscanf(buf, "%f %f %f", &r, &g, &b) != 3) {
+		wrapBool(text.readLine(line))
+		if (!line.readFloat(r) || !line.readFloat(g) || !line.readFloat(b)) {
 			Log::error("Failed to parse palette color");
 			return false;
 		}
@@ -110,10 +112,13 @@ bool QEFFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 	node.setPalette(palette);
 	sceneGraph.emplace(core::move(node));
 
-	while (stream->remaining() > 0) {
-		wrapBool(stream->readLine(64, buf))
+	while (text.readLine(line)) {
+		if (line.empty()) {
+			continue;
+		}
 		int x, y, z, color, vismask;
-		if (SDL_sscanf(buf, "%i %i %i %i %i", &x, &z, &y, &color, &vismask) != 5) {
+		if (!line.readInt(x) || !line.readInt(z) || !line.readInt(y) || !line.readInt(color) ||
+			!line.readInt(vismask)) {
 			Log::error("Failed to parse voxel data line");
 			return false;
 		}
@@ -126,14 +131,15 @@ bool QEFFormat::loadGroupsPalette(const core::String &filename, const io::Archiv
 
 bool QEFFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename,
 						   const io::ArchivePtr &archive, const SaveContext &ctx) {
-	core::ScopedPtr<io::SeekableWriteStream> stream(archive->writeStream(filename));
-	if (!stream) {
+	core::ScopedPtr<io::SeekableWriteStream> outStream(archive->writeStream(filename));
+	if (!outStream) {
 		Log::error("Could not open file %s", filename.c_str());
 		return false;
 	}
-	stream->writeString("Qubicle Exchange Format\n", false);
-	stream->writeString("Version 0.2\n", false);
-	stream->writeString("www.minddesk.com\n", false);
+	io::TextWriteStream stream(*outStream);
+	stream.writeString("Qubicle Exchange Format\n", false);
+	stream.writeString("Version 0.2\n", false);
+	stream.writeString("www.minddesk.com\n", false);
 
 	const scenegraph::SceneGraphNode *node = sceneGraph.firstModelNode();
 	core_assert(node);
@@ -145,19 +151,20 @@ bool QEFFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core:
 	const uint32_t width = region.getWidthInVoxels();
 	const uint32_t height = region.getHeightInVoxels();
 	const uint32_t depth = region.getDepthInVoxels();
-	stream->writeStringFormat(false, "%i %i %i\n", width, depth, height);
+	stream.writeStringFormat(false, "%i %i %i\n", width, depth, height);
 	const palette::Palette &palette = node->palette();
-	stream->writeStringFormat(false, "%i\n", palette.colorCount());
+	stream.writeStringFormat(false, "%i\n", palette.colorCount());
 	for (int i = 0; i < palette.colorCount(); ++i) {
 		const core::RGBA c = palette.color(i);
 		const glm::vec4 &cv = core::Color::fromRGBA(c);
-		stream->writeStringFormat(false, "%f %f %f\n", cv.r, cv.g, cv.b);
+		stream.writeFloatText(cv.r);
+		stream.writeFloats(nullptr, &cv.g, 2, 6);
 	}
 
 	for (uint32_t x = 0u; x < width; ++x) {
 		for (uint32_t y = 0u; y < height; ++y) {
-			for (uint32_t z = 0u; z < depth; ++z) {
-				core_assert_always(sampler.setPosition(lower.x + x, lower.y + y, lower.z + z));
+			core_assert_always(sampler.setPosition(lower.x + x, lower.y + y, lower.z));
+			for (uint32_t z = 0u; z < depth; ++z, sampler.movePositiveZ()) {
 				const voxel::Voxel &voxel = sampler.voxel();
 				if (voxel.getMaterial() == voxel::VoxelType::Air) {
 					continue;
@@ -172,10 +179,16 @@ bool QEFFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core:
 				// const voxel::FaceBits faceBits = voxel::visibleFaces(v, x, y, z);
 				const int vismask = 0x7E; // TODO: VOXELFORMAT: this produces voxels where every side is visible, it's up to the
 										  // importer to fix this atm
-				stream->writeStringFormat(false, "%i %i %i %i %i\n", x, z, y, voxel.getColor(), vismask);
+				const int values[]{(int)z, (int)y, voxel.getColor(), vismask};
+				stream.writeIntText(x);
+				stream.writeInts(nullptr, values, 4);
 			}
 		}
 	}
+	if (!stream.flush()) {
+		Log::error("Failed to write qef %s", filename.c_str());
+		return false;
+	}
 	return true;
 }
 
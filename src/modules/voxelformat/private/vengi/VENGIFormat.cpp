@@ -228,7 +228,7 @@ bool VENGIFormat::loadNodeProperties(scenegraph::SceneGraph &sceneGraph, scenegr
 }
 
 bool VENGIFormat::loadNodeData(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version,
-							   io::ReadStream &stream) {
+							   io::ReadStream &stream, const LoadContext &ctx) {
 	glm::ivec3 mins, maxs;
 	wrap(stream.readInt32(mins.x))
 	wrap(stream.readInt32(mins.y))
@@ -238,6 +238,23 @@ bool VENGIFormat::loadNodeData(scenegraph::SceneGraph &sceneGraph, scenegraph::S
 	wrap(stream.readInt32(maxs.z))
 	Log::debug("Load region of %i:%i:%i %i:%i:%i", mins.x, mins.y, mins.z, maxs.x, maxs.y, maxs.z);
 	const voxel::Region region(mins, maxs);
+	if (!ctx.acceptsNode(node.name())) {
+		// the node is removed after loading - just consume the voxels without allocating the volume
+		Log::debug("Skip voxels of node %s", node.name().c_str());
+		const int64_t voxels = (int64_t)region.getWidthInVoxels() * region.getHeightInVoxels() * region.getDepthInVoxels();
+		for (int64_t i = 0; i < voxels; ++i) {
+			if (stream.readBool()) {
+				continue;
+			}
+			uint8_t color;
+			wrap(stream.readUInt8(color))
+			if (version >= 4u) {
+				uint8_t normal;
+				wrap(stream.readUInt8(normal))
+			}
+		}
+		return true;
+	}
 	voxel::RawVolume *v = new voxel::RawVolume(region);
 	node.setVolume(v, true);
 	const palette::Palette &palette = node.palette();
@@ -394,7 +411,7 @@ bool VENGIFormat::loadNodeKeyFrame(scenegraph::SceneGraph &sceneGraph, scenegrap
 }
 
 bool VENGIFormat::loadNode(scenegraph::SceneGraph &sceneGraph, int parent, uint32_t version, io::ReadStream &stream,
-						   NodeMapping &nodeMapping) {
+						   NodeMapping &nodeMapping, const LoadContext &ctx) {
 	core::String name;
 	wrapBool(stream.readPascalStringUInt16LE(name))
 	core::String type;
@@ -450,7 +467,7 @@ bool VENGIFormat::loadNode(scenegraph::SceneGraph &sceneGraph, int parent, uint3
 				return false;
 			}
 		} else if (chunkMagic == FourCC('D', 'A', 'T', 'A')) {
-			if (!loadNodeData(sceneGraph, node, version, stream)) {
+			if (!loadNodeData(sceneGraph, node, version, stream, ctx)) {
 				return false;
 			}
 		} else if (chunkMagic == FourCC('P', 'A', 'L', 'C')) {
@@ -470,7 +487,7 @@ bool VENGIFormat::loadNode(scenegraph::SceneGraph &sceneGraph, int parent, uint3
 				return false;
 			}
 		} else if (chunkMagic == FourCC('N', 'O', 'D', 'E')) {
-			if (!loadNode(sceneGraph, node.id(), version, stream, nodeMapping)) {
+			if (!loadNode(sceneGraph, node.id(), version, stream, nodeMapping, ctx)) {
 				return false;
 			}
 		} else if (chunkMagic == FourCC('E', 'N', 'D', 'N')) {
@@ -523,7 +540,7 @@ bool VENGIFormat::loadGroups(const core::String &filename, const io::ArchivePtr
 	wrap(zipStream.readUInt32(chunkMagic))
 	NodeMapping nodeMapping;
 	if (chunkMagic == FourCC('N', 'O', 'D', 'E')) {
-		if (!loadNode(sceneGraph, sceneGraph.root().id(), version, zipStream, nodeMapping)) {
+		if (!loadNode(sceneGraph, sceneGraph.root().id(), version, zipStream, nodeMapping, ctx)) {
 			return false;
 		}
 		for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::ModelReference); iter != sceneGraph.end();
@@ -39,8 +39,13 @@ private:
 
 	bool loadNodeProperties(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version,
 							io::ReadStream &stream);
+	/**
+	 * @note Only the node name filter can skip the decoding of the voxels. The transforms of the node are stored
+	 * after the voxel data and the whole file is one compressed stream without chunk offsets - so the region
+	 * filter is applied after the scene graph was loaded.
+	 */
 	bool loadNodeData(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version,
-					  io::ReadStream &stream);
+					  io::ReadStream &stream, const LoadContext &ctx);
 	bool loadAnimation(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version,
 					   io::ReadStream &stream);
 	bool loadNodeKeyFrame(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version,
@@ -52,7 +57,7 @@ private:
 	bool loadNodePaletteNormals(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version,
 								io::ReadStream &stream);
 	bool loadNode(scenegraph::SceneGraph &sceneGraph, int parent, uint32_t version, io::ReadStream &stream,
-				  NodeMapping &nodeMapping);
+				  NodeMapping &nodeMapping, const LoadContext &ctx);
 
 protected:
 	bool saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename,
@@ -188,6 +188,13 @@ bool VMaxFormat::loadGroupsPalette(const core::String &filename, const io::Archi
 			Log::debug("Skip to load object %s", obj.data.c_str());
 			continue;
 		}
+		if (!ctx.acceptsNode(obj.n)) {
+			Log::debug("Skip filtered object %s", obj.n.c_str());
+			if (onlyOneObject) {
+				break;
+			}
+			continue;
+		}
 		palette::Palette vmaxPalette;
 		if (!loadPaletteFromArchive(zipArchive, obj.pal, vmaxPalette, ctx)) {
 			return false;
@@ -303,6 +310,12 @@ bool VMaxFormat::loadObjectFromArchive(const core::String &filename, const io::A
 		}
 	}
 
+	// the chunks of an unrotated and unscaled top level object can be tested against the region filter before
+	// they are decoded - everything else is cropped after the scene graph was loaded
+	const bool filterChunks = ctx.region.isValid() && obj.pid.empty() && obj.t_r == glm::vec4(0.0f) &&
+							  obj.t_s == glm::vec3(1.0f);
+	const glm::ivec3 objPos = glm::round(obj.t_p);
+
 	scenegraph::SceneGraph objectSceneGraph;
 	for (size_t i = 0; i < snapshotsArray.size(); ++i) {
 		Log::debug("Load snapshot %i of %i", (int)i, (int)snapshotsArray.size());
@@ -348,6 +361,16 @@ bool VMaxFormat::loadObjectFromArchive(const core::String &filename, const io::A
 			return false;
 		}
 
+		const glm::ivec3 mins(chunkX * maxChunkSize, chunkY * maxChunkSize, chunkZ * maxChunkSize);
+		if (filterChunks) {
+			voxel::Region chunkRegion(mins, mins + maxChunkSize - 1);
+			chunkRegion.shift(objPos);
+			if (!ctx.accepts(chunkRegion)) {
+				Log::debug("Skip chunk %i, %i, %i", chunkX, chunkY, chunkZ);
+				continue;
+			}
+		}
+
 		// now loop over the 'voxels' array and create a volume from it
 		const voxel::Region region(0, maxChunkSize - 1);
 		voxel::RawVolume *v = new voxel::RawVolume(region);
@@ -394,13 +417,16 @@ bool VMaxFormat::loadObjectFromArchive(const core::String &filename, const io::A
 						  chunkOffsetZ + z, mortonIdx);
 			}
 		}
-		const glm::ivec3 mins(chunkX * maxChunkSize, chunkY * maxChunkSize, chunkZ * maxChunkSize);
 		v->translate(mins);
 
 		if (objectSceneGraph.emplace(core::move(node)) == InvalidNodeId) {
 			return false;
 		}
 	}
+	if (filterChunks && objectSceneGraph.empty()) {
+		Log::debug("All chunks of %s are outside of the region filter", obj.n.c_str());
+		return true;
+	}
 	const scenegraph::SceneGraph::MergeResult &merged = objectSceneGraph.merge();
 	if (!merged.hasVolume()) {
 		Log::error("No volumes found in the scene graph");
@@ -25,6 +25,30 @@ TEST_F(AoSVXLFormatTest, testLoad) {
 	testLoad("aceofspades.vxl", 1);
 }
 
+TEST_F(AoSVXLFormatTest, testLoadRegionFilter) {
+	scenegraph::SceneGraph sceneGraph;
+	testLoad(sceneGraph, "aceofspades.vxl", 1);
+	const scenegraph::SceneGraphNode &node = *sceneGraph.beginModel();
+	const voxel::Region &fullRegion = sceneGraph.sceneRegion(node, 0);
+	const glm::ivec3 mins = fullRegion.getLowerCorner() + 16;
+	const voxel::Region region(mins, mins + 31);
+
+	scenegraph::SceneGraph sceneGraphFiltered;
+	testLoadCtx.region = region;
+	testLoad(sceneGraphFiltered, "aceofspades.vxl", 1);
+	const scenegraph::SceneGraphNode &filteredNode = *sceneGraphFiltered.beginModel();
+	EXPECT_EQ(region, sceneGraphFiltered.sceneRegion(filteredNode, 0));
+	const voxel::RawVolume *v = node.volume();
+	const voxel::RawVolume *filtered = filteredNode.volume();
+	for (int y = mins.y; y < mins.y + 32; ++y) {
+		for (int z = mins.z; z < mins.z + 32; ++z) {
+			for (int x = mins.x; x < mins.x + 32; ++x) {
+				ASSERT_EQ(v->voxel(x, y, z), filtered->voxel(x, y, z)) << x << ":" << y << ":" << z;
+			}
+		}
+	}
+}
+
 TEST_F(AoSVXLFormatTest, testLoadPalette) {
 	AoSVXLFormat f;
 	palette::Palette pal;
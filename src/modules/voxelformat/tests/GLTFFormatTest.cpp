@@ -4,8 +4,14 @@
 
 #include "voxelformat/private/mesh/GLTFFormat.h"
 #include "AbstractFormatTest.h"
+#include "core/ConfigVar.h"
+#include "core/FourCC.h"
+#include "core/ScopedPtr.h"
+#include "core/Var.h"
+#include "voxelformat/VolumeFormat.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
+#include "voxel/RawVolume.h"
 #include "voxel/Voxel.h"
 
 namespace voxelformat {
@@ -54,6 +60,107 @@ TEST_F(GLTFFormatTest, testSaveLoadVoxel) {
 	testSaveLoadVoxel("bv-smallvolumesavetest.gltf", &f, 0, 10, flags);
 }
 
+TEST_F(GLTFFormatTest, testSaveLoadVoxelGlb) {
+	GLTFFormat f;
+	const voxel::ValidateFlags flags = voxel::ValidateFlags::All & ~voxel::ValidateFlags::Palette;
+	testSaveLoadVoxel("bv-smallvolumesavetest.glb", &f, 0, 10, flags);
+}
+
+TEST_F(GLTFFormatTest, testSaveLoadVoxelGlbQuantized) {
+	core::Var::getSafe(cfg::VoxFormatGLTF_KHR_mesh_quantization)->setVal(true);
+	GLTFFormat f;
+	const voxel::ValidateFlags flags = voxel::ValidateFlags::All & ~voxel::ValidateFlags::Palette;
+	testSaveLoadVoxel("bv-smallvolumesavetest-quantized.glb", &f, 0, 10, flags);
+	core::Var::getSafe(cfg::VoxFormatGLTF_KHR_mesh_quantization)->setVal(false);
+}
+
+TEST_F(GLTFFormatTest, testSaveGlbCompressed) {
+	scenegraph::SceneGraph sceneGraph;
+	testLoad(sceneGraph, "rgb.qb");
+	const io::ArchivePtr &archive = helper_archive();
+	SaveContext saveCtx;
+	ASSERT_TRUE(saveFormat(sceneGraph, "rgb-uncompressed.glb", nullptr, archive, saveCtx));
+	core::Var::getSafe(cfg::VoxFormatGLTF_KHR_mesh_quantization)->setVal(true);
+	core::Var::getSafe(cfg::VoxFormatGLTF_EXT_meshopt_compression)->setVal(true);
+	const bool saved = saveFormat(sceneGraph, "rgb-compressed.glb", nullptr, archive, saveCtx);
+	core::Var::getSafe(cfg::VoxFormatGLTF_KHR_mesh_quantization)->setVal(false);
+	core::Var::getSafe(cfg::VoxFormatGLTF_EXT_meshopt_compression)->setVal(false);
+	ASSERT_TRUE(saved);
+
+	core::ScopedPtr<io::SeekableReadStream> uncompressed(archive->readStream("rgb-uncompressed.glb"));
+	core::ScopedPtr<io::SeekableReadStream> compressed(archive->readStream("rgb-compressed.glb"));
+	ASSERT_TRUE(uncompressed);
+	ASSERT_TRUE(compressed);
+	EXPECT_LT(compressed->size(), uncompressed->size());
+
+	uint32_t magic, version, length, jsonLength, jsonMagic;
+	ASSERT_EQ(0, compressed->readUInt32(magic));
+	ASSERT_EQ(0, compressed->readUInt32(version));
+	ASSERT_EQ(0, compressed->readUInt32(length));
+	ASSERT_EQ(0, compressed->readUInt32(jsonLength));
+	ASSERT_EQ(0, compressed->readUInt32(jsonMagic));
+	EXPECT_EQ(FourCC('g', 'l', 'T', 'F'), magic);
+	EXPECT_EQ(2u, version);
+	EXPECT_EQ(compressed->size(), (int64_t)length);
+	EXPECT_EQ(FourCC('J', 'S', 'O', 'N'), jsonMagic);
+	core::String json;
+	ASSERT_TRUE(compressed->readString((int)jsonLength, json));
+	EXPECT_TRUE(json.contains("\"extensionsRequired\":[\"KHR_mesh_quantization\",\"EXT_meshopt_compression\"]"))
+		<< json.c_str();
+}
+
+TEST_F(GLTFFormatTest, testSaveModelReferences) {
+	palette::Palette pal;
+	pal.nippon();
+	voxel::RawVolume volume(voxel::Region(0, 7));
+	for (int i = 0; i < 8; ++i) {
+		volume.setVoxel(i, i, 0, voxel::createVoxel(pal, i + 1));
+	}
+	const int instances = 10;
+	scenegraph::SceneGraph referenceSceneGraph;
+	scenegraph::SceneGraph copySceneGraph;
+	for (int i = 0; i < instances; ++i) {
+		scenegraph::SceneGraphTransform transform;
+		transform.setWorldTranslation(glm::vec3(i * 10, 0, 0));
+		if (i == 0) {
+			scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+			node.setVolume(&volume, false);
+			node.setPalette(pal);
+			node.setTransform(0, transform);
+			ASSERT_NE(InvalidNodeId, referenceSceneGraph.emplace(core::move(node)));
+		} else {
+			scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::ModelReference);
+			node.setReference(referenceSceneGraph.firstModelNode()->id());
+			node.setPalette(pal);
+			node.setTransform(0, transform);
+			ASSERT_NE(InvalidNodeId, referenceSceneGraph.emplace(core::move(node)));
+		}
+		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+		node.setVolume(new voxel::RawVolume(volume), true);
+		node.setPalette(pal);
+		node.setTransform(0, transform);
+		ASSERT_NE(InvalidNodeId, copySceneGraph.emplace(core::move(node)));
+	}
+	referenceSceneGraph.updateTransforms();
+	copySceneGraph.updateTransforms();
+
+	GLTFFormat f;
+	const io::ArchivePtr &archive = helper_archive();
+	ASSERT_TRUE(f.save(referenceSceneGraph, "references.gltf", archive, testSaveCtx));
+	ASSERT_TRUE(f.save(copySceneGraph, "copies.gltf", archive, testSaveCtx));
+	{
+		core::ScopedPtr<io::SeekableReadStream> references(archive->readStream("references.gltf"));
+		core::ScopedPtr<io::SeekableReadStream> copies(archive->readStream("copies.gltf"));
+		ASSERT_TRUE(references);
+		ASSERT_TRUE(copies);
+		EXPECT_LT(references->size() * 3, copies->size()) << "The mesh should only be written once";
+	}
+
+	scenegraph::SceneGraph sceneGraph;
+	ASSERT_TRUE(f.load("references.gltf", archive, sceneGraph, testLoadCtx));
+	EXPECT_EQ((size_t)instances, sceneGraph.size(scenegraph::SceneGraphNodeType::AllModels));
+}
+
 TEST_F(GLTFFormatTest, testVoxelizeLantern) {
 	scenegraph::SceneGraph sceneGraph;
 	testLoad(sceneGraph, "glTF/lantern/Lantern.gltf", 3u);
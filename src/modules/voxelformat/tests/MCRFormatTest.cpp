@@ -26,6 +26,17 @@ TEST_F(MCRFormatTest, testLoad117) {
 	EXPECT_EQ(32512, cnt);
 }
 
+TEST_F(MCRFormatTest, testLoad117Region) {
+	// only the chunk column that contains the voxel at 0,62,-576 is decoded
+	testLoadCtx.region = voxel::Region(0, -64, -576, 15, 319, -561);
+	scenegraph::SceneGraph sceneGraph;
+	testLoad(sceneGraph, "r.0.-2.mca", 1);
+	const scenegraph::SceneGraphNode &node = *sceneGraph.begin(scenegraph::SceneGraphNodeType::Model);
+	const voxel::RawVolume *v = node.volume();
+	EXPECT_TRUE(testLoadCtx.region.containsRegion(v->region()));
+	EXPECT_EQ(v->voxel(0, 62, -576), voxel::Voxel(voxel::VoxelType::Generic, 8));
+}
+
 TEST_F(MCRFormatTest, testLoad110) {
 	scenegraph::SceneGraph sceneGraph;
 	testLoad(sceneGraph, "minecraft_110.mca", 1024);
@@ -4,6 +4,9 @@
 
 #include "voxelformat/private/image/PNGFormat.h"
 #include "AbstractFormatTest.h"
+#include "core/StringUtil.h"
+#include "core/collection/Buffer.h"
+#include "image/Image.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "util/VarUtil.h"
@@ -41,4 +44,37 @@ TEST_F(PNGFormatTest, testLoadHeightmap) {
 	EXPECT_EQ(region.getDimensionsInVoxels(), glm::ivec3(8, 255, 8));
 }
 
+TEST_F(PNGFormatTest, testLoadSlices) {
+	constexpr int w = 6;
+	constexpr int h = 5;
+	constexpr int slices = 12;
+	const core::RGBA red(255, 0, 0, 255);
+	for (int z = 0; z < slices; ++z) {
+		// one opaque pixel per slice - at a different position for every slice
+		core::Buffer<core::RGBA> rgba;
+		rgba.resize(w * h);
+		for (int i = 0; i < w * h; ++i) {
+			rgba[i] = core::RGBA(0, 0, 0, 0);
+		}
+		rgba[(z % h) * w + (z % w)] = red;
+		image::Image image("slice");
+		ASSERT_TRUE(image.loadRGBA((const uint8_t *)rgba.data(), w, h));
+		ASSERT_TRUE(image::writeImage(image, core::string::format("pngslicetest-%i.png", z)));
+	}
+	scenegraph::SceneGraph sceneGraph;
+	testLoad(sceneGraph, "pngslicetest-0.png", 1);
+	scenegraph::SceneGraphNode *node = sceneGraph.firstModelNode();
+	ASSERT_TRUE(node != nullptr);
+	const voxel::RawVolume *volume = node->volume();
+	EXPECT_EQ(volume->region().getDimensionsInVoxels(), glm::ivec3(w, h, slices));
+	for (int z = 0; z < slices; ++z) {
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x) {
+				const bool expected = x == z % w && y == z % h;
+				EXPECT_EQ(expected, !voxel::isAir(volume->voxel(x, y, z).getMaterial())) << x << ":" << y << ":" << z;
+			}
+		}
+	}
+}
+
 } // namespace voxelformat
@@ -3,6 +3,9 @@
  */
 
 #include "AbstractFormatTest.h"
+#include "io/FormatDescription.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxelformat/VolumeFormat.h"
 #include "voxelformat/private/qubicle/QBTFormat.h"
 
 namespace voxelformat {
@@ -14,6 +17,39 @@ TEST_F(QBTFormatTest, testLoad) {
 	testLoad("qubicle.qbt", 17);
 }
 
+TEST_F(QBTFormatTest, testLoadNodeFilter) {
+	scenegraph::SceneGraph sceneGraph;
+	testLoad(sceneGraph, "qubicle.qbt", 17);
+	const core::String name = (*sceneGraph.beginModel()).name();
+
+	scenegraph::SceneGraph sceneGraphFiltered;
+	testLoadCtx.nodeFilter = name;
+	testLoad(sceneGraphFiltered, "qubicle.qbt", 1);
+	EXPECT_EQ(name, (*sceneGraphFiltered.beginModel()).name());
+}
+
+TEST_F(QBTFormatTest, testLoadRegionFilter) {
+	scenegraph::SceneGraph sceneGraph;
+	testLoad(sceneGraph, "qubicle.qbt", 17);
+	const scenegraph::SceneGraphNode &node = *sceneGraph.beginModel();
+	voxel::Region region = sceneGraph.sceneRegion(node, 0);
+	region.setUpperCorner(region.getLowerCorner());
+
+	scenegraph::SceneGraph sceneGraphFiltered;
+	testLoadCtx.region = region;
+	const io::ArchivePtr &archive = helper_filesystemarchive();
+	io::FileDescription fileDesc;
+	fileDesc.set("qubicle.qbt");
+	ASSERT_TRUE(voxelformat::loadFormat(fileDesc, archive, sceneGraphFiltered, testLoadCtx));
+	ASSERT_GE(sceneGraphFiltered.size(), 1u);
+	EXPECT_LT(sceneGraphFiltered.size(), sceneGraph.size());
+	sceneGraphFiltered.updateTransforms();
+	for (auto iter = sceneGraphFiltered.beginModel(); iter != sceneGraphFiltered.end(); ++iter) {
+		const voxel::Region &nodeRegion = sceneGraphFiltered.sceneRegion(*iter, 0);
+		EXPECT_TRUE(region.containsRegion(nodeRegion)) << (*iter).name().c_str();
+	}
+}
+
 TEST_F(QBTFormatTest, testLoadRGBSmall) {
 	testRGBSmall("rgb_small.qbt");
 }
@@ -4,11 +4,32 @@
 
 #include "voxelformat/private/vengi/VENGIFormat.h"
 #include "AbstractFormatTest.h"
+#include "io/FormatDescription.h"
+#include "voxelformat/VolumeFormat.h"
 
 namespace voxelformat {
 
 class VENGIFormatTest : public AbstractFormatTest {};
 
+TEST_F(VENGIFormatTest, testLoadNodeFilter) {
+	const io::ArchivePtr &archive = helper_filesystemarchive();
+	io::FileDescription fileDesc;
+	fileDesc.set("bat_anim.vengi");
+	scenegraph::SceneGraph sceneGraph;
+	ASSERT_TRUE(voxelformat::loadFormat(fileDesc, archive, sceneGraph, testLoadCtx));
+	ASSERT_GT(sceneGraph.size(), 1u);
+	const core::String name = (*sceneGraph.beginModel()).name();
+
+	scenegraph::SceneGraph sceneGraphFiltered;
+	testLoadCtx.nodeFilter = name;
+	ASSERT_TRUE(voxelformat::loadFormat(fileDesc, archive, sceneGraphFiltered, testLoadCtx));
+	ASSERT_GE(sceneGraphFiltered.size(), 1u);
+	EXPECT_LT(sceneGraphFiltered.size(), sceneGraph.size());
+	for (auto iter = sceneGraphFiltered.beginModel(); iter != sceneGraphFiltered.end(); ++iter) {
+		EXPECT_EQ(name, (*iter).name());
+	}
+}
+
 TEST_F(VENGIFormatTest, testSaveSmallVolume) {
 	VENGIFormat f;
 	testSaveSmallVolume("testSaveSmallVolume.vengi", &f);
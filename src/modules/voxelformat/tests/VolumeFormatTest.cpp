@@ -5,6 +5,8 @@
 #include "voxelformat/VolumeFormat.h"
 #include "AbstractFormatTest.h"
 #include "io/FilesystemArchive.h"
+#include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
 
 namespace voxelformat {
 
@@ -30,6 +32,46 @@ TEST_F(VolumeFormatTest, testLoadFormat) {
 	}
 }
 
+TEST_F(VolumeFormatTest, testProbe) {
+	// vox and qb only read the headers - qbcl falls back to loading the whole scene graph
+	const char *files[] = {"rgb.vox", "robo.vox", "magicavoxel.vox", "rgb.qb", "qubicle.qb", "rgb.qbcl"};
+	const io::ArchivePtr &archive = io::openFilesystemArchive(_testApp->filesystem());
+	for (int i = 0; i < lengthof(files); ++i) {
+		io::FileDescription fileDesc;
+		fileDesc.set(files[i]);
+		scenegraph::SceneGraph sceneGraph;
+		ASSERT_TRUE(loadFormat(fileDesc, archive, sceneGraph, testLoadCtx)) << "Failed to load " << files[i];
+		SceneInfo info;
+		ASSERT_TRUE(probe(fileDesc, archive, info, testLoadCtx)) << "Failed to probe " << files[i];
+		ASSERT_EQ((int)sceneGraph.size(scenegraph::SceneGraphNodeType::Model), info.models()) << files[i];
+		for (int n = 0; n < (int)info.nodes.size(); ++n) {
+			EXPECT_LT(info.nodes[n].parent, n) << "Parent after child in " << files[i];
+		}
+		for (auto iter = sceneGraph.beginModel(); iter != sceneGraph.end(); ++iter) {
+			const scenegraph::SceneGraphNode &node = *iter;
+			bool found = false;
+			for (const SceneInfo::Node &infoNode : info.nodes) {
+				// the scene graph names the nodes without a name on adding them
+				const bool sameName = infoNode.name.empty() || infoNode.name == node.name();
+				if (infoNode.type == scenegraph::SceneGraphNodeType::Model && sameName &&
+					infoNode.region == node.region()) {
+					found = true;
+					break;
+				}
+			}
+			EXPECT_TRUE(found) << "No probed node for " << node.name() << " with region " << node.region().toString()
+							   << " in " << files[i];
+		}
+		if (info.hasPalette) {
+			const palette::Palette &palette = sceneGraph.firstPalette();
+			ASSERT_EQ(palette.colorCount(), info.palette.colorCount()) << files[i];
+			for (int c = 0; c < palette.colorCount(); ++c) {
+				EXPECT_EQ(palette.color(c), info.palette.color(c)) << "Color " << c << " differs in " << files[i];
+			}
+		}
+	}
+}
+
 TEST_F(VolumeFormatTest, testIsMeshFormat) {
 	EXPECT_TRUE(isMeshFormat("foo.obj", false));
 	EXPECT_TRUE(isMeshFormat("foo.glb", false));
@@ -16,6 +16,7 @@
 #include "lua.h"
 #include "math/Axis.h"
 #include "noise/Simplex.h"
+#include "palette/NormalPalette.h"
 #include "palette/PaletteFormatDescription.h"
 #include "palette/Palette.h"
 #include "palette/PaletteLookup.h"
@@ -366,6 +367,30 @@ static int luaVoxel_volumewrapper_hollow(lua_State *s) {
 	return 0;
 }
 
+static int luaVoxel_volumewrapper_calculatenormals(lua_State *s) {
+	LuaRawVolumeWrapper *volume = luaVoxel_tovolumewrapper(s, 1);
+	const int connectivityNeighbours = (int)luaL_optinteger(s, 2, 26);
+	const bool recalcAll = clua_optboolean(s, 3, true);
+	voxel::Connectivity connectivity;
+	if (connectivityNeighbours == 6) {
+		connectivity = voxel::Connectivity::SixConnected;
+	} else if (connectivityNeighbours == 18) {
+		connectivity = voxel::Connectivity::EighteenConnected;
+	} else if (connectivityNeighbours == 26) {
+		connectivity = voxel::Connectivity::TwentySixConnected;
+	} else {
+		return clua_error(s, "Invalid connectivity %i - expected 6, 18 or 26", connectivityNeighbours);
+	}
+	scenegraph::SceneGraphNode *node = volume->node();
+	if (!node->hasNormalPalette()) {
+		palette::NormalPalette normalPalette;
+		normalPalette.redAlert2();
+		node->setNormalPalette(normalPalette);
+	}
+	lua_pushinteger(s, voxelutil::calculateNormals(*volume, node->normalPalette(), connectivity, recalcAll));
+	return 1;
+}
+
 static int luaVoxel_volumewrapper_importimageasvolume(lua_State *s) {
 	int idx = 1;
 	LuaRawVolumeWrapper *volume = luaVoxel_tovolumewrapper(s, idx++);
@@ -1613,6 +1638,7 @@ static void prepareState(lua_State* s) {
 		{"text", luaVoxel_volumewrapper_text},
 		{"fillHollow", luaVoxel_volumewrapper_fillhollow},
 		{"hollow", luaVoxel_volumewrapper_hollow},
+		{"calculateNormals", luaVoxel_volumewrapper_calculatenormals},
 		{"importHeightmap", luaVoxel_volumewrapper_importheightmap},
 		{"importColoredHeightmap", luaVoxel_volumewrapper_importcoloredheightmap},
 		{"importImageAsVolume", luaVoxel_volumewrapper_importimageasvolume},
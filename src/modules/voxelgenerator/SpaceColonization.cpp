@@ -3,8 +3,10 @@
  */
 
 #include "SpaceColonization.h"
+#include "app/Async.h"
 #include "core/Common.h"
 #include "core/Log.h"
+#include "core/Trace.h"
 
 namespace voxelgenerator {
 namespace tree {
@@ -25,6 +27,52 @@ void Branch::reset() {
 	_growDirection = _originalGrowDirection;
 }
 
+glm::ivec3 BranchGrid::cell(const glm::vec3 &pos) const {
+	return glm::ivec3(glm::floor(pos / _cellSize));
+}
+
+void BranchGrid::init(float cellSize) {
+	_cellSize = cellSize;
+	_branches.clear();
+	_next.clear();
+	_cells.clear();
+}
+
+void BranchGrid::insert(Branch *branch) {
+	const glm::ivec3 &c = cell(branch->_position);
+	int head = -1;
+	_cells.get(c, head);
+	_next.push_back(head);
+	_cells.put(c, (int)_branches.size());
+	_branches.push_back(branch);
+}
+
+int BranchGrid::closest(const glm::vec3 &pos, float maxDistance2, float &distance2) const {
+	const glm::ivec3 &c = cell(pos);
+	int closestIndex = -1;
+	for (int z = c.z - 1; z <= c.z + 1; ++z) {
+		for (int y = c.y - 1; y <= c.y + 1; ++y) {
+			for (int x = c.x - 1; x <= c.x + 1; ++x) {
+				int index = -1;
+				if (!_cells.get(glm::ivec3(x, y, z), index)) {
+					continue;
+				}
+				for (; index != -1; index = _next[index]) {
+					const float length2 = (float)glm::round(glm::distance2(_branches[index]->_position, pos));
+					if (length2 > maxDistance2) {
+						continue;
+					}
+					if (closestIndex == -1 || length2 < distance2 || (length2 == distance2 && index < closestIndex)) {
+						closestIndex = index;
+						distance2 = length2;
+					}
+				}
+			}
+		}
+	}
+	return closestIndex;
+}
+
 SpaceColonization::SpaceColonization(const glm::ivec3& position, int branchLength,
 	int attractionPointWidth, int attractionPointHeight, int attractionPointDepth, float branchSize,
 	unsigned int seed, int minDistance, int maxDistance, int attractionPointCount) :
@@ -81,6 +129,7 @@ void SpaceColonization::grow() {
 }
 
 bool SpaceColonization::step() {
+	core_trace_scoped(SpaceColonizationStep);
 	if (_doneGrowing) {
 		return false;
 	}
@@ -91,41 +140,49 @@ bool SpaceColonization::step() {
 		return false;
 	}
 
-	// process the attraction points
-	for (auto pi = _attractionPoints.begin(); pi != _attractionPoints.end();) {
-		bool attractionPointRemoved = false;
-		AttractionPoint& attractionPoint = *pi;
-
-		attractionPoint._closestBranch = nullptr;
-
-		// Find the nearest branch for this attraction point
-		for (auto bi = _branches.begin(); bi != _branches.end(); ++bi) {
-			Branch* branch = bi->second;
-			const float length2 = (float) glm::round(glm::distance2(branch->_position, attractionPoint._position));
+	if (_grid.size() != _branches.size()) {
+		// the rounded distances are up to 0.5 bigger than the real ones
+		_grid.init(glm::sqrt((float)_maxDistance2) + 1.0f);
+		for (auto e : _branches) {
+			_grid.insert(e->value);
+		}
+	}
 
+	// find the closest branch of each attraction point - this only reads the branches and can run in parallel
+	static constexpr int RemoveAttractionPoint = -2;
+	const int attractionPointCount = (int)_attractionPoints.size();
+	core::DynamicArray<int> closestBranches;
+	closestBranches.resize(attractionPointCount);
+	auto findClosestBranches = [this, &closestBranches](int start, int end) {
+		core_trace_scoped(FindClosestBranches);
+		for (int i = start; i < end; ++i) {
+			float length2 = 0.0f;
+			const int index = _grid.closest(_attractionPoints[i]._position, (float)_maxDistance2, length2);
 			// Min attraction point distance reached, we remove it
-			if (attractionPoint._closestBranch == nullptr) {
-				attractionPoint._closestBranch = branch;
-			} else if (length2 <= _minDistance2) {
-				pi = _attractionPoints.erase(pi);
-				attractionPointRemoved = true;
-				break;
-			} else if (length2 <= _maxDistance2) {
-				// branch in range, determine if it is the nearest
-				if (glm::distance2(attractionPoint._closestBranch->_position, attractionPoint._position) > length2) {
-					attractionPoint._closestBranch = branch;
-				}
+			if (index != -1 && length2 <= (float)_minDistance2) {
+				closestBranches[i] = RemoveAttractionPoint;
+			} else {
+				closestBranches[i] = index;
 			}
 		}
+	};
+	if (attractionPointCount >= ParallelAttractionPoints) {
+		app::for_parallel(0, attractionPointCount, findClosestBranches);
+	} else {
+		findClosestBranches(0, attractionPointCount);
+	}
 
-		// if the attraction point was removed, skip
-		if (attractionPointRemoved) {
+	// Set the grow parameters on all the closest branches that are in range - in the order of the attraction points
+	// to get the same sums for each run
+	size_t remaining = 0;
+	for (int i = 0; i < attractionPointCount; ++i) {
+		const int index = closestBranches[i];
+		if (index == RemoveAttractionPoint) {
 			continue;
 		}
-
-		++pi;
-
-		// Set the grow parameters on all the closest branches that are in range
+		AttractionPoint &attractionPoint = _attractionPoints[remaining++];
+		attractionPoint = _attractionPoints[i];
+		attractionPoint._closestBranch = index == -1 ? nullptr : _grid.branch(index);
 		if (attractionPoint._closestBranch == nullptr) {
 			continue;
 		}
@@ -134,6 +191,7 @@ bool SpaceColonization::step() {
 		attractionPoint._closestBranch->_growDirection += dir;
 		++attractionPoint._closestBranch->_attractionPointInfluence;
 	}
+	_attractionPoints.erase(_attractionPoints.begin() + remaining, _attractionPoints.end());
 
 	// Generate the new branches
 	core::DynamicArray<Branch*> newBranches;
@@ -175,6 +233,7 @@ bool SpaceColonization::step() {
 			continue;
 		}
 		_branches.put(branch->_position, branch);
+		_grid.insert(branch);
 		branchAdded = true;
 	}
 	newBranches.clear();
@@ -8,8 +8,8 @@
 #include "ShapeGenerator.h"
 #include "core/Log.h"
 #include "core/GLM.h"
-#include "core/collection/Map.h"
 #include "core/collection/DynamicArray.h"
+#include "core/collection/DynamicMap.h"
 #include <glm/gtc/epsilon.hpp>
 #ifndef GLM_ENABLE_EXPERIMENTAL
 #define GLM_ENABLE_EXPERIMENTAL
@@ -42,6 +42,45 @@ struct Branch {
 	void reset();
 };
 
+/**
+ * @brief Uniform grid over the branches to find the closest branch of an attraction point without checking all
+ * branches
+ *
+ * The cells are at least as big as the max attraction distance - all branches in range of a position are in the 27
+ * cells around the cell of the position. The grid is updated for every new branch.
+ */
+class BranchGrid {
+private:
+	float _cellSize = 1.0f;
+	/** the branches in the order they were added - the index is used to resolve equal distances */
+	core::DynamicArray<Branch *> _branches;
+	/** index of the next branch in the same cell or @c -1 */
+	core::DynamicArray<int> _next;
+	/** index of the last added branch of a cell */
+	core::DynamicMap<glm::ivec3, int, 1031, std::hash<glm::ivec3>> _cells;
+
+	glm::ivec3 cell(const glm::vec3 &pos) const;
+
+public:
+	void init(float cellSize);
+	void insert(Branch *branch);
+
+	inline size_t size() const {
+		return _branches.size();
+	}
+
+	inline Branch *branch(int index) const {
+		return _branches[index];
+	}
+
+	/**
+	 * @param[out] distance2 The rounded squared distance to the returned branch
+	 * @return The index of the closest branch with a rounded squared distance of @c maxDistance2 or less - @c -1 if
+	 * there is no such branch
+	 */
+	int closest(const glm::vec3 &pos, float maxDistance2, float &distance2) const;
+};
+
 /**
  * @brief Space colonization algorithm
  *
@@ -72,10 +111,16 @@ protected:
 		}
 	};
 
-	using Branches = core::Map<glm::vec3, Branch*, 64, std::hash<glm::vec3>, EqualCompare>;
+	using Branches = core::DynamicMap<glm::vec3, Branch*, 1031, std::hash<glm::vec3>, EqualCompare>;
 	Branches _branches;
+	BranchGrid _grid;
 	math::Random _random;
 
+	/**
+	 * The attraction points are only searched in parallel if there are at least this many
+	 */
+	static constexpr int ParallelAttractionPoints = 512;
+
 	/**
 	 * Generate the attraction points for the crown
 	 */
@@ -0,0 +1,29 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "voxelgenerator/SpaceColonization.h"
+#include <math.h>
+
+class SpaceColonizationBenchmark : public app::AbstractBenchmark {};
+
+BENCHMARK_DEFINE_F(SpaceColonizationBenchmark, Grow)(benchmark::State &state) {
+	const int attractionPoints = (int)state.range();
+	// the density of the attraction points in the crown stays the same
+	const int crownSize = (int)(6.0 * cbrt((double)attractionPoints));
+	for (auto _ : state) {
+		voxelgenerator::tree::SpaceColonization tree(glm::ivec3(0), 2, crownSize, crownSize, crownSize, 4.0f, 1u, 6, 10,
+													 attractionPoints);
+		tree.grow();
+	}
+	state.SetComplexityN(attractionPoints);
+}
+
+BENCHMARK_REGISTER_F(SpaceColonizationBenchmark, Grow)
+	->RangeMultiplier(4)
+	->Range(400, 6400)
+	->Complexity()
+	->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,75 @@
+/**
+ * @file
+ */
+
+#include "voxelgenerator/SpaceColonization.h"
+#include "app/tests/AbstractTest.h"
+
+namespace voxelgenerator {
+namespace tree {
+
+class SpaceColonizationTest : public app::AbstractTest {
+protected:
+	class TestTree : public SpaceColonization {
+	public:
+		TestTree(int attractionPointCount)
+			: SpaceColonization(glm::ivec3(0), 2, 60, 60, 60, 4.0f, 1u, 6, 10, attractionPointCount) {
+		}
+
+		size_t attractionPoints() const {
+			return _attractionPoints.size();
+		}
+
+		size_t branches() const {
+			return _branches.size();
+		}
+
+		const BranchGrid &grid() const {
+			return _grid;
+		}
+	};
+};
+
+TEST_F(SpaceColonizationTest, testBranchGridClosest) {
+	Branch root(nullptr, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 1.0f);
+	Branch a(&root, glm::vec3(5.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), 1.0f);
+	Branch b(&root, glm::vec3(-5.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), 1.0f);
+	Branch c(&root, glm::vec3(30.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), 1.0f);
+	BranchGrid grid;
+	grid.init(11.0f);
+	grid.insert(&root);
+	grid.insert(&a);
+	grid.insert(&b);
+	grid.insert(&c);
+	ASSERT_EQ(4u, grid.size());
+
+	float distance2 = 0.0f;
+	EXPECT_EQ(1, grid.closest(glm::vec3(4.0f, 0.0f, 0.0f), 100.0f, distance2));
+	EXPECT_FLOAT_EQ(1.0f, distance2);
+	EXPECT_EQ(0, grid.closest(glm::vec3(0.0f, 9.0f, 0.0f), 100.0f, distance2));
+	EXPECT_EQ(0, grid.closest(glm::vec3(2.5f, 0.0f, 0.0f), 100.0f, distance2))
+		<< "Equal distances should be resolved by the insertion order";
+	EXPECT_EQ(0, grid.closest(glm::vec3(-2.5f, 0.0f, 0.0f), 100.0f, distance2));
+	EXPECT_EQ(-1, grid.closest(glm::vec3(18.0f, 0.0f, 0.0f), 100.0f, distance2)) << "No branch is in range";
+	EXPECT_EQ(3, grid.closest(glm::vec3(28.0f, 0.0f, 0.0f), 100.0f, distance2));
+}
+
+TEST_F(SpaceColonizationTest, testGrow) {
+	// enough attraction points to search them in parallel
+	TestTree tree(2000);
+	const size_t attractionPoints = tree.attractionPoints();
+	ASSERT_GT(attractionPoints, 0u);
+	tree.grow();
+	EXPECT_LT(tree.attractionPoints(), attractionPoints);
+	EXPECT_GT(tree.branches(), 1u);
+	EXPECT_EQ(tree.branches(), tree.grid().size());
+	EXPECT_FALSE(tree.step()) << "The tree should be done growing";
+
+	TestTree tree2(2000);
+	tree2.grow();
+	EXPECT_EQ(tree.attractionPoints(), tree2.attractionPoints());
+	EXPECT_EQ(tree.branches(), tree2.branches());
+}
+
+} // namespace tree
+} // namespace voxelgenerator
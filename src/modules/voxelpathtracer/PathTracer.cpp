@@ -3,6 +3,7 @@
  */
 
 #include "PathTracer.h"
+#include "app/Async.h"
 #include "core/Color.h"
 #include "core/Log.h"
 #include "core/Var.h"
@@ -66,6 +67,26 @@ public:
 	}
 };
 
+/**
+ * @brief Same as @c yocto::add_camera() but with the given bounds instead of the bounds of the yocto shapes
+ */
+static void addCamera(yocto::scene_data &scene, const glm::vec3 &mins, const glm::vec3 &maxs) {
+	scene.camera_names.emplace_back("camera");
+	yocto::camera_data &camera = scene.cameras.emplace_back();
+	camera.orthographic = false;
+	camera.film = 0.036f;
+	camera.aspect = 16.0f / 9.0f;
+	camera.aperture = 0.0f;
+	camera.lens = 0.050f;
+	const glm::vec3 center = (maxs + mins) / 2.0f;
+	const float radius = glm::length(maxs - mins) / 2.0f;
+	// correction for tracer camera implementation
+	const float distance = radius * camera.lens / (camera.film / camera.aspect) * 2.0f;
+	const glm::vec3 from = glm::vec3(0.0f, 0.0f, 1.0f) * distance + center;
+	camera.frame = yocto::lookat_frame(toVec3f(from), toVec3f(center), yocto::vec3f{0.0f, 1.0f, 0.0f});
+	camera.focus = distance;
+}
+
 } // namespace priv
 
 PathTracer::~PathTracer() {
@@ -263,6 +284,30 @@ static void addPaletteTexture(yocto::scene_data &scene, const palette::Palette &
 }
 #endif
 
+void PathTracer::addCameras(const scenegraph::SceneGraph &sceneGraph, const video::Camera *camera) {
+	if (camera) {
+		addCamera("default", *camera);
+	}
+
+	for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::Camera); iter != sceneGraph.end(); ++iter) {
+		const scenegraph::SceneGraphNode &node = *iter;
+		addCamera(scenegraph::toCameraNode(node));
+	}
+
+	if (_state.scene.cameras.size() <= 1) {
+		if (_state.voxelTraversal) {
+			// there are no shapes in the yocto scene to compute the bounds from
+			glm::vec3 mins;
+			glm::vec3 maxs;
+			_state.voxelTracer.bounds(mins, maxs);
+			priv::addCamera(_state.scene, mins, maxs);
+		} else {
+			yocto::add_camera(_state.scene);
+		}
+	}
+	yocto::add_sky(_state.scene);
+}
+
 bool PathTracer::createScene(const scenegraph::SceneGraph &sceneGraph, const video::Camera *camera) {
 	_state.scene = {};
 	_state.lights = {};
@@ -305,30 +350,70 @@ bool PathTracer::createScene(const scenegraph::SceneGraph &sceneGraph, const vid
 		}
 	}
 
-	if (camera) {
-		addCamera("default", *camera);
-	}
+	addCameras(sceneGraph, camera);
+	return true;
+}
 
-	for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::Camera); iter != sceneGraph.end(); ++iter) {
-		const scenegraph::SceneGraphNode &node = *iter;
-		addCamera(scenegraph::toCameraNode(node));
-	}
+bool PathTracer::createVoxelScene(const scenegraph::SceneGraph &sceneGraph, const video::Camera *camera) {
+	_state.scene = {};
+	_state.lights = {};
+	_state.bvh = {};
+	// the volumes are not converted into yocto shapes - only the brick grids of modified nodes are rebuilt
+	_state.voxelTracer.update(sceneGraph);
+	addCameras(sceneGraph, camera);
+	return true;
+}
 
-	if (_state.scene.cameras.size() <= 1) {
-		yocto::add_camera(_state.scene);
+void PathTracer::voxelTraceStart() {
+	const int height = _state.state.height;
+	const int samples = core_min(_state.params.batch, _state.params.samples - _state.state.samples);
+	const int sampleStart = _state.state.samples;
+	const int rowsPerTask = 16;
+	_voxelFutures.reserve(height / rowsPerTask + 1);
+	for (int rowStart = 0; rowStart < height; rowStart += rowsPerTask) {
+		const int rowEnd = core_min(rowStart + rowsPerTask, height);
+		_voxelFutures.emplace_back(app::async([this, rowStart, rowEnd, sampleStart, samples]() {
+			for (int sample = sampleStart; sample < sampleStart + samples; ++sample) {
+				if (_voxelCancel) {
+					return;
+				}
+				_state.voxelTracer.traceRows(_state.state, _state.scene, _state.params, sample, rowStart, rowEnd);
+			}
+		}));
 	}
-	yocto::add_sky(_state.scene);
+}
 
+bool PathTracer::voxelTraceDone() const {
+	for (const std::future<void> &future : _voxelFutures) {
+		if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			return false;
+		}
+	}
 	return true;
 }
 
+void PathTracer::voxelTraceCancel() {
+	_voxelCancel = true;
+	for (std::future<void> &future : _voxelFutures) {
+		future.wait();
+	}
+	_voxelFutures.clear();
+	_voxelCancel = false;
+}
+
 bool PathTracer::start(const scenegraph::SceneGraph &sceneGraph, const video::Camera *camera) {
 	Log::debug("Create scene");
-	createScene(sceneGraph, camera);
-	_state.bvh = yocto::make_trace_bvh(_state.scene, _state.params);
-	_state.lights = yocto::make_trace_lights(_state.scene, _state.params);
-	_state.state = yocto::make_trace_state(_state.scene, _state.params);
-	yocto::trace_start(_state.context, _state.state, _state.scene, _state.bvh, _state.lights, _state.params);
+	if (_state.voxelTraversal) {
+		createVoxelScene(sceneGraph, camera);
+		_state.state = yocto::make_trace_state(_state.scene, _state.params);
+		voxelTraceStart();
+	} else {
+		createScene(sceneGraph, camera);
+		_state.bvh = yocto::make_trace_bvh(_state.scene, _state.params);
+		_state.lights = yocto::make_trace_lights(_state.scene, _state.params);
+		_state.state = yocto::make_trace_state(_state.scene, _state.params);
+		yocto::trace_start(_state.context, _state.state, _state.scene, _state.bvh, _state.lights, _state.params);
+	}
 	_state.started = true;
 	Log::debug("Started pathtracer");
 	return true;
@@ -345,6 +430,7 @@ bool PathTracer::restart(const scenegraph::SceneGraph &sceneGraph, const video::
 
 bool PathTracer::stop() {
 	yocto::trace_cancel(_state.context);
+	voxelTraceCancel();
 	_state.started = false;
 	return true;
 }
@@ -353,6 +439,10 @@ bool PathTracer::started() const {
 	return _state.started;
 }
 
+void PathTracer::markDirty(int nodeId) {
+	_state.voxelTracer.markDirty(nodeId);
+}
+
 bool PathTracer::update(int *currentSample) {
 	if (!_state.started) {
 		if (currentSample) {
@@ -360,6 +450,24 @@ bool PathTracer::update(int *currentSample) {
 		}
 		return true;
 	}
+	if (_state.voxelTraversal) {
+		if (voxelTraceDone()) {
+			if (!_voxelFutures.empty()) {
+				_voxelFutures.clear();
+				_state.state.samples = core_min(_state.state.samples + _state.params.batch, _state.params.samples);
+			}
+			if (_state.state.samples >= _state.params.samples) {
+				_state.started = false;
+				return true;
+			}
+			if (currentSample) {
+				*currentSample = _state.state.samples;
+			}
+			Log::debug("PathTracer sample: %i", _state.state.samples);
+			voxelTraceStart();
+		}
+		return false;
+	}
 	if (yocto::trace_done(_state.context)) {
 		if (_state.state.samples >= _state.params.samples) {
 			_state.started = false;
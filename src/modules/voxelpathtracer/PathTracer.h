@@ -4,8 +4,12 @@
 
 #pragma once
 
+#include "VoxelTracer.h"
 #include "core/SharedPtr.h"
 #include "core/GLM.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Atomic.h"
+#include <future>
 #include <yocto_scene.h>
 #include <yocto_trace.h>
 
@@ -41,6 +45,12 @@ struct PathTracerState {
 	yocto::trace_params params;
 	yocto::trace_lights lights;
 	yocto::trace_state state;
+	/**
+	 * @brief Intersect the rays directly with the voxel volumes instead of meshing the volumes and building a
+	 * triangle bvh
+	 */
+	bool voxelTraversal = false;
+	VoxelTracer voxelTracer;
 	bool started = false;
 
 	PathTracerState() : context(yocto::make_trace_context({})) {
@@ -50,13 +60,21 @@ struct PathTracerState {
 class PathTracer {
 private:
 	PathTracerState _state;
+	core::DynamicArray<std::future<void>> _voxelFutures;
+	core::AtomicBool _voxelCancel{false};
 
 	void addCamera(const scenegraph::SceneGraphNodeCamera &node);
 	void addCamera(const char *name, const video::Camera &cam);
+	void addCameras(const scenegraph::SceneGraph &sceneGraph, const video::Camera *camera);
 
 	bool createScene(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node,
 					 const voxel::Mesh &mesh, bool opaque);
 	bool createScene(const scenegraph::SceneGraph &sceneGraph, const video::Camera *camera);
+	bool createVoxelScene(const scenegraph::SceneGraph &sceneGraph, const video::Camera *camera);
+
+	void voxelTraceStart();
+	bool voxelTraceDone() const;
+	void voxelTraceCancel();
 
 public:
 	~PathTracer();
@@ -67,6 +85,12 @@ public:
 	bool restart(const scenegraph::SceneGraph &sceneGraph, const video::Camera *camera = nullptr);
 	bool stop();
 	bool started() const;
+	/**
+	 * @brief Mark the given node as modified. This is only needed for the voxel traversal mode - only the acceleration
+	 * data of modified nodes is rebuilt on the next (re-)start.
+	 * @param nodeId The node id or @c -1 to mark all nodes as modified
+	 */
+	void markDirty(int nodeId = -1);
 
 	/**
 	 * @brief Update the path tracer. This will render a batch of samples and must get called until either stop() was
@@ -0,0 +1,595 @@
+/**
+ * @file
+ */
+
+#include "VoxelTracer.h"
+#include "app/Async.h"
+#include "core/Color.h"
+#include "core/Log.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicMap.h"
+#include "palette/Palette.h"
+#include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxel/RawVolume.h"
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/matrix.hpp>
+#include <yocto_scene.h>
+#include <yocto_trace.h>
+#include <algorithm>
+
+namespace voxelpathtracer {
+
+namespace priv {
+
+static constexpr float RayEpsilon = 1e-3f;
+
+static inline glm::vec3 toVec3(const yocto::vec3f &in) {
+	return glm::vec3(in.x, in.y, in.z);
+}
+
+static inline yocto::vec3f toVec3f(const glm::vec3 &in) {
+	return yocto::vec3f{in.x, in.y, in.z};
+}
+
+static inline int minAxis(const glm::vec3 &v) {
+	if (v.x < v.y) {
+		return v.x < v.z ? 0 : 2;
+	}
+	return v.y < v.z ? 1 : 2;
+}
+
+static inline float maxComponent(const glm::vec3 &v) {
+	return glm::max(v.x, glm::max(v.y, v.z));
+}
+
+/**
+ * @brief Amanatides & Woo grid traversal state for cells of the given size
+ */
+struct DDA {
+	glm::ivec3 cell;
+	glm::ivec3 step;
+	glm::vec3 tMax;
+	glm::vec3 tDelta;
+
+	DDA(const glm::vec3 &origin, const glm::vec3 &dir, const glm::vec3 &invDir, float t, float cellSize,
+		const glm::ivec3 &cellMins, const glm::ivec3 &cellMaxs) {
+		const glm::vec3 p = origin + dir * t;
+		cell = glm::clamp(glm::ivec3(glm::floor(p / cellSize)), cellMins, cellMaxs);
+		for (int i = 0; i < 3; ++i) {
+			if (dir[i] > 0.0f) {
+				step[i] = 1;
+				tMax[i] = ((float)(cell[i] + 1) * cellSize - origin[i]) * invDir[i];
+				tDelta[i] = cellSize * invDir[i];
+			} else if (dir[i] < 0.0f) {
+				step[i] = -1;
+				tMax[i] = ((float)cell[i] * cellSize - origin[i]) * invDir[i];
+				tDelta[i] = -cellSize * invDir[i];
+			} else {
+				step[i] = 0;
+				tMax[i] = FLT_MAX;
+				tDelta[i] = FLT_MAX;
+			}
+		}
+	}
+
+	/**
+	 * @return the axis that was stepped
+	 */
+	inline int next() {
+		const int axis = minAxis(tMax);
+		cell[axis] += step[axis];
+		tMax[axis] += tDelta[axis];
+		return axis;
+	}
+};
+
+static bool intersectBox(const glm::vec3 &origin, const glm::vec3 &invDir, const glm::vec3 &mins,
+						 const glm::vec3 &maxs, float &tmin, float &tmax, int *entryAxis = nullptr) {
+	const glm::vec3 t0 = (mins - origin) * invDir;
+	const glm::vec3 t1 = (maxs - origin) * invDir;
+	const glm::vec3 tnear = glm::min(t0, t1);
+	const glm::vec3 tfar = glm::max(t0, t1);
+	float enter = maxComponent(tnear);
+	const float exit = glm::min(tfar.x, glm::min(tfar.y, tfar.z));
+	if (entryAxis != nullptr) {
+		*entryAxis = tnear.x > tnear.y ? (tnear.x > tnear.z ? 0 : 2) : (tnear.y > tnear.z ? 1 : 2);
+	}
+	enter = glm::max(enter, tmin);
+	// also rejects nan values
+	if (!(enter <= glm::min(exit, tmax))) {
+		return false;
+	}
+	tmin = enter;
+	tmax = glm::min(exit, tmax);
+	return true;
+}
+
+static inline glm::vec3 safeInverse(const glm::vec3 &dir) {
+	glm::vec3 inv;
+	for (int i = 0; i < 3; ++i) {
+		inv[i] = dir[i] == 0.0f ? FLT_MAX : 1.0f / dir[i];
+	}
+	return inv;
+}
+
+static inline glm::vec3 reflect(const glm::vec3 &dir, const glm::vec3 &normal) {
+	return dir - 2.0f * glm::dot(dir, normal) * normal;
+}
+
+static inline glm::vec3 randomInSphere(yocto::rng_state &rng) {
+	return toVec3(yocto::sample_sphere(yocto::rand2f(rng))) * yocto::rand1f(rng);
+}
+
+} // namespace priv
+
+void VoxelBrickGrid::build(const voxel::RawVolume *v) {
+	core_trace_scoped(VoxelBrickGridBuild);
+	region = v->region();
+	const glm::ivec3 &dim = region.getDimensionsInVoxels();
+	constexpr int bs = VoxelTracer::BrickSize;
+	bricks = (dim + (bs - 1)) / bs;
+	occupied.clear();
+	occupied.resize((size_t)bricks.x * bricks.y * bricks.z);
+
+	const voxel::Voxel *data = (const voxel::Voxel *)v->data();
+	const size_t stride = (size_t)dim.x * dim.y;
+	for (int z = 0; z < dim.z; ++z) {
+		const int bz = z / bs;
+		for (int y = 0; y < dim.y; ++y) {
+			const int by = y / bs;
+			const voxel::Voxel *row = data + (size_t)z * stride + (size_t)y * dim.x;
+			uint8_t *brickRow = &occupied[(size_t)by * bricks.x + (size_t)bz * bricks.x * bricks.y];
+			for (int bx = 0; bx < bricks.x; ++bx) {
+				if (brickRow[bx] != 0u) {
+					continue;
+				}
+				const int xEnd = glm::min(dim.x, (bx + 1) * bs);
+				for (int x = bx * bs; x < xEnd; ++x) {
+					if (!voxel::isAir(row[x].getMaterial())) {
+						brickRow[bx] = 1u;
+						break;
+					}
+				}
+			}
+		}
+	}
+	dirty = false;
+}
+
+void VoxelTracer::clear() {
+	_grids.clear();
+	_instances.clear();
+	_instanceIndices.clear();
+	_bvh.clear();
+	_materials.clear();
+}
+
+void VoxelTracer::markDirty(int nodeId) {
+	if (nodeId == -1) {
+		for (VoxelBrickGrid &grid : _grids) {
+			grid.dirty = true;
+		}
+		return;
+	}
+	for (VoxelBrickGrid &grid : _grids) {
+		if (grid.nodeId == nodeId) {
+			grid.dirty = true;
+		}
+	}
+	// a reference node id marks the grid of the referenced model node
+	for (const VoxelTraceInstance &instance : _instances) {
+		if (instance.nodeId == nodeId) {
+			_grids[instance.gridIdx].dirty = true;
+		}
+	}
+}
+
+void VoxelTracer::addMaterials(const palette::Palette &palette) {
+	for (int i = 0; i < palette::PaletteMaxColors; ++i) {
+		_materials.emplace_back();
+		VoxelTraceMaterial &material = _materials.back();
+		if (i >= palette.colorCount()) {
+			continue;
+		}
+		const palette::Material &ownMaterial = palette.material(i);
+		const glm::vec4 color = core::Color::fromRGBA(palette.color(i));
+		material.color = glm::vec3(color);
+		material.opacity = color.a;
+		if (ownMaterial.type == palette::MaterialType::Emit ||
+			ownMaterial.has(palette::MaterialProperty::MaterialEmit)) {
+			material.emission = glm::vec3(core::Color::fromRGBA(palette.emitColor(i)));
+		}
+		if (ownMaterial.type == palette::MaterialType::Metal) {
+			material.metallic = 1.0f;
+		}
+		if (ownMaterial.has(palette::MaterialProperty::MaterialMetal)) {
+			material.metallic = ownMaterial.value(palette::MaterialProperty::MaterialMetal);
+		}
+		if (ownMaterial.has(palette::MaterialProperty::MaterialRoughness)) {
+			material.roughness = ownMaterial.value(palette::MaterialProperty::MaterialRoughness);
+		}
+		// glass is not refracted - it's handled like the blend material
+		material.transparent =
+			ownMaterial.type == palette::MaterialType::Glass || ownMaterial.type == palette::MaterialType::Blend;
+	}
+}
+
+void VoxelTracer::update(const scenegraph::SceneGraph &sceneGraph) {
+	core_trace_scoped(VoxelTracerUpdate);
+	_instances.clear();
+	_instanceIndices.clear();
+	_bvh.clear();
+	_materials.clear();
+
+	// the volume address is not used as key - a new volume might get the address of an already deleted one
+	core::DynamicMap<uint64_t, int, 223> gridMap;
+	for (size_t i = 0; i < _grids.size(); ++i) {
+		gridMap.put(_grids[i].key(), (int)i);
+	}
+	core::DynamicArray<bool> usedGrids;
+	usedGrids.resize(_grids.size());
+
+	const scenegraph::KeyFrameIndex keyFrameIdx = 0;
+	for (auto iter = sceneGraph.beginAllModels(); iter != sceneGraph.end(); ++iter) {
+		const scenegraph::SceneGraphNode &node = *iter;
+		if (!node.visible()) {
+			continue;
+		}
+		// references share the grid of the model node
+		const scenegraph::SceneGraphNode *modelNode = &node;
+		while (modelNode->type() == scenegraph::SceneGraphNodeType::ModelReference) {
+			modelNode = &sceneGraph.node(modelNode->reference());
+		}
+		const voxel::RawVolume *v = modelNode->volume();
+		if (v == nullptr) {
+			continue;
+		}
+		const uint64_t key = VoxelBrickGrid::key(modelNode->id(), modelNode->volumeGeneration());
+		int gridIdx = -1;
+		if (!gridMap.get(key, gridIdx)) {
+			gridIdx = (int)_grids.size();
+			VoxelBrickGrid grid;
+			grid.nodeId = modelNode->id();
+			grid.generation = modelNode->volumeGeneration();
+			_grids.emplace_back(core::move(grid));
+			usedGrids.push_back(false);
+			gridMap.put(key, gridIdx);
+		}
+		VoxelBrickGrid &grid = _grids[gridIdx];
+		if (grid.region != v->region()) {
+			grid.dirty = true;
+		}
+		if (grid.dirty) {
+			// the voxel data is shared with the node volume until one of them is modified
+			grid.volume = core::make_shared<voxel::RawVolume>(*v);
+		}
+		usedGrids[gridIdx] = true;
+
+		_instances.emplace_back();
+		VoxelTraceInstance &instance = _instances.back();
+		instance.nodeId = node.id();
+		instance.gridIdx = gridIdx;
+		instance.materialOffset = (int)_materials.size();
+		addMaterials(node.palette());
+
+		// this matches the transform that is applied to the mesh vertices in the mesh based path tracer
+		const scenegraph::SceneGraphTransform &transform = node.transform(keyFrameIdx);
+		const voxel::Region &region = v->region();
+		const glm::vec3 size(region.getDimensionsInVoxels());
+		const glm::mat4 volumeToWorld = glm::translate(transform.worldMatrix(), -node.pivot() * size);
+		instance.worldToVolume = glm::inverse(volumeToWorld);
+		instance.normalMatrix = glm::transpose(glm::mat3(instance.worldToVolume));
+
+		const glm::vec3 lo = region.getLowerCornerf();
+		const glm::vec3 hi = glm::vec3(region.getUpperCorner() + 1);
+		instance.mins = glm::vec3(FLT_MAX);
+		instance.maxs = glm::vec3(-FLT_MAX);
+		for (int i = 0; i < 8; ++i) {
+			const glm::vec3 corner((i & 1) ? hi.x : lo.x, (i & 2) ? hi.y : lo.y, (i & 4) ? hi.z : lo.z);
+			const glm::vec3 world(volumeToWorld * glm::vec4(corner, 1.0f));
+			instance.mins = glm::min(instance.mins, world);
+			instance.maxs = glm::max(instance.maxs, world);
+		}
+	}
+
+	// drop the grids of volumes that are no longer part of the scene - and remap the instance grid indices
+	core::DynamicArray<int> remap;
+	remap.resize(_grids.size());
+	core::DynamicArray<VoxelBrickGrid> grids;
+	grids.reserve(_grids.size());
+	for (size_t i = 0; i < _grids.size(); ++i) {
+		if (!usedGrids[i]) {
+			remap[i] = -1;
+			continue;
+		}
+		remap[i] = (int)grids.size();
+		grids.emplace_back(core::move(_grids[i]));
+	}
+	_grids = core::move(grids);
+	for (VoxelTraceInstance &instance : _instances) {
+		instance.gridIdx = remap[instance.gridIdx];
+	}
+
+	// only rebuild the brick grids of new or modified volumes
+	core::DynamicArray<std::future<void>> futures;
+	for (VoxelBrickGrid &grid : _grids) {
+		if (!grid.dirty) {
+			continue;
+		}
+		futures.emplace_back(app::async([&grid]() { grid.build(grid.volume.get()); }));
+	}
+	for (std::future<void> &future : futures) {
+		future.wait();
+	}
+	Log::debug("Rebuilt %i of %i brick grids for %i instances", (int)futures.size(), (int)_grids.size(),
+			   (int)_instances.size());
+
+	_instanceIndices.reserve(_instances.size());
+	for (size_t i = 0; i < _instances.size(); ++i) {
+		_instanceIndices.push_back((int)i);
+	}
+	if (!_instances.empty()) {
+		_bvh.reserve(_instances.size() * 2);
+		_bvh.emplace_back();
+		buildBVH(0, 0, (int)_instances.size());
+	}
+}
+
+void VoxelTracer::buildBVH(int nodeIdx, int start, int count) {
+	glm::vec3 mins(FLT_MAX);
+	glm::vec3 maxs(-FLT_MAX);
+	glm::vec3 centerMins(FLT_MAX);
+	glm::vec3 centerMaxs(-FLT_MAX);
+	for (int i = start; i < start + count; ++i) {
+		const VoxelTraceInstance &instance = _instances[_instanceIndices[i]];
+		mins = glm::min(mins, instance.mins);
+		maxs = glm::max(maxs, instance.maxs);
+		const glm::vec3 center = (instance.mins + instance.maxs) * 0.5f;
+		centerMins = glm::min(centerMins, center);
+		centerMaxs = glm::max(centerMaxs, center);
+	}
+	_bvh[nodeIdx].mins = mins;
+	_bvh[nodeIdx].maxs = maxs;
+
+	const glm::vec3 extent = centerMaxs - centerMins;
+	const int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+	if (count <= 2 || extent[axis] <= 0.0f) {
+		_bvh[nodeIdx].start = start;
+		_bvh[nodeIdx].count = count;
+		return;
+	}
+
+	// median split along the axis with the largest extent of the instance centers
+	const int mid = start + count / 2;
+	int *first = _instanceIndices.data() + start;
+	std::nth_element(first, _instanceIndices.data() + mid, first + count, [this, axis](int a, int b) {
+		const VoxelTraceInstance &ia = _instances[a];
+		const VoxelTraceInstance &ib = _instances[b];
+		return ia.mins[axis] + ia.maxs[axis] < ib.mins[axis] + ib.maxs[axis];
+	});
+
+	// children are always stored next to each other
+	const int left = (int)_bvh.size();
+	_bvh.emplace_back();
+	_bvh.emplace_back();
+	_bvh[nodeIdx].start = left;
+	_bvh[nodeIdx].count = 0;
+	buildBVH(left, start, mid - start);
+	buildBVH(left + 1, mid, start + count - mid);
+}
+
+bool VoxelTracer::intersectInstance(const VoxelTraceInstance &instance, const glm::vec3 &worldOrigin,
+									const glm::vec3 &worldDir, float tmax, VoxelTraceHit &hit) const {
+	const VoxelBrickGrid &grid = _grids[instance.gridIdx];
+	const voxel::Region &region = grid.region;
+	const glm::vec3 lo = region.getLowerCornerf();
+	// the ray in the volume space relative to the lower corner of the volume region - the ray parameter t is the
+	// same as in world space, because the direction isn't normalized
+	const glm::vec3 origin = glm::vec3(instance.worldToVolume * glm::vec4(worldOrigin, 1.0f)) - lo;
+	const glm::vec3 dir = glm::mat3(instance.worldToVolume) * worldDir;
+	if (glm::all(glm::equal(dir, glm::vec3(0.0f)))) {
+		return false;
+	}
+	const glm::vec3 invDir = priv::safeInverse(dir);
+	const glm::ivec3 &dim = region.getDimensionsInVoxels();
+
+	float t0 = 0.0f;
+	float t1 = tmax;
+	int entryAxis = 0;
+	if (!priv::intersectBox(origin, invDir, glm::vec3(0.0f), glm::vec3(dim), t0, t1, &entryAxis)) {
+		return false;
+	}
+
+	constexpr int bs = BrickSize;
+	const voxel::Voxel *data = (const voxel::Voxel *)grid.volume->data();
+	const size_t stride = (size_t)dim.x * dim.y;
+
+	priv::DDA outer(origin, dir, invDir, t0, (float)bs, glm::ivec3(0), grid.bricks - 1);
+	float brickEnter = t0;
+	int brickAxis = entryAxis;
+	for (;;) {
+		const glm::ivec3 &brick = outer.cell;
+		if (brick.x < 0 || brick.y < 0 || brick.z < 0 || brick.x >= grid.bricks.x || brick.y >= grid.bricks.y ||
+			brick.z >= grid.bricks.z || brickEnter > t1) {
+			break;
+		}
+		const float brickExit = glm::min(t1, glm::min(outer.tMax.x, glm::min(outer.tMax.y, outer.tMax.z)));
+		if (grid.isOccupied(brick.x, brick.y, brick.z)) {
+			const glm::ivec3 cellMins = brick * bs;
+			const glm::ivec3 cellMaxs = glm::min(cellMins + (bs - 1), dim - 1);
+			priv::DDA inner(origin, dir, invDir, brickEnter, 1.0f, cellMins, cellMaxs);
+			float cellEnter = brickEnter;
+			int cellAxis = brickAxis;
+			for (;;) {
+				const glm::ivec3 &c = inner.cell;
+				const voxel::Voxel &voxel = data[(size_t)c.z * stride + (size_t)c.y * dim.x + c.x];
+				if (!voxel::isAir(voxel.getMaterial())) {
+					glm::vec3 normal(0.0f);
+					normal[cellAxis] = dir[cellAxis] > 0.0f ? -1.0f : 1.0f;
+					hit.t = cellEnter;
+					hit.tExit = glm::min(inner.tMax.x, glm::min(inner.tMax.y, inner.tMax.z));
+					hit.normal = glm::normalize(instance.normalMatrix * normal);
+					hit.colorIndex = voxel.getColor();
+					return true;
+				}
+				cellAxis = priv::minAxis(inner.tMax);
+				cellEnter = inner.tMax[cellAxis];
+				if (cellEnter > brickExit) {
+					break;
+				}
+				inner.next();
+				if (glm::any(glm::lessThan(inner.cell, cellMins)) || glm::any(glm::greaterThan(inner.cell, cellMaxs))) {
+					break;
+				}
+			}
+		}
+		brickAxis = priv::minAxis(outer.tMax);
+		brickEnter = outer.tMax[brickAxis];
+		outer.next();
+	}
+	return false;
+}
+
+void VoxelTracer::bounds(glm::vec3 &mins, glm::vec3 &maxs) const {
+	if (_bvh.empty()) {
+		mins = maxs = glm::vec3(0.0f);
+		return;
+	}
+	mins = _bvh[0].mins;
+	maxs = _bvh[0].maxs;
+}
+
+bool VoxelTracer::intersect(const glm::vec3 &origin, const glm::vec3 &dir, VoxelTraceHit &hit, float tmax) const {
+	if (_bvh.empty()) {
+		return false;
+	}
+	const glm::vec3 invDir = priv::safeInverse(dir);
+	int stack[64];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	bool found = false;
+	while (stackSize > 0) {
+		const BVHNode &node = _bvh[stack[--stackSize]];
+		float tmin = 0.0f;
+		float tfar = tmax;
+		if (!priv::intersectBox(origin, invDir, node.mins, node.maxs, tmin, tfar)) {
+			continue;
+		}
+		if (node.count == 0) {
+			core_assert(stackSize + 2 <= (int)lengthof(stack));
+			stack[stackSize++] = node.start;
+			stack[stackSize++] = node.start + 1;
+			continue;
+		}
+		for (int i = node.start; i < node.start + node.count; ++i) {
+			const int instanceIdx = _instanceIndices[i];
+			VoxelTraceHit instanceHit;
+			if (intersectInstance(_instances[instanceIdx], origin, dir, tmax, instanceHit)) {
+				tmax = instanceHit.t;
+				hit = instanceHit;
+				hit.instanceIdx = instanceIdx;
+				found = true;
+			}
+		}
+	}
+	return found;
+}
+
+glm::vec3 VoxelTracer::traceRay(const yocto::scene_data &scene, const yocto::trace_params &params, glm::vec3 origin,
+								glm::vec3 dir, yocto::rng_state &rng, bool &hitSomething) const {
+	const bool eyelight = params.sampler == yocto::trace_sampler_type::eyelight;
+	glm::vec3 radiance(0.0f);
+	glm::vec3 weight(1.0f);
+	hitSomething = false;
+	for (int bounce = 0; bounce < params.bounces; ++bounce) {
+		VoxelTraceHit hit;
+		if (!intersect(origin, dir, hit)) {
+			if (bounce > 0 || !params.envhidden) {
+				radiance += weight * priv::toVec3(yocto::eval_environment(scene, priv::toVec3f(dir)));
+			}
+			break;
+		}
+		if (bounce == 0) {
+			hitSomething = true;
+		}
+		const VoxelTraceInstance &instance = _instances[hit.instanceIdx];
+		const VoxelTraceMaterial &material = _materials[instance.materialOffset + hit.colorIndex];
+		const glm::vec3 pos = origin + dir * hit.t;
+		glm::vec3 normal = hit.normal;
+		if (glm::dot(normal, dir) > 0.0f) {
+			normal = -normal;
+		}
+
+		if (eyelight) {
+			radiance += weight * material.color * glm::abs(glm::dot(normal, dir)) + material.emission;
+			break;
+		}
+
+		radiance += weight * material.emission;
+
+		if (material.transparent && yocto::rand1f(rng) > material.opacity) {
+			// transparent voxels are handled like a participating medium - each voxel absorbs parts of the light. The
+			// ray continues behind the voxel - otherwise it would hit the same voxel again.
+			weight *= material.color;
+			origin += dir * (hit.tExit + priv::RayEpsilon);
+			continue;
+		}
+
+		if (material.metallic > 0.0f && yocto::rand1f(rng) < material.metallic) {
+			dir = glm::normalize(priv::reflect(dir, normal) + material.roughness * priv::randomInSphere(rng));
+			if (glm::dot(dir, normal) <= 0.0f) {
+				break;
+			}
+		} else {
+			dir = priv::toVec3(yocto::sample_hemisphere_cos(priv::toVec3f(normal), yocto::rand2f(rng)));
+		}
+		weight *= material.color;
+		origin = pos + normal * priv::RayEpsilon;
+
+		// russian roulette
+		if (bounce > 3) {
+			const float survive = glm::min(priv::maxComponent(weight), 0.95f);
+			if (yocto::rand1f(rng) >= survive) {
+				break;
+			}
+			weight /= survive;
+		}
+	}
+	return radiance;
+}
+
+void VoxelTracer::traceRows(yocto::trace_state &state, const yocto::scene_data &scene,
+							const yocto::trace_params &params, int sample, int rowStart, int rowEnd) const {
+	const yocto::camera_data &camera = scene.cameras[params.camera];
+	const float weight = 1.0f / (float)(sample + 1);
+	for (int j = rowStart; j < rowEnd; ++j) {
+		for (int i = 0; i < state.width; ++i) {
+			const int idx = state.width * j + i;
+			yocto::rng_state &rng = state.rngs[idx];
+			const yocto::vec2f puv = yocto::rand2f(rng);
+			const yocto::vec2f luv = yocto::rand2f(rng);
+			const yocto::vec2f uv{(i + puv.x) / state.width, (j + puv.y) / state.height};
+			const yocto::ray3f ray = yocto::eval_camera(camera, uv, yocto::sample_disk(luv));
+			bool hit = false;
+			glm::vec3 radiance = traceRay(scene, params, priv::toVec3(ray.o), priv::toVec3(ray.d), rng, hit);
+			if (glm::any(glm::isnan(radiance)) || glm::any(glm::isinf(radiance))) {
+				radiance = glm::vec3(0.0f);
+			}
+			const float maxRadiance = priv::maxComponent(radiance);
+			if (maxRadiance > params.clamp) {
+				radiance *= params.clamp / maxRadiance;
+			}
+			if (hit || (!params.envhidden && !scene.environments.empty())) {
+				state.image[idx] = yocto::lerp(state.image[idx], {radiance.x, radiance.y, radiance.z, 1.0f}, weight);
+				state.hits[idx] += hit ? 1 : 0;
+			} else {
+				state.image[idx] = yocto::lerp(state.image[idx], {0.0f, 0.0f, 0.0f, 0.0f}, weight);
+			}
+		}
+	}
+}
+
+} // namespace voxelpathtracer
@@ -0,0 +1,176 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/GLM.h"
+#include "core/SharedPtr.h"
+#include "core/collection/DynamicArray.h"
+#include "voxel/Region.h"
+#include <glm/mat4x4.hpp>
+#include <yocto_sampling.h>
+
+namespace voxel {
+class RawVolume;
+}
+
+namespace palette {
+class Palette;
+}
+
+namespace scenegraph {
+class SceneGraph;
+class SceneGraphNode;
+} // namespace scenegraph
+
+namespace yocto {
+struct scene_data;
+struct trace_params;
+struct trace_state;
+} // namespace yocto
+
+namespace voxelpathtracer {
+
+/**
+ * @brief Palette material as it is used by the voxel tracer
+ */
+struct VoxelTraceMaterial {
+	glm::vec3 color{1.0f};
+	glm::vec3 emission{0.0f};
+	float metallic = 0.0f;
+	float roughness = 1.0f;
+	float opacity = 1.0f;
+	bool transparent = false;
+};
+
+/**
+ * @brief Occupancy information for a volume on brick granularity. Empty bricks are skipped completely while
+ * traversing the volume.
+ */
+struct VoxelBrickGrid {
+	/** the model node and the generation of its volume identify the grid */
+	int nodeId = -1;
+	uint32_t generation = 0u;
+	/**
+	 * copy of the node volume that is taken whenever the grid is rebuilt - the copy shares the voxels with the node
+	 * volume until the editor modifies it, so the tracing threads never read voxels that are modified concurrently
+	 */
+	core::SharedPtr<voxel::RawVolume> volume;
+	voxel::Region region;
+	/** the amount of bricks in each direction */
+	glm::ivec3 bricks{0};
+	/** one entry per brick - @c 0 for empty bricks */
+	core::DynamicArray<uint8_t> occupied;
+	bool dirty = true;
+
+	void build(const voxel::RawVolume *v);
+	static inline uint64_t key(int nodeId, uint32_t generation) {
+		return ((uint64_t)(uint32_t)nodeId << 32) | generation;
+	}
+	inline uint64_t key() const {
+		return key(nodeId, generation);
+	}
+	inline bool isOccupied(int x, int y, int z) const {
+		return occupied[x + y * bricks.x + z * bricks.x * bricks.y] != 0u;
+	}
+};
+
+/**
+ * @brief A model node (or reference node) in the scene that points to a @c VoxelBrickGrid
+ */
+struct VoxelTraceInstance {
+	int nodeId = -1;
+	int gridIdx = -1;
+	int materialOffset = 0;
+	glm::mat4 worldToVolume{1.0f};
+	glm::mat3 normalMatrix{1.0f};
+	glm::vec3 mins{0.0f};
+	glm::vec3 maxs{0.0f};
+};
+
+struct VoxelTraceHit {
+	float t = 0.0f;
+	/** where the ray leaves the voxel that was hit */
+	float tExit = 0.0f;
+	glm::vec3 normal{0.0f};
+	int instanceIdx = -1;
+	uint8_t colorIndex = 0;
+};
+
+/**
+ * @brief Path tracer that intersects rays directly with the voxel volumes instead of meshing them into triangles.
+ *
+ * There are two levels of acceleration structures: a bounding volume hierarchy over the scene graph model nodes and a
+ * brick occupancy grid for each volume that is traversed with a DDA. Only the brick grids of nodes that were marked
+ * dirty (or whose volume was exchanged) are rebuilt on @c update(). The volumes are snapshotted at that point - the
+ * editor can modify the scene while the tracing threads are running.
+ *
+ * The sampler shares the camera, environment and @c yocto::trace_state with the mesh based path tracer.
+ */
+class VoxelTracer {
+public:
+	static constexpr int BrickSize = 8;
+
+private:
+	struct BVHNode {
+		glm::vec3 mins;
+		glm::vec3 maxs;
+		// either the index of the first child (the second one is always right after the first child) or the index of
+		// the first instance in @c _instanceIndices for leaf nodes
+		int start = 0;
+		// number of instances for leaf nodes - 0 for inner nodes
+		int count = 0;
+	};
+
+	core::DynamicArray<VoxelBrickGrid> _grids;
+	core::DynamicArray<VoxelTraceInstance> _instances;
+	core::DynamicArray<int> _instanceIndices;
+	core::DynamicArray<BVHNode> _bvh;
+	core::DynamicArray<VoxelTraceMaterial> _materials;
+
+	void buildBVH(int nodeIdx, int start, int count);
+	bool intersectInstance(const VoxelTraceInstance &instance, const glm::vec3 &origin, const glm::vec3 &dir,
+						   float tmax, VoxelTraceHit &hit) const;
+	void addMaterials(const palette::Palette &palette);
+
+public:
+	/**
+	 * @brief Collect the visible model nodes of the given scene graph and rebuild the acceleration data of those
+	 * volumes that are new or marked as dirty.
+	 */
+	void update(const scenegraph::SceneGraph &sceneGraph);
+	/**
+	 * @brief Mark the volume of the given node as modified - the brick grid is rebuilt on the next @c update() call.
+	 * @param nodeId The node id or @c -1 to mark all volumes as dirty
+	 */
+	void markDirty(int nodeId);
+	void clear();
+
+	bool intersect(const glm::vec3 &origin, const glm::vec3 &dir, VoxelTraceHit &hit,
+				   float tmax = FLT_MAX) const;
+
+	/**
+	 * @brief Trace one sample for every pixel in the given row range and accumulate the result in the trace state
+	 */
+	void traceRows(yocto::trace_state &state, const yocto::scene_data &scene, const yocto::trace_params &params,
+				   int sample, int rowStart, int rowEnd) const;
+
+	glm::vec3 traceRay(const yocto::scene_data &scene, const yocto::trace_params &params, glm::vec3 origin,
+					   glm::vec3 dir, yocto::rng_state &rng, bool &hitSomething) const;
+
+	/**
+	 * @brief The world space bounds of all instances
+	 */
+	void bounds(glm::vec3 &mins, glm::vec3 &maxs) const;
+
+	int instances() const {
+		return (int)_instances.size();
+	}
+
+	int grids() const {
+		return (int)_grids.size();
+	}
+};
+
+} // namespace voxelpathtracer
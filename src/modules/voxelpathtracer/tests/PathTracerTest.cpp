@@ -3,12 +3,15 @@
  */
 
 #include "voxelpathtracer/PathTracer.h"
+#include "voxelpathtracer/VoxelTracer.h"
 #include "app/App.h"
 #include "app/tests/AbstractTest.h"
 #include "image/Image.h"
 #include "io/FilesystemArchive.h"
 #include "io/FormatDescription.h"
 #include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxel/RawVolume.h"
 #include "voxel/MaterialColor.h"
 #include "voxelformat/FormatConfig.h"
 #include "voxelformat/VolumeFormat.h"
@@ -54,3 +57,118 @@ TEST_F(PathTracerTest, testHMec) {
 	image::writeImage(img, "hmec.vxl.png");
 	ASSERT_TRUE(pathTracer.stop());
 }
+
+TEST_F(PathTracerTest, testHMecVoxelTraversal) {
+	const io::ArchivePtr &archive = io::openFilesystemArchive(_testApp->filesystem());
+	io::FileDescription fileDesc;
+	fileDesc.set("hmec.vxl");
+	scenegraph::SceneGraph sceneGraph;
+	voxelformat::LoadContext testLoadCtx;
+	ASSERT_TRUE(voxelformat::loadFormat(fileDesc, archive, sceneGraph, testLoadCtx))
+		<< "Could not load " << fileDesc.name.c_str();
+
+	voxelpathtracer::PathTracer pathTracer;
+	pathTracer.state().voxelTraversal = true;
+	pathTracer.state().params.resolution = 128;
+	pathTracer.state().params.samples = 4;
+	ASSERT_TRUE(pathTracer.start(sceneGraph));
+	while (!pathTracer.update()) {
+		_testApp->wait(10);
+	}
+	const image::ImagePtr &img = pathTracer.image();
+	ASSERT_TRUE(img);
+	ASSERT_TRUE(img->isLoaded());
+	ASSERT_EQ(128, img->width());
+	image::writeImage(img, "hmec.vxl.voxeltraversal.png");
+	ASSERT_TRUE(pathTracer.stop());
+}
+
+TEST_F(PathTracerTest, testVoxelTracerIntersect) {
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	voxel::RawVolume *volume = new voxel::RawVolume(voxel::Region(0, 31));
+	volume->setVoxel(20, 5, 9, voxel::createVoxel(voxel::VoxelType::Generic, 42));
+	node.setVolume(volume, true);
+	const int nodeId = sceneGraph.emplace(core::move(node));
+	ASSERT_NE(InvalidNodeId, nodeId);
+	sceneGraph.updateTransforms();
+
+	voxelpathtracer::VoxelTracer tracer;
+	tracer.update(sceneGraph);
+	EXPECT_EQ(1, tracer.instances());
+	EXPECT_EQ(1, tracer.grids());
+
+	voxelpathtracer::VoxelTraceHit hit;
+	ASSERT_TRUE(tracer.intersect(glm::vec3(20.5f, 5.5f, -10.0f), glm::vec3(0.0f, 0.0f, 1.0f), hit));
+	EXPECT_FLOAT_EQ(19.0f, hit.t);
+	EXPECT_FLOAT_EQ(20.0f, hit.tExit);
+	EXPECT_EQ(42, hit.colorIndex);
+	EXPECT_FLOAT_EQ(-1.0f, hit.normal.z);
+
+	ASSERT_TRUE(tracer.intersect(glm::vec3(20.5f, 50.0f, 9.5f), glm::vec3(0.0f, -1.0f, 0.0f), hit));
+	EXPECT_FLOAT_EQ(44.0f, hit.t);
+	EXPECT_FLOAT_EQ(1.0f, hit.normal.y);
+
+	EXPECT_FALSE(tracer.intersect(glm::vec3(21.5f, 5.5f, -10.0f), glm::vec3(0.0f, 0.0f, 1.0f), hit));
+
+	// a modified volume is only picked up after the node was marked as dirty
+	volume->setVoxel(21, 5, 3, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	tracer.update(sceneGraph);
+	EXPECT_FALSE(tracer.intersect(glm::vec3(21.5f, 5.5f, -10.0f), glm::vec3(0.0f, 0.0f, 1.0f), hit));
+	tracer.markDirty(nodeId);
+	tracer.update(sceneGraph);
+	ASSERT_TRUE(tracer.intersect(glm::vec3(21.5f, 5.5f, -10.0f), glm::vec3(0.0f, 0.0f, 1.0f), hit));
+	EXPECT_FLOAT_EQ(13.0f, hit.t);
+	EXPECT_EQ(1, hit.colorIndex);
+}
+
+TEST_F(PathTracerTest, testVoxelTracerVolumeSnapshot) {
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	voxel::RawVolume *volume = new voxel::RawVolume(voxel::Region(0, 31));
+	volume->setVoxel(20, 5, 9, voxel::createVoxel(voxel::VoxelType::Generic, 42));
+	node.setVolume(volume, true);
+	const int nodeId = sceneGraph.emplace(core::move(node));
+	ASSERT_NE(InvalidNodeId, nodeId);
+	sceneGraph.updateTransforms();
+
+	voxelpathtracer::VoxelTracer tracer;
+	tracer.update(sceneGraph);
+	// the tracer keeps tracing the state of the volume at the time of the update
+	volume->setVoxel(20, 5, 9, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	voxelpathtracer::VoxelTraceHit hit;
+	ASSERT_TRUE(tracer.intersect(glm::vec3(20.5f, 5.5f, -10.0f), glm::vec3(0.0f, 0.0f, 1.0f), hit));
+	EXPECT_EQ(42, hit.colorIndex);
+
+	tracer.markDirty(nodeId);
+	tracer.update(sceneGraph);
+	ASSERT_TRUE(tracer.intersect(glm::vec3(20.5f, 5.5f, -10.0f), glm::vec3(0.0f, 0.0f, 1.0f), hit));
+	EXPECT_EQ(1, hit.colorIndex);
+}
+
+TEST_F(PathTracerTest, testVoxelTracerExchangeVolume) {
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	voxel::RawVolume *volume = new voxel::RawVolume(voxel::Region(0, 31));
+	volume->setVoxel(20, 5, 9, voxel::createVoxel(voxel::VoxelType::Generic, 42));
+	node.setVolume(volume, true);
+	const int nodeId = sceneGraph.emplace(core::move(node));
+	ASSERT_NE(InvalidNodeId, nodeId);
+	sceneGraph.updateTransforms();
+
+	voxelpathtracer::VoxelTracer tracer;
+	tracer.update(sceneGraph);
+	voxelpathtracer::VoxelTraceHit hit;
+	ASSERT_TRUE(tracer.intersect(glm::vec3(20.5f, 5.5f, -10.0f), glm::vec3(0.0f, 0.0f, 1.0f), hit));
+
+	// a new volume of the same size is picked up without marking the node as dirty - even if the new volume got the
+	// address of the old one
+	voxel::RawVolume *newVolume = new voxel::RawVolume(voxel::Region(0, 31));
+	newVolume->setVoxel(21, 5, 3, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	sceneGraph.node(nodeId).setVolume(newVolume, true);
+	tracer.update(sceneGraph);
+	EXPECT_EQ(1, tracer.grids());
+	EXPECT_FALSE(tracer.intersect(glm::vec3(20.5f, 5.5f, -10.0f), glm::vec3(0.0f, 0.0f, 1.0f), hit));
+	ASSERT_TRUE(tracer.intersect(glm::vec3(21.5f, 5.5f, -10.0f), glm::vec3(0.0f, 0.0f, 1.0f), hit));
+	EXPECT_EQ(1, hit.colorIndex);
+}
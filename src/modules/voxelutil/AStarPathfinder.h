@@ -108,6 +108,10 @@ public:
  * found then this is stored in the list which was set as the 'result' field of
  * the AStarPathfinderParams.
  *
+ * The visited nodes are stored in a flat pool that is indexed by a hash of the
+ * position and the open nodes are kept in a binary heap - no allocation is done
+ * per visited voxel.
+ *
  * @sa AStarPathfinderParams
  */
 template<typename VolumeType>
@@ -127,12 +131,11 @@ private:
 	uint32_t hash(uint32_t a);
 
 	// Node containers
-	AllNodesContainer _allNodes;
+	NodePool _allNodes;
 	OpenNodesContainer _openNodes;
-	ClosedNodesContainer _closedNodes;
 
-	// The current node
-	AllNodesContainer::iterator _current;
+	// The index of the current node
+	uint32_t _current = InvalidNodeIndex;
 
 	float _progress = 0.0f;
 
@@ -152,45 +155,56 @@ bool AStarPathfinder<VolumeType>::execute() {
 	//Clear any existing nodes
 	_allNodes.clear();
 	_openNodes.clear();
-	_closedNodes.clear();
 
 	//Clear the result
 	_params.result->clear();
 
-	//Iterators to start and end node.
-	AllNodesContainer::iterator startNode = _allNodes.insert(Node(_params.start.x, _params.start.y, _params.start.z)).first;
-	AllNodesContainer::iterator endNode = _allNodes.insert(Node(_params.end.x, _params.end.y, _params.end.z)).first;
-
-	//Regarding the const_cast - normally you should not modify an object which is in an std::set.
-	//The reason is that objects in a set are stored sorted in a tree so they can be accessed quickly,
-	//and changing the object directly can break the sorting. However, in our case we have provided a
-	//custom sort operator for the set which we know only uses the position to sort. Hence we can safely
-	//modify other properties of the object while it is in the set.
-	Node* tempStart = const_cast<Node*>(&(*startNode));
-	tempStart->gVal = 0;
-	tempStart->hVal = computeH(startNode->position, endNode->position);
-
-	Node* tempEnd = const_cast<Node*>(&(*endNode));
-	tempEnd->hVal = 0.0f;
+	bool inserted;
+	const uint32_t startNode = _allNodes.findOrInsert(_params.start, inserted);
+	const uint32_t endNode = _allNodes.findOrInsert(_params.end, inserted);
 
-	_openNodes.insert(startNode);
+	Node& start = _allNodes[startNode];
+	start.gVal = 0.0f;
+	start.hVal = computeH(_params.start, _params.end);
+	start.state = Node::Open;
+	_openNodes.insert(start.f(), startNode);
 
-	float fDistStartToEnd = glm::length(glm::vec3(endNode->position) - glm::vec3(startNode->position));
+	float fDistStartToEnd = glm::length(glm::vec3(_params.end) - glm::vec3(_params.start));
 	_progress = 0.0f;
 	if (_params.progressCallback) {
 		_params.progressCallback(_progress);
 	}
 
-	while (!_openNodes.empty() && _openNodes.getFirst() != endNode) {
+	//The distance from one cell to another connected by face, edge, or corner.
+	const float fFaceCost = 1.0f;
+	const float fEdgeCost = glm::root_two<float>();
+	const float fCornerCost = glm::root_three<float>();
+
+	bool found = false;
+	while (!_openNodes.empty()) {
+		const OpenNodesContainer::Entry entry = _openNodes.getFirst();
+		const Node& first = _allNodes[entry.node];
+		if (first.state != Node::Open || entry.f != first.f()) {
+			//The node was already closed or reached with a cheaper path after this entry was added.
+			_openNodes.removeFirst();
+			continue;
+		}
+		if (entry.node == endNode) {
+			found = true;
+			break;
+		}
+
 		//Move the first node from open to closed.
-		_current = _openNodes.getFirst();
+		_current = entry.node;
 		_openNodes.removeFirst();
-		_closedNodes.insert(_current);
+		_allNodes[_current].state = Node::Closed;
+		const glm::ivec3 currentPos = _allNodes[_current].position;
+		const float currentGVal = _allNodes[_current].gVal;
 
 		//Update the user on our progress
 		if (_params.progressCallback) {
 			const float fMinProgresIncreament = 0.001f;
-			float fDistCurrentToEnd = glm::length(glm::vec3(endNode->position) - glm::vec3(_current->position));
+			float fDistCurrentToEnd = glm::length(glm::vec3(_params.end) - glm::vec3(currentPos));
 			float fDistNormalised = fDistCurrentToEnd / fDistStartToEnd;
 			float fProgress = 1.0f - fDistNormalised;
 			if (fProgress >= _progress + fMinProgresIncreament) {
@@ -199,47 +213,25 @@ bool AStarPathfinder<VolumeType>::execute() {
 			}
 		}
 
-		//The distance from one cell to another connected by face, edge, or corner.
-		const float fFaceCost = 1.0f;
-		const float fEdgeCost = glm::root_two<float>();
-		const float fCornerCost = glm::root_three<float>();
-
 		//Process the neighbours. Note the deliberate lack of 'break'
 		//statements, larger connectivities include smaller ones.
 		switch (_params.connectivity) {
 		case voxel::Connectivity::TwentySixConnected:
-			processNeighbour(_current->position + voxel::arrayPathfinderCorners[0], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderCorners[1], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderCorners[2], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderCorners[3], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderCorners[4], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderCorners[5], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderCorners[6], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderCorners[7], _current->gVal + fCornerCost);
+			for (const glm::ivec3& offset : voxel::arrayPathfinderCorners) {
+				processNeighbour(currentPos + offset, currentGVal + fCornerCost);
+			}
 			/* fallthrough */
 
 		case voxel::Connectivity::EighteenConnected:
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[0], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[1], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[2], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[3], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[4], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[5], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[6], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[7], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[8], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[9], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[10], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderEdges[11], _current->gVal + fEdgeCost);
+			for (const glm::ivec3& offset : voxel::arrayPathfinderEdges) {
+				processNeighbour(currentPos + offset, currentGVal + fEdgeCost);
+			}
 			/* fallthrough */
 
 		case voxel::Connectivity::SixConnected:
-			processNeighbour(_current->position + voxel::arrayPathfinderFaces[0], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderFaces[1], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderFaces[2], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderFaces[3], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderFaces[4], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + voxel::arrayPathfinderFaces[5], _current->gVal + fFaceCost);
+			for (const glm::ivec3& offset : voxel::arrayPathfinderFaces) {
+				processNeighbour(currentPos + offset, currentGVal + fFaceCost);
+			}
 			break;
 		}
 
@@ -249,19 +241,12 @@ bool AStarPathfinder<VolumeType>::execute() {
 		}
 	}
 
-	if (_openNodes.empty() || _openNodes.getFirst() != endNode) {
+	if (!found) {
 		Log::debug("We've failed to find a valid path.");
 		return false;
 	}
-	//Regarding the const_cast - normally you should not modify an object which is in an std::set.
-	//The reason is that objects in a set are stored sorted in a tree so they can be accessed quickly,
-	//and changing the object directly can break the sorting. However, in our case we have provided a
-	//custom sort operator for the set which we know only uses the position to sort. Hence we can safely
-	//modify other properties of the object while it is in the set.
-	Node* n = const_cast<Node*>(&(*endNode));
-	while (n != 0) {
-		_params.result->insert_front(n->position);
-		n = n->parent;
+	for (uint32_t n = endNode; n != InvalidNodeIndex; n = _allNodes[n].parent) {
+		_params.result->insert_front(_allNodes[n].position);
 	}
 
 	if (_params.progressCallback) {
@@ -280,44 +265,23 @@ void AStarPathfinder<VolumeType>::processNeighbour(const glm::ivec3& neighbourPo
 
 	float cost = neighbourGVal;
 
-	std::pair<AllNodesContainer::iterator, bool> insertResult = _allNodes.insert(Node(neighbourPos.x, neighbourPos.y, neighbourPos.z));
-	AllNodesContainer::iterator neighbour = insertResult.first;
+	bool inserted;
+	const uint32_t neighbourIndex = _allNodes.findOrInsert(neighbourPos, inserted);
+	Node& neighbour = _allNodes[neighbourIndex];
 
-	if (insertResult.second) {
+	if (inserted) {
 		//New node, compute h.
-		Node* tempNeighbour = const_cast<Node*>(&(*neighbour));
-		tempNeighbour->hVal = computeH(neighbour->position, _params.end);
-	}
-
-	OpenNodesContainer::iterator openIter = _openNodes.find(neighbour);
-	if (openIter != _openNodes.end()) {
-		if (cost < neighbour->gVal) {
-			_openNodes.remove(openIter);
-			openIter = _openNodes.end();
-		}
+		neighbour.hVal = computeH(neighbourPos, _params.end);
 	}
 
-	//TODO - Nodes could keep track of if they are in open or closed? And a pointer to where they are?
-	ClosedNodesContainer::iterator closedIter = _closedNodes.find(neighbour);
-	if (closedIter != _closedNodes.end()) {
-		if (cost < neighbour->gVal) {
-			//Probably shouldn't happen?
-			_closedNodes.remove(closedIter);
-			closedIter = _closedNodes.end();
-		}
-	}
-
-	if (openIter == _openNodes.end() && closedIter == _closedNodes.end()) {
-		//Regarding the const_cast - normally you should not modify an object which is in an std::set.
-		//The reason is that objects in a set are stored sorted in a tree so they can be accessed quickly,
-		//and changing the object directly can break the sorting. However, in our case we have provided a
-		//custom sort operator for the set which we know only uses the position to sort. Hence we can safely
-		//modify other properties of the object while it is in the set.
-		Node* temp = const_cast<Node*>(&(*neighbour));
-		temp->gVal = cost;
-		_openNodes.insert(neighbour);
-		temp->parent = const_cast<Node*>(&(*_current));
+	//Open and closed nodes are only updated (and opened again) if this path to them is cheaper.
+	if (neighbour.state != Node::Unvisited && cost >= neighbour.gVal) {
+		return;
 	}
+	neighbour.gVal = cost;
+	neighbour.parent = _current;
+	neighbour.state = Node::Open;
+	_openNodes.insert(neighbour.f(), neighbourIndex);
 }
 
 template<typename VolumeType>
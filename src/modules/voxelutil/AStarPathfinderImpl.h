@@ -5,148 +5,166 @@
 #pragma once
 
 #include "core/Common.h"
+#include "core/collection/Buffer.h"
 #include <glm/vec3.hpp>
 #include <algorithm>
-#include <limits> //For numeric_limits
-#include <set>
-#include <vector>
+#include <stdint.h>
 
 namespace voxelutil {
 
-class OpenNodesContainer;
-class ClosedNodesContainer;
+static constexpr uint32_t InvalidNodeIndex = UINT32_MAX;
 
 struct Node {
-	Node(int x, int y, int z) :
-			// Initialise with NaNs so that we will know if we forget to set these properly.
-			gVal(std::numeric_limits<float>::quiet_NaN()), hVal(std::numeric_limits<float>::quiet_NaN()), parent(nullptr) {
-		position = {x, y, z};
-	}
-
-	bool operator==(const Node& rhs) const {
-		return position == rhs.position;
-	}
-
-	bool operator<(const Node& rhs) const {
-		if (position.x < rhs.position.x)
-			return true;
-		if (rhs.position.x < position.x)
-			return false;
-
-		if (position.y < rhs.position.y)
-			return true;
-		if (rhs.position.y < position.y)
-			return false;
-
-		if (position.z < rhs.position.z)
-			return true;
-		if (rhs.position.z < position.z)
-			return false;
-
-		return false;
-	}
+	enum State : uint8_t { Unvisited, Open, Closed };
 
 	glm::ivec3 position;
 	float gVal;
 	float hVal;
-	Node* parent;
+	/** index of the parent node in the @c NodePool */
+	uint32_t parent;
+	State state;
 
 	inline float f() const {
 		return gVal + hVal;
 	}
 };
 
-typedef std::set<Node> AllNodesContainer;
-
-class AllNodesContainerIteratorComparator {
-public:
-	bool operator()(const AllNodesContainer::iterator& lhs, const AllNodesContainer::iterator& rhs) const {
-		return (&(*lhs)) < (&(*rhs));
-	}
-};
-
-class NodeSort {
-public:
-	bool operator()(const AllNodesContainer::iterator& lhs, const AllNodesContainer::iterator& rhs) const {
-		return lhs->f() > rhs->f();
-	}
-};
-
-class OpenNodesContainer {
-public:
-	typedef std::vector<AllNodesContainer::iterator>::iterator iterator;
-
-public:
-	inline void clear() {
-		open.clear();
-	}
-
-	inline bool empty() const {
-		return open.empty();
-	}
-
-	void insert(AllNodesContainer::iterator node) {
-		open.push_back(node);
-		std::push_heap(open.begin(), open.end(), NodeSort());
-	}
-
-	inline AllNodesContainer::iterator getFirst() {
-		return open[0];
-	}
+/**
+ * @brief Stores all nodes of a search in one flat array. The nodes are found by their position with an open
+ * addressing hash table that only stores the indices into the node array.
+ */
+class NodePool {
+private:
+	core::Buffer<Node> _nodes;
+	core::Buffer<uint32_t> _table;
+	uint32_t _mask = 0u;
 
-	void removeFirst() {
-		std::pop_heap(open.begin(), open.end(), NodeSort());
-		open.pop_back();
+	static inline uint32_t hash(const glm::ivec3 &pos) {
+		uint32_t h = (uint32_t)pos.x * 73856093u;
+		h ^= (uint32_t)pos.y * 19349663u;
+		h ^= (uint32_t)pos.z * 83492791u;
+		return h ^ (h >> 16);
 	}
 
-	void remove(iterator iterToRemove) {
-		open.erase(iterToRemove);
-		std::make_heap(open.begin(), open.end(), NodeSort());
+	void insertIndex(uint32_t nodeIndex) {
+		uint32_t slot = hash(_nodes[nodeIndex].position) & _mask;
+		while (_table[slot] != InvalidNodeIndex) {
+			slot = (slot + 1u) & _mask;
+		}
+		_table[slot] = nodeIndex;
 	}
 
-	inline iterator begin() {
-		return open.begin();
+	void rehash(uint32_t tableSize) {
+		_table.resizeIfNeeded(tableSize);
+		_table.fill(InvalidNodeIndex);
+		_mask = tableSize - 1u;
+		for (uint32_t i = 0u; i < (uint32_t)_nodes.size(); ++i) {
+			insertIndex(i);
+		}
 	}
 
-	inline iterator end() {
-		return open.end();
+public:
+	void clear() {
+		_nodes.clear();
+		rehash(1024u);
+	}
+
+	inline uint32_t size() const {
+		return (uint32_t)_nodes.size();
+	}
+
+	inline Node &operator[](uint32_t nodeIndex) {
+		return _nodes[nodeIndex];
+	}
+
+	inline const Node &operator[](uint32_t nodeIndex) const {
+		return _nodes[nodeIndex];
+	}
+
+	/**
+	 * @return The index of the node at the given position. If the node didn't exist yet, it is created in the
+	 * @c Node::Unvisited state and @c inserted is set to @c true.
+	 */
+	uint32_t findOrInsert(const glm::ivec3 &pos, bool &inserted) {
+		uint32_t slot = hash(pos) & _mask;
+		for (;;) {
+			const uint32_t nodeIndex = _table[slot];
+			if (nodeIndex == InvalidNodeIndex) {
+				break;
+			}
+			if (_nodes[nodeIndex].position == pos) {
+				inserted = false;
+				return nodeIndex;
+			}
+			slot = (slot + 1u) & _mask;
+		}
+		inserted = true;
+		const uint32_t nodeIndex = size();
+		if (_nodes.size() == _nodes.capacity()) {
+			// the buffer only grows linearly on its own
+			_nodes.reserve(core_max((size_t)1024u, _nodes.capacity() * 2u));
+		}
+		_nodes.push_back(Node{pos, 0.0f, 0.0f, InvalidNodeIndex, Node::Unvisited});
+		// keep the load factor below 50%
+		if (size() * 2u > _mask + 1u) {
+			rehash((_mask + 1u) * 2u);
+		} else {
+			_table[slot] = nodeIndex;
+		}
+		return nodeIndex;
 	}
+};
 
-	iterator find(AllNodesContainer::iterator node) {
-		return std::find(open.begin(), open.end(), node);
-	}
+/**
+ * @brief Binary heap of the open nodes with the lowest f() value on top
+ *
+ * Nodes that got a cheaper path are pushed again instead of being searched and removed - the outdated entries are
+ * skipped by the pathfinder when they reach the top.
+ */
+class OpenNodesContainer {
+public:
+	struct Entry {
+		float f;
+		uint32_t node;
+	};
 
 private:
-	std::vector<AllNodesContainer::iterator> open;
-};
+	core::Buffer<Entry> _heap;
 
-class ClosedNodesContainer {
-public:
-	typedef std::set<AllNodesContainer::iterator, AllNodesContainerIteratorComparator>::iterator iterator;
+	struct EntrySort {
+		inline bool operator()(const Entry &lhs, const Entry &rhs) const {
+			if (lhs.f != rhs.f) {
+				return lhs.f > rhs.f;
+			}
+			return lhs.node > rhs.node;
+		}
+	};
 
 public:
 	inline void clear() {
-		closed.clear();
+		_heap.clear();
 	}
 
-	inline void insert(AllNodesContainer::iterator node) {
-		closed.insert(node);
+	inline bool empty() const {
+		return _heap.empty();
 	}
 
-	inline void remove(iterator iterToRemove) {
-		closed.erase(iterToRemove);
+	void insert(float f, uint32_t node) {
+		if (_heap.size() == _heap.capacity()) {
+			_heap.reserve(core_max((size_t)1024u, _heap.capacity() * 2u));
+		}
+		_heap.push_back(Entry{f, node});
+		std::push_heap(_heap.data(), _heap.data() + _heap.size(), EntrySort());
 	}
 
-	inline iterator end() {
-		return closed.end();
+	inline const Entry &getFirst() const {
+		return _heap[0];
 	}
 
-	inline iterator find(AllNodesContainer::iterator node) {
-		return closed.find(node);
+	void removeFirst() {
+		std::pop_heap(_heap.data(), _heap.data() + _heap.size(), EntrySort());
+		_heap.pop();
 	}
-
-private:
-	std::set<AllNodesContainer::iterator, AllNodesContainerIteratorComparator> closed;
 };
 
-}
+} // namespace voxelutil
@@ -3,11 +3,16 @@
  */
 
 #include "ImageUtils.h"
+#include "app/Async.h"
 #include "core/Assert.h"
 #include "core/Color.h"
 #include "core/GLM.h"
 #include "core/Log.h"
+#include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
+#include "core/Trace.h"
+#include "core/collection/Buffer.h"
+#include "core/collection/DynamicArray.h"
 #include "image/Image.h"
 #include "palette/Palette.h"
 #include "palette/PaletteLookup.h"
@@ -77,16 +82,16 @@ int importHeightMaxHeight(const image::ImagePtr &image, bool alphaAsHeight) {
 	int maxHeight = 0;
 	int minHeight = 255;
 	if (alphaAsHeight) {
-		for (int x = 0; x < w; ++x) {
-			for (int y = 0; y < h; ++y) {
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x) {
 				const uint8_t alphaVal = image->colorAt(x, y).a;
 				maxHeight = core_max(maxHeight, alphaVal);
 				minHeight = core_min(minHeight, alphaVal);
 			}
 		}
 	} else {
-		for (int x = 0; x < w; ++x) {
-			for (int y = 0; y < h; ++y) {
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x) {
 				const uint8_t redVal = image->colorAt(x, y).r;
 				maxHeight = core_max(maxHeight, redVal);
 				minHeight = core_min(minHeight, redVal);
@@ -99,9 +104,21 @@ int importHeightMaxHeight(const image::ImagePtr &image, bool alphaAsHeight) {
 	return maxHeight;
 }
 
-void importColoredHeightmap(voxel::RawVolumeWrapper &volume, palette::PaletteLookup &palLookup,
-							const image::ImagePtr &image, const voxel::Voxel &underground, uint8_t minHeight,
-							bool adoptHeight) {
+/**
+ * @brief Writes the columns of a heightmap into the volume
+ *
+ * The rows of the volume are imported in parallel - every thread quantizes the colors of its rows with its own
+ * palette lookup and fills the columns with a sampler instead of computing the position of every voxel.
+ *
+ * @param palette If this is not @c null the surface voxel gets the closest palette color of the rgb values of the
+ * pixel - otherwise @c surface is used
+ * @param alphaAsHeight Use the alpha channel as height - otherwise the red channel
+ */
+static void importHeightmapColumns(voxel::RawVolumeWrapper &volume, const image::ImagePtr &image,
+								   const voxel::Voxel &underground, const voxel::Voxel &surface,
+								   const palette::Palette *palette, uint8_t minHeight, float scaleHeight,
+								   bool alphaAsHeight) {
+	core_trace_scoped(ImportHeightmap);
 	const int imageWidth = image->width();
 	const int imageHeight = image->height();
 	const voxel::Region &region = volume.region();
@@ -111,99 +128,87 @@ void importColoredHeightmap(voxel::RawVolumeWrapper &volume, palette::PaletteLoo
 	const glm::ivec3 &mins = region.getLowerCorner();
 	const float stepWidthY = (float)imageHeight / (float)volumeDepth;
 	const float stepWidthX = (float)imageWidth / (float)volumeWidth;
-	const float scaleHeight = adoptHeight ? (float)volumeHeight / (float)255.0f : 1.0f;
+	Log::debug("stepwidth: %f %f", stepWidthX, stepWidthY);
+
+	// the image positions are accumulated to sample exactly the same pixels for every row
+	core::Buffer<int> imageXs;
+	imageXs.resize(volumeWidth);
+	float imageX = 0.0f;
+	for (int x = 0; x < volumeWidth; ++x, imageX += stepWidthX) {
+		imageXs[x] = (int)imageX;
+	}
+	core::Buffer<int> imageYs;
+	imageYs.resize(volumeDepth);
 	float imageY = 0.0f;
 	for (int z = 0; z < volumeDepth; ++z, imageY += stepWidthY) {
-		float imageX = 0.0f;
-		for (int x = 0; x < volumeWidth; ++x, imageX += stepWidthX) {
-			const core::RGBA heightmapPixel = image->colorAt((int)imageX, (int)imageY);
-			uint8_t heightValue = (uint8_t)(glm::round((float)(heightmapPixel.a) * scaleHeight));
-			if (heightValue < minHeight) {
-				heightValue = minHeight;
-			}
+		imageYs[z] = (int)imageY;
+	}
 
-			if (voxel::isAir(underground.getMaterial())) {
-				const glm::ivec3 pos(x, heightValue - 1, z);
-				const glm::ivec3 regionPos = mins + pos;
-				if (!region.containsPoint(regionPos)) {
+	const bool surfaceOnly = voxel::isAir(underground.getMaterial());
+	voxel::RawVolume *v = volume.volume();
+	v->detach();
+	core::DynamicArray<voxel::Region> dirtyRows;
+	dirtyRows.resize(volumeDepth);
+	app::for_parallel(0, volumeDepth, [&](int start, int end) {
+		core::ScopedPtr<palette::PaletteLookup> palLookup(palette ? new palette::PaletteLookup(*palette, 4096) : nullptr);
+		voxel::RawVolume::Sampler sampler(v);
+		for (int z = start; z < end; ++z) {
+			voxel::Region dirty = voxel::Region::InvalidRegion;
+			for (int x = 0; x < volumeWidth; ++x) {
+				const core::RGBA heightmapPixel = image->colorAt(imageXs[x], imageYs[z]);
+				const uint8_t channel = alphaAsHeight ? heightmapPixel.a : heightmapPixel.r;
+				uint8_t heightValue = (uint8_t)(glm::round((float)channel * scaleHeight));
+				if (heightValue < minHeight) {
+					heightValue = minHeight;
+				}
+				const int surfaceY = heightValue - 1;
+				const int lowerY = surfaceOnly ? surfaceY : 0;
+				const int upperY = core_min(surfaceY, volumeHeight - 1);
+				if (lowerY < 0 || lowerY > upperY) {
 					continue;
 				}
-				const uint8_t palidx =
-					palLookup.findClosestIndex(core::RGBA(heightmapPixel.r, heightmapPixel.g, heightmapPixel.b));
-				const voxel::Voxel voxel = voxel::createVoxel(palLookup.palette(), palidx);
-				volume.setVoxel(regionPos, voxel);
-			} else {
-				for (int y = 0; y < heightValue; ++y) {
-					const glm::ivec3 pos(x, y, z);
-					const glm::ivec3 regionPos = mins + pos;
-					if (!region.containsPoint(regionPos)) {
-						continue;
-					}
-					voxel::Voxel voxel;
-					if (y < heightValue - 1) {
-						voxel = underground;
-					} else {
-						const uint8_t palidx = palLookup.findClosestIndex(
-							core::RGBA(heightmapPixel.r, heightmapPixel.g, heightmapPixel.b));
-						voxel = voxel::createVoxel(palLookup.palette(), palidx);
-					}
-					volume.setVoxel(regionPos, voxel);
+				voxel::Voxel top = surface;
+				if (palLookup) {
+					const uint8_t palidx = palLookup->findClosestIndex(
+						core::RGBA(heightmapPixel.r, heightmapPixel.g, heightmapPixel.b));
+					top = voxel::createVoxel(palLookup->palette(), palidx);
+				}
+				const glm::ivec3 lower(mins.x + x, mins.y + lowerY, mins.z + z);
+				sampler.setPosition(lower);
+				for (int y = lowerY; y <= upperY; ++y) {
+					sampler.setVoxel(y == surfaceY ? top : underground);
+					sampler.movePositiveY();
+				}
+				const voxel::Region column(lower, glm::ivec3(lower.x, mins.y + upperY, lower.z));
+				if (dirty.isValid()) {
+					dirty.accumulate(column);
+				} else {
+					dirty = column;
 				}
 			}
+			dirtyRows[z] = dirty;
 		}
+	});
+	for (const voxel::Region &dirty : dirtyRows) {
+		volume.addDirtyRegion(dirty);
 	}
 }
 
+void importColoredHeightmap(voxel::RawVolumeWrapper &volume, palette::PaletteLookup &palLookup,
+							const image::ImagePtr &image, const voxel::Voxel &underground, uint8_t minHeight,
+							bool adoptHeight) {
+	const int volumeHeight = volume.region().getHeightInVoxels();
+	const float scaleHeight = adoptHeight ? (float)volumeHeight / (float)255.0f : 1.0f;
+	importHeightmapColumns(volume, image, underground, voxel::Voxel(), &palLookup.palette(), minHeight, scaleHeight,
+						   true);
+}
+
 void importHeightmap(voxel::RawVolumeWrapper &volume, const image::ImagePtr &image, const voxel::Voxel &underground,
 					 const voxel::Voxel &surface, uint8_t minHeight, bool adoptHeight) {
-	const int imageWidth = image->width();
-	const int imageHeight = image->height();
-	const voxel::Region &region = volume.region();
-	const int volumeHeight = region.getHeightInVoxels();
-	const int volumeWidth = region.getWidthInVoxels();
-	const int volumeDepth = region.getDepthInVoxels();
-	const glm::ivec3 &mins = region.getLowerCorner();
-	const float stepWidthY = (float)imageHeight / (float)volumeDepth;
-	const float stepWidthX = (float)imageWidth / (float)volumeWidth;
-	Log::debug("stepwidth: %f %f", stepWidthX, stepWidthY);
+	const int volumeHeight = volume.region().getHeightInVoxels();
 	const int maxImageHeight = importHeightMaxHeight(image, true);
 	const float scaleHeight = adoptHeight ? (float)volumeHeight / (float)maxImageHeight : 1.0f;
-	float imageY = 0.0f;
-	// TODO: use a volume sampler
-	for (int z = 0; z < volumeDepth; ++z, imageY += stepWidthY) {
-		float imageX = 0.0f;
-		for (int x = 0; x < volumeWidth; ++x, imageX += stepWidthX) {
-			const core::RGBA heightmapPixel = image->colorAt((int)imageX, (int)imageY);
-			uint8_t heightValue = (uint8_t)(glm::round((float)(heightmapPixel.r) * scaleHeight));
-			if (heightValue < minHeight) {
-				heightValue = minHeight;
-			}
-
-			if (voxel::isAir(underground.getMaterial())) {
-				const glm::ivec3 pos(x, heightValue - 1, z);
-				const glm::ivec3 regionPos = mins + pos;
-				if (!region.containsPoint(regionPos)) {
-					continue;
-				}
-				volume.setVoxel(regionPos, surface);
-			} else {
-				for (int y = 0; y < heightValue; ++y) {
-					const glm::ivec3 pos(x, y, z);
-					const glm::ivec3 regionPos = mins + pos;
-					if (!region.containsPoint(regionPos)) {
-						continue;
-					}
-					voxel::Voxel voxel;
-					if (y < heightValue - 1) {
-						voxel = underground;
-					} else {
-						voxel = surface;
-					}
-					volume.setVoxel(regionPos, voxel);
-				}
-			}
-		}
-	}
+	importHeightmapColumns(volume, image, underground, surface, nullptr, minHeight, scaleHeight, false);
 }
 
 voxel::RawVolume *importAsPlane(const image::ImagePtr &image, uint8_t thickness) {
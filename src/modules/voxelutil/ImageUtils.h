@@ -23,8 +23,14 @@ namespace voxelutil {
 
 /**
  * @brief Import a heightmap with rgb being the surface color and alpha channel being the height
+ * @note The rows are imported in parallel and the voxels are written directly into the wrapped volume - the dirty
+ * region of the wrapper is updated, but an overridden @c RawVolumeWrapper::setVoxel() is not called
  */
 void importColoredHeightmap(voxel::RawVolumeWrapper& volume, palette::PaletteLookup &palLookup, const image::ImagePtr& image, const voxel::Voxel &underground, uint8_t minHeight = 0, bool adoptHeight = true);
+/**
+ * @brief Import a grayscale heightmap with the red channel being the height
+ * @note The rows are imported in parallel - see importColoredHeightmap()
+ */
 void importHeightmap(voxel::RawVolumeWrapper& volume, const image::ImagePtr& image, const voxel::Voxel &underground, const voxel::Voxel &surface, uint8_t minHeight = 0, bool adoptHeight = true);
 /**
  * @param alphaAsHeight If this is @c true, the rgb color is used for the colors - otherwise the red channel is used
@@ -0,0 +1,135 @@
+/**
+ * @file
+ */
+
+#include "VolumeCropper.h"
+#include "app/Async.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+
+namespace voxelutil {
+
+/**
+ * @brief Searches the non-air voxels of the slices @c [zStart, zEnd) of the given region
+ */
+static voxel::Region calculateUsedRegion(const voxel::RawVolume &volume, const voxel::Region &region, int32_t zStart,
+										 int32_t zEnd) {
+	const voxel::Region &volumeRegion = volume.region();
+	const glm::ivec3 &volumeMins = volumeRegion.getLowerCorner();
+	const int64_t width = volumeRegion.getWidthInVoxels();
+	const int64_t sliceSize = width * volumeRegion.getHeightInVoxels();
+	const voxel::Voxel *data = (const voxel::Voxel *)volume.data();
+	const int32_t lowerX = region.getLowerX();
+	const int32_t upperX = region.getUpperX();
+	glm::ivec3 mins((std::numeric_limits<int>::max)());
+	glm::ivec3 maxs((std::numeric_limits<int>::min)());
+	for (int32_t z = zStart; z < zEnd; ++z) {
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			const voxel::Voxel *row =
+				data + (z - volumeMins.z) * sliceSize + (y - volumeMins.y) * width - volumeMins.x;
+			int32_t first = lowerX;
+			while (first <= upperX && voxel::isAir(row[first].getMaterial())) {
+				++first;
+			}
+			if (first > upperX) {
+				continue;
+			}
+			int32_t last = upperX;
+			while (last > first && voxel::isAir(row[last].getMaterial())) {
+				--last;
+			}
+			mins = glm::min(mins, glm::ivec3(first, y, z));
+			maxs = glm::max(maxs, glm::ivec3(last, y, z));
+		}
+	}
+	if (mins.x > maxs.x) {
+		return voxel::Region::InvalidRegion;
+	}
+	return voxel::Region(mins, maxs);
+}
+
+voxel::Region calculateUsedRegion(const voxel::RawVolume &volume, const voxel::Region &region, bool parallel) {
+	core_trace_scoped(CalculateUsedRegion);
+	voxel::Region cropped = region;
+	if (!cropped.cropTo(volume.region())) {
+		return voxel::Region::InvalidRegion;
+	}
+	if (!parallel) {
+		return calculateUsedRegion(volume, cropped, cropped.getLowerZ(), cropped.getUpperZ() + 1);
+	}
+	const int32_t lowerZ = cropped.getLowerZ();
+	core::DynamicArray<voxel::Region> slices;
+	slices.resize(cropped.getDepthInVoxels());
+	app::for_parallel(lowerZ, cropped.getUpperZ() + 1, [&](int start, int end) {
+		for (int z = start; z < end; ++z) {
+			slices[z - lowerZ] = calculateUsedRegion(volume, cropped, z, z + 1);
+		}
+	});
+	voxel::Region used = voxel::Region::InvalidRegion;
+	for (const voxel::Region &slice : slices) {
+		if (!slice.isValid()) {
+			continue;
+		}
+		if (used.isValid()) {
+			used.accumulate(slice);
+		} else {
+			used = slice;
+		}
+	}
+	return used;
+}
+
+voxel::RawVolume *copyRegion(const voxel::RawVolume &volume, const voxel::Region &region, bool parallel) {
+	core_trace_scoped(CopyRegion);
+	if (!region.isValid()) {
+		return nullptr;
+	}
+	const size_t size = voxel::RawVolume::size(region);
+	voxel::Voxel *dest = (voxel::Voxel *)core_malloc(size);
+	voxel::Region cropped = region;
+	if (!cropped.cropTo(volume.region())) {
+		core_memset(dest, 0, size);
+		return voxel::RawVolume::createRaw(dest, region);
+	}
+	if (cropped != region) {
+		// the parts outside of the source volume stay empty
+		core_memset(dest, 0, size);
+	}
+
+	const voxel::Region &volumeRegion = volume.region();
+	const glm::ivec3 &volumeMins = volumeRegion.getLowerCorner();
+	const int64_t srcWidth = volumeRegion.getWidthInVoxels();
+	const int64_t srcSliceSize = srcWidth * volumeRegion.getHeightInVoxels();
+	const voxel::Voxel *src = (const voxel::Voxel *)volume.data();
+	const glm::ivec3 &destMins = region.getLowerCorner();
+	const int64_t destWidth = region.getWidthInVoxels();
+	const int64_t destSliceSize = destWidth * region.getHeightInVoxels();
+	// the memory of a new volume is cleared to zero - air voxels are not copied
+	const voxel::Voxel emptyVoxel(voxel::VoxelType::Air, 0, 0, 0);
+	const int32_t lowerX = cropped.getLowerX();
+	const int32_t upperX = cropped.getUpperX();
+
+	auto copySlices = [&](int start, int end) {
+		for (int32_t z = start; z < end; ++z) {
+			for (int32_t y = cropped.getLowerY(); y <= cropped.getUpperY(); ++y) {
+				const voxel::Voxel *srcRow =
+					src + (z - volumeMins.z) * srcSliceSize + (y - volumeMins.y) * srcWidth - volumeMins.x;
+				voxel::Voxel *destRow =
+					dest + (z - destMins.z) * destSliceSize + (y - destMins.y) * destWidth - destMins.x;
+				for (int32_t x = lowerX; x <= upperX; ++x) {
+					const voxel::Voxel &voxel = srcRow[x];
+					destRow[x] = voxel::isAir(voxel.getMaterial()) ? emptyVoxel : voxel;
+				}
+			}
+		}
+	};
+	if (parallel) {
+		app::for_parallel(cropped.getLowerZ(), cropped.getUpperZ() + 1, copySlices);
+	} else {
+		copySlices(cropped.getLowerZ(), cropped.getUpperZ() + 1);
+	}
+	return voxel::RawVolume::createRaw(dest, region);
+}
+
+} // namespace voxelutil
@@ -20,6 +20,21 @@ struct CropSkipEmpty {
 	}
 };
 
+/**
+ * @brief Calculates the smallest region inside the given region that contains all non-air voxels of the volume
+ * @param parallel The slices are searched in parallel - use @c false if the caller already runs in parallel
+ * @return @c voxel::Region::InvalidRegion if there are only air voxels in the region
+ */
+voxel::Region calculateUsedRegion(const voxel::RawVolume &volume, const voxel::Region &region, bool parallel = true);
+
+/**
+ * @brief Creates a new volume for the given region with the voxels of the source volume. Air voxels are not copied
+ * and the parts of the region that are outside of the source volume stay empty.
+ * @param parallel The slices are copied in parallel - use @c false if the caller already runs in parallel
+ */
+[[nodiscard]] voxel::RawVolume *copyRegion(const voxel::RawVolume &volume, const voxel::Region &region,
+										   bool parallel = true);
+
 /**
  * @brief Resizes a volume to cut off empty parts
  */
@@ -30,9 +45,7 @@ template<class CropSkipCondition = CropSkipEmpty>
 	if (!newRegion.isValid()) {
 		return nullptr;
 	}
-	voxel::RawVolume* newVolume = new voxel::RawVolume(newRegion);
-	voxelutil::mergeVolumes(newVolume, volume, newRegion, voxel::Region(mins, maxs));
-	return newVolume;
+	return copyRegion(*volume, newRegion);
 }
 
 /**
@@ -44,22 +57,10 @@ template<class CropSkipCondition = CropSkipEmpty>
 		return nullptr;
 	}
 	core_trace_scoped(CropRawVolume);
-	glm::ivec3 newMins((std::numeric_limits<int>::max)() / 2);
-	glm::ivec3 newMaxs((std::numeric_limits<int>::min)() / 2);
-	if (visitVolume(
-			*volume,
-			[&newMins, &newMaxs](int x, int y, int z, const voxel::Voxel &) {
-				newMins.x = core_min(newMins.x, x);
-				newMins.y = core_min(newMins.y, y);
-				newMins.z = core_min(newMins.z, z);
-
-				newMaxs.x = core_max(newMaxs.x, x);
-				newMaxs.y = core_max(newMaxs.y, y);
-				newMaxs.z = core_max(newMaxs.z, z);
-			},
-			SkipEmpty()) == 0) {
+	const voxel::Region &usedRegion = calculateUsedRegion(*volume, volume->region());
+	if (!usedRegion.isValid()) {
 		return nullptr;
 	}
-	return cropVolume(volume, newMins, newMaxs);
+	return copyRegion(*volume, usedRegion);
 }
 }
@@ -0,0 +1,136 @@
+/**
+ * @file
+ */
+
+#include "VolumeImporter.h"
+#include "app/Async.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+
+namespace voxelutil {
+
+bool GridLayout::isValid() const {
+	if (size.x <= 0 || size.y <= 0 || size.z <= 0) {
+		return false;
+	}
+	bool used[3]{false, false, false};
+	for (int i = 0; i < 3; ++i) {
+		const int axis = volumeAxis[i];
+		if (axis < 0 || axis > 2 || used[axis]) {
+			return false;
+		}
+		used[axis] = true;
+	}
+	return true;
+}
+
+VolumeImporter::VolumeImporter(const GridLayout &layout, const glm::ivec3 &mins) : _layout(layout) {
+	_region = voxel::Region::InvalidRegion;
+	if (!layout.isValid()) {
+		return;
+	}
+	glm::ivec3 volumeSize;
+	for (int i = 0; i < 3; ++i) {
+		volumeSize[layout.volumeAxis[i]] = layout.size[i];
+	}
+	_region = voxel::Region(mins, mins + volumeSize - 1);
+	const int64_t volumeStrides[3]{1, volumeSize.x, (int64_t)volumeSize.x * volumeSize.y};
+	for (int i = 0; i < 3; ++i) {
+		const int64_t stride = volumeStrides[layout.volumeAxis[i]];
+		if (layout.flip[i]) {
+			_strides[i] = -stride;
+			_origin += (int64_t)(layout.size[i] - 1) * stride;
+		} else {
+			_strides[i] = stride;
+		}
+	}
+	const size_t size = voxel::RawVolume::size(_region);
+	_data = (voxel::Voxel *)core_malloc(size);
+	if (_data != nullptr) {
+		core_memset(_data, 0, size);
+	}
+}
+
+VolumeImporter::~VolumeImporter() {
+	core_free(_data);
+}
+
+void VolumeImporter::setRun(int64_t index, int64_t count, const voxel::Voxel &voxel) {
+	if (voxel::isAir(voxel.getMaterial()) || count <= 0) {
+		return;
+	}
+	const glm::ivec3 &size = _layout.size;
+	int x = (int)(index % size.x);
+	const int64_t yz = index / size.x;
+	int y = (int)(yz % size.y);
+	int z = (int)(yz / size.y);
+	core_assert(index + count <= (int64_t)size.x * size.y * size.z);
+	const int64_t stride = _strides[0];
+	while (count > 0 && z < size.z) {
+		const int n = (int)core_min((int64_t)(size.x - x), count);
+		voxel::Voxel *dest = _data + offset(x, y, z);
+		for (int i = 0; i < n; ++i, dest += stride) {
+			*dest = voxel;
+		}
+		count -= n;
+		x = 0;
+		if (++y == size.y) {
+			y = 0;
+			++z;
+		}
+	}
+}
+
+void VolumeImporter::setRow(int y, int z, const uint8_t *values, const voxel::Voxel *remap, uint8_t empty) {
+	const int width = _layout.size.x;
+	const int64_t stride = _strides[0];
+	voxel::Voxel *dest = _data + offset(0, y, z);
+	const uint64_t emptyWord = empty * UINT64_C(0x0101010101010101);
+	int x = 0;
+	while (x < width) {
+		// skip the empty cells eight at a time
+		if (x + 8 <= width) {
+			uint64_t word;
+			core_memcpy(&word, values + x, sizeof(word));
+			if (word == emptyWord) {
+				x += 8;
+				continue;
+			}
+		}
+		const uint8_t value = values[x];
+		if (value != empty) {
+			dest[x * stride] = remap[value];
+		}
+		++x;
+	}
+}
+
+void VolumeImporter::setGrid(const uint8_t *values, const voxel::Voxel *remap, uint8_t empty) {
+	core_trace_scoped(VolumeImporterSetGrid);
+	const glm::ivec3 &size = _layout.size;
+	const int64_t sliceSize = (int64_t)size.x * size.y;
+	auto importSlices = [&](int start, int end) {
+		for (int z = start; z < end; ++z) {
+			for (int y = 0; y < size.y; ++y) {
+				setRow(y, z, values + z * sliceSize + (int64_t)y * size.x, remap, empty);
+			}
+		}
+	};
+	// small grids are usually one of many models that are decoded in parallel anyway
+	if (sliceSize * size.z >= 256 * 1024) {
+		app::for_parallel(0, size.z, importSlices);
+	} else {
+		importSlices(0, size.z);
+	}
+}
+
+voxel::RawVolume *VolumeImporter::release() {
+	if (_data == nullptr) {
+		return nullptr;
+	}
+	voxel::RawVolume *volume = voxel::RawVolume::createRaw(_data, _region);
+	_data = nullptr;
+	return volume;
+}
+
+} // namespace voxelutil
@@ -0,0 +1,110 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Region.h"
+#include "voxel/Voxel.h"
+#include <glm/vec3.hpp>
+
+namespace voxelutil {
+
+/**
+ * @brief Describes how the axes of a dense grid from a file are mapped onto the volume
+ *
+ * Grid axis @c 0 is running fastest, then axis @c 1 and axis @c 2 - this is the order of the loops of most formats.
+ */
+struct GridLayout {
+	/** the amount of cells along every grid axis */
+	glm::ivec3 size{0};
+	/** the volume axis that grid axis @c i is written to */
+	glm::ivec3 volumeAxis{0, 1, 2};
+	/** the grid axes that are running from the upper to the lower corner of the volume */
+	glm::bvec3 flip{false};
+
+	bool isValid() const;
+};
+
+/**
+ * @brief Creates a volume from the cells of a dense grid without the bounds checks and position calculations of
+ * @c RawVolume::setVoxel()
+ *
+ * The memory offsets of the grid axes are computed once - importing a row of the grid is a strided copy. Air voxels
+ * are never written because the memory of the volume is cleared.
+ *
+ * Different rows can be imported from different threads.
+ */
+class VolumeImporter : public core::NonCopyable {
+private:
+	GridLayout _layout;
+	voxel::Region _region;
+	voxel::Voxel *_data = nullptr;
+	/** the memory offset of one step along the grid axes */
+	int64_t _strides[3]{0, 0, 0};
+	/** the memory offset of the first grid cell */
+	int64_t _origin = 0;
+
+	inline int64_t offset(int x, int y, int z) const {
+		return _origin + (int64_t)x * _strides[0] + (int64_t)y * _strides[1] + (int64_t)z * _strides[2];
+	}
+
+public:
+	/**
+	 * @param mins The lower corner of the volume region
+	 */
+	VolumeImporter(const GridLayout &layout, const glm::ivec3 &mins = glm::ivec3(0));
+	~VolumeImporter();
+
+	/**
+	 * @return @c false if the layout is invalid or the memory couldn't get allocated
+	 */
+	inline bool isValid() const {
+		return _data != nullptr;
+	}
+
+	/**
+	 * @brief The region of the volume - the grid size with permuted axes
+	 */
+	inline const voxel::Region &region() const {
+		return _region;
+	}
+
+	/**
+	 * @brief Sets the voxel of the given grid cell
+	 */
+	inline void setVoxel(int x, int y, int z, const voxel::Voxel &voxel) {
+		core_assert(x >= 0 && x < _layout.size.x && y >= 0 && y < _layout.size.y && z >= 0 && z < _layout.size.z);
+		_data[offset(x, y, z)] = voxel;
+	}
+
+	/**
+	 * @brief Sets @c count grid cells starting at the linear grid index @c index to the same voxel - like the runs
+	 * of rle encoded formats. A run may span several rows.
+	 */
+	void setRun(int64_t index, int64_t count, const voxel::Voxel &voxel);
+
+	/**
+	 * @brief Imports the values of one row along grid axis @c 0
+	 * @param values @c size.x values
+	 * @param remap The voxels for all 256 values
+	 * @param empty The value of empty cells - runs of this value are skipped
+	 */
+	void setRow(int y, int z, const uint8_t *values, const voxel::Voxel *remap, uint8_t empty = 0);
+
+	/**
+	 * @brief Imports all values of the grid - big grids are imported in parallel
+	 * @param values @c size.x * @c size.y * @c size.z values
+	 * @sa setRow()
+	 */
+	void setGrid(const uint8_t *values, const voxel::Voxel *remap, uint8_t empty = 0);
+
+	/**
+	 * @brief Hands the memory over to a new volume - the importer can't be used afterwards
+	 */
+	[[nodiscard]] voxel::RawVolume *release();
+};
+
+} // namespace voxelutil
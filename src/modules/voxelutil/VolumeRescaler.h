@@ -4,9 +4,11 @@
 #pragma once
 
 #include "app/App.h"
+#include "app/Async.h"
 #include "core/Color.h"
 #include "core/Common.h"
 #include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
 #include "palette/Palette.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/RawVolume.h"
@@ -16,25 +18,40 @@
 namespace voxelutil {
 
 template<typename Sampler>
-static bool isHidden(Sampler &srcSampler) {
-	const glm::ivec3 pos = srcSampler.position();
-	for (int32_t childZ = -1; childZ <= 1; ++childZ) {
-		for (int32_t childY = -1; childY <= 1; ++childY) {
-			for (int32_t childX = -1; childX <= 1; ++childX) {
-				if (childZ == 0 && childY == 0 && childX == 0) {
-					continue;
-				}
-				srcSampler.setPosition(pos.x + childX, pos.y + childY, pos.z + childZ);
-				if (!srcSampler.currentPositionValid()) {
-					return false;
-				}
-				if (!isBlocked(srcSampler.voxel().getMaterial())) {
-					return false;
-				}
-			}
-		}
+static bool isHidden(const Sampler &srcSampler) {
+	// the neighbours outside of the volume are not blocked
+	const glm::ivec3 &pos = srcSampler.position();
+	const voxel::Region &region = srcSampler.region();
+	if (glm::any(glm::lessThanEqual(pos, region.getLowerCorner())) ||
+		glm::any(glm::greaterThanEqual(pos, region.getUpperCorner()))) {
+		return false;
 	}
-	return true;
+	return isBlocked(srcSampler.peekVoxel1nx1ny1nz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1nx1ny0pz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1nx1ny1pz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1nx0py1nz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1nx0py0pz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1nx0py1pz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1nx1py1nz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1nx1py0pz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1nx1py1pz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel0px1ny1nz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel0px1ny0pz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel0px1ny1pz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel0px0py1nz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel0px0py1pz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel0px1py1nz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel0px1py0pz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel0px1py1pz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1px1ny1nz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1px1ny0pz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1px1ny1pz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1px0py1nz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1px0py0pz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1px0py1pz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1px1py1nz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1px1py0pz().getMaterial()) &&
+		   isBlocked(srcSampler.peekVoxel1px1py1pz().getMaterial());
 }
 
 /**
@@ -44,79 +61,89 @@ static bool isHidden(Sampler &srcSampler) {
  * @param[in] sourceRegion The region of the source volume to resample
  * @param[in] destRegion The region of the destination volume to resample into. Usually this should
  * be exactly half of the size of the sourceRegion.
+ * @note The slices of the destination volume are filled from several threads - the destination volume must allow
+ * to set different voxels in parallel (like @c voxel::RawVolume does)
  */
 template<typename SourceVolume, typename DestVolume>
 void scaleDown(const SourceVolume &sourceVolume, const palette::Palette &palette, const voxel::Region &sourceRegion,
 			   DestVolume &destVolume, const voxel::Region &destRegion) {
 	core_trace_scoped(ScaleVolumeDown);
-	typename SourceVolume::Sampler srcSampler(sourceVolume);
-
 	const int32_t depth = destRegion.getDepthInVoxels();
 	const int32_t height = destRegion.getHeightInVoxels();
 	const int32_t width = destRegion.getWidthInVoxels();
 	// First of all we iterate over all destination voxels and compute their color as the
 	// avg of the colors of the eight corresponding voxels in the higher resolution version.
-	for (int32_t z = 0; z < depth; ++z) {
-		for (int32_t y = 0; y < height; ++y) {
-			for (int32_t x = 0; x < width; ++x) {
-				const glm::ivec3 curPos(x, y, z);
-				const glm::ivec3 srcPos = sourceRegion.getLowerCorner() + curPos * 2;
-				const glm::ivec3 dstPos = destRegion.getLowerCorner() + curPos;
+	// Every destination voxel only depends on the source voxels - the slices are computed in parallel.
+	app::for_parallel(0, depth, [&](int start, int end) {
+		typename SourceVolume::Sampler srcSampler(sourceVolume);
+		// neighbouring voxels often get the same color - avoid the palette search for them
+		core::RGBA lastRGBA(0, 0, 0, 0);
+		int lastIndex = -1;
+		for (int32_t z = start; z < end; ++z) {
+			for (int32_t y = 0; y < height; ++y) {
+				for (int32_t x = 0; x < width; ++x) {
+					const glm::ivec3 curPos(x, y, z);
+					const glm::ivec3 srcPos = sourceRegion.getLowerCorner() + curPos * 2;
+					const glm::ivec3 dstPos = destRegion.getLowerCorner() + curPos;
 
-				float colorContributors = 0.0f;
-				float solidVoxels = 0.0f;
-				float avgColorRed = 0.0f;
-				float avgColorGreen = 0.0f;
-				float avgColorBlue = 0.0f;
-				voxel::Voxel colorGuardVoxel;
-				for (int32_t childZ = 0; childZ < 2; ++childZ) {
-					for (int32_t childY = 0; childY < 2; ++childY) {
-						for (int32_t childX = 0; childX < 2; ++childX) {
-							srcSampler.setPosition(srcPos + glm::ivec3(childX, childY, childZ));
-							if (!srcSampler.currentPositionValid()) {
-								continue;
-							}
-							const voxel::Voxel &child = srcSampler.voxel();
-
-							if (isBlocked(child.getMaterial())) {
-								++solidVoxels;
-								if (isHidden(srcSampler)) {
-									colorGuardVoxel = child;
+					float colorContributors = 0.0f;
+					float solidVoxels = 0.0f;
+					float avgColorRed = 0.0f;
+					float avgColorGreen = 0.0f;
+					float avgColorBlue = 0.0f;
+					voxel::Voxel colorGuardVoxel;
+					for (int32_t childZ = 0; childZ < 2; ++childZ) {
+						for (int32_t childY = 0; childY < 2; ++childY) {
+							for (int32_t childX = 0; childX < 2; ++childX) {
+								srcSampler.setPosition(srcPos + glm::ivec3(childX, childY, childZ));
+								if (!srcSampler.currentPositionValid()) {
 									continue;
 								}
-								const glm::vec4 &color = core::Color::fromRGBA(palette.color(child.getColor()));
-								avgColorRed += color.r;
-								avgColorGreen += color.g;
-								avgColorBlue += color.b;
-								++colorContributors;
+								const voxel::Voxel &child = srcSampler.voxel();
+
+								if (isBlocked(child.getMaterial())) {
+									++solidVoxels;
+									if (isHidden(srcSampler)) {
+										colorGuardVoxel = child;
+										continue;
+									}
+									const glm::vec4 &color = core::Color::fromRGBA(palette.color(child.getColor()));
+									avgColorRed += color.r;
+									avgColorGreen += color.g;
+									avgColorBlue += color.b;
+									++colorContributors;
+								}
 							}
 						}
 					}
-				}
 
-				// We only make a voxel solid if the eight corresponding voxels are also all solid. This
-				// means that higher LOD meshes actually shrink away which ensures cracks aren't visible.
-				if (solidVoxels >= 7.0f) {
-					if (colorContributors <= 0.0f) {
-						const glm::vec4 &color = core::Color::fromRGBA(palette.color(colorGuardVoxel.getColor()));
-						avgColorRed += color.r;
-						avgColorGreen += color.g;
-						avgColorBlue += color.b;
-						++colorContributors;
+					// We only make a voxel solid if the eight corresponding voxels are also all solid. This
+					// means that higher LOD meshes actually shrink away which ensures cracks aren't visible.
+					if (solidVoxels >= 7.0f) {
+						if (colorContributors <= 0.0f) {
+							const glm::vec4 &color = core::Color::fromRGBA(palette.color(colorGuardVoxel.getColor()));
+							avgColorRed += color.r;
+							avgColorGreen += color.g;
+							avgColorBlue += color.b;
+							++colorContributors;
+						}
+						const glm::vec4 avgColor(avgColorRed / colorContributors, avgColorGreen / colorContributors,
+												 avgColorBlue / colorContributors, 1.0f);
+						core::RGBA avgRGBA = core::Color::getRGBA(avgColor);
+						if (lastIndex == -1 || avgRGBA != lastRGBA) {
+							lastIndex = palette.getClosestMatch(avgRGBA);
+							lastRGBA = avgRGBA;
+						}
+						voxel::Voxel voxel = voxel::createVoxel(palette, lastIndex);
+						destVolume.setVoxel(dstPos, voxel);
+					} else {
+						const voxel::Voxel voxelAir;
+						destVolume.setVoxel(dstPos, voxelAir);
 					}
-					const glm::vec4 avgColor(avgColorRed / colorContributors, avgColorGreen / colorContributors,
-											 avgColorBlue / colorContributors, 1.0f);
-					core::RGBA avgRGBA = core::Color::getRGBA(avgColor);
-					const int index = palette.getClosestMatch(avgRGBA);
-					voxel::Voxel voxel = voxel::createVoxel(palette, index);
-					destVolume.setVoxel(dstPos, voxel);
-				} else {
-					const voxel::Voxel voxelAir;
-					destVolume.setVoxel(dstPos, voxelAir);
 				}
 			}
 		}
-	}
+	});
 
 	// At this point the results are usable, but we have a problem with thin structures disappearing.
 	// For example, if we have a solid blue sphere with a one voxel thick layer of red voxels on it,
@@ -124,91 +151,107 @@ void scaleDown(const SourceVolume &sourceVolume, const palette::Palette &palette
 	// color changes, as this is very noticeable. Our solution is to process again only those voxels
 	// which lie on a material-air boundary, and to recompute their color using a larger neighborhood
 	// while also accounting for how visible the child voxels are.
-	typename DestVolume::Sampler dstSampler(destVolume);
-	for (int32_t z = 0; z < destRegion.getDepthInVoxels(); ++z) {
-		for (int32_t y = 0; y < destRegion.getHeightInVoxels(); ++y) {
-			for (int32_t x = 0; x < destRegion.getWidthInVoxels(); ++x) {
-				const glm::ivec3 curPos(x, y, z);
-				const glm::ivec3 dstPos = destRegion.getLowerCorner() + curPos;
+	// The neighbours of the destination voxels are read here - so the new colors are collected for each slice and
+	// are only written once all slices are done.
+	struct RecoloredVoxel {
+		glm::ivec3 pos;
+		voxel::Voxel voxel;
+	};
+	core::DynamicArray<core::DynamicArray<RecoloredVoxel>> recolored;
+	recolored.resize(depth);
+	app::for_parallel(0, depth, [&](int start, int end) {
+		typename SourceVolume::Sampler srcSampler(sourceVolume);
+		typename DestVolume::Sampler dstSampler(destVolume);
+		for (int32_t z = start; z < end; ++z) {
+			for (int32_t y = 0; y < height; ++y) {
+				for (int32_t x = 0; x < width; ++x) {
+					const glm::ivec3 curPos(x, y, z);
+					const glm::ivec3 dstPos = destRegion.getLowerCorner() + curPos;
 
-				dstSampler.setPosition(dstPos);
+					dstSampler.setPosition(dstPos);
 
-				// Skip empty voxels
-				if (dstSampler.voxel().getMaterial() == voxel::VoxelType::Air) {
-					continue;
-				}
-				// Only process voxels on a material-air boundary.
-				if (dstSampler.peekVoxel0px0py1nz().getMaterial() != voxel::VoxelType::Air &&
-					dstSampler.peekVoxel0px0py1pz().getMaterial() != voxel::VoxelType::Air &&
-					dstSampler.peekVoxel0px1ny0pz().getMaterial() != voxel::VoxelType::Air &&
-					dstSampler.peekVoxel0px1py0pz().getMaterial() != voxel::VoxelType::Air &&
-					dstSampler.peekVoxel1nx0py0pz().getMaterial() != voxel::VoxelType::Air &&
-					dstSampler.peekVoxel1px0py0pz().getMaterial() != voxel::VoxelType::Air) {
-					continue;
-				}
-				const glm::ivec3 srcPos = sourceRegion.getLowerCorner() + curPos * 2;
+					// Skip empty voxels
+					if (dstSampler.voxel().getMaterial() == voxel::VoxelType::Air) {
+						continue;
+					}
+					// Only process voxels on a material-air boundary.
+					if (dstSampler.peekVoxel0px0py1nz().getMaterial() != voxel::VoxelType::Air &&
+						dstSampler.peekVoxel0px0py1pz().getMaterial() != voxel::VoxelType::Air &&
+						dstSampler.peekVoxel0px1ny0pz().getMaterial() != voxel::VoxelType::Air &&
+						dstSampler.peekVoxel0px1py0pz().getMaterial() != voxel::VoxelType::Air &&
+						dstSampler.peekVoxel1nx0py0pz().getMaterial() != voxel::VoxelType::Air &&
+						dstSampler.peekVoxel1px0py0pz().getMaterial() != voxel::VoxelType::Air) {
+						continue;
+					}
+					const glm::ivec3 srcPos = sourceRegion.getLowerCorner() + curPos * 2;
 
-				float totalRed = 0.0f;
-				float totalGreen = 0.0f;
-				float totalBlue = 0.0f;
-				float totalExposedFaces = 0.0f;
+					float totalRed = 0.0f;
+					float totalGreen = 0.0f;
+					float totalBlue = 0.0f;
+					float totalExposedFaces = 0.0f;
 
-				// Look at the 64 (4x4x4) children
-				for (int32_t childZ = -1; childZ < 3; childZ++) {
-					for (int32_t childY = -1; childY < 3; childY++) {
-						for (int32_t childX = -1; childX < 3; childX++) {
-							srcSampler.setPosition(srcPos + glm::ivec3(childX, childY, childZ));
+					// Look at the 64 (4x4x4) children
+					for (int32_t childZ = -1; childZ < 3; childZ++) {
+						for (int32_t childY = -1; childY < 3; childY++) {
+							for (int32_t childX = -1; childX < 3; childX++) {
+								srcSampler.setPosition(srcPos + glm::ivec3(childX, childY, childZ));
 
-							const voxel::Voxel &child = srcSampler.voxel();
-							if (child.getMaterial() == voxel::VoxelType::Air) {
-								continue;
-							}
+								const voxel::Voxel &child = srcSampler.voxel();
+								if (child.getMaterial() == voxel::VoxelType::Air) {
+									continue;
+								}
 
-							// For each small voxel, count the exposed faces and use this
-							// to determine the importance of the color contribution.
-							float exposedFaces = 0.0f;
-							if (srcSampler.peekVoxel0px0py1nz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
-							if (srcSampler.peekVoxel0px0py1pz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
-							if (srcSampler.peekVoxel0px1ny0pz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
-							if (srcSampler.peekVoxel0px1py0pz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
-							if (srcSampler.peekVoxel1nx0py0pz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
-							if (srcSampler.peekVoxel1px0py0pz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
+								// For each small voxel, count the exposed faces and use this
+								// to determine the importance of the color contribution.
+								float exposedFaces = 0.0f;
+								if (srcSampler.peekVoxel0px0py1nz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel0px0py1pz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel0px1ny0pz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel0px1py0pz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel1nx0py0pz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel1px0py0pz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
 
-							const glm::vec4 &color = core::Color::fromRGBA(palette.color(child.getColor()));
-							totalRed += color.r * exposedFaces;
-							totalGreen += color.g * exposedFaces;
-							totalBlue += color.b * exposedFaces;
+								const glm::vec4 &color = core::Color::fromRGBA(palette.color(child.getColor()));
+								totalRed += color.r * exposedFaces;
+								totalGreen += color.g * exposedFaces;
+								totalBlue += color.b * exposedFaces;
 
-							totalExposedFaces += exposedFaces;
+								totalExposedFaces += exposedFaces;
+							}
 						}
 					}
-				}
 
-				// Avoid divide by zero if there were no exposed faces.
-				if (totalExposedFaces <= 0.01f) {
-					++totalExposedFaces;
-				}
+					// Avoid divide by zero if there were no exposed faces.
+					if (totalExposedFaces <= 0.01f) {
+						++totalExposedFaces;
+					}
 
-				const glm::vec4 avgColor(totalRed / totalExposedFaces, totalGreen / totalExposedFaces,
-										 totalBlue / totalExposedFaces, 1.0f);
-				core::RGBA avgRGBA = core::Color::getRGBA(avgColor);
-				const int index = palette.getClosestMatch(avgRGBA);
-				const voxel::Voxel voxel = voxel::createVoxel(palette, index);
-				destVolume.setVoxel(dstPos, voxel);
+					const glm::vec4 avgColor(totalRed / totalExposedFaces, totalGreen / totalExposedFaces,
+											 totalBlue / totalExposedFaces, 1.0f);
+					core::RGBA avgRGBA = core::Color::getRGBA(avgColor);
+					const int index = palette.getClosestMatch(avgRGBA);
+					const voxel::Voxel voxel = voxel::createVoxel(palette, index);
+					recolored[z].push_back(RecoloredVoxel{dstPos, voxel});
+				}
 			}
 		}
+	});
+	for (const core::DynamicArray<RecoloredVoxel> &slice : recolored) {
+		for (const RecoloredVoxel &v : slice) {
+			destVolume.setVoxel(v.pos, v.voxel);
+		}
 	}
 }
 
@@ -217,7 +260,8 @@ void scaleDown(const SourceVolume &sourceVolume, const palette::Palette &palette
 	scaleDown(sourceVolume, palette, sourceVolume.region(), destVolume, destVolume.region());
 }
 
-[[nodiscard]] voxel::RawVolume *scaleUp(const voxel::RawVolume &sourceVolume) {
+[[nodiscard]] inline voxel::RawVolume *scaleUp(const voxel::RawVolume &sourceVolume) {
+	core_trace_scoped(ScaleVolumeUp);
 	const voxel::Region srcRegion = sourceVolume.region();
 	const glm::ivec3 &dim = srcRegion.getDimensionsInVoxels();
 	const glm::ivec3 &mins = srcRegion.getLowerCorner();
@@ -227,29 +271,28 @@ void scaleDown(const SourceVolume &sourceVolume, const palette::Palette &palette
 		return nullptr;
 	}
 
-	static const glm::ivec3 directions[8] = {glm::ivec3(0, 0, 0), glm::ivec3(1, 0, 0), glm::ivec3(0, 1, 0),
-											 glm::ivec3(1, 1, 0), glm::ivec3(0, 0, 1), glm::ivec3(1, 0, 1),
-											 glm::ivec3(0, 1, 1), glm::ivec3(1, 1, 1)};
-
 	voxel::RawVolume *destVolume = new voxel::RawVolume(destRegion);
-	voxel::RawVolume::Sampler sourceSampler(sourceVolume);
-	sourceSampler.setPosition(mins);
-	for (int32_t x = 0; x < dim.x; ++x) {
-		voxel::RawVolume::Sampler sampler2 = sourceSampler;
-		for (int32_t y = 0; y < dim.y; ++y) {
-			voxel::RawVolume::Sampler sampler3 = sampler2;
-			for (int32_t z = 0; z < dim.z; ++z) {
-				const voxel::Voxel &voxel = sampler3.voxel();
-				const glm::ivec3 targetPos(mins.x + x * 2, mins.y + y * 2, mins.z + z * 2);
-				for (int i = 0; i < 8; ++i) {
-					destVolume->setVoxel(targetPos + directions[i], voxel);
+	// each source slice fills two destination slices
+	app::for_parallel(0, dim.z, [&](int start, int end) {
+		voxel::RawVolume::Sampler sourceSampler(sourceVolume);
+		voxel::RawVolume::Sampler destSampler(destVolume);
+		for (int32_t z = start; z < end; ++z) {
+			for (int32_t y = 0; y < dim.y; ++y) {
+				sourceSampler.setPosition(mins.x, mins.y + y, mins.z + z);
+				for (int32_t x = 0; x < dim.x; ++x) {
+					const voxel::Voxel voxel = sourceSampler.voxel();
+					sourceSampler.movePositiveX();
+					const glm::ivec3 targetPos(mins.x + x * 2, mins.y + y * 2, mins.z + z * 2);
+					for (int i = 0; i < 4; ++i) {
+						destSampler.setPosition(targetPos.x, targetPos.y + (i & 1), targetPos.z + (i >> 1));
+						destSampler.setVoxel(voxel);
+						destSampler.movePositiveX();
+						destSampler.setVoxel(voxel);
+					}
 				}
-				sampler3.movePositiveZ(1);
 			}
-			sampler2.movePositiveY(1);
 		}
-		sourceSampler.movePositiveX(1);
-	}
+	});
 	return destVolume;
 }
 
@@ -3,15 +3,17 @@
  */
 
 #include "VolumeRotator.h"
+#include "app/Async.h"
 #include "core/Assert.h"
 #include "core/GLM.h"
 #include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
 #include "math/AABB.h"
 #include "math/Axis.h"
 #include "math/Math.h"
 #include "palette/Palette.h"
 #include "voxel/RawVolume.h"
-#include "voxel/RawVolumeWrapper.h"
 #include "voxel/Region.h"
 #include "voxel/Voxel.h"
 #include "voxelutil/VoxelUtil.h"
@@ -28,6 +30,7 @@ namespace voxelutil {
  */
 voxel::RawVolume *rotateVolume(const voxel::RawVolume *srcVolume, const palette::Palette &palette,
 							   const glm::ivec3 &angles, const glm::vec3 &normalizedPivot) {
+	core_trace_scoped(RotateVolume);
 	// TODO: implement sampling http://www.leptonica.org/rotation.html
 	const float pitch = glm::radians((float)angles.x);
 	const float yaw = glm::radians((float)angles.y);
@@ -38,150 +41,143 @@ voxel::RawVolume *rotateVolume(const voxel::RawVolume *srcVolume, const palette:
 	const glm::vec3 pivot(normalizedPivot * glm::vec3(srcRegion.getDimensionsInVoxels()));
 	const voxel::Region &destRegion = srcRegion.rotate(mat, pivot);
 	voxel::RawVolume *destVolume = new voxel::RawVolume(destRegion);
-	voxel::RawVolumeWrapper destVolumeWrapper(destVolume);
 
-	voxel::RawVolume::Sampler srcSampler(srcVolume);
-	srcSampler.setPosition(srcRegion.getLowerCorner());
-	for (int32_t z = srcRegion.getLowerZ(); z <= srcRegion.getUpperZ(); ++z) {
-		voxel::RawVolume::Sampler srcSampler2 = srcSampler;
-		for (int32_t y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
-			voxel::RawVolume::Sampler srcSampler3 = srcSampler2;
-			for (int32_t x = srcRegion.getLowerX(); x <= srcRegion.getUpperX(); ++x) {
-				const voxel::Voxel voxel = srcSampler3.voxel();
-				if (!voxel::isAir(voxel.getMaterial())) {
+	// every thread owns a slab of the destination volume and only writes the voxels that end up in its slab. The
+	// source voxels are visited in the same order in each thread - so if several voxels end up at the same position,
+	// the result doesn't depend on the amount of threads.
+	const int32_t lowerX = srcRegion.getLowerX();
+	const int32_t upperX = srcRegion.getUpperX();
+	// the destination z coordinate changes by this value for each step on the source x axis
+	const float dzdx = mat[0][2];
+	app::for_parallel(destRegion.getLowerZ(), destRegion.getUpperZ() + 1, [&](int start, int end) {
+		voxel::RawVolume::Sampler srcSampler(srcVolume);
+		for (int32_t z = srcRegion.getLowerZ(); z <= srcRegion.getUpperZ(); ++z) {
+			for (int32_t y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
+				// only transform the voxels of the row that can end up in the slab - with one voxel tolerance
+				const float z0 = math::transform(mat, glm::vec3(lowerX, y, z), pivot).z;
+				int32_t xStart = lowerX;
+				int32_t xEnd = upperX;
+				if (glm::abs(dzdx) > 0.0001f) {
+					float a = (float)(start - 1) - z0;
+					float b = (float)(end + 1) - z0;
+					a = glm::clamp(a / dzdx, -1.0f, (float)(upperX - lowerX + 1));
+					b = glm::clamp(b / dzdx, -1.0f, (float)(upperX - lowerX + 1));
+					xStart = core_max(lowerX, lowerX + (int32_t)glm::floor(core_min(a, b)));
+					xEnd = core_min(upperX, lowerX + (int32_t)glm::ceil(core_max(a, b)));
+				} else if (z0 < (float)(start - 1) || z0 > (float)(end + 1)) {
+					continue;
+				}
+				if (xStart > xEnd) {
+					continue;
+				}
+				srcSampler.setPosition(xStart, y, z);
+				for (int32_t x = xStart; x <= xEnd; ++x) {
+					const voxel::Voxel voxel = srcSampler.voxel();
+					srcSampler.movePositiveX();
+					if (voxel::isAir(voxel.getMaterial())) {
+						continue;
+					}
 					const glm::vec3 srcPos(x, y, z);
 					const glm::vec3 &destPos = math::transform(mat, srcPos, pivot);
 					const glm::ivec3 &destPosFloor = glm::floor(destPos);
-					destVolumeWrapper.setVoxel(destPosFloor, voxel);
+					if (destPosFloor.z < start || destPosFloor.z >= end || !destRegion.containsPoint(destPosFloor)) {
+						continue;
+					}
+					destVolume->setVoxel(destPosFloor, voxel);
 				}
-				srcSampler3.movePositiveX();
 			}
-			srcSampler2.movePositiveY();
 		}
-		srcSampler.movePositiveZ();
-	}
+	});
 	return destVolume;
 }
 
+/**
+ * @brief Creates a new volume for the given region and fills it with the voxels of the source volume
+ *
+ * The voxel for the destination position (x, y, z) - relative to the lower corner - is taken from the source voxel
+ * at index @code offset + x * stride.x + y * stride.y + z * stride.z @endcode
+ *
+ * The destination is filled in blocks - this keeps the reads from the source in the cache if the source is walked
+ * with a big stride. The slices are filled in parallel.
+ *
+ * @param keepAir If this is @c false, all air voxels are replaced by an empty voxel - like in a new volume
+ */
+static voxel::RawVolume *copyPermuted(const voxel::RawVolume *srcVolume, const voxel::Region &destRegion,
+									  int64_t offset, const glm::i64vec3 &stride, bool keepAir) {
+	core_trace_scoped(CopyPermuted);
+	static constexpr int32_t TileSize = 32;
+	static constexpr int32_t TileDepth = 16;
+	const int32_t width = destRegion.getWidthInVoxels();
+	const int32_t height = destRegion.getHeightInVoxels();
+	const int32_t depth = destRegion.getDepthInVoxels();
+	const voxel::Voxel *src = (const voxel::Voxel *)srcVolume->data();
+	voxel::Voxel *dest = (voxel::Voxel *)core_malloc(voxel::RawVolume::size(destRegion));
+	// the memory of a new volume is cleared to zero
+	const voxel::Voxel emptyVoxel(voxel::VoxelType::Air, 0, 0, 0);
+	app::for_parallel(0, depth, [&](int start, int end) {
+		for (int32_t tileZ = start; tileZ < end; tileZ += TileDepth) {
+			const int32_t tileZEnd = core_min(tileZ + TileDepth, end);
+			for (int32_t tileY = 0; tileY < height; tileY += TileSize) {
+				const int32_t tileYEnd = core_min(tileY + TileSize, height);
+				for (int32_t tileX = 0; tileX < width; tileX += TileSize) {
+					const int32_t tileXEnd = core_min(tileX + TileSize, width);
+					for (int32_t z = tileZ; z < tileZEnd; ++z) {
+						voxel::Voxel *destSlice = dest + (int64_t)z * width * height;
+						const voxel::Voxel *srcSlice = src + offset + z * stride.z;
+						for (int32_t y = tileY; y < tileYEnd; ++y) {
+							voxel::Voxel *destRow = destSlice + (int64_t)y * width;
+							const voxel::Voxel *srcRow = srcSlice + y * stride.y;
+							for (int32_t x = tileX; x < tileXEnd; ++x) {
+								const voxel::Voxel &voxel = srcRow[x * stride.x];
+								if (keepAir || !voxel::isAir(voxel.getMaterial())) {
+									destRow[x] = voxel;
+								} else {
+									destRow[x] = emptyVoxel;
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	});
+	return voxel::RawVolume::createRaw(dest, destRegion);
+}
+
 voxel::RawVolume *rotateAxis(const voxel::RawVolume *srcVolume, math::Axis axis) {
 	const voxel::Region &srcRegion = srcVolume->region();
 	const glm::ivec3 srcMins = srcRegion.getLowerCorner();
 	const glm::ivec3 srcMaxs = srcRegion.getUpperCorner();
+	const int64_t w = srcRegion.getWidthInVoxels();
+	const int64_t h = srcRegion.getHeightInVoxels();
+	const int64_t d = srcRegion.getDepthInVoxels();
 	if (axis == math::Axis::X) {
+		// dest(x, z, maxs.y - y) = src(x, y, z)
 		const voxel::Region destRegion(srcMins.x, srcMins.z, srcMins.y, srcMaxs.x, srcMaxs.z, srcMaxs.y);
-		voxel::RawVolume *destVolume = new voxel::RawVolume(destRegion);
-
-		voxel::RawVolume::Sampler srcSampler(srcVolume);
-		srcSampler.setPosition(srcRegion.getLowerCorner());
-		for (int32_t z = srcRegion.getLowerZ(); z <= srcRegion.getUpperZ(); ++z) {
-			voxel::RawVolume::Sampler srcSampler2 = srcSampler;
-			for (int32_t y = 0; y < srcRegion.getHeightInVoxels(); ++y) {
-				voxel::RawVolume::Sampler srcSampler3 = srcSampler2;
-				for (int32_t x = srcRegion.getLowerX(); x <= srcRegion.getUpperX(); ++x) {
-					const voxel::Voxel voxel = srcSampler3.voxel();
-					if (!voxel::isAir(voxel.getMaterial())) {
-						destVolume->setVoxel(x, z, srcMaxs.y - y, voxel);
-					}
-					srcSampler3.movePositiveX();
-				}
-				srcSampler2.movePositiveY();
-			}
-			srcSampler.movePositiveZ();
-		}
-		return destVolume;
+		return copyPermuted(srcVolume, destRegion, (h - 1) * w, glm::i64vec3(1, w * h, -w), false);
 	} else if (axis == math::Axis::Y) {
+		// dest(maxs.z - z, y, x) = src(x, y, z)
 		const voxel::Region destRegion(srcMins.z, srcMins.y, srcMins.x, srcMaxs.z, srcMaxs.y, srcMaxs.x);
-		voxel::RawVolume *destVolume = new voxel::RawVolume(destRegion);
-
-		voxel::RawVolume::Sampler srcSampler(srcVolume);
-		srcSampler.setPosition(srcRegion.getLowerCorner());
-		for (int32_t z = 0; z < srcRegion.getDepthInVoxels(); ++z) {
-			voxel::RawVolume::Sampler srcSampler2 = srcSampler;
-			for (int32_t y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
-				voxel::RawVolume::Sampler srcSampler3 = srcSampler2;
-				for (int32_t x = srcRegion.getLowerX(); x <= srcRegion.getUpperX(); ++x) {
-					const voxel::Voxel voxel = srcSampler3.voxel();
-					if (!voxel::isAir(voxel.getMaterial())) {
-						destVolume->setVoxel(srcMaxs.z - z, y, x, voxel);
-					}
-					srcSampler3.movePositiveX();
-				}
-				srcSampler2.movePositiveY();
-			}
-			srcSampler.movePositiveZ();
-		}
-		return destVolume;
+		return copyPermuted(srcVolume, destRegion, (d - 1) * w * h, glm::i64vec3(-w * h, w, 1), false);
 	}
+	// dest(y, maxs.x - x, z) = src(x, y, z)
 	const voxel::Region destRegion(srcMins.y, srcMins.x, srcMins.z, srcMaxs.y, srcMaxs.x, srcMaxs.z);
-	voxel::RawVolume *destVolume = new voxel::RawVolume(destRegion);
-
-	voxel::RawVolume::Sampler srcSampler(srcVolume);
-	srcSampler.setPosition(srcRegion.getLowerCorner());
-	for (int32_t z = srcRegion.getLowerZ(); z <= srcRegion.getUpperZ(); ++z) {
-		voxel::RawVolume::Sampler srcSampler2 = srcSampler;
-		for (int32_t y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
-			voxel::RawVolume::Sampler srcSampler3 = srcSampler2;
-			for (int32_t x = 0; x < srcRegion.getWidthInVoxels(); ++x) {
-				const voxel::Voxel voxel = srcSampler3.voxel();
-				if (!voxel::isAir(voxel.getMaterial())) {
-					destVolume->setVoxel(y, srcMaxs.x - x, z, voxel);
-				}
-				srcSampler3.movePositiveX();
-			}
-			srcSampler2.movePositiveY();
-		}
-		srcSampler.movePositiveZ();
-	}
-	return destVolume;
+	return copyPermuted(srcVolume, destRegion, w - 1, glm::i64vec3(w, -1, w * h), false);
 }
 
 voxel::RawVolume *mirrorAxis(const voxel::RawVolume *source, math::Axis axis) {
 	const voxel::Region &srcRegion = source->region();
-	voxel::RawVolume *destination = new voxel::RawVolume(source);
-	voxel::RawVolume::Sampler destSampler(destination);
-	voxel::RawVolume::Sampler srcSampler(source);
-
-	const glm::ivec3 &mins = srcRegion.getLowerCorner();
-	const glm::ivec3 &maxs = srcRegion.getUpperCorner();
-
+	const int64_t w = srcRegion.getWidthInVoxels();
+	const int64_t h = srcRegion.getHeightInVoxels();
+	const int64_t d = srcRegion.getDepthInVoxels();
 	if (axis == math::Axis::X) {
-		for (int32_t z = mins.z; z <= maxs.z; ++z) {
-			for (int32_t y = mins.y; y <= maxs.y; ++y) {
-				srcSampler.setPosition(mins.x, y, z);
-				destSampler.setPosition(maxs.x, y, z);
-				for (int32_t x = mins.x; x <= maxs.x; ++x) {
-					destSampler.setVoxel(srcSampler.voxel());
-					srcSampler.movePositiveX();
-					destSampler.moveNegativeX();
-				}
-			}
-		}
+		return copyPermuted(source, srcRegion, w - 1, glm::i64vec3(-1, w, w * h), true);
 	} else if (axis == math::Axis::Y) {
-		for (int32_t z = mins.z; z <= maxs.z; ++z) {
-			for (int32_t x = mins.x; x <= maxs.x; ++x) {
-				srcSampler.setPosition(x, mins.y, z);
-				destSampler.setPosition(x, maxs.y, z);
-				for (int32_t y = mins.y; y <= maxs.y; ++y) {
-					destSampler.setVoxel(srcSampler.voxel());
-					srcSampler.movePositiveY();
-					destSampler.moveNegativeY();
-				}
-			}
-		}
+		return copyPermuted(source, srcRegion, (h - 1) * w, glm::i64vec3(1, -w, w * h), true);
 	} else if (axis == math::Axis::Z) {
-		for (int32_t y = mins.y; y <= maxs.y; ++y) {
-			for (int32_t x = mins.x; x <= maxs.x; ++x) {
-				srcSampler.setPosition(x, y, mins.z);
-				destSampler.setPosition(x, y, maxs.z);
-				for (int32_t z = mins.z; z <= maxs.z; ++z) {
-					destSampler.setVoxel(srcSampler.voxel());
-					srcSampler.movePositiveZ();
-					destSampler.moveNegativeZ();
-				}
-			}
-		}
+		return copyPermuted(source, srcRegion, (d - 1) * w * h, glm::i64vec3(1, w, -w * h), true);
 	}
-	return destination;
+	return new voxel::RawVolume(source);
 }
 
 } // namespace voxelutil
@@ -3,8 +3,11 @@
  */
 
 #include "VolumeSplitter.h"
+#include "app/Async.h"
 #include "core/Common.h"
 #include "core/Log.h"
+#include "core/Trace.h"
+#include "core/collection/Buffer.h"
 #include "voxel/RawVolume.h"
 #include "voxel/Voxel.h"
 #include "voxelutil/VolumeCropper.h"
@@ -13,91 +16,133 @@
 
 namespace voxelutil {
 
-namespace priv {
+static constexpr glm::ivec3 Neighbours[6] = {glm::ivec3(0, 0, -1), glm::ivec3(0, 0, +1), glm::ivec3(0, -1, 0),
+											  glm::ivec3(0, +1, 0), glm::ivec3(-1, 0, 0), glm::ivec3(+1, 0, 0)};
 
-const glm::ivec3 neighbours[6] = {glm::ivec3(0, 0, -1), glm::ivec3(0, 0, +1), glm::ivec3(0, -1, 0),
-								  glm::ivec3(0, +1, 0), glm::ivec3(-1, 0, 0), glm::ivec3(+1, 0, 0)};
+namespace {
+struct ObjectVoxel {
+	glm::ivec3 pos;
+	voxel::Voxel voxel;
+};
 
-// special voxel to mark already visited voxels
-const uint8_t visitedFlag = 1u;
-const voxel::Voxel visited(voxel::VoxelType::Air, 1, visitedFlag);
-
-} // namespace priv
-
-static void processNeighbours(voxel::RawVolume &volume, voxel::RawVolume &object, const glm::ivec3 position) {
-	if (!volume.region().containsPoint(position)) {
-		return;
-	}
-	voxel::Voxel voxel = volume.voxel(position);
-	if (voxel.getFlags() == priv::visitedFlag) {
-		return;
-	}
-	if (voxel::isAir(voxel.getMaterial())) {
-		volume.setVoxelUnsafe(position, priv::visited);
-		return;
-	}
-
-	object.setVoxel(position, voxel);
-	volume.setVoxelUnsafe(position, priv::visited);
-
-	for (int i = 0; i < 6; ++i) {
-		const glm::ivec3 p = position + priv::neighbours[i];
-		processNeighbours(volume, object, p);
-	}
-}
+struct SplitTile {
+	voxel::Region region;
+	bool empty;
+};
+} // namespace
 
 core::DynamicArray<voxel::RawVolume *> splitObjects(const voxel::RawVolume *v, VisitorOrder order) {
-	voxel::RawVolume copy(*v);
-	copy.setBorderValue(priv::visited);
+	core_trace_scoped(SplitObjects);
+	const voxel::Region &region = v->region();
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const int64_t width = region.getWidthInVoxels();
+	const int64_t sliceSize = width * region.getHeightInVoxels();
+	auto index = [&](const glm::ivec3 &pos) {
+		return (size_t)((pos.z - mins.z) * sliceSize + (pos.y - mins.y) * width + (pos.x - mins.x));
+	};
+	core::Buffer<bool> visited(region.voxels());
+	visited.fill(false);
 
 	core::DynamicArray<voxel::RawVolume *> rawVolumes;
+	core::DynamicArray<glm::ivec3> open;
+	core::DynamicArray<ObjectVoxel> object;
 
-	visitVolume(copy, [&](int x, int y, int z, const voxel::Voxel &voxel) {
-		if (voxel.getFlags() == priv::visitedFlag) {
+	visitVolume(*v, [&](int x, int y, int z, const voxel::Voxel &voxel) {
+		const glm::ivec3 position(x, y, z);
+		if (visited[index(position)]) {
 			return;
 		}
-		const glm::ivec3 position(x, y, z);
+		visited[index(position)] = true;
 		if (voxel::isAir(voxel.getMaterial())) {
-			copy.setVoxelUnsafe(position, priv::visited);
 			return;
 		}
 
-		voxel::RawVolume object(copy.region());
-		processNeighbours(copy, object, position);
-		rawVolumes.push_back(voxelutil::cropVolume(&object));
+		// collect the connected voxels first - the volume of the object only gets the size of its bounds
+		object.clear();
+		object.push_back({position, voxel});
+		open.push_back(position);
+		voxel::Region objectRegion(position, position);
+		while (!open.empty()) {
+			const glm::ivec3 current = open.back();
+			open.pop();
+			for (int i = 0; i < lengthof(Neighbours); ++i) {
+				const glm::ivec3 &p = current + Neighbours[i];
+				if (!region.containsPoint(p) || visited[index(p)]) {
+					continue;
+				}
+				visited[index(p)] = true;
+				const voxel::Voxel &neighbour = v->voxel(p);
+				if (voxel::isAir(neighbour.getMaterial())) {
+					continue;
+				}
+				object.push_back({p, neighbour});
+				objectRegion.accumulate(p);
+				open.push_back(p);
+			}
+		}
+
+		voxel::RawVolume *objectVolume = new voxel::RawVolume(objectRegion);
+		for (const ObjectVoxel &objectVoxel : object) {
+			objectVolume->setVoxel(objectVoxel.pos, objectVoxel.voxel);
+		}
+		rawVolumes.push_back(objectVolume);
 	}, VisitAll(), order);
 
 	return rawVolumes;
 }
 
-core::DynamicArray<voxel::RawVolume *> splitVolume(const voxel::RawVolume *volume, const glm::ivec3 &maxSize, bool createEmpty) {
+core::DynamicArray<voxel::RawVolume *> splitVolume(const voxel::RawVolume *volume, const glm::ivec3 &maxSize,
+												   bool createEmpty, bool crop) {
+	core_trace_scoped(SplitVolume);
 	const voxel::Region &region = volume->region();
 	const glm::ivec3 &mins = region.getLowerCorner();
 	const glm::ivec3 &maxs = region.getUpperCorner();
 
-	core::DynamicArray<voxel::RawVolume *> rawVolumes;
-
 	const glm::ivec3 step = glm::min(region.getDimensionsInVoxels(), maxSize);
 	Log::debug("split region: %s", region.toString().c_str());
+	core::DynamicArray<voxel::Region> tiles;
 	for (int y = mins.y; y <= maxs.y; y += step.y) {
 		for (int z = mins.z; z <= maxs.z; z += step.z) {
 			for (int x = mins.x; x <= maxs.x; x += step.x) {
 				const glm::ivec3 innerMins(x, y, z);
 				const glm::ivec3 innerMaxs = glm::min(maxs, innerMins + maxSize - 1);
-				const voxel::Region innerRegion(innerMins, innerMaxs);
-				voxel::RawVolume *copy = new voxel::RawVolume(innerRegion);
-				if (voxelutil::copy(*volume, innerRegion, *copy, innerRegion)) {
-					Log::debug("- split %s", innerRegion.toString().c_str());
-				} else if (!createEmpty) {
-					Log::debug("- skip empty %s", innerRegion.toString().c_str());
-					delete copy;
-					continue;
-				}
-				rawVolumes.push_back(copy);
+				tiles.emplace_back(innerMins, innerMaxs);
 			}
 		}
 	}
 
+	// find the occupied parts of the tiles first - only the volumes for the non-empty tiles are allocated then
+	core::DynamicArray<voxel::Region> usedRegions;
+	usedRegions.resize(tiles.size());
+	app::for_parallel(0, (int)tiles.size(), [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			usedRegions[i] = calculateUsedRegion(*volume, tiles[i], false);
+		}
+	});
+
+	core::DynamicArray<SplitTile> targets;
+	targets.reserve(tiles.size());
+	for (size_t i = 0; i < tiles.size(); ++i) {
+		if (usedRegions[i].isValid()) {
+			targets.push_back({crop ? usedRegions[i] : tiles[i], false});
+		} else if (createEmpty) {
+			targets.push_back({tiles[i], true});
+		}
+	}
+	Log::debug("split into %i volumes out of %i tiles", (int)targets.size(), (int)tiles.size());
+
+	core::DynamicArray<voxel::RawVolume *> rawVolumes;
+	rawVolumes.resize(targets.size());
+	app::for_parallel(0, (int)targets.size(), [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			const SplitTile &target = targets[i];
+			if (target.empty) {
+				rawVolumes[i] = new voxel::RawVolume(target.region);
+			} else {
+				rawVolumes[i] = copyRegion(*volume, target.region, false);
+			}
+		}
+	});
 	return rawVolumes;
 }
 
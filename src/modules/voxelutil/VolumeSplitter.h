@@ -15,11 +15,18 @@ class RawVolume;
 namespace voxelutil {
 
 /**
+ * @brief Splits the volume into parts of the given max size
+ *
+ * The occupied region of each part is searched in parallel first - the volumes are only allocated for the non-empty
+ * parts and are filled in parallel afterwards.
+ *
  * @param createEmpty if @c true, for empty parts of the source volume empty volumes will be created, too. Otherwise
  * they will be ignored.
+ * @param crop if @c true, the volumes of the non-empty parts only get the size of their voxels.
  */
 [[nodiscard]] core::DynamicArray<voxel::RawVolume *> splitVolume(const voxel::RawVolume *volume,
-																 const glm::ivec3 &maxSize, bool createEmpty = false);
+																 const glm::ivec3 &maxSize, bool createEmpty = false,
+																 bool crop = false);
 
 /**
  * @param order This defines the order in which the splitted objects are returned.
@@ -3,6 +3,7 @@
  */
 
 #include "VoxelUtil.h"
+#include "app/Async.h"
 #include "core/GLM.h"
 #include "core/Log.h"
 #include "core/collection/Array3DView.h"
@@ -11,6 +12,7 @@
 #include "core/collection/Set.h"
 #include <glm/geometric.hpp>
 #include "math/Axis.h"
+#include "palette/NormalPaletteLookup.h"
 #include "palette/Palette.h"
 #include "palette/PaletteLookup.h"
 #include "voxel/Face.h"
@@ -70,6 +72,55 @@ glm::vec3 calculateNormal(voxel::RawVolume::Sampler &sampler, voxel::Connectivit
 	return glm::normalize(glm::vec3(sum));
 }
 
+int calculateNormals(voxel::RawVolumeWrapper &in, const palette::NormalPalette &normalPalette,
+					 voxel::Connectivity connectivity, bool recalcAll) {
+	const voxel::Region &region = in.region();
+	if (!region.isValid()) {
+		return 0;
+	}
+	struct NormalChange {
+		glm::ivec3 pos;
+		voxel::Voxel voxel;
+	};
+	const palette::NormalPaletteLookup lookup(normalPalette);
+	const voxel::RawVolume &volume = *in.volume();
+	const int lowerZ = region.getLowerZ();
+	const int depth = region.getDepthInVoxels();
+	// the volume is only read while the normals are computed - every slice collects its own changes
+	core::DynamicArray<core::DynamicArray<NormalChange>> changes;
+	changes.resize(depth);
+	app::for_parallel(0, depth, [&](int start, int end) {
+		voxel::RawVolume::Sampler sampler(volume);
+		const voxel::Region block(region.getLowerX(), region.getLowerY(), lowerZ + start, region.getUpperX(),
+								  region.getUpperY(), lowerZ + end - 1);
+		visitVolume(
+			volume, block, 1, 1, 1,
+			[&](int x, int y, int z, const voxel::Voxel &voxel) {
+				if (!recalcAll && voxel.getNormal() != NO_NORMAL) {
+					return;
+				}
+				if (voxel::visibleFaces(volume, x, y, z) == voxel::FaceBits::None) {
+					return;
+				}
+				sampler.setPosition(x, y, z);
+				const glm::vec3 &normal = calculateNormal(sampler, connectivity);
+				const uint8_t normalIndex = lookup.getClosestMatch(normal);
+				changes[z - lowerZ].emplace_back(NormalChange{
+					glm::ivec3(x, y, z),
+					voxel::createVoxel(voxel.getMaterial(), voxel.getColor(), normalIndex, voxel.getFlags())});
+			},
+			SkipEmpty());
+	});
+	int cnt = 0;
+	for (const core::DynamicArray<NormalChange> &sliceChanges : changes) {
+		for (const NormalChange &change : sliceChanges) {
+			in.setVoxel(change.pos, change.voxel);
+		}
+		cnt += (int)sliceChanges.size();
+	}
+	return cnt;
+}
+
 bool isTouching(const voxel::RawVolume &volume, const glm::ivec3 &pos, voxel::Connectivity connectivity) {
 	voxel::RawVolume::Sampler sampler(volume);
 	if (!sampler.setPosition(pos)) {
@@ -16,6 +16,7 @@ class RawVolumeWrapper;
 }
 namespace palette {
 class Palette;
+class NormalPalette;
 }
 
 namespace voxelutil {
@@ -172,4 +173,15 @@ voxel::Region remapToPalette(voxel::RawVolume *v, const palette::Palette &oldPal
 [[nodiscard]] voxel::RawVolume *diffVolumes(const voxel::RawVolume *v1, const voxel::RawVolume *v2);
 glm::vec3 calculateNormal(voxel::RawVolume::Sampler &sampler, voxel::Connectivity connectivity);
 
+/**
+ * @brief Assigns the closest normal of the given normal palette to all surface voxels of the volume
+ *
+ * The normals are computed for slices of the volume in parallel and written afterwards - the result is the same as
+ * calling @c calculateNormal() for each surface voxel.
+ * @param recalcAll If this is @c false, only voxels without a normal are updated
+ * @return The number of voxels that got a new normal
+ */
+int calculateNormals(voxel::RawVolumeWrapper &in, const palette::NormalPalette &normalPalette,
+					 voxel::Connectivity connectivity, bool recalcAll = true);
+
 } // namespace voxelutil
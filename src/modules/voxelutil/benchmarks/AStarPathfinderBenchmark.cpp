@@ -0,0 +1,66 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/collection/List.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/AStarPathfinder.h"
+
+class AStarPathfinderBenchmark : public app::AbstractBenchmark {
+protected:
+	voxel::RawVolume v{voxel::Region{0, 63}};
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+
+		const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+		for (int x = 0; x < 64; ++x) {
+			for (int z = 0; z < 64; ++z) {
+				v.setVoxel(x, 0, z, voxel);
+			}
+		}
+		// walls with alternating gaps to force a long path
+		for (int x = 8; x < 64; x += 8) {
+			const int gap = (x / 8) % 2 == 0 ? 2 : 61;
+			for (int z = 0; z < 64; ++z) {
+				if (z >= gap - 1 && z <= gap + 1) {
+					continue;
+				}
+				for (int y = 1; y < 64; ++y) {
+					v.setVoxel(x, y, z, voxel);
+				}
+			}
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(AStarPathfinderBenchmark, Execute)(benchmark::State &state) {
+	const voxel::Connectivity connectivity = (voxel::Connectivity)state.range();
+	for (auto _ : state) {
+		core::List<glm::ivec3> listResult;
+		voxelutil::AStarPathfinderParams<voxel::RawVolume> params(
+			&v, glm::ivec3(0, 1, 0), glm::ivec3(63, 1, 63), &listResult,
+			[](const voxel::RawVolume *vol, const glm::ivec3 &pos) {
+				if (!vol->region().containsPoint(pos) || voxel::isBlocked(vol->voxel(pos).getMaterial())) {
+					return false;
+				}
+				const glm::ivec3 below(pos.x, pos.y - 1, pos.z);
+				return voxel::isBlocked(vol->voxel(below).getMaterial());
+			},
+			1.0f, 1000000, connectivity);
+		voxelutil::AStarPathfinder pathfinder(params);
+		bool found = pathfinder.execute();
+		if (!found) {
+			state.SkipWithError("No path found");
+		}
+		benchmark::DoNotOptimize(found);
+	}
+}
+
+BENCHMARK_REGISTER_F(AStarPathfinderBenchmark, Execute)
+	->Arg((int)voxel::Connectivity::SixConnected)
+	->Arg((int)voxel::Connectivity::EighteenConnected)
+	->Arg((int)voxel::Connectivity::TwentySixConnected)
+	->Unit(benchmark::kMillisecond);
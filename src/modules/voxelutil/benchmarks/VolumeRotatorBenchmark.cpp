@@ -0,0 +1,83 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/ScopedPtr.h"
+#include "math/Axis.h"
+#include "palette/Palette.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/VolumeRescaler.h"
+#include "voxelutil/VolumeRotator.h"
+
+class VolumeRotatorBenchmark : public app::AbstractBenchmark {
+protected:
+	voxel::RawVolume v{voxel::Region{glm::ivec3(0), glm::ivec3(127, 95, 63)}};
+	palette::Palette pal;
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		pal.nippon();
+		// a sphere with a few colors
+		const glm::ivec3 center = v.region().getCenter();
+		for (int z = 0; z < v.depth(); ++z) {
+			for (int y = 0; y < v.height(); ++y) {
+				for (int x = 0; x < v.width(); ++x) {
+					const glm::ivec3 d = glm::ivec3(x, y, z) - center;
+					if (d.x * d.x + d.y * d.y + d.z * d.z <= 30 * 30) {
+						v.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, (x + y + z) % 8));
+					}
+				}
+			}
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(VolumeRotatorBenchmark, RotateAxis)(benchmark::State &state) {
+	const math::Axis axis = (math::Axis)state.range();
+	for (auto _ : state) {
+		core::ScopedPtr<voxel::RawVolume> rotated(voxelutil::rotateAxis(&v, axis));
+		benchmark::DoNotOptimize(rotated->data());
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeRotatorBenchmark, MirrorAxis)(benchmark::State &state) {
+	const math::Axis axis = (math::Axis)state.range();
+	for (auto _ : state) {
+		core::ScopedPtr<voxel::RawVolume> mirrored(voxelutil::mirrorAxis(&v, axis));
+		benchmark::DoNotOptimize(mirrored->data());
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeRotatorBenchmark, RotateVolume)(benchmark::State &state) {
+	for (auto _ : state) {
+		core::ScopedPtr<voxel::RawVolume> rotated(
+			voxelutil::rotateVolume(&v, pal, glm::ivec3(0, 45, 30), glm::vec3(0.5f)));
+		benchmark::DoNotOptimize(rotated->data());
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeRotatorBenchmark, ScaleDown)(benchmark::State &state) {
+	const voxel::Region &srcRegion = v.region();
+	const voxel::Region destRegion(srcRegion.getLowerCorner(),
+								   srcRegion.getLowerCorner() + srcRegion.getDimensionsInVoxels() / 2 - 1);
+	for (auto _ : state) {
+		voxel::RawVolume destVolume(destRegion);
+		voxelutil::scaleDown(v, pal, destVolume);
+		benchmark::DoNotOptimize(destVolume.data());
+	}
+}
+
+BENCHMARK_REGISTER_F(VolumeRotatorBenchmark, RotateAxis)
+	->Arg((int)math::Axis::X)
+	->Arg((int)math::Axis::Y)
+	->Arg((int)math::Axis::Z)
+	->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VolumeRotatorBenchmark, MirrorAxis)
+	->Arg((int)math::Axis::X)
+	->Arg((int)math::Axis::Y)
+	->Arg((int)math::Axis::Z)
+	->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VolumeRotatorBenchmark, RotateVolume)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VolumeRotatorBenchmark, ScaleDown)->Unit(benchmark::kMillisecond);
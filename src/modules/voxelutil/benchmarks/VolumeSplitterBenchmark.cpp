@@ -0,0 +1,49 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/ScopedPtr.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/VolumeCropper.h"
+#include "voxelutil/VolumeSplitter.h"
+
+class VolumeSplitterBenchmark : public app::AbstractBenchmark {
+protected:
+	// a flat terrain like world - most of the tiles above the ground are empty
+	voxel::RawVolume v{voxel::Region{glm::ivec3(0), glm::ivec3(511, 127, 511)}};
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		for (int z = 0; z < v.depth(); ++z) {
+			for (int x = 0; x < v.width(); ++x) {
+				const int height = 8 + (x * 7 + z * 3) % 24;
+				for (int y = 0; y < height; ++y) {
+					v.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, y % 8));
+				}
+			}
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(VolumeSplitterBenchmark, SplitVolume)(benchmark::State &state) {
+	const bool crop = state.range() != 0;
+	for (auto _ : state) {
+		core::DynamicArray<voxel::RawVolume *> volumes = voxelutil::splitVolume(&v, glm::ivec3(32), false, crop);
+		benchmark::DoNotOptimize(volumes.data());
+		for (voxel::RawVolume *volume : volumes) {
+			delete volume;
+		}
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeSplitterBenchmark, CropVolume)(benchmark::State &state) {
+	for (auto _ : state) {
+		core::ScopedPtr<voxel::RawVolume> cropped(voxelutil::cropVolume(&v));
+		benchmark::DoNotOptimize(cropped->data());
+	}
+}
+
+BENCHMARK_REGISTER_F(VolumeSplitterBenchmark, SplitVolume)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VolumeSplitterBenchmark, CropVolume)->Unit(benchmark::kMillisecond);
@@ -31,4 +31,46 @@ TEST_F(AStarPathfinderTest, test) {
 	EXPECT_EQ(20u, listResult.size());
 }
 
+TEST_F(AStarPathfinderTest, testConnectivity) {
+	voxel::RawVolume volume(voxel::Region(0, 20));
+	// a wall with a single hole
+	for (int y = 0; y <= 20; ++y) {
+		for (int z = 0; z <= 20; ++z) {
+			if (y == 10 && z == 10) {
+				continue;
+			}
+			volume.setVoxel(10, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		}
+	}
+	auto isValid = [](const voxel::RawVolume *v, const glm::ivec3 &pos) {
+		return v->region().containsPoint(pos) && !voxel::isBlocked(v->voxel(pos).getMaterial());
+	};
+	const glm::ivec3 start(0, 10, 10);
+	const glm::ivec3 end(20, 10, 10);
+	for (voxel::Connectivity connectivity : {voxel::Connectivity::SixConnected, voxel::Connectivity::EighteenConnected,
+											 voxel::Connectivity::TwentySixConnected}) {
+		core::List<glm::ivec3> listResult;
+		AStarPathfinderParams<voxel::RawVolume> params(&volume, start, end, &listResult, isValid, 1.0f, 100000,
+													   connectivity);
+		AStarPathfinder pathfinder(params);
+		ASSERT_TRUE(pathfinder.execute()) << "connectivity " << (int)connectivity;
+		EXPECT_EQ(21u, listResult.size()) << "connectivity " << (int)connectivity;
+		EXPECT_EQ(start, *listResult.begin());
+		bool passedHole = false;
+		for (const glm::ivec3 &pos : listResult) {
+			passedHole |= pos == glm::ivec3(10, 10, 10);
+		}
+		EXPECT_TRUE(passedHole);
+	}
+
+	// close the hole - there is no path anymore
+	volume.setVoxel(10, 10, 10, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	core::List<glm::ivec3> listResult;
+	AStarPathfinderParams<voxel::RawVolume> params(&volume, start, end, &listResult, isValid, 1.0f, 100000,
+												   voxel::Connectivity::SixConnected);
+	AStarPathfinder pathfinder(params);
+	EXPECT_FALSE(pathfinder.execute());
+	EXPECT_TRUE(listResult.empty());
+}
+
 } // namespace voxelutil
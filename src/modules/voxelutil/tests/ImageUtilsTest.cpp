@@ -5,12 +5,75 @@
 #include "voxelutil/ImageUtils.h"
 #include "app/tests/AbstractTest.h"
 #include "core/ScopedPtr.h"
+#include "core/collection/Buffer.h"
 #include "image/Image.h"
+#include "palette/PaletteLookup.h"
 #include "voxel/RawVolume.h"
+#include "voxel/RawVolumeWrapper.h"
 
 namespace voxelutil {
 
-class ImageUtilsTest : public app::AbstractTest {};
+class ImageUtilsTest : public app::AbstractTest {
+protected:
+	image::ImagePtr createHeightmap(int w, int h) {
+		core::Buffer<core::RGBA> buffer;
+		buffer.resize((size_t)w * h);
+		uint32_t s = 1337u;
+		for (size_t i = 0; i < buffer.size(); ++i) {
+			s = s * 1664525u + 1013904223u;
+			buffer[i] = core::RGBA((s >> 24) % 48u, (s >> 16) & 0xff, (s >> 8) & 0xff, (uint8_t)(s % 40u));
+		}
+		const image::ImagePtr &image = image::createEmptyImage("heightmap");
+		image->loadRGBA((const uint8_t *)buffer.data(), w, h);
+		return image;
+	}
+
+	/**
+	 * @brief The columns that are expected for the heightmap - voxel by voxel
+	 */
+	void expectedHeightmap(voxel::RawVolume &volume, const voxel::Region &region, const image::ImagePtr &image,
+						   const voxel::Voxel &underground, const voxel::Voxel *surface,
+						   palette::PaletteLookup &palLookup, uint8_t minHeight) {
+		const float stepWidthY = (float)image->height() / (float)region.getDepthInVoxels();
+		const float stepWidthX = (float)image->width() / (float)region.getWidthInVoxels();
+		float imageY = 0.0f;
+		for (int z = 0; z < region.getDepthInVoxels(); ++z, imageY += stepWidthY) {
+			float imageX = 0.0f;
+			for (int x = 0; x < region.getWidthInVoxels(); ++x, imageX += stepWidthX) {
+				const core::RGBA pixel = image->colorAt((int)imageX, (int)imageY);
+				int height = surface ? pixel.r : pixel.a;
+				if (height < minHeight) {
+					height = minHeight;
+				}
+				voxel::Voxel top;
+				if (surface) {
+					top = *surface;
+				} else {
+					top = voxel::createVoxel(palLookup.palette(),
+											 palLookup.findClosestIndex(core::RGBA(pixel.r, pixel.g, pixel.b)));
+				}
+				const int lowerY = voxel::isAir(underground.getMaterial()) ? height - 1 : 0;
+				for (int y = core_max(0, lowerY); y < height; ++y) {
+					const glm::ivec3 pos = region.getLowerCorner() + glm::ivec3(x, y, z);
+					if (region.containsPoint(pos)) {
+						volume.setVoxel(pos, y == height - 1 ? top : underground);
+					}
+				}
+			}
+		}
+	}
+
+	void expectEqualVolumes(const voxel::RawVolume &expected, const voxel::RawVolume &volume) {
+		const voxel::Region &region = expected.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					ASSERT_EQ(expected.voxel(x, y, z), volume.voxel(x, y, z)) << x << ":" << y << ":" << z;
+				}
+			}
+		}
+	}
+};
 
 TEST_F(ImageUtilsTest, testImportAsPlane) {
 	const image::ImagePtr &img = image::loadImage("test-palette-in.png");
@@ -63,4 +126,39 @@ TEST_F(ImageUtilsTest, importHeightMaxHeightAlpha) {
 	EXPECT_EQ(129, maxHeight);
 }
 
+TEST_F(ImageUtilsTest, testImportHeightmap) {
+	const image::ImagePtr &image = createHeightmap(97, 61);
+	const voxel::Region volumeRegion(0, 0, 0, 80, 40, 70);
+	// the wrapper region is cropping the heights and is not starting at the origin
+	const voxel::Region region(3, 2, 5, 75, 30, 66);
+	const voxel::Voxel underground = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	const voxel::Voxel surface = voxel::createVoxel(voxel::VoxelType::Generic, 2);
+	palette::PaletteLookup palLookup;
+	for (const voxel::Voxel &ground : {underground, voxel::Voxel()}) {
+		voxel::RawVolume volume(volumeRegion);
+		voxel::RawVolumeWrapper wrapper(&volume, region);
+		voxelutil::importHeightmap(wrapper, image, ground, surface, 2, false);
+		voxel::RawVolume expected(volumeRegion);
+		expectedHeightmap(expected, region, image, ground, &surface, palLookup, 2);
+		expectEqualVolumes(expected, volume);
+		EXPECT_TRUE(wrapper.dirtyRegion().isValid());
+		EXPECT_TRUE(region.containsRegion(wrapper.dirtyRegion()));
+	}
+}
+
+TEST_F(ImageUtilsTest, testImportColoredHeightmap) {
+	const image::ImagePtr &image = createHeightmap(64, 128);
+	const voxel::Region region(-10, 0, -20, 53, 31, 43);
+	const voxel::Voxel underground = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	palette::PaletteLookup palLookup;
+	for (const voxel::Voxel &ground : {underground, voxel::Voxel()}) {
+		voxel::RawVolume volume(region);
+		voxel::RawVolumeWrapper wrapper(&volume);
+		voxelutil::importColoredHeightmap(wrapper, palLookup, image, ground, 0, false);
+		voxel::RawVolume expected(region);
+		expectedHeightmap(expected, region, image, ground, nullptr, palLookup, 0);
+		expectEqualVolumes(expected, volume);
+	}
+}
+
 } // namespace voxelutil
@@ -51,4 +51,24 @@ TEST_F(VolumeCropperTest, testCropBiggerMultiple) {
 	delete croppedVolume;
 }
 
+TEST_F(VolumeCropperTest, testCropEmpty) {
+	voxel::RawVolume volume(voxel::Region(0, 10));
+	EXPECT_EQ(nullptr, voxelutil::cropVolume(&volume));
+	EXPECT_FALSE(voxelutil::calculateUsedRegion(volume, volume.region()).isValid());
+}
+
+TEST_F(VolumeCropperTest, testCopyRegionOutside) {
+	voxel::RawVolume volume(voxel::Region(0, 10));
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	volume.setVoxel(10, 10, 10, voxel);
+	volume.setVoxel(9, 10, 10, voxel::Voxel(voxel::VoxelType::Air, 2));
+	voxel::RawVolume *copy = voxelutil::copyRegion(volume, voxel::Region(5, 15));
+	ASSERT_NE(nullptr, copy);
+	EXPECT_EQ(voxel, copy->voxel(10, 10, 10));
+	EXPECT_EQ(voxel::Voxel(voxel::VoxelType::Air, 0, 0, 0), copy->voxel(9, 10, 10)) << "Air voxels are not copied";
+	EXPECT_TRUE(voxel::isAir(copy->voxel(15, 15, 15).getMaterial()));
+	EXPECT_EQ(voxel::Region(10, 10), voxelutil::calculateUsedRegion(*copy, copy->region()));
+	delete copy;
+}
+
 }
@@ -0,0 +1,145 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "core/ScopedPtr.h"
+#include "core/collection/Buffer.h"
+#include "voxelutil/VolumeImporter.h"
+
+namespace voxelutil {
+
+class VolumeImporterTest : public app::AbstractTest {
+protected:
+	voxel::Voxel _remap[256];
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		_remap[0] = voxel::Voxel();
+		for (int i = 1; i < 256; ++i) {
+			_remap[i] = voxel::createVoxel(voxel::VoxelType::Generic, i);
+		}
+	}
+
+	void fillGrid(core::Buffer<uint8_t> &grid, const glm::ivec3 &size) {
+		grid.resize((size_t)size.x * size.y * size.z);
+		uint32_t s = 42u;
+		for (size_t i = 0; i < grid.size(); ++i) {
+			s = s * 1664525u + 1013904223u;
+			// a lot of empty cells with a few runs of voxels
+			grid[i] = (s >> 24) < 160 ? 0 : (uint8_t)(1 + (s >> 16) % 255);
+		}
+	}
+
+	static glm::ivec3 volumePos(const GridLayout &layout, const glm::ivec3 &gridPos, const glm::ivec3 &mins) {
+		glm::ivec3 pos;
+		for (int i = 0; i < 3; ++i) {
+			const int v = layout.flip[i] ? layout.size[i] - 1 - gridPos[i] : gridPos[i];
+			pos[layout.volumeAxis[i]] = v;
+		}
+		return pos + mins;
+	}
+
+	void checkVolume(const voxel::RawVolume &volume, const GridLayout &layout, const core::Buffer<uint8_t> &grid,
+					 const glm::ivec3 &mins) {
+		int64_t index = 0;
+		for (int z = 0; z < layout.size.z; ++z) {
+			for (int y = 0; y < layout.size.y; ++y) {
+				for (int x = 0; x < layout.size.x; ++x, ++index) {
+					const glm::ivec3 &pos = volumePos(layout, glm::ivec3(x, y, z), mins);
+					ASSERT_EQ(_remap[grid[index]], volume.voxel(pos))
+						<< "grid " << x << ":" << y << ":" << z << " axes " << layout.volumeAxis.x
+						<< layout.volumeAxis.y << layout.volumeAxis.z << " flip " << layout.flip.x << layout.flip.y
+						<< layout.flip.z;
+				}
+			}
+		}
+	}
+};
+
+TEST_F(VolumeImporterTest, testInvalidLayout) {
+	GridLayout layout;
+	layout.size = glm::ivec3(2);
+	layout.volumeAxis = glm::ivec3(0, 0, 2);
+	VolumeImporter importer(layout);
+	EXPECT_FALSE(importer.isValid());
+	EXPECT_EQ(nullptr, importer.release());
+}
+
+TEST_F(VolumeImporterTest, testAllLayouts) {
+	const glm::ivec3 permutations[] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+	const glm::ivec3 mins(-3, 1, 7);
+	for (const glm::ivec3 &permutation : permutations) {
+		for (int flip = 0; flip < 8; ++flip) {
+			GridLayout layout;
+			layout.size = glm::ivec3(21, 4, 3);
+			layout.volumeAxis = permutation;
+			layout.flip = glm::bvec3(flip & 1, flip & 2, flip & 4);
+			core::Buffer<uint8_t> grid;
+			fillGrid(grid, layout.size);
+
+			VolumeImporter importer(layout, mins);
+			ASSERT_TRUE(importer.isValid());
+			importer.setGrid(grid.data(), _remap);
+			core::ScopedPtr<voxel::RawVolume> volume(importer.release());
+			ASSERT_TRUE(volume);
+			for (int i = 0; i < 3; ++i) {
+				EXPECT_EQ(layout.size[i], volume->region().getDimensionsInVoxels()[permutation[i]]);
+			}
+			EXPECT_EQ(mins, volume->region().getLowerCorner());
+			checkVolume(*volume, layout, grid, mins);
+		}
+	}
+}
+
+TEST_F(VolumeImporterTest, testRuns) {
+	GridLayout layout;
+	layout.size = glm::ivec3(5, 3, 4);
+	layout.volumeAxis = glm::ivec3(2, 1, 0);
+	layout.flip = glm::bvec3(true, false, false);
+	core::Buffer<uint8_t> grid;
+	fillGrid(grid, layout.size);
+
+	VolumeImporter importer(layout);
+	// the runs are crossing the rows and slices of the grid
+	size_t index = 0;
+	while (index < grid.size()) {
+		size_t end = index + 1;
+		while (end < grid.size() && grid[end] == grid[index]) {
+			++end;
+		}
+		importer.setRun((int64_t)index, (int64_t)(end - index), _remap[grid[index]]);
+		index = end;
+	}
+	core::ScopedPtr<voxel::RawVolume> volume(importer.release());
+	ASSERT_TRUE(volume);
+	checkVolume(*volume, layout, grid, glm::ivec3(0));
+
+	VolumeImporter fullImporter(layout);
+	fullImporter.setRun(0, (int64_t)grid.size(), _remap[7]);
+	core::ScopedPtr<voxel::RawVolume> fullVolume(fullImporter.release());
+	const voxel::Region &region = fullVolume->region();
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				ASSERT_EQ(_remap[7], fullVolume->voxel(x, y, z));
+			}
+		}
+	}
+}
+
+TEST_F(VolumeImporterTest, testParallelGrid) {
+	GridLayout layout;
+	layout.size = glm::ivec3(64, 70, 64);
+	layout.volumeAxis = glm::ivec3(0, 2, 1);
+	layout.flip = glm::bvec3(true, false, false);
+	core::Buffer<uint8_t> grid;
+	fillGrid(grid, layout.size);
+	VolumeImporter importer(layout);
+	importer.setGrid(grid.data(), _remap);
+	core::ScopedPtr<voxel::RawVolume> volume(importer.release());
+	ASSERT_TRUE(volume);
+	checkVolume(*volume, layout, grid, glm::ivec3(0));
+}
+
+} // namespace voxelutil
@@ -5,6 +5,7 @@
 #include "voxelutil/VolumeRescaler.h"
 #include "app/tests/AbstractTest.h"
 #include "core/ScopedPtr.h"
+#include "palette/Palette.h"
 #include "voxel/RawVolume.h"
 #include "voxel/Region.h"
 #include "voxel/Voxel.h"
@@ -45,4 +46,30 @@ TEST_F(VolumeRescalerTest, testScaleUpFull) {
 	testScaleUpFull(7, 8);
 }
 
+TEST_F(VolumeRescalerTest, testScaleUpVoxels) {
+	voxel::RawVolume volume({0, 3});
+	voxelutil::visitVolume(volume, [&](int x, int y, int z, const voxel::Voxel &voxel) {
+		volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, x + y * 4 + z * 16));
+	}, VisitAll());
+	core::ScopedPtr<voxel::RawVolume> v(voxelutil::scaleUp(volume));
+	ASSERT_TRUE(v);
+	voxelutil::visitVolume(*v, [&](int x, int y, int z, const voxel::Voxel &voxel) {
+		EXPECT_EQ(volume.voxel(x / 2, y / 2, z / 2).getColor(), voxel.getColor()) << x << ":" << y << ":" << z;
+	}, VisitAll());
+}
+
+TEST_F(VolumeRescalerTest, testScaleDownFull) {
+	palette::Palette palette;
+	palette.nippon();
+	voxel::RawVolume volume({0, 31});
+	volume.fill(voxel::createVoxel(palette, 3));
+	voxel::RawVolume destVolume({0, 15});
+	voxelutil::scaleDown(volume, palette, destVolume);
+	const int expectedIndex = palette.getClosestMatch(palette.color(3));
+	voxelutil::visitVolume(destVolume, [&](int x, int y, int z, const voxel::Voxel &voxel) {
+		ASSERT_TRUE(voxel::isBlocked(voxel.getMaterial())) << x << ":" << y << ":" << z;
+		EXPECT_EQ(expectedIndex, voxel.getColor()) << x << ":" << y << ":" << z;
+	}, VisitAll());
+}
+
 } // namespace voxelutil
@@ -11,6 +11,9 @@
 #include "voxel/RawVolume.h"
 #include "voxel/Voxel.h"
 #include "voxel/tests/VoxelPrinter.h"
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/euler_angles.hpp>
+#include <string.h>
 
 namespace glm {
 ::std::ostream &operator<<(::std::ostream &os, const ivec3 &v) {
@@ -27,6 +30,20 @@ namespace voxelutil {
 
 class VolumeRotatorTest : public app::AbstractTest {
 protected:
+	static void fill(voxel::RawVolume &volume) {
+		const voxel::Region &region = volume.region();
+		int i = 0;
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x, ++i) {
+					if (i % 3 != 0) {
+						volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, i % 255 + 1));
+					}
+				}
+			}
+		}
+	}
+
 	// {0, 0, 0}, {0, 1, 0}, {-1, 0, 0}, {1, 0, 0}
 	void rotateAxisAndValidate(math::Axis axis, const glm::ivec3 positions[4]) {
 		const voxel::Region region(-1, 1);
@@ -116,4 +133,81 @@ TEST_F(VolumeRotatorTest, testRotateAxisY45) {
 									 << " " << region;
 }
 
+TEST_F(VolumeRotatorTest, testRotateAxisNonCubic) {
+	const voxel::Region region(glm::ivec3(-3, -2, 1), glm::ivec3(4, 6, 3));
+	voxel::RawVolume volume(region);
+	fill(volume);
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	core::ScopedPtr<voxel::RawVolume> rotatedX(voxelutil::rotateAxis(&volume, math::Axis::X));
+	core::ScopedPtr<voxel::RawVolume> rotatedY(voxelutil::rotateAxis(&volume, math::Axis::Y));
+	core::ScopedPtr<voxel::RawVolume> rotatedZ(voxelutil::rotateAxis(&volume, math::Axis::Z));
+	for (int z = mins.z; z <= maxs.z; ++z) {
+		for (int y = mins.y; y <= maxs.y; ++y) {
+			for (int x = mins.x; x <= maxs.x; ++x) {
+				const voxel::Voxel &expected = volume.voxel(x, y, z);
+				const glm::ivec3 local = glm::ivec3(x, y, z) - mins;
+				EXPECT_TRUE(expected.isSame(rotatedX->voxel(x, z, maxs.y - local.y)));
+				EXPECT_TRUE(expected.isSame(rotatedY->voxel(maxs.z - local.z, y, x)));
+				EXPECT_TRUE(expected.isSame(rotatedZ->voxel(y, maxs.x - local.x, z)));
+			}
+		}
+	}
+}
+
+TEST_F(VolumeRotatorTest, testMirrorAxis) {
+	const voxel::Region region(glm::ivec3(-3, -2, 1), glm::ivec3(4, 6, 3));
+	voxel::RawVolume volume(region);
+	fill(volume);
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	core::ScopedPtr<voxel::RawVolume> mirroredX(voxelutil::mirrorAxis(&volume, math::Axis::X));
+	core::ScopedPtr<voxel::RawVolume> mirroredY(voxelutil::mirrorAxis(&volume, math::Axis::Y));
+	core::ScopedPtr<voxel::RawVolume> mirroredZ(voxelutil::mirrorAxis(&volume, math::Axis::Z));
+	ASSERT_EQ(region, mirroredX->region());
+	for (int z = mins.z; z <= maxs.z; ++z) {
+		for (int y = mins.y; y <= maxs.y; ++y) {
+			for (int x = mins.x; x <= maxs.x; ++x) {
+				const voxel::Voxel &expected = volume.voxel(x, y, z);
+				EXPECT_TRUE(expected.isSame(mirroredX->voxel(maxs.x - x + mins.x, y, z)));
+				EXPECT_TRUE(expected.isSame(mirroredY->voxel(x, maxs.y - y + mins.y, z)));
+				EXPECT_TRUE(expected.isSame(mirroredZ->voxel(x, y, maxs.z - z + mins.z)));
+			}
+		}
+	}
+}
+
+TEST_F(VolumeRotatorTest, testRotateVolumeSameAsSerial) {
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(20, 11, 40));
+	voxel::RawVolume volume(region);
+	fill(volume);
+	const glm::ivec3 angles[]{{0, 45, 30}, {90, 0, 0}, {33, 60, 10}};
+	for (const glm::ivec3 &angle : angles) {
+		core::ScopedPtr<voxel::RawVolume> rotated(
+			voxelutil::rotateVolume(&volume, voxel::getPalette(), angle, glm::vec3(0.5f)));
+		// the voxels are set in the order of the source volume - later voxels win
+		const glm::mat4 &mat = glm::eulerAngleXYZ(glm::radians((float)angle.x), glm::radians((float)angle.y),
+												   glm::radians((float)angle.z));
+		const glm::vec3 pivot(0.5f * glm::vec3(region.getDimensionsInVoxels()));
+		voxel::RawVolume expected(region.rotate(mat, pivot));
+		ASSERT_EQ(expected.region(), rotated->region());
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					const voxel::Voxel &voxel = volume.voxel(x, y, z);
+					if (voxel::isAir(voxel.getMaterial())) {
+						continue;
+					}
+					const glm::ivec3 destPos = glm::floor(math::transform(mat, glm::vec3(x, y, z), pivot));
+					if (expected.region().containsPoint(destPos)) {
+						expected.setVoxel(destPos, voxel);
+					}
+				}
+			}
+		}
+		EXPECT_EQ(0, memcmp(expected.data(), rotated->data(), voxel::RawVolume::size(expected.region())))
+			<< "Rotation by " << angle << " differs";
+	}
+}
+
 } // namespace voxelutil
@@ -85,7 +85,48 @@ TEST_F(VolumeSplitterTest, testSplitObjects) {
 	volume.setVoxel(0, 1, 1, voxel);
 
 	core::DynamicArray<voxel::RawVolume *> rawVolumes = voxelutil::splitObjects(&volume);
-	EXPECT_EQ(5u, rawVolumes.size());
+	ASSERT_EQ(5u, rawVolumes.size());
+	// the objects only get the size of their voxels
+	EXPECT_EQ(voxel::Region(0, 0, 0, 0, 1, 1), rawVolumes[0]->region());
+	EXPECT_EQ(voxel::Region(13, 14, 15, 13, 14, 15), rawVolumes[3]->region());
+	EXPECT_EQ(voxel::Region(14, 15, 16, 16, 16, 16), rawVolumes[4]->region());
+	EXPECT_EQ(voxel, rawVolumes[4]->voxel(14, 15, 16));
+	EXPECT_EQ(6, countVoxels(*rawVolumes[4], voxel));
+	for (voxel::RawVolume *v : rawVolumes) {
+		delete v;
+	}
+}
+
+TEST_F(VolumeSplitterTest, testSplitSparse) {
+	const voxel::Region region(0, 0, 0, 63, 15, 63);
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	voxel::RawVolume volume(region);
+	volume.setVoxel(1, 2, 3, voxel);
+	volume.setVoxel(5, 6, 7, voxel);
+	volume.setVoxel(40, 0, 60, voxel);
+
+	core::DynamicArray<voxel::RawVolume *> rawVolumes = voxelutil::splitVolume(&volume, glm::ivec3(16));
+	ASSERT_EQ(2u, rawVolumes.size()) << "Only the non-empty tiles should get a volume";
+	EXPECT_EQ(voxel::Region(0, 0, 0, 15, 15, 15), rawVolumes[0]->region());
+	EXPECT_EQ(voxel, rawVolumes[0]->voxel(1, 2, 3));
+	EXPECT_EQ(voxel, rawVolumes[0]->voxel(5, 6, 7));
+	EXPECT_EQ(voxel::Region(32, 0, 48, 47, 15, 63), rawVolumes[1]->region());
+	EXPECT_EQ(voxel, rawVolumes[1]->voxel(40, 0, 60));
+	for (voxel::RawVolume *v : rawVolumes) {
+		delete v;
+	}
+
+	rawVolumes = voxelutil::splitVolume(&volume, glm::ivec3(16), true);
+	EXPECT_EQ(16u, rawVolumes.size());
+	for (voxel::RawVolume *v : rawVolumes) {
+		delete v;
+	}
+
+	rawVolumes = voxelutil::splitVolume(&volume, glm::ivec3(16), false, true);
+	ASSERT_EQ(2u, rawVolumes.size());
+	EXPECT_EQ(voxel::Region(1, 2, 3, 5, 6, 7), rawVolumes[0]->region());
+	EXPECT_EQ(voxel::Region(40, 0, 60, 40, 0, 60), rawVolumes[1]->region());
+	EXPECT_EQ(2, countVoxels(*rawVolumes[0], voxel));
 	for (voxel::RawVolume *v : rawVolumes) {
 		delete v;
 	}
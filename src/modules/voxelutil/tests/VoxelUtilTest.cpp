@@ -4,6 +4,7 @@
 
 #include "voxelutil/VoxelUtil.h"
 #include "app/tests/AbstractTest.h"
+#include "palette/NormalPalette.h"
 #include "palette/Palette.h"
 #include "palette/PaletteLookup.h"
 #include "voxel/Face.h"
@@ -235,4 +236,49 @@ TEST_F(VoxelUtilTest, testFillPlaneWithImage) {
 	}
 }
 
+TEST_F(VoxelUtilTest, testCalculateNormals) {
+	voxel::Region region(-4, 12);
+	voxel::RawVolume v(region);
+	// a sphere with a few voxels that already have a normal
+	const glm::ivec3 center = region.getCenter();
+	voxelutil::visitVolume(
+		v, region, 1, 1, 1,
+		[&](int x, int y, int z, const voxel::Voxel &) {
+			const glm::ivec3 d = glm::ivec3(x, y, z) - center;
+			if (d.x * d.x + d.y * d.y + d.z * d.z <= 49) {
+				v.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1, (x + y) % 7 == 0 ? 3 : NO_NORMAL));
+			}
+		},
+		VisitAll());
+	palette::NormalPalette normalPalette;
+	normalPalette.redAlert2();
+
+	for (bool recalcAll : {true, false}) {
+		voxel::RawVolume expected(v);
+		voxel::RawVolume::Sampler sampler(expected);
+		int expectedCnt = 0;
+		// the serial reference implementation
+		visitSurfaceVolume(v, [&](int x, int y, int z, const voxel::Voxel &voxel) {
+			if (!recalcAll && voxel.getNormal() != NO_NORMAL) {
+				return;
+			}
+			sampler.setPosition(x, y, z);
+			const glm::vec3 &normal = calculateNormal(sampler, voxel::Connectivity::TwentySixConnected);
+			expected.setVoxel(x, y, z,
+							  voxel::createVoxel(voxel.getMaterial(), voxel.getColor(),
+												 normalPalette.getClosestMatch(normal), voxel.getFlags()));
+			++expectedCnt;
+		});
+
+		voxel::RawVolume actual(v);
+		voxel::RawVolumeWrapper wrapper(&actual);
+		EXPECT_EQ(expectedCnt, calculateNormals(wrapper, normalPalette, voxel::Connectivity::TwentySixConnected, recalcAll));
+		EXPECT_TRUE(wrapper.dirtyRegion().isValid());
+		visitVolume(expected, [&](int x, int y, int z, const voxel::Voxel &voxel) {
+			ASSERT_TRUE(voxel.isSame(actual.voxel(x, y, z))) << x << ":" << y << ":" << z;
+			ASSERT_EQ(voxel.getNormal(), actual.voxel(x, y, z).getNormal()) << x << ":" << y << ":" << z;
+		});
+	}
+}
+
 } // namespace voxelutil
@@ -22,6 +22,8 @@
 #include "io/FormatDescription.h"
 #include "io/Stream.h"
 #include "io/ZipArchive.h"
+#include "json/JSON.h"
+#include "palette/NormalPalette.h"
 #include "palette/Palette.h"
 #include "palette/PaletteFormatDescription.h"
 #include "scenegraph/JsonExporter.h"
@@ -30,6 +32,7 @@
 #include "scenegraph/SceneGraphUtil.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/RawVolume.h"
+#include "voxel/RawVolumeWrapper.h"
 #include "voxel/Region.h"
 #include "voxel/Voxel.h"
 #include "voxelformat/Format.h"
@@ -43,6 +46,7 @@
 #include "voxelutil/VolumeRotator.h"
 #include "voxelutil/VolumeSplitter.h"
 #include "voxelutil/VolumeVisitor.h"
+#include "voxelutil/VoxelUtil.h"
 
 #include <glm/gtc/quaternion.hpp>
 #include <glm/trigonometric.hpp>
@@ -57,11 +61,14 @@ app::AppState VoxConvert::onConstruct() {
 	const app::AppState state = Super::onConstruct();
 	registerArg("--crop").setDescription("Reduce the models to their real voxel sizes");
 	registerArg("--json").setDescription(
-		"Print the scene graph of the input file. Give full as argument to also get mesh details");
+		"Print the scene graph of the input file. Give full as argument to also get mesh details or probe to only read "
+		"the file headers");
 	registerArg("--export-models").setDescription("Export all the models of a scene into single files");
 	registerArg("--export-palette").setDescription("Export the palette data into the given output file format");
 	registerArg("--filter").setDescription("Model filter. For example '1-4,6'");
 	registerArg("--filter-property").setDescription("Model filter by property. For example 'name:foo'");
+	registerArg("--filter-name")
+		.setDescription("Only load the models with a matching name - wildcards are supported. For example 'arm*'");
 	registerArg("--force").setShort("-f").setDescription("Overwrite existing files");
 	registerArg("--input").setShort("-i").setDescription("Allow to specify input files").addFlag(ARGUMENT_FLAG_FILE);
 	registerArg("--wildcard")
@@ -69,6 +76,7 @@ app::AppState VoxConvert::onConstruct() {
 		.setDescription("Allow to specify input file filter if --input is a directory");
 	registerArg("--merge").setShort("-m").setDescription("Merge models into one volume");
 	registerArg("--mirror").setDescription("Mirror by the given axis (x, y or z)");
+	registerArg("--normals").setDescription("Calculate the normals of the surface voxels");
 	registerArg("--output")
 		.setShort("-o")
 		.setDescription("Allow to specify the output file")
@@ -76,6 +84,9 @@ app::AppState VoxConvert::onConstruct() {
 	registerArg("--rotate")
 		.setDescription(
 			"Rotate by 90 degree at the given axis (x, y or z), specify e.g. x:180 to rotate around x by 180 degree.");
+	registerArg("--region").setDescription(
+		"Only load the voxels inside the given region of the scene <x1:y1:z1:x2:y2:z2> - big scenes are not loaded "
+		"completely");
 	registerArg("--resize").setDescription("Resize the volume by the given x (right), y (up) and z (back) values");
 	registerArg("--scale").setShort("-s").setDescription("Scale model to 50% of its original size");
 	registerArg("--script")
@@ -280,6 +291,7 @@ app::AppState VoxConvert::onInit() {
 	_exportModels = hasArg("--export-models");
 	_cropModels = hasArg("--crop");
 	_surfaceOnly = hasArg("--surface-only");
+	_calculateNormals = hasArg("--normals");
 	_splitModels = hasArg("--split");
 	_printSceneGraph = hasArg("--json");
 	_resizeModels = hasArg("--resize");
@@ -318,6 +330,7 @@ app::AppState VoxConvert::onInit() {
 	Log::info("* scale models:      - %s", (_scaleModels ? "true" : "false"));
 	Log::info("* crop models:       - %s", (_cropModels ? "true" : "false"));
 	Log::info("* surface only:      - %s", (_surfaceOnly ? "true" : "false"));
+	Log::info("* calculate normals: - %s", (_calculateNormals ? "true" : "false"));
 	Log::info("* split models:      - %s", (_splitModels ? "true" : "false"));
 	Log::info("* mirror models:     - %s", (_mirrorModels ? "true" : "false"));
 	Log::info("* translate models:  - %s", (_translateModels ? "true" : "false"));
@@ -346,6 +359,9 @@ app::AppState VoxConvert::onInit() {
 		Log::error("No output specified");
 		return app::AppState::InitFailure;
 	}
+	// nothing is going to operate on the voxels - there is no need to load them
+	_probeOnly = _printSceneGraph && outfiles.empty() && !_exportModels && !_exportPalette && !hasScript &&
+				 getArgVal("--json", "") == "probe";
 
 	const io::ArchivePtr &fsArchive = io::openFilesystemArchive(filesystem());
 	scenegraph::SceneGraph sceneGraph;
@@ -410,6 +426,9 @@ app::AppState VoxConvert::onInit() {
 			}
 		}
 	}
+	if (_probeOnly) {
+		return state;
+	}
 	if (!scriptParameters.empty() && sceneGraph.empty()) {
 		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
 		const voxel::Region region(0, 63);
@@ -526,7 +545,12 @@ app::AppState VoxConvert::onInit() {
 		removeNonSurfaceVoxels(sceneGraph);
 	}
 
-	// STEP 11: split the models
+	// STEP 11: calculate the normals
+	if (_calculateNormals) {
+		calculateNormals(sceneGraph);
+	}
+
+	// STEP 12: split the models
 	if (_splitModels) {
 		split(getArgIvec3("--split"), sceneGraph);
 	}
@@ -569,6 +593,56 @@ core::String VoxConvert::getFilenameForModelName(const core::String &inputfile,
 	return core::string::path(core::string::extractDir(inputfile), core::string::sanitizeFilename(name));
 }
 
+/**
+ * @brief Quotes the given string and escapes quotes, backslashes and control characters - the names are taken from
+ * the files as they are
+ */
+static core::String jsonString(const core::String &str) {
+	const nlohmann::json json(str.c_str());
+	return json.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace).c_str();
+}
+
+static void sceneInfoJson(const core::String &infile, const voxelformat::SceneInfo &info) {
+	Log::printf("{");
+	Log::printf("\"file\": %s,", jsonString(infile).c_str());
+	Log::printf("\"nodes\": [");
+	for (size_t i = 0; i < info.nodes.size(); ++i) {
+		const voxelformat::SceneInfo::Node &node = info.nodes[i];
+		Log::printf("{");
+		Log::printf("\"id\": %i,", (int)i);
+		Log::printf("\"parent\": %i,", node.parent);
+		Log::printf("\"name\": %s,", jsonString(node.name).c_str());
+		Log::printf("\"type\": \"%s\"", scenegraph::SceneGraphNodeTypeStr[core::enumVal(node.type)]);
+		if (node.region.isValid()) {
+			const voxel::Region &region = node.region;
+			Log::printf(",\"region\": {");
+			Log::printf("\"mins\": \"%i:%i:%i\",", region.getLowerX(), region.getLowerY(), region.getLowerZ());
+			Log::printf("\"maxs\": \"%i:%i:%i\",", region.getUpperX(), region.getUpperY(), region.getUpperZ());
+			Log::printf("\"size\": \"%i:%i:%i\"", region.getWidthInVoxels(), region.getHeightInVoxels(),
+						region.getDepthInVoxels());
+			Log::printf("}");
+		}
+		if (node.voxels >= 0) {
+			Log::printf(",\"voxels\": %li", (long)node.voxels);
+		}
+		Log::printf("}");
+		if (i + 1 < info.nodes.size()) {
+			Log::printf(",");
+		}
+	}
+	Log::printf("]");
+	if (info.hasPalette) {
+		Log::printf(",\"palette\": {");
+		Log::printf("\"name\": %s,", jsonString(info.palette.name()).c_str());
+		Log::printf("\"colors\": %i", info.palette.colorCount());
+		Log::printf("}");
+	}
+	if (info.thumbnail && info.thumbnail->isLoaded()) {
+		Log::printf(",\"thumbnail\": \"%i:%i\"", info.thumbnail->width(), info.thumbnail->height());
+	}
+	Log::printf("}\n");
+}
+
 static void printProgress(const char *name, int cur, int max) {
 	// Log::info("%s: %i/%i", name, cur, max);
 }
@@ -584,8 +658,31 @@ bool VoxConvert::handleInputFile(const core::String &infile, const io::ArchivePt
 	scenegraph::SceneGraph newSceneGraph;
 	voxelformat::LoadContext loadCtx;
 	loadCtx.monitor = printProgress;
+	if (hasArg("--region")) {
+		const core::String &arguments = getArgVal("--region");
+		glm::ivec3 mins;
+		glm::ivec3 maxs;
+		if (SDL_sscanf(arguments.c_str(), "%i:%i:%i:%i:%i:%i", &mins.x, &mins.y, &mins.z, &maxs.x, &maxs.y,
+					   &maxs.z) != 6) {
+			Log::error("Invalid region given: '%s' - expected <x1:y1:z1:x2:y2:z2>", arguments.c_str());
+			_exitCode = 1;
+			return false;
+		}
+		loadCtx.region = voxel::Region(mins, maxs);
+	}
+	if (hasArg("--filter-name")) {
+		loadCtx.nodeFilter = getArgVal("--filter-name");
+	}
 	io::FileDescription fileDesc;
 	fileDesc.set(infile);
+	if (_probeOnly) {
+		voxelformat::SceneInfo info;
+		if (!voxelformat::probe(fileDesc, archive, info, loadCtx)) {
+			return false;
+		}
+		sceneInfoJson(infile, info);
+		return true;
+	}
 	if (!voxelformat::loadFormat(fileDesc, archive, newSceneGraph, loadCtx)) {
 		return false;
 	}
@@ -690,6 +787,26 @@ void VoxConvert::removeNonSurfaceVoxels(scenegraph::SceneGraph &sceneGraph) {
 	}
 }
 
+void VoxConvert::calculateNormals(scenegraph::SceneGraph &sceneGraph) {
+	Log::info("Calculate normals");
+	for (auto iter = sceneGraph.beginModel(); iter != sceneGraph.end(); ++iter) {
+		scenegraph::SceneGraphNode &node = *iter;
+		if (!node.hasNormalPalette()) {
+			palette::NormalPalette normalPalette;
+			const core::String &normalPaletteName = core::Var::getSafe(cfg::NormalPalette)->strVal();
+			if (!normalPalette.load(normalPaletteName.c_str())) {
+				Log::debug("Failed to load normal palette %s - use redalert2 as default", normalPaletteName.c_str());
+				normalPalette.redAlert2();
+			}
+			node.setNormalPalette(normalPalette);
+		}
+		voxel::RawVolumeWrapper wrapper(node.volume());
+		const int cnt = voxelutil::calculateNormals(wrapper, node.normalPalette(),
+													voxel::Connectivity::TwentySixConnected);
+		Log::debug("Calculated %i normals for node %s", cnt, node.name().c_str());
+	}
+}
+
 void VoxConvert::script(const core::String &scriptParameters, scenegraph::SceneGraph &sceneGraph, uint8_t color) {
 	voxelgenerator::LUAApi script(_filesystem);
 	if (!script.init()) {
@@ -36,8 +36,10 @@ private:
 	bool _exportModels = false;
 	bool _cropModels = false;
 	bool _surfaceOnly = false;
+	bool _calculateNormals = false;
 	bool _splitModels = false;
 	bool _printSceneGraph = false;
+	bool _probeOnly = false;
 	bool _resizeModels = false;
 
 protected:
@@ -57,6 +59,7 @@ protected:
 	void translate(const glm::ivec3& pos, scenegraph::SceneGraph& sceneGraph);
 	void crop(scenegraph::SceneGraph& sceneGraph);
 	void removeNonSurfaceVoxels(scenegraph::SceneGraph& sceneGraph);
+	void calculateNormals(scenegraph::SceneGraph& sceneGraph);
 	void filterModels(scenegraph::SceneGraph& sceneGraph);
 	void filterModelsByProperty(scenegraph::SceneGraph& sceneGraph, const core::String &property, const core::String &value);
 	void exportModelsIntoSingleObjects(scenegraph::SceneGraph& sceneGraph, const core::String &inputfile, const core::String &ext);
@@ -16,10 +16,15 @@ namespace voxedit {
 
 bool RenderPanel::init() {
 	_texture = video::createEmptyTexture("pathtracer");
+	_sceneMgr->sceneGraph().registerListener(this);
 
 	return true;
 }
 
+void RenderPanel::onNodeModified(int nodeId) {
+	_pathTracer.markDirty(nodeId);
+}
+
 void RenderPanel::renderMenuBar(const scenegraph::SceneGraph &sceneGraph) {
 	if (ImGui::BeginMenuBar()) {
 		if (_image && _image->isLoaded()) {
@@ -81,6 +86,9 @@ void RenderPanel::updateSettings(const char *id, const scenegraph::SceneGraph &s
 		yocto::trace_params &params = state.params;
 		int changed = 0;
 		changed += ImGui::InputInt(_("Dimensions"), &params.resolution, 0, 0, ImGuiInputTextFlags_ReadOnly);
+		changed += ImGui::Checkbox(_("Voxel traversal"), &state.voxelTraversal);
+		ImGui::TooltipTextUnformatted(_("Trace the voxels directly instead of converting the volumes into triangles. "
+										"Only path tracing and the eyelight preview are supported in this mode."));
 		changed += ImGui::ComboItems(_("Tracer"), (int *)&params.sampler, yocto::trace_sampler_names);
 		changed += ImGui::InputInt(_("Samples"), &params.samples, 16, 4096);
 		ImGui::TooltipTextUnformatted(_("The number of per-pixel samples used while rendering and is the only "
@@ -132,6 +140,10 @@ void RenderPanel::updateSettings(const char *id, const scenegraph::SceneGraph &s
 }
 
 void RenderPanel::shutdown() {
+	scenegraph::SceneGraph &sceneGraph = _sceneMgr->sceneGraph();
+	if (sceneGraph.isRegistered(this)) {
+		sceneGraph.unregisterListener(this);
+	}
 	if (_texture) {
 		_texture->shutdown();
 	}
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "scenegraph/SceneGraphListener.h"
 #include "ui/Panel.h"
 #include "video/Texture.h"
 #include "voxelpathtracer/PathTracer.h"
@@ -17,7 +18,7 @@ namespace voxedit {
 class SceneManager;
 typedef core::SharedPtr<SceneManager> SceneManagerPtr;
 
-class RenderPanel : public ui::Panel {
+class RenderPanel : public ui::Panel, public scenegraph::SceneGraphListener {
 private:
 	using Super = ui::Panel;
 	voxelpathtracer::PathTracer _pathTracer;
@@ -35,6 +36,11 @@ public:
 	void update(const char *id, const scenegraph::SceneGraph &sceneGraph);
 	bool init();
 	void shutdown();
+
+	/**
+	 * @brief Only the acceleration data of the modified nodes is rebuilt once the path tracer is started again
+	 */
+	void onNodeModified(int nodeId) override;
 #ifdef IMGUI_ENABLE_TEST_ENGINE
 	void registerUITests(ImGuiTestEngine *engine, const char *id) override;
 #endif
@@ -165,18 +165,7 @@ bool SceneManager::calculateNormals(int nodeId, voxel::Connectivity connectivity
 		if (fillAndHollow) {
 			voxelutil::fillHollow(wrapper, _modifierFacade.cursorVoxel());
 		}
-		voxel::RawVolumeWrapper::Sampler sampler(wrapper);
-		const palette::NormalPalette &normalPalette = node->normalPalette();
-		voxelutil::visitSurfaceVolume(*node->volume(), [&] (int x, int y, int z, const voxel::Voxel &voxel) {
-			if (!recalcAll && voxel.getNormal() != NO_NORMAL) {
-				return;
-			}
-			sampler.setPosition(x, y, z);
-			const glm::vec3 &normal = voxelutil::calculateNormal(sampler, connectivity);
-			const uint8_t normalIndex = normalPalette.getClosestMatch(normal);
-			const voxel::Voxel newVoxel = voxel::createVoxel(voxel.getMaterial(), voxel.getColor(), normalIndex, voxel.getFlags());
-			wrapper.setVoxel(x, y, z, newVoxel);
-		});
+		voxelutil::calculateNormals(wrapper, node->normalPalette(), connectivity, recalcAll);
 		if (fillAndHollow) {
 			voxelutil::hollow(wrapper);
 		}
@@ -521,6 +510,7 @@ void SceneManager::modified(int nodeId, const voxel::Region& modifiedRegion, boo
 		Log::debug("Modify region for nodeid %i", nodeId);
 		_sceneRenderer->updateNodeRegion(nodeId, modifiedRegion, renderRegionMillis);
 	}
+	_sceneGraph.notifyNodeModified(nodeId);
 	markDirty();
 	resetLastTrace();
 }
@@ -1570,6 +1560,8 @@ void SceneManager::construct() {
 	_movementSpeed = core::Var::get(cfg::VoxEditMovementSpeed, "180.0f");
 	_transformUpdateChildren = core::Var::get(cfg::VoxEditTransformUpdateChildren, "true", -1, _("Update the children of a node when the transform of the node changes"));
 	_maxSuggestedVolumeSize = core::Var::getSafe(cfg::VoxEditMaxSuggestedVolumeSize);
+	_undoMemory = core::Var::get(cfg::VoxEditUndoMemory, "512", -1, _("The amount of memory in MB the compressed undo states may use"));
+	_undoSpill = core::Var::get(cfg::VoxEditUndoSpill, "true", -1, _("Move old undo states to disk instead of removing them if the undo memory is exhausted"), core::Var::boolValidator);
 
 	command::Command::registerCommand("resizetoselection", [&](const command::CmdArgs &args) {
 		const voxel::Region &region = modifier().selectionMgr().region();
@@ -2343,6 +2335,7 @@ bool SceneManager::init() {
 
 	voxel::Region maxUndoRegion(0, _maxSuggestedVolumeSize->intVal() - 1);
 	_mementoHandler.setMaxUndoRegion(maxUndoRegion);
+	updateUndoMemoryBudget();
 
 	_modifierFacade.setLockedAxis(math::Axis::None, true);
 	return true;
@@ -2447,6 +2440,9 @@ bool SceneManager::update(double nowSeconds) {
 		_mementoHandler.setMaxUndoRegion(maxUndoRegion);
 		_maxSuggestedVolumeSize->markClean();
 	}
+	if (_undoMemory->isDirty() || _undoSpill->isDirty()) {
+		updateUndoMemoryBudget();
+	}
 
 	_movement.update(nowSeconds);
 	voxelgenerator::ScriptState state = _luaApi.update(nowSeconds);
@@ -3213,6 +3209,17 @@ bool SceneManager::nodeRemove(int nodeId, bool recursive) {
 	return false;
 }
 
+void SceneManager::updateUndoMemoryBudget() {
+	if (_undoSpill->boolVal()) {
+		_mementoHandler.setSpillDirectory(io::filesystem()->homeWritePath("undo"));
+	} else {
+		_mementoHandler.setSpillDirectory("");
+	}
+	_mementoHandler.setMemoryBudget((size_t)core_max(1, _undoMemory->intVal()) * 1024u * 1024u);
+	_undoMemory->markClean();
+	_undoSpill->markClean();
+}
+
 bool SceneManager::exceedsMaxSuggestedVolumeSize() const {
 	const int maxDim = _maxSuggestedVolumeSize->intVal();
 	const int maxVoxels = maxDim * maxDim * maxDim;